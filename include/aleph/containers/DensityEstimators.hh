@@ -0,0 +1,602 @@
+#ifndef ALEPH_CONTAINERS_DENSITY_ESTIMATORS_HH__
+#define ALEPH_CONTAINERS_DENSITY_ESTIMATORS_HH__
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace containers
+{
+
+/**
+  @namespace kernels
+  @brief     Radial kernels for tree-based density estimation
+
+  In contrast to the kernels of `math::KernelDensityEstimator`, these
+  kernels are evaluated for *squared* Euclidean distances and include
+  their bandwidth. Every kernel is monotonically decreasing, which is
+  required for bounding its values in a region of space, and reports
+  the radius of its support as well as its normalization constant.
+*/
+
+namespace kernels
+{
+
+/**
+  @class Gaussian
+  @brief Multivariate Gaussian kernel with an isotropic bandwidth
+*/
+
+class Gaussian
+{
+public:
+  explicit Gaussian( double bandwidth = 1.0 )
+    : _h( bandwidth )
+  {
+  }
+
+  double operator()( double squaredDistance ) const
+  {
+    return std::exp( -0.5 * squaredDistance / ( _h * _h ) );
+  }
+
+  /** @returns Squared radius beyond which the kernel vanishes */
+  double squaredSupport() const noexcept
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  /** @returns Factor that makes the kernel integrate to one in d dimensions */
+  double normalization( std::size_t d ) const
+  {
+    return 1.0 / std::pow( std::sqrt( 2.0 * M_PI ) * _h, static_cast<double>( d ) );
+  }
+
+private:
+  double _h;
+};
+
+/**
+  @class Epanechnikov
+  @brief Multivariate Epanechnikov kernel with an isotropic bandwidth
+*/
+
+class Epanechnikov
+{
+public:
+  explicit Epanechnikov( double bandwidth = 1.0 )
+    : _h( bandwidth )
+  {
+  }
+
+  double operator()( double squaredDistance ) const
+  {
+    return squaredDistance < _h * _h ? 1.0 - squaredDistance / ( _h * _h ) : 0.0;
+  }
+
+  double squaredSupport() const noexcept
+  {
+    return _h * _h;
+  }
+
+  double normalization( std::size_t d ) const
+  {
+    // Volume of the d-dimensional unit ball
+    auto D = static_cast<double>( d );
+    auto V = std::pow( M_PI, 0.5 * D ) / std::tgamma( 0.5 * D + 1.0 );
+
+    return ( D + 2.0 ) / ( 2.0 * V * std::pow( _h, D ) );
+  }
+
+private:
+  double _h;
+};
+
+/**
+  @class TruncatedGaussian
+  @brief Truncated Gaussian kernel of `estimateDensityTruncatedGaussian()`
+
+  Uses the same, unnormalized, definition as the original estimator, so
+  both yield the same density values. Points farther away than the
+  bandwidth do not contribute anything.
+*/
+
+class TruncatedGaussian
+{
+public:
+  explicit TruncatedGaussian( double bandwidth = 1.0 )
+    : _h( bandwidth )
+  {
+  }
+
+  double operator()( double squaredDistance ) const
+  {
+    return squaredDistance <= _h * _h ? std::exp( -squaredDistance / ( 2.0 * _h ) ) : 0.0;
+  }
+
+  double squaredSupport() const noexcept
+  {
+    return _h * _h;
+  }
+
+  double normalization( std::size_t ) const noexcept
+  {
+    return 1.0;
+  }
+
+private:
+  double _h;
+};
+
+} // namespace kernels
+
+/**
+  @class TreeDensityEstimator
+  @brief Kernel density estimator with guaranteed error bounds
+
+  Evaluates the kernel density estimate
+
+    f(x) = c / n * sum_i K( |x - x_i|^2 )
+
+  of a point cloud with Euclidean distances. Instead of visiting all pairs
+  of points, the points are stored in a kd-tree whose nodes know their
+  bounding boxes. For every query, the tree is traversed from its root,
+  and all points of a node are approximated by the mean of the smallest
+  and the largest kernel value that can occur in its box, provided that
+  the resulting error is within the permitted share of the node. Nodes
+  outside of the support of a kernel, as well as nodes in which a kernel
+  is constant, are skipped without any error.
+
+  The error of every estimate is at most max(a, r * f(x)) for an absolute
+  tolerance a and a relative tolerance r. By default, both tolerances are
+  zero, which only skips nodes that do not contribute anything.
+
+  Queries are processed in parallel. The densities of the points of the
+  point cloud are evaluated in the order of the tree, so every batch of
+  queries traverses the same parts of the tree.
+*/
+
+template <class Container, class Kernel> class TreeDensityEstimator
+{
+public:
+  using T = typename Container::ElementType;
+
+  TreeDensityEstimator( const Container& container, Kernel kernel = Kernel(), std::size_t leafSize = 32 )
+    : _n( container.size() )
+    , _d( container.dimension() )
+    , _kernel( kernel )
+    , _normalization( _n > 0 ? kernel.normalization( _d ) / static_cast<double>( _n ) : 0.0 )
+    , _leafSize( std::max( leafSize, std::size_t(1) ) )
+  {
+    this->build( container );
+  }
+
+  /** Sets the absolute error tolerance of the density estimates */
+  void setAbsoluteError( double error )
+  {
+    if( error < 0.0 )
+      throw std::runtime_error( "Error tolerance must be non-negative" );
+
+    _absoluteError = error;
+  }
+
+  /** Sets the relative error tolerance of the density estimates */
+  void setRelativeError( double error )
+  {
+    if( error < 0.0 )
+      throw std::runtime_error( "Error tolerance must be non-negative" );
+
+    _relativeError = error;
+  }
+
+  /** Sets the number of queries that are assigned to a thread at once */
+  void setBatchSize( std::size_t size ) noexcept
+  {
+    _batchSize = std::max( size, std::size_t(1) );
+  }
+
+  double absoluteError() const noexcept { return _absoluteError; }
+  double relativeError() const noexcept { return _relativeError; }
+  std::size_t batchSize() const noexcept { return _batchSize;    }
+
+  /** @returns Density estimate at a single point with d coordinates */
+  double operator()( const T* x ) const
+  {
+    std::vector<Entry> stack;
+    return this->evaluate( x, stack );
+  }
+
+  /**
+    @returns Density estimates of all points of the point cloud, in the
+    order of the point cloud. The values can be used directly as vertex
+    data for `buildVietorisRipsComplex()`.
+  */
+
+  std::vector<double> operator()() const
+  {
+    std::vector<double> result( _n );
+
+    #pragma omp parallel
+    {
+      std::vector<Entry> stack;
+
+      #pragma omp for schedule(dynamic, 1)
+      for( std::size_t batch = 0; batch < _n; batch += _batchSize )
+      {
+        auto end = std::min( batch + _batchSize, _n );
+
+        for( std::size_t i = batch; i < end; i++ )
+          result[ _indices[i] ] = this->evaluate( _points.data() + i * _d, stack );
+      }
+    }
+
+    return result;
+  }
+
+  /** @returns Density estimates of all points of another point cloud */
+  std::vector<double> operator()( const Container& queries ) const
+  {
+    if( queries.dimension() != _d )
+      throw std::runtime_error( "Dimension of queries does not match dimension of point cloud" );
+
+    auto m = queries.size();
+    std::vector<double> result( m );
+
+    #pragma omp parallel
+    {
+      std::vector<Entry> stack;
+
+      #pragma omp for schedule(dynamic, 1)
+      for( std::size_t batch = 0; batch < m; batch += _batchSize )
+      {
+        auto end = std::min( batch + _batchSize, m );
+
+        for( std::size_t i = batch; i < end; i++ )
+          result[i] = this->evaluate( queries.data() + i * _d, stack );
+      }
+    }
+
+    return result;
+  }
+
+private:
+
+  /**
+    Node of the kd-tree, covering a range of the permuted points. Inner
+    nodes have exactly two children.
+  */
+
+  struct Node
+  {
+    std::size_t begin;
+    std::size_t end;
+    std::size_t left;
+    std::size_t right;
+
+    bool isLeaf() const noexcept
+    {
+      return left == 0;
+    }
+  };
+
+  /**
+    Pending node of a traversal, together with the squared distance of
+    the query to its box, the number of its points, and the bounds of the
+    kernel values of its points.
+  */
+
+  struct Entry
+  {
+    std::size_t node;
+    double minimum;
+    double count;
+    double kMin;
+    double kMax;
+
+    /** Contribution of the node to a lower bound of the kernel sum */
+    double lower() const noexcept
+    {
+      return count * kMin;
+    }
+
+    /** Error of approximating all kernel values by the mean of their bounds */
+    double error() const noexcept
+    {
+      return 0.5 * count * ( kMax - kMin );
+    }
+  };
+
+  /**
+    Builds the kd-tree by splitting nodes at the median of their widest
+    dimension. Points are copied in the order of the tree, so all points
+    of a node are stored contiguously.
+  */
+
+  void build( const Container& container )
+  {
+    _indices.resize( _n );
+    std::iota( _indices.begin(), _indices.end(), std::size_t(0) );
+
+    if( _n == 0 )
+      return;
+
+    const T* points = container.data();
+
+    _nodes.push_back( Node{ 0, _n, 0, 0 } );
+
+    // Nodes are appended while iterating, so their children are created
+    // in breadth-first order.
+    for( std::size_t k = 0; k < _nodes.size(); k++ )
+    {
+      auto begin = _nodes[k].begin;
+      auto end   = _nodes[k].end;
+
+      std::vector<double> lower( _d,  std::numeric_limits<double>::infinity() );
+      std::vector<double> upper( _d, -std::numeric_limits<double>::infinity() );
+
+      for( std::size_t i = begin; i < end; i++ )
+      {
+        for( std::size_t c = 0; c < _d; c++ )
+        {
+          auto x   = static_cast<double>( points[ _indices[i] * _d + c ] );
+          lower[c] = std::min( lower[c], x );
+          upper[c] = std::max( upper[c], x );
+        }
+      }
+
+      _lower.insert( _lower.end(), lower.begin(), lower.end() );
+      _upper.insert( _upper.end(), upper.begin(), upper.end() );
+
+      if( end - begin <= _leafSize )
+        continue;
+
+      std::size_t dimension = 0;
+
+      for( std::size_t c = 1; c < _d; c++ )
+        if( upper[c] - lower[c] > upper[dimension] - lower[dimension] )
+          dimension = c;
+
+      // All points coincide, so splitting the node is pointless
+      if( _d == 0 || upper[dimension] == lower[dimension] )
+        continue;
+
+      auto middle = begin + ( end - begin ) / 2;
+
+      std::nth_element( _indices.begin() + static_cast<std::ptrdiff_t>( begin ),
+                        _indices.begin() + static_cast<std::ptrdiff_t>( middle ),
+                        _indices.begin() + static_cast<std::ptrdiff_t>( end ),
+                        [&] ( std::size_t i, std::size_t j )
+                        {
+                          return points[ i * _d + dimension ] < points[ j * _d + dimension ];
+                        } );
+
+      _nodes[k].left  = _nodes.size();
+      _nodes[k].right = _nodes.size() + 1;
+
+      _nodes.push_back( Node{ begin,  middle, 0, 0 } );
+      _nodes.push_back( Node{ middle, end,    0, 0 } );
+    }
+
+    _points.resize( _n * _d );
+
+    for( std::size_t i = 0; i < _n; i++ )
+      std::copy( points + _indices[i] * _d, points + ( _indices[i] + 1 ) * _d, _points.begin() + static_cast<std::ptrdiff_t>( i * _d ) );
+  }
+
+  /** Calculates the smallest and the largest squared distance of a point to the box of a node */
+  std::pair<double, double> squaredDistances( const T* x, std::size_t node ) const
+  {
+    const double* lower = _lower.data() + node * _d;
+    const double* upper = _upper.data() + node * _d;
+
+    double minimum = 0.0;
+    double maximum = 0.0;
+
+    for( std::size_t c = 0; c < _d; c++ )
+    {
+      auto y = static_cast<double>( x[c] );
+      auto a = y - lower[c];
+      auto b = upper[c] - y;
+
+      if( a < 0.0 )
+        minimum += a * a;
+      else if( b < 0.0 )
+        minimum += b * b;
+
+      auto f   = std::max( std::abs( a ), std::abs( b ) );
+      maximum += f * f;
+    }
+
+    return std::make_pair( minimum, maximum );
+  }
+
+  Entry makeEntry( const T* x, std::size_t node ) const
+  {
+    auto distances = this->squaredDistances( x, node );
+    auto count     = static_cast<double>( _nodes[node].end - _nodes[node].begin );
+
+    // Outside of the support, the node does not contribute anything
+    if( distances.first > _kernel.squaredSupport() )
+      return Entry{ node, distances.first, count, 0.0, 0.0 };
+
+    return Entry{ node, distances.first, count, _kernel( distances.second ), _kernel( distances.first ) };
+  }
+
+  /**
+    Evaluates the density estimate at a single point. The stack of nodes
+    is provided by the caller in order to re-use its memory.
+
+    The traversal maintains a lower bound of the kernel sum, comprising
+    all exact contributions, all approximations, and the smallest kernel
+    values of all pending nodes. Since this bound never exceeds the final
+    sum, the relative error criterion is always conservative.
+
+    Every approximated node may use its share of the error budget that
+    has not been spent yet. Nearby nodes are processed first and rarely
+    spend anything, so distant nodes are approximated more aggressively.
+    Since the error bound of a node is the difference of its kernel values
+    at the closest and farthest point of its box, nodes in which a kernel
+    is constant are approximated even if both tolerances are zero.
+  */
+
+  double evaluate( const T* x, std::vector<Entry>& stack ) const
+  {
+    if( _n == 0 )
+      return 0.0;
+
+    auto absolute = _normalization > 0.0 ? _absoluteError / _normalization : 0.0;
+
+    double sum     = 0.0; // estimate of the kernel sum
+    double settled = 0.0; // lower bound of the kernel sum of all processed nodes
+    double spent   = 0.0; // error of all approximations
+
+    // Bounds for all pending nodes; their sum with the settled values
+    // is a lower bound of the kernel sum.
+    double pendingLower = 0.0;
+    double pendingError = 0.0;
+    double pendingCount = 0.0;
+
+    auto push = [&] ( const Entry& entry )
+    {
+      stack.push_back( entry );
+
+      pendingLower += entry.lower();
+      pendingError += entry.error();
+      pendingCount += entry.count;
+    };
+
+    stack.clear();
+    push( this->makeEntry( x, 0 ) );
+
+    while( !stack.empty() )
+    {
+      auto tolerance = std::max( absolute, _relativeError * ( settled + pendingLower ) );
+
+      // If the remaining budget covers all pending nodes, they are all
+      // approximated at once. This terminates the traversal as soon as
+      // the far field is sufficiently well-known.
+      if( tolerance > 0.0 && pendingError <= tolerance - spent )
+      {
+        sum += pendingLower + pendingError;
+        break;
+      }
+
+      auto entry = stack.back();
+      stack.pop_back();
+
+      pendingLower -= entry.lower();
+      pendingError -= entry.error();
+      pendingCount -= entry.count;
+
+      if( entry.kMax == 0.0 )
+        continue;
+
+      // Every node may use its share of the remaining budget
+      if( entry.error() <= ( tolerance - spent ) * entry.count / ( pendingCount + entry.count ) )
+      {
+        sum     += entry.lower() + entry.error();
+        settled += entry.lower();
+        spent   += entry.error();
+
+        continue;
+      }
+
+      auto&& N = _nodes[entry.node];
+
+      if( N.isLeaf() )
+      {
+        double partial = 0.0;
+
+        for( std::size_t i = N.begin; i < N.end; i++ )
+        {
+          const T* y = _points.data() + i * _d;
+          double distance = 0.0;
+
+          for( std::size_t c = 0; c < _d; c++ )
+          {
+            auto z    = static_cast<double>( x[c] ) - static_cast<double>( y[c] );
+            distance += z * z;
+          }
+
+          partial += _kernel( distance );
+        }
+
+        sum     += partial;
+        settled += partial;
+
+        continue;
+      }
+
+      // Children are pushed such that the closer one is processed first,
+      // which increases the lower bound as quickly as possible.
+      auto left  = this->makeEntry( x, N.left );
+      auto right = this->makeEntry( x, N.right );
+
+      if( left.minimum < right.minimum )
+        std::swap( left, right );
+
+      push( left );
+      push( right );
+    }
+
+    return _normalization * sum;
+  }
+
+  std::size_t _n;
+  std::size_t _d;
+
+  Kernel _kernel;
+  double _normalization;
+
+  std::size_t _leafSize;
+  std::size_t _batchSize = 64;
+
+  double _absoluteError = 0.0;
+  double _relativeError = 0.0;
+
+  std::vector<Node>        _nodes;
+  std::vector<double>      _lower;   // lower corners of bounding boxes
+  std::vector<double>      _upper;   // upper corners of bounding boxes
+  std::vector<std::size_t> _indices; // original index of every point in tree order
+  std::vector<T>           _points;  // coordinates in tree order
+};
+
+/**
+  Convenience function for estimating the density of all points of a
+  point cloud with a given kernel and error tolerances.
+
+  @param container     Point cloud
+  @param kernel        Kernel, e.g. `kernels::Gaussian( h )`
+  @param absoluteError Absolute error tolerance
+  @param relativeError Relative error tolerance
+
+  @returns Density estimates in the order of the point cloud
+*/
+
+template <class Container, class Kernel> std::vector<double> estimateDensity( const Container& container,
+                                                                              Kernel kernel,
+                                                                              double absoluteError = 0.0,
+                                                                              double relativeError = 0.0 )
+{
+  TreeDensityEstimator<Container, Kernel> estimator( container, kernel );
+
+  estimator.setAbsoluteError( absoluteError );
+  estimator.setRelativeError( relativeError );
+
+  return estimator();
+}
+
+} // namespace containers
+
+} // namespace aleph
+
+#endif
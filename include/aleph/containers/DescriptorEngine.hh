@@ -0,0 +1,501 @@
+#ifndef ALEPH_CONTAINERS_DESCRIPTOR_ENGINE_HH__
+#define ALEPH_CONTAINERS_DESCRIPTOR_ENGINE_HH__
+
+#include <aleph/geometry/distances/Traits.hh>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace containers
+{
+
+/**
+  @struct Descriptors
+  @brief Values of all data descriptors calculated by a DescriptorEngine
+
+  Every vector contains one value per point, in the order of the point
+  cloud. Descriptors that have not been requested remain empty.
+*/
+
+struct Descriptors
+{
+  /** Eccentricities, one vector for every requested order */
+  std::vector< std::vector<double> > eccentricities;
+
+  /** Truncated Gaussian density estimates */
+  std::vector<double> truncatedGaussian;
+
+  /** Distance to a measure density estimates */
+  std::vector<double> distanceToMeasure;
+
+  /** Distance to the k-th nearest neighbour */
+  std::vector<double> kNNDistance;
+};
+
+namespace detail
+{
+
+/** Raises a value to a non-negative integer power by repeated squaring */
+inline double power( double x, unsigned p ) noexcept
+{
+  double result = 1.0;
+
+  for( ; p != 0; p >>= 1 )
+  {
+    if( p & 1 )
+      result *= x;
+
+    x *= x;
+  }
+
+  return result;
+}
+
+/**
+  Bounded max-heap that keeps the k smallest values that have been
+  inserted. The heap is stored in a range of an external array, so the
+  heaps of all rows of a tile share a single allocation.
+*/
+
+class BoundedHeap
+{
+public:
+  BoundedHeap( double* values, std::size_t capacity )
+    : _values( values )
+    , _capacity( capacity )
+  {
+  }
+
+  void insert( double value )
+  {
+    if( _size < _capacity )
+    {
+      _values[ _size++ ] = value;
+      std::push_heap( _values, _values + _size );
+    }
+    else if( value < _values[0] )
+    {
+      std::pop_heap( _values, _values + _size );
+      _values[ _size - 1 ] = value;
+      std::push_heap( _values, _values + _size );
+    }
+  }
+
+  /** @returns Largest value that is currently stored, or infinity if the heap is not full */
+  double bound() const noexcept
+  {
+    return _size < _capacity ? std::numeric_limits<double>::infinity() : _values[0];
+  }
+
+  std::size_t size() const noexcept
+  {
+    return _size;
+  }
+
+  const double* begin() const noexcept { return _values;         }
+  const double* end()   const noexcept { return _values + _size; }
+
+private:
+  double* _values;
+  std::size_t _capacity;
+  std::size_t _size = 0;
+};
+
+} // namespace detail
+
+/**
+  @class DescriptorEngine
+  @brief Calculates multiple data descriptors of a point cloud in one pass
+
+  Every descriptor of `DataDescriptors.hh` requires all pairwise distances
+  of a point cloud. Instead of calculating them once per descriptor, this
+  engine calculates the distances in tiles of rows and columns, and
+  updates all requested descriptors from every tile:
+
+  - eccentricities of arbitrary orders, using integer powers
+  - truncated Gaussian density estimates
+  - distance to a measure density estimates, based on the k smallest
+    distances of every point, including the point itself
+  - distances to the k-th nearest neighbour
+
+  Row tiles are processed in parallel, so no synchronization is required.
+  Every tile of distances is small enough to remain in the cache while it
+  is being consumed.
+
+  In the approximate mode, all descriptors are restricted to the k nearest
+  neighbours that are reported by a nearest neighbour wrapper. The density
+  estimates are exact if the neighbourhoods contain all points within the
+  bandwidth, and all k neighbours of the distance to a measure estimator,
+  respectively. Eccentricities become local, i.e. they only account for
+  the neighbourhood of every point.
+*/
+
+template <class Distance, class Container> class DescriptorEngine
+{
+public:
+  using Traits = distances::Traits<Distance>;
+
+  explicit DescriptorEngine( const Container& container )
+    : _container( container )
+  {
+  }
+
+  /**
+    Sets the orders of all eccentricities to calculate. An order of zero
+    refers to the maximum eccentricity.
+  */
+
+  void setEccentricityOrders( std::vector<unsigned> orders )
+  {
+    _orders = std::move( orders );
+  }
+
+  /** Sets the bandwidth of the truncated Gaussian estimator; zero disables it */
+  void setBandwidth( double bandwidth )
+  {
+    if( bandwidth < 0.0 )
+      throw std::runtime_error( "Bandwidth must be non-negative" );
+
+    _bandwidth = bandwidth;
+  }
+
+  /**
+    Sets the number of neighbours for the distance to a measure estimator
+    and the k-th nearest neighbour distance; zero disables both.
+  */
+
+  void setNumNeighbours( unsigned k ) noexcept
+  {
+    _k = k;
+  }
+
+  /** Sets the number of rows and columns of every tile of distances */
+  void setTileSize( std::size_t rows, std::size_t columns )
+  {
+    if( rows == 0 || columns == 0 )
+      throw std::runtime_error( "Tile size must be positive" );
+
+    _tileRows    = rows;
+    _tileColumns = columns;
+  }
+
+  const std::vector<unsigned>& eccentricityOrders() const noexcept { return _orders;    }
+  double bandwidth() const noexcept                                { return _bandwidth; }
+  unsigned numNeighbours() const noexcept                          { return _k;         }
+
+  /** Calculates all descriptors exactly from all pairwise distances */
+  Descriptors operator()() const
+  {
+    auto n = _container.size();
+    auto d = _container.dimension();
+    auto k = std::min( std::size_t( _k ), n );
+
+    Descriptors D = this->prepare();
+
+    if( n == 0 )
+      return D;
+
+    const auto* points = _container.data();
+
+    auto numTiles = ( n + _tileRows - 1 ) / _tileRows;
+    auto h2       = _bandwidth * _bandwidth;
+    auto numOrders = _orders.size();
+
+    #pragma omp parallel
+    {
+      std::vector<double> distances( _tileRows * _tileColumns );
+      std::vector<double> sums( _tileRows * numOrders );
+      std::vector<double> densities( _tileRows );
+      std::vector<double> heapValues( _tileRows * k );
+
+      Distance dist;
+      Traits traits;
+
+      #pragma omp for schedule(dynamic, 1)
+      for( std::size_t tile = 0; tile < numTiles; tile++ )
+      {
+        auto rowBegin = tile * _tileRows;
+        auto rowEnd   = std::min( rowBegin + _tileRows, n );
+        auto rows     = rowEnd - rowBegin;
+
+        std::fill( sums.begin(), sums.end(), 0.0 );
+        std::fill( densities.begin(), densities.end(), 0.0 );
+
+        std::vector<detail::BoundedHeap> heaps;
+        heaps.reserve( rows );
+
+        for( std::size_t r = 0; r < rows; r++ )
+          heaps.emplace_back( heapValues.data() + r * k, k );
+
+        for( std::size_t columnBegin = 0; columnBegin < n; columnBegin += _tileColumns )
+        {
+          auto columnEnd = std::min( columnBegin + _tileColumns, n );
+          auto columns   = columnEnd - columnBegin;
+
+          // Distances of the tile ---------------------------------------
+
+          for( std::size_t r = 0; r < rows; r++ )
+          {
+            const auto* p = points + ( rowBegin + r ) * d;
+            double* row   = distances.data() + r * _tileColumns;
+
+            for( std::size_t c = 0; c < columns; c++ )
+            {
+              const auto* q = points + ( columnBegin + c ) * d;
+              row[c]        = static_cast<double>( traits.from( dist( p, q, d ) ) );
+            }
+          }
+
+          // Descriptor updates ------------------------------------------
+          //
+          // Only the diagonal of the full distance matrix, i.e. the
+          // distance of a point to itself, needs to be excluded from the
+          // eccentricities. It is treated separately below.
+
+          for( std::size_t r = 0; r < rows; r++ )
+          {
+            const double* row = distances.data() + r * _tileColumns;
+            auto i            = rowBegin + r;
+
+            for( std::size_t o = 0; o < numOrders; o++ )
+            {
+              auto p    = _orders[o];
+              double s  = sums[ r * numOrders + o ];
+
+              if( p == 0 )
+              {
+                for( std::size_t c = 0; c < columns; c++ )
+                  if( columnBegin + c != i )
+                    s = std::max( s, row[c] );
+              }
+              else if( p == 1 )
+              {
+                for( std::size_t c = 0; c < columns; c++ )
+                  s += row[c];
+              }
+              else if( p == 2 )
+              {
+                for( std::size_t c = 0; c < columns; c++ )
+                  s += row[c] * row[c];
+              }
+              else
+              {
+                for( std::size_t c = 0; c < columns; c++ )
+                  s += detail::power( row[c], p );
+              }
+
+              // Remove the contribution of the diagonal element again
+              if( p != 0 && i >= columnBegin && i < columnEnd )
+                s -= detail::power( row[ i - columnBegin ], p );
+
+              sums[ r * numOrders + o ] = s;
+            }
+
+            if( _bandwidth > 0.0 )
+            {
+              double s = 0.0;
+
+              for( std::size_t c = 0; c < columns; c++ )
+              {
+                auto x = row[c] * row[c];
+                s     += x <= h2 ? std::exp( -x / ( 2.0 * _bandwidth ) ) : 0.0;
+              }
+
+              densities[r] += s;
+            }
+
+            if( k > 0 )
+            {
+              auto&& heap = heaps[r];
+
+              for( std::size_t c = 0; c < columns; c++ )
+                if( row[c] < heap.bound() )
+                  heap.insert( row[c] );
+            }
+          }
+        }
+
+        // Finalization ----------------------------------------------------
+
+        for( std::size_t r = 0; r < rows; r++ )
+        {
+          auto i = rowBegin + r;
+
+          for( std::size_t o = 0; o < numOrders; o++ )
+            D.eccentricities[o][i] = this->eccentricity( sums[ r * numOrders + o ], _orders[o], n );
+
+          if( _bandwidth > 0.0 )
+            D.truncatedGaussian[i] = densities[r] / static_cast<double>( n );
+
+          if( k > 0 )
+            this->finalizeNeighbours( heaps[r].begin(), heaps[r].end(), n, D, i );
+        }
+      }
+    }
+
+    return D;
+  }
+
+  /**
+    Calculates all descriptors approximately from the nearest neighbours
+    of every point.
+
+    @param nn Nearest neighbour wrapper of the same point cloud
+    @param k  Number of neighbours to query
+  */
+
+  template <class Wrapper> Descriptors operator()( const Wrapper& nn, unsigned k ) const
+  {
+    auto n = _container.size();
+
+    if( nn.size() != n )
+      throw std::runtime_error( "Nearest neighbour wrapper does not match point cloud" );
+
+    using IndexType   = typename Wrapper::IndexType;
+    using ElementType = typename Wrapper::ElementType;
+
+    std::vector< std::vector<IndexType> > indices;
+    std::vector< std::vector<ElementType> > distances;
+
+    nn.neighbourSearch( static_cast<unsigned>( std::min( std::size_t( k ), n ) ), indices, distances );
+
+    Descriptors D = this->prepare();
+
+    auto h2        = _bandwidth * _bandwidth;
+    auto numOrders = _orders.size();
+
+    #pragma omp parallel
+    {
+      std::vector<double> neighbours;
+
+      #pragma omp for schedule(dynamic, 256)
+      for( std::size_t i = 0; i < n; i++ )
+      {
+        neighbours.clear();
+
+        for( std::size_t j = 0; j < indices[i].size(); j++ )
+          neighbours.push_back( static_cast<double>( distances[i][j] ) );
+
+        for( std::size_t o = 0; o < numOrders; o++ )
+        {
+          auto p   = _orders[o];
+          double s = 0.0;
+
+          for( std::size_t j = 0; j < neighbours.size(); j++ )
+          {
+            if( std::size_t( indices[i][j] ) == i )
+              continue;
+
+            if( p == 0 )
+              s = std::max( s, neighbours[j] );
+            else
+              s += detail::power( neighbours[j], p );
+          }
+
+          D.eccentricities[o][i] = this->eccentricity( s, p, n );
+        }
+
+        if( _bandwidth > 0.0 )
+        {
+          double s = 0.0;
+
+          for( auto&& x : neighbours )
+            s += x * x <= h2 ? std::exp( -x * x / ( 2.0 * _bandwidth ) ) : 0.0;
+
+          D.truncatedGaussian[i] = s / static_cast<double>( n );
+        }
+
+        if( _k > 0 )
+        {
+          std::sort( neighbours.begin(), neighbours.end() );
+
+          auto m = std::min( neighbours.size(), std::size_t( _k ) );
+          this->finalizeNeighbours( neighbours.begin(), neighbours.begin() + static_cast<std::ptrdiff_t>( m ), n, D, i );
+        }
+      }
+    }
+
+    return D;
+  }
+
+private:
+
+  /** Allocates all requested descriptors */
+  Descriptors prepare() const
+  {
+    auto n = _container.size();
+
+    Descriptors D;
+    D.eccentricities.assign( _orders.size(), std::vector<double>( n ) );
+
+    if( _bandwidth > 0.0 )
+      D.truncatedGaussian.resize( n );
+
+    if( _k > 0 )
+    {
+      D.distanceToMeasure.resize( n );
+      D.kNNDistance.resize( n );
+    }
+
+    return D;
+  }
+
+  /** Converts an accumulated sum of distances into an eccentricity */
+  static double eccentricity( double sum, unsigned p, std::size_t n )
+  {
+    if( p == 0 )
+      return sum;
+    else if( p == 1 )
+      return sum / static_cast<double>( n );
+    else
+      return std::pow( sum / static_cast<double>( n ), 1.0 / static_cast<double>( p ) );
+  }
+
+  /**
+    Calculates the nearest neighbour descriptors of a point from its
+    smallest distances, which need not be sorted.
+  */
+
+  template <class InputIterator> static void finalizeNeighbours( InputIterator begin, InputIterator end,
+                                                                  std::size_t n,
+                                                                  Descriptors& D,
+                                                                  std::size_t i )
+  {
+    double sum     = 0.0;
+    double largest = 0.0;
+
+    for( auto it = begin; it != end; ++it )
+    {
+      sum    += *it;
+      largest = std::max( largest, *it );
+    }
+
+    D.distanceToMeasure[i] = -sum / static_cast<double>( n );
+    D.kNNDistance[i]       = largest;
+  }
+
+  const Container& _container;
+
+  std::vector<unsigned> _orders;
+
+  double _bandwidth = 0.0;
+  unsigned _k       = 0;
+
+  std::size_t _tileRows    = 32;
+  std::size_t _tileColumns = 512;
+};
+
+} // namespace containers
+
+} // namespace aleph
+
+#endif
@@ -2,17 +2,19 @@
 #define ALEPH_CONTAINERS_DIMENSIONALITY_ESTIMATORS_HH__
 
 #include <aleph/math/KahanSummation.hh>
-#include <aleph/math/PrincipalComponentAnalysis.hh>
+#include <aleph/math/SymmetricEigenvalues.hh>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/kruskal_min_spanning_tree.hpp>
 
+#include <algorithm>
 #include <iterator>
 #include <limits>
 #include <stdexcept>
 #include <vector>
 
 #include <cmath>
+#include <cstddef>
 
 namespace aleph
 {
@@ -20,6 +22,39 @@ namespace aleph
 namespace containers
 {
 
+namespace detail
+{
+
+/**
+  Returns the position of the largest gap between two consecutive values
+  of a descending sequence, i.e. the number of values that precede it. A
+  sequence with less than two values has no gap, resulting in zero.
+*/
+
+inline unsigned largestGapIndex( const double* values, std::size_t n )
+{
+  double spectralGap     = std::numeric_limits<double>::lowest();
+  unsigned spectralIndex = 0;
+
+  for( std::size_t i = 1; i < n; i++ )
+  {
+    auto gap = std::abs( values[i-1] - values[i] );
+
+    // Notice that I am using the *lower* bound of the index here. This
+    // makes sense, as a jump between $i-1$ and $i$ indicates that $i-1$
+    // values are sufficient to describe the data adequately.
+    if( gap > spectralGap )
+    {
+      spectralGap   = gap;
+      spectralIndex = static_cast<unsigned>( i );
+    }
+  }
+
+  return spectralIndex;
+}
+
+} // namespace detail
+
 /**
   Estimates local intrinsic dimensionality of a container using its
   nearest neighbours. The underlying assumption of the estimator is
@@ -53,16 +88,24 @@ template <
 
   auto n = container.size();
 
-  std::vector<double> estimates;
-  estimates.reserve( n );
+  std::vector<double> estimates( n );
 
-  for( decltype(n) i = 0; i < n; i++ )
+  #pragma omp parallel for schedule(static)
+  for( std::size_t i = 0; i < n; i++ )
   {
-    auto&& nnDistances = distances.at(i);
-    auto r1            = aleph::math::accumulate_kahan( nnDistances.begin(), nnDistances.begin() + k,     0.0 ) / static_cast<double>(k  );
-    auto r2            = aleph::math::accumulate_kahan( nnDistances.begin(), nnDistances.begin() + k + 1, 0.0 ) / static_cast<double>(k+1);
+    auto&& nnDistances = distances[i];
+
+    aleph::math::KahanSummation<double> sum = 0.0;
+
+    for( unsigned j = 0; j < k; j++ )
+      sum += static_cast<double>( nnDistances.at(j) );
+
+    auto r1 = sum / static_cast<double>(k);
+
+    sum    += static_cast<double>( nnDistances.at(k) );
+    auto r2 = sum / static_cast<double>(k+1);
 
-    estimates.push_back( r1 / ( (r2-r1)*k ) );
+    estimates[i] = r1 / ( (r2-r1)*k );
   }
 
   return estimates;
@@ -124,45 +167,50 @@ template <
 
   auto n = container.size();
 
-  std::vector<double> estimates;
-  estimates.reserve( n );
+  std::vector<double> estimates( n );
 
-  for( decltype(n) i = 0; i < n; i++ )
+  #pragma omp parallel
   {
-    auto&& nnDistances = distances.at(i);
-
     std::vector<double> localEstimates;
     localEstimates.reserve( kMax );
 
-    for( unsigned k = kMin; k < kMax; k++ )
+    #pragma omp for schedule(static)
+    for( std::size_t i = 0; i < n; i++ )
     {
-      auto r = aleph::math::accumulate_kahan( nnDistances.begin(), nnDistances.begin() + k, 0.0 ) / static_cast<double>(k);
-      localEstimates.emplace_back( r );
-    }
+      auto&& nnDistances = distances[i];
 
-    // The dimensionality estimates consist of two terms. The first term
-    // is similar to the local biased dimensionality estimate.
+      localEstimates.clear();
 
-    std::vector<double> firstTerms;
-    firstTerms.reserve( kMax );
+      // The mean distances for all $k$ are prefix sums of the sorted
+      // distances, so a single pass over the neighbours suffices.
+      aleph::math::KahanSummation<double> sum = 0.0;
 
-    std::vector<double> secondTerms;
-    secondTerms.reserve( kMax );
+      for( unsigned k = 1; k < kMax; k++ )
+      {
+        sum += static_cast<double>( nnDistances.at(k-1) );
 
-    for( unsigned k = kMin; k < kMax - 1; k++ )
-    {
-      auto index = k - kMin;
-      auto r1    = localEstimates.at(index);
-      auto r2    = localEstimates.at(index+1);
+        if( k >= kMin )
+          localEstimates.push_back( sum / static_cast<double>(k) );
+      }
 
-      firstTerms.emplace_back ( ( (r2-r1) * r1 ) / k );
-      secondTerms.emplace_back( ( (r2-r1) * (r2-r1) ) );
-    }
+      // The dimensionality estimates consist of two terms. The first term
+      // is similar to the local biased dimensionality estimate.
+
+      aleph::math::KahanSummation<double> s = 0.0;
+      aleph::math::KahanSummation<double> t = 0.0;
 
-    auto s = aleph::math::accumulate_kahan( firstTerms.begin() , firstTerms.end() , 0.0 );
-    auto t = aleph::math::accumulate_kahan( secondTerms.begin(), secondTerms.end(), 0.0 );
+      for( unsigned k = kMin; k + 1 < kMax; k++ )
+      {
+        auto index = k - kMin;
+        auto r1    = localEstimates[index];
+        auto r2    = localEstimates[index+1];
+
+        s += ( (r2-r1) * r1 ) / k;
+        t += ( (r2-r1) * (r2-r1) );
+      }
 
-    estimates.push_back( s / t );
+      estimates[i] = s / t;
+    }
   }
 
   return estimates;
@@ -224,50 +272,51 @@ template <
 
   auto n = container.size();
 
-  std::vector<double> estimates;
-  estimates.reserve( n );
+  std::vector<double> estimates( n );
 
-  for( decltype(n) i = 0; i < n; i++ )
+  #pragma omp parallel for schedule(static)
+  for( std::size_t i = 0; i < n; i++ )
   {
-    auto&& nnDistances = distances.at(i);
+    auto&& nnDistances = distances[i];
 
-    std::vector<double> localEstimates;
-    localEstimates.reserve( kMax );
+    // Sum and number of all logarithms of non-zero distances below the
+    // current index. Since $\log(T_k/T_j) = \log T_k - \log T_j$, these
+    // are sufficient to update the estimate for every $k$ in O(1).
+    aleph::math::KahanSummation<double> logSum = 0.0;
+    unsigned numLogs                           = 0;
+
+    aleph::math::KahanSummation<double> sum = 0.0;
 
     // This follows the notation in the original paper. I dislike using
     // $T_k$ to denote distances, though.
-    for( unsigned k = kMin - 1; k < kMax; k++ )
+    for( unsigned k = 1; k < kMax; k++ )
     {
-      // Nothing to do here...
-      if( k == 0 )
-        continue;
+      auto Tj = static_cast<double>( nnDistances.at(k-1) );
 
-      std::vector<double> logEstimates;
-      logEstimates.reserve( k-1 );
-
-      for( auto it = nnDistances.begin(); it != nnDistances.begin() + k; ++it )
+      // This defines log(0) = 0, as usually done in information
+      // theory. The original paper does not handle this.
+      if( Tj > 0.0 )
       {
-        if( *it > 0.0 && nnDistances.at(k) > 0.0 )
-          logEstimates.push_back( std::log( nnDistances.at(k) / *it ) );
-
-        // This defines log(0) = 0, as usually done in information
-        // theory. The original paper does not handle this.
-        else
-          logEstimates.push_back( 0.0 );
+        logSum += std::log( Tj );
+        numLogs++;
       }
 
-      auto mk = k > 1 ? 1.0 / (k-1) * aleph::math::accumulate_kahan( logEstimates.begin(), logEstimates.end(), 0.0 )
-                      : 0.0;
+      if( k + 1 < kMin )
+        continue;
+
+      auto Tk = static_cast<double>( nnDistances.at(k) );
+      auto mk = k > 1 && Tk > 0.0 ? 1.0 / (k-1) * ( numLogs * std::log( Tk ) - logSum )
+                                  : 0.0;
 
       if( mk > 0.0 )
         mk = 1.0 / mk;
       else
         mk = 0.0;
 
-      localEstimates.push_back( mk );
+      sum += mk;
     }
 
-    estimates.push_back( aleph::math::accumulate_kahan( localEstimates.begin(), localEstimates.end(), 0.0 ) / (kMax - kMin + 1) );
+    estimates[i] = sum / (kMax - kMin + 1);
   }
 
   return estimates;
@@ -344,93 +393,167 @@ template <
 
 /**
   Estimates local intrinsic dimensionality of a container using its
-  local principal components. The basic premise is that the largest
-  spectral gap in the eigenspectrum of a local PCA gives a suitable
-  hint about the local dimensionality at the given set of points.
+  local principal components for a *range* of neighbourhood sizes. The
+  basic premise is that the largest spectral gap in the eigenspectrum
+  of a local PCA gives a suitable hint about the local dimensionality
+  at the given set of points.
+
+  All neighbourhoods are obtained from a single nearest neighbour query.
+  Since they are nested, the local covariance matrix of every point is
+  updated incrementally, using one rank-one update per neighbour, which
+  leaves only a small eigenvalue problem for every neighbourhood size.
 
   @param container Container to use for dimensionality estimation
+
+  @param kMin      Minimum number of nearest neighbours to use in
+                   computing local dimensionality estimates.
+
+  @param kMax      Maximum number of nearest neighbours to use in
+                   computing local dimensionality estimates. This
+                   parameter influences performance.
+
   @param distance  Distance measure
 
-  @returns Vector of local intrinsic dimensionality estimates. The numbers are
-           not rounded but taken directly from the estimation procedure.
+  @returns Vector of local intrinsic dimensionality estimates, containing
+           one estimate for every $k$ in $[kMin, kMax]$ per point.
 */
 
 template <
   class Distance,
   class Container,
   class Wrapper
-> std::vector<unsigned> estimateLocalDimensionalityPCA( const Container& container,
-                                                        unsigned k,
-                                                        Distance /* distance */ = Distance() )
+> std::vector< std::vector<unsigned> > estimateLocalDimensionalityPCA( const Container& container,
+                                                                       unsigned kMin,
+                                                                       unsigned kMax,
+                                                                       Distance /* distance */ = Distance() )
 {
+  if( kMin > kMax )
+    std::swap( kMin, kMax );
+
+  if( kMax == 0 || kMin == 0 )
+    throw std::runtime_error( "Expecting non-zero number of nearest neighbours" );
+
   using IndexType   = typename Wrapper::IndexType;
   using ElementType = typename Wrapper::ElementType;
 
   std::vector< std::vector<IndexType> > indices;
   std::vector< std::vector<ElementType> > distances;
 
+  auto n    = container.size();
+  auto d    = container.dimension();
+  auto data = container.data();
+
   Wrapper nnWrapper( container );
-  nnWrapper.neighbourSearch( k+1, indices, distances );
+  nnWrapper.neighbourSearch( static_cast<unsigned>( std::min( std::size_t( kMax ) + 1, n ) ), indices, distances );
 
-  std::vector<unsigned> estimates;
-  estimates.reserve( container.size() );
+  std::vector< std::vector<unsigned> > estimates( n, std::vector<unsigned>( kMax - kMin + 1 ) );
 
-  for( auto&& localIndices : indices )
+  #pragma omp parallel
   {
-    std::vector< std::vector<ElementType> > data( localIndices.size(), std::vector<ElementType>() );
-
-    {
-      std::size_t i = 0;
-      for( auto&& index : localIndices )
-      {
-        auto&& p = container[index];
+    std::vector<double> mean( d );
+    std::vector<double> delta( d );
+    std::vector<double> scatter( d * d );
+    std::vector<double> singularValues( d );
 
-        data[i].assign( p.begin(), p.end() );
+    aleph::math::SymmetricEigenvalues eigenvalues;
 
-        i++;
-      }
-    }
+    #pragma omp for schedule(dynamic, 64)
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      auto&& localIndices   = indices[i];
+      auto&& localEstimates = estimates[i];
 
-    // Calculate a (local) principal component analysis and analyse the
-    // resulting spectrum. The largest spectral gap is used to estimate
-    // the local intrinsic dimensionality.
-    aleph::math::PrincipalComponentAnalysis pca;
-    auto result           = pca( data );
-    auto&& singularValues = result.singularValues;
+      std::fill( mean.begin(), mean.end(), 0.0 );
+      std::fill( scatter.begin(), scatter.end(), 0.0 );
 
-    if( singularValues.size() >= 2 )
-    {
-      ElementType spectralGap = std::numeric_limits<ElementType>::lowest();
-      unsigned spectralIndex  = 0;
+      // Neighbourhoods of $k$ neighbours contain $k+1$ points, including
+      // the point itself. Smaller data sets may not have enough points.
+      auto m = std::min( localIndices.size(), std::size_t( kMax ) + 1 );
 
-      auto prev = singularValues.begin();
-      auto curr = std::next( prev );
+      unsigned estimate = 0;
 
-      for( ; curr != singularValues.end(); ++prev, ++curr)
+      for( std::size_t j = 0; j < m; j++ )
       {
-        auto gap = std::abs( *prev - *curr );
+        auto x = data + std::size_t( localIndices[j] ) * d;
+        auto c = static_cast<double>( j + 1 );
+
+        // Welford's update: the first factor of the rank-one update uses
+        // the previous mean, the second factor uses the updated one.
+        for( std::size_t r = 0; r < d; r++ )
+        {
+          delta[r] = static_cast<double>( x[r] ) - mean[r];
+          mean[r] += delta[r] / c;
+        }
 
-        if( gap > spectralGap )
+        for( std::size_t r = 0; r < d; r++ )
         {
-          // Notice that I am using the *lower* bound of the index here
-          // by specifying `prev` instead of current. This makes sense,
-          // as a jumping between $i-1$ and $i$ indicates that $i-1$ is
-          // sufficient to describe the data adequately.
-          //
-          // The additional offset of 1 is used because `std::distance`
-          // uses zero-based indices.
-          spectralGap   = gap;
-          spectralIndex = static_cast<unsigned>( std::distance( singularValues.begin(), prev ) ) + 1;
+          for( std::size_t s = r; s < d; s++ )
+          {
+            scatter[ r * d + s ] += delta[r] * ( static_cast<double>( x[s] ) - mean[s] );
+            scatter[ s * d + r ]  = scatter[ r * d + s ];
+          }
         }
+
+        if( j < kMin )
+          continue;
+
+        // The singular values of the centred data, scaled as in a regular
+        // principal component analysis, are given by the eigenvalues of
+        // the scatter matrix. Only the first $j+1$ of them are relevant.
+        eigenvalues( scatter.data(), d, singularValues.data() );
+
+        auto numValues = std::min( j + 1, d );
+
+        for( std::size_t r = 0; r < numValues; r++ )
+          singularValues[r] = std::sqrt( std::max( singularValues[r], 0.0 ) / static_cast<double>( d ) );
+
+        estimate                   = detail::largestGapIndex( singularValues.data(), numValues );
+        localEstimates[ j - kMin ] = estimate;
       }
 
-      estimates.push_back( spectralIndex );
+      // Neighbourhood sizes that exceed the number of available points
+      // are assigned the estimate for the largest neighbourhood.
+      for( std::size_t j = std::max( m, std::size_t( kMin ) ); j <= kMax; j++ )
+        localEstimates[ j - kMin ] = estimate;
     }
   }
 
   return estimates;
 }
 
+/**
+  Estimates local intrinsic dimensionality of a container using its
+  local principal components. The basic premise is that the largest
+  spectral gap in the eigenspectrum of a local PCA gives a suitable
+  hint about the local dimensionality at the given set of points.
+
+  @param container Container to use for dimensionality estimation
+  @param k         Number of nearest neighbours
+  @param distance  Distance measure
+
+  @returns Vector of local intrinsic dimensionality estimates. The numbers are
+           not rounded but taken directly from the estimation procedure.
+*/
+
+template <
+  class Distance,
+  class Container,
+  class Wrapper
+> std::vector<unsigned> estimateLocalDimensionalityPCA( const Container& container,
+                                                        unsigned k,
+                                                        Distance distance = Distance() )
+{
+  auto localEstimates = estimateLocalDimensionalityPCA<Distance, Container, Wrapper>( container, k, k, distance );
+
+  std::vector<unsigned> estimates;
+  estimates.reserve( localEstimates.size() );
+
+  for( auto&& localEstimate : localEstimates )
+    estimates.push_back( localEstimate.front() );
+
+  return estimates;
+}
+
 } // namespace containers
 
 } // namespace aleph
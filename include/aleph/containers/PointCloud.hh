@@ -249,10 +249,11 @@ template<class T> PointCloud<T> load( const std::string& filename )
   std::string line;
 
   PointCloud<T> pointCloud;
+  utilities::Tokenizer tokenizer( ":;, \t\r\n\v\f" );
 
   while( std::getline( in, line ) )
   {
-    auto tokens = utilities::split( line, std::string( "[:;,[:space:]]+" ) );
+    auto&& tokens = tokenizer( line );
 
     if( d == 0 )
     {
@@ -265,7 +266,7 @@ template<class T> PointCloud<T> load( const std::string& filename )
 
     for( auto&& token : tokens )
     {
-      T coordinate = utilities::convert<T>( token );
+      T coordinate = utilities::parse<T>( token );
       coordinates.push_back( coordinate );
     }
 
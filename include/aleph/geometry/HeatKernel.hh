@@ -213,14 +213,18 @@ public:
   {
 #ifdef ALEPH_WITH_EIGEN
 
-    Vector result = Vector();
+    Vector result = Vector::Zero( _eigenvectors.empty() ? 0 : _eigenvectors.front().size() );
+
+    // Only the diagonal of the heat matrix is required, i.e. the
+    // auto-diffusion of every vertex, so the outer products of the
+    // eigenvectors need not be formed.
 
     for( std::size_t k = 0; k < _eigenvalues.size(); k++ )
     {
       auto&& lk  = std::exp( -t * _eigenvalues[k] );
       auto&& uk = _eigenvectors[k];
 
-      result += lk * uk * uk.transpose();
+      result += lk * uk.cwiseProduct( uk );
     }
 
     return std::vector<T>( result.data(), result.data() + result.size() );
@@ -0,0 +1,967 @@
+#ifndef ALEPH_GEOMETRY_SPARSE_HEAT_KERNEL_HH__
+#define ALEPH_GEOMETRY_SPARSE_HEAT_KERNEL_HH__
+
+#include <aleph/config/Eigen.hh>
+
+#ifdef ALEPH_WITH_EIGEN
+  #include <Eigen/Core>
+  #include <Eigen/Eigenvalues>
+#endif
+
+#include <aleph/topology/WeightedGraph.hh>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace geometry
+{
+
+/**
+  @class SparseLaplacian
+  @brief Weighted graph Laplacian in compressed sparse row format
+
+  Stores the weighted adjacency matrix W of a graph in compressed sparse
+  row format, together with the weighted degree of every vertex, and
+  permits multiplying the Laplacian L = D - W with blocks of vectors. In
+  contrast to `weightedLaplacianMatrix()`, the memory requirements are
+  linear in the number of edges.
+*/
+
+template <class T> class SparseLaplacian
+{
+public:
+
+  /** Creates an empty Laplacian */
+  SparseLaplacian()
+    : _offsets( 1, 0 )
+  {
+  }
+
+  /**
+    Creates a Laplacian from a symmetric weighted adjacency matrix in
+    compressed sparse row format. Self-loops are ignored.
+  */
+
+  SparseLaplacian( std::vector<std::size_t> offsets,
+                   std::vector<std::size_t> columns,
+                   std::vector<T> weights )
+    : _offsets( std::move( offsets ) )
+    , _columns( std::move( columns ) )
+    , _weights( std::move( weights ) )
+  {
+    if(    _offsets.empty()
+        || _offsets.back() != _columns.size()
+        || _columns.size() != _weights.size() )
+      throw std::runtime_error( "Inconsistent arrays for sparse Laplacian" );
+
+    auto n = this->size();
+
+    _degrees.assign( n, T() );
+
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      for( std::size_t k = _offsets[i]; k < _offsets[i+1]; k++ )
+      {
+        if( _columns[k] >= n )
+          throw std::runtime_error( "Column index exceeds size of sparse Laplacian" );
+
+        if( _columns[k] == i )
+          _weights[k] = T();
+
+        _degrees[i] += _weights[k];
+      }
+    }
+  }
+
+  /** Creates a Laplacian from a weighted graph */
+  template <class Vertex, class Weight> explicit SparseLaplacian( const topology::WeightedGraph<Vertex, Weight>& G )
+    : SparseLaplacian( G.offsets(),
+                       std::vector<std::size_t>( G.targets().begin(), G.targets().end() ),
+                       std::vector<T>( G.weights().begin(), G.weights().end() ) )
+  {
+  }
+
+  /** @returns Number of rows, i.e. vertices */
+  std::size_t size() const noexcept
+  {
+    return _offsets.size() - 1;
+  }
+
+  /** @returns Weighted degree of a vertex, i.e. the diagonal entry of its row */
+  T degree( std::size_t i ) const
+  {
+    return _degrees.at( i );
+  }
+
+  /**
+    @returns Upper bound of the largest eigenvalue, following from the
+    Gershgorin circle theorem
+  */
+
+  T spectralBound() const noexcept
+  {
+    T bound = T();
+
+    for( std::size_t i = 0; i < this->size(); i++ )
+    {
+      T sum = _degrees[i];
+
+      for( std::size_t k = _offsets[i]; k < _offsets[i+1]; k++ )
+        sum += std::abs( _weights[k] );
+
+      bound = std::max( bound, sum );
+    }
+
+    return bound;
+  }
+
+  /**
+    Multiplies the Laplacian with a block of b vectors, i.e. calculates
+    Y = L X. Both blocks are stored in row-major order, so every row of
+    a block contains one entry of each vector.
+  */
+
+  void multiply( const T* X, T* Y, std::size_t b ) const
+  {
+    auto n = this->size();
+
+    #pragma omp parallel for schedule(static)
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      T* y       = Y + i * b;
+      const T* x = X + i * b;
+
+      for( std::size_t c = 0; c < b; c++ )
+        y[c] = _degrees[i] * x[c];
+
+      for( std::size_t k = _offsets[i]; k < _offsets[i+1]; k++ )
+      {
+        const T* xj = X + _columns[k] * b;
+        T w         = _weights[k];
+
+        for( std::size_t c = 0; c < b; c++ )
+          y[c] -= w * xj[c];
+      }
+    }
+  }
+
+private:
+  std::vector<std::size_t> _offsets;
+  std::vector<std::size_t> _columns;
+  std::vector<T>           _weights;
+  std::vector<T>           _degrees;
+};
+
+/**
+  Extracts the sparse weighted Laplacian of a simplicial complex. As for
+  `weightedLaplacianMatrix()`, edge weights are taken from the data of the
+  edges, and the indices of rows and columns follow the order of the
+  vertices in the complex.
+*/
+
+template <class SimplicialComplex> SparseLaplacian<double> sparseLaplacianMatrix( const SimplicialComplex& K )
+{
+  using Simplex    = typename SimplicialComplex::ValueType;
+  using VertexType = typename Simplex::VertexType;
+
+  std::unordered_map<VertexType, std::size_t> vertex_to_index;
+  std::size_t n = 0;
+
+  {
+    std::vector<VertexType> vertices;
+    K.vertices( std::back_inserter( vertices ) );
+
+    for( auto&& vertex : vertices )
+      vertex_to_index[vertex] = n++;
+  }
+
+  std::vector< std::tuple<std::size_t, std::size_t, double> > entries;
+
+  for( auto&& s : K )
+  {
+    if( s.dimension() != 1 )
+      continue;
+
+    auto i = vertex_to_index.at( s[0] );
+    auto j = vertex_to_index.at( s[1] );
+    auto w = static_cast<double>( s.data() );
+
+    entries.emplace_back( i, j, w );
+    entries.emplace_back( j, i, w );
+  }
+
+  std::sort( entries.begin(), entries.end() );
+
+  std::vector<std::size_t> offsets( n + 1, 0 );
+  std::vector<std::size_t> columns;
+  std::vector<double>      weights;
+
+  columns.reserve( entries.size() );
+  weights.reserve( entries.size() );
+
+  for( auto&& entry : entries )
+  {
+    offsets[ std::get<0>( entry ) + 1 ] += 1;
+
+    columns.push_back( std::get<1>( entry ) );
+    weights.push_back( std::get<2>( entry ) );
+  }
+
+  std::partial_sum( offsets.begin(), offsets.end(), offsets.begin() );
+
+  return SparseLaplacian<double>( std::move( offsets ), std::move( columns ), std::move( weights ) );
+}
+
+namespace detail
+{
+
+/**
+  Calculates all eigenvalues and eigenvectors of a symmetric tridiagonal
+  matrix using the QL algorithm with implicit shifts. This is the scalar
+  fallback if Eigen is not available.
+
+  @param diagonal    Diagonal of the matrix; overwritten with the eigenvalues
+  @param subdiagonal Subdiagonal of the matrix; destroyed
+  @param Z           Eigenvectors, stored in row-major order such that
+                     every column contains one eigenvector
+
+  Eigenvalues are sorted in ascending order, and eigenvectors follow the
+  same order.
+*/
+
+template <class T> void tridiagonalEigenDecomposition( std::vector<T>& diagonal,
+                                                       std::vector<T> subdiagonal,
+                                                       std::vector<T>& Z )
+{
+  auto n = diagonal.size();
+
+  Z.assign( n * n, T() );
+
+  for( std::size_t i = 0; i < n; i++ )
+    Z[ i * n + i ] = T(1);
+
+  if( n == 0 )
+    return;
+
+  subdiagonal.resize( n, T() );
+  subdiagonal[n-1] = T();
+
+  auto& d = diagonal;
+  auto& e = subdiagonal;
+
+  for( std::size_t l = 0; l < n; l++ )
+  {
+    unsigned iteration = 0;
+    std::size_t m      = l;
+
+    do
+    {
+      for( m = l; m + 1 < n; m++ )
+      {
+        T dd = std::abs( d[m] ) + std::abs( d[m+1] );
+        if( std::abs( e[m] ) <= std::numeric_limits<T>::epsilon() * dd )
+          break;
+      }
+
+      if( m != l )
+      {
+        if( iteration++ == 64 )
+          throw std::runtime_error( "Tridiagonal eigendecomposition did not converge" );
+
+        T g = ( d[l+1] - d[l] ) / ( 2 * e[l] );
+        T r = std::hypot( g, T(1) );
+        g   = d[m] - d[l] + e[l] / ( g + std::copysign( r, g ) );
+
+        T s = T(1);
+        T c = T(1);
+        T p = T();
+
+        bool underflow = false;
+
+        for( std::ptrdiff_t i = static_cast<std::ptrdiff_t>( m ) - 1; i >= static_cast<std::ptrdiff_t>( l ); i-- )
+        {
+          auto k = static_cast<std::size_t>( i );
+
+          T f = s * e[k];
+          T b = c * e[k];
+
+          r      = std::hypot( f, g );
+          e[k+1] = r;
+
+          if( r == T() )
+          {
+            d[k+1]   -= p;
+            e[m]      = T();
+            underflow = true;
+            break;
+          }
+
+          s = f / r;
+          c = g / r;
+          g = d[k+1] - p;
+          r = ( d[k] - g ) * s + 2 * c * b;
+          p = s * r;
+
+          d[k+1] = g + p;
+          g      = c * r - b;
+
+          for( std::size_t row = 0; row < n; row++ )
+          {
+            T z              = Z[ row * n + k + 1 ];
+            Z[ row * n + k + 1 ] = s * Z[ row * n + k ] + c * z;
+            Z[ row * n + k ]     = c * Z[ row * n + k ] - s * z;
+          }
+        }
+
+        if( underflow )
+          continue;
+
+        d[l] -= p;
+        e[l]  = g;
+        e[m]  = T();
+      }
+    }
+    while( m != l );
+  }
+
+  // Sort eigenvalues and eigenvectors ---------------------------------
+
+  std::vector<std::size_t> order( n );
+  std::iota( order.begin(), order.end(), std::size_t(0) );
+
+  std::sort( order.begin(), order.end(), [&d] ( std::size_t i, std::size_t j ) { return d[i] < d[j]; } );
+
+  std::vector<T> eigenvalues( n );
+  std::vector<T> eigenvectors( n * n );
+
+  for( std::size_t j = 0; j < n; j++ )
+  {
+    eigenvalues[j] = d[ order[j] ];
+
+    for( std::size_t row = 0; row < n; row++ )
+      eigenvectors[ row * n + j ] = Z[ row * n + order[j] ];
+  }
+
+  diagonal.swap( eigenvalues );
+  Z.swap( eigenvectors );
+}
+
+/** @returns Dot product of two vectors, calculated in parallel */
+template <class T> T dot( const T* x, const T* y, std::size_t n )
+{
+  T result = T();
+
+  #pragma omp parallel for reduction(+:result)
+  for( std::size_t i = 0; i < n; i++ )
+    result += x[i] * y[i];
+
+  return result;
+}
+
+/** Calculates y = y + a * x in parallel */
+template <class T> void axpy( T a, const T* x, T* y, std::size_t n )
+{
+  #pragma omp parallel for
+  for( std::size_t i = 0; i < n; i++ )
+    y[i] += a * x[i];
+}
+
+} // namespace detail
+
+/**
+  @class LanczosHeatKernel
+  @brief Heat kernel based on a truncated spectrum of a sparse Laplacian
+
+  Approximates the heat kernel by the k smallest eigenpairs of the graph
+  Laplacian, which dominate it for all but the smallest time scales. The
+  eigenpairs are calculated by the Lanczos algorithm with full
+  reorthogonalization, which only requires multiplications with the
+  sparse Laplacian. Eigenvectors are stored in a single contiguous array.
+
+  In contrast to HeatKernel, the eigenpair of the smallest eigenvalue is
+  not skipped, so the heat kernel signature of a vertex converges to its
+  exact value if all eigenpairs are used.
+*/
+
+class LanczosHeatKernel
+{
+public:
+  using T = double;
+
+  /**
+    Calculates the k smallest eigenpairs of a Laplacian.
+
+    @param L     Sparse Laplacian
+    @param k     Number of eigenpairs
+    @param steps Number of Lanczos steps; if zero, a heuristic is used.
+                 More steps increase the accuracy of the eigenpairs.
+    @param seed  Seed for the random start vector
+  */
+
+  LanczosHeatKernel( const SparseLaplacian<T>& L,
+                     std::size_t k,
+                     std::size_t steps = 0,
+                     unsigned seed     = 42 )
+    : _n( L.size() )
+  {
+    k = std::min( k, _n );
+
+    if( steps == 0 )
+      steps = std::max( 3 * k, k + 50 );
+
+    steps = std::max( std::min( steps, _n ), k );
+
+    std::vector<T> alpha;
+    std::vector<T> beta;
+    std::vector<T> Q;
+
+    this->lanczos( L, steps, seed, alpha, beta, Q );
+
+    auto m = alpha.size();
+
+    // Eigendecomposition of the tridiagonal matrix --------------------
+
+    std::vector<T> theta;
+    std::vector<T> S;
+
+#ifdef ALEPH_WITH_EIGEN
+#if EIGEN_VERSION_AT_LEAST(3,3,0)
+    {
+      using Matrix = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+      using Vector = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+
+      Vector d = Eigen::Map<Vector>( alpha.data(), static_cast<Eigen::Index>( m ) );
+      Vector e = Vector::Zero( static_cast<Eigen::Index>( m > 0 ? m - 1 : 0 ) );
+
+      for( std::size_t i = 0; i + 1 < m; i++ )
+        e( static_cast<Eigen::Index>( i ) ) = beta[i];
+
+      Eigen::SelfAdjointEigenSolver<Matrix> solver;
+      solver.computeFromTridiagonal( d, e, Eigen::ComputeEigenvectors );
+
+      theta.assign( solver.eigenvalues().data(), solver.eigenvalues().data() + m );
+      S.resize( m * m );
+
+      for( std::size_t i = 0; i < m; i++ )
+        for( std::size_t j = 0; j < m; j++ )
+          S[ i * m + j ] = solver.eigenvectors()( static_cast<Eigen::Index>( i ), static_cast<Eigen::Index>( j ) );
+    }
+#else
+    theta = alpha;
+    detail::tridiagonalEigenDecomposition( theta, beta, S );
+#endif
+#else
+    theta = alpha;
+    detail::tridiagonalEigenDecomposition( theta, beta, S );
+#endif
+
+    // Ritz pairs ------------------------------------------------------
+
+    k = std::min( k, m );
+
+    _eigenvalues.assign( theta.begin(), theta.begin() + static_cast<std::ptrdiff_t>( k ) );
+    _eigenvectors.assign( _n * k, T() );
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < _n; i++ )
+    {
+      for( std::size_t l = 0; l < k; l++ )
+      {
+        T sum = T();
+
+        for( std::size_t j = 0; j < m; j++ )
+          sum += Q[ j * _n + i ] * S[ j * m + l ];
+
+        _eigenvectors[ i * k + l ] = sum;
+      }
+    }
+
+    // The Laplacian is positive semi-definite; tiny negative values are
+    // caused by round-off errors.
+    for( auto&& eigenvalue : _eigenvalues )
+      eigenvalue = std::max( eigenvalue, T() );
+  }
+
+  /** @returns Number of vertices */
+  std::size_t size() const noexcept
+  {
+    return _n;
+  }
+
+  /** @returns Eigenvalues in ascending order */
+  const std::vector<T>& eigenvalues() const noexcept
+  {
+    return _eigenvalues;
+  }
+
+  /** @returns Entry of an eigenvector for a given vertex */
+  T eigenvector( std::size_t i, std::size_t k ) const
+  {
+    return _eigenvectors.at( i * _eigenvalues.size() + k );
+  }
+
+  /**
+    Calculates the heat kernel value of two vertices \f$i\f$ and \f$j\f$
+    at a given time \f$t\f$.
+  */
+
+  T operator()( std::size_t i, std::size_t j, T t ) const
+  {
+    auto k = _eigenvalues.size();
+    T result = T();
+
+    for( std::size_t l = 0; l < k; l++ )
+      result += std::exp( -t * _eigenvalues[l] ) * _eigenvectors.at( i * k + l ) * _eigenvectors.at( j * k + l );
+
+    return result;
+  }
+
+  /**
+    Calculates the heat kernel signatures of all vertices for multiple
+    time scales in a single pass. The result is stored in row-major order,
+    i.e. the signature of vertex i occupies the entries [i * m, (i+1) * m)
+    for m time scales.
+  */
+
+  std::vector<T> signatures( const std::vector<T>& times ) const
+  {
+    auto k = _eigenvalues.size();
+    auto m = times.size();
+
+    std::vector<T> weights( k * m );
+
+    for( std::size_t l = 0; l < k; l++ )
+      for( std::size_t s = 0; s < m; s++ )
+        weights[ l * m + s ] = std::exp( -times[s] * _eigenvalues[l] );
+
+    std::vector<T> result( _n * m, T() );
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < _n; i++ )
+    {
+      T* row = result.data() + i * m;
+
+      for( std::size_t l = 0; l < k; l++ )
+      {
+        T u = _eigenvectors[ i * k + l ];
+        T w = u * u;
+
+        for( std::size_t s = 0; s < m; s++ )
+          row[s] += w * weights[ l * m + s ];
+      }
+    }
+
+    return result;
+  }
+
+  /** Calculates the trace of the heat kernel for multiple time scales */
+  std::vector<T> trace( const std::vector<T>& times ) const
+  {
+    std::vector<T> result;
+    result.reserve( times.size() );
+
+    for( auto&& t : times )
+    {
+      T sum = T();
+      for( auto&& eigenvalue : _eigenvalues )
+        sum += std::exp( -t * eigenvalue );
+
+      result.push_back( sum );
+    }
+
+    return result;
+  }
+
+private:
+
+  /**
+    Performs the Lanczos iteration with full reorthogonalization. If the
+    Krylov subspace becomes invariant, the iteration continues with a new
+    random vector that is orthogonal to all previous ones, which happens
+    for disconnected graphs, for example.
+
+    @param alpha Diagonal of the tridiagonal matrix
+    @param beta  Subdiagonal of the tridiagonal matrix
+    @param Q     Lanczos vectors, stored one after the other
+  */
+
+  void lanczos( const SparseLaplacian<T>& L,
+                std::size_t steps,
+                unsigned seed,
+                std::vector<T>& alpha,
+                std::vector<T>& beta,
+                std::vector<T>& Q ) const
+  {
+    auto n = _n;
+
+    std::mt19937 rng( seed );
+    std::uniform_real_distribution<T> distribution( T(-1), T(1) );
+
+    auto tolerance = std::max( L.spectralBound(), T(1) ) * 1e-10;
+
+    Q.assign( n * steps, T() );
+
+    // Orthogonalizes a vector against the first j Lanczos vectors; this
+    // is done twice to ensure that orthogonality is not lost.
+    auto orthogonalize = [&] ( T* w, std::size_t j )
+    {
+      for( unsigned pass = 0; pass < 2; pass++ )
+      {
+        for( std::size_t r = 0; r < j; r++ )
+        {
+          const T* q = Q.data() + r * n;
+          detail::axpy( -detail::dot( q, w, n ), q, w, n );
+        }
+      }
+    };
+
+    // Creates a random unit vector that is orthogonal to the first j
+    // Lanczos vectors; returns false if there is no such vector.
+    auto restart = [&] ( T* q, std::size_t j )
+    {
+      for( std::size_t i = 0; i < n; i++ )
+        q[i] = distribution( rng );
+
+      orthogonalize( q, j );
+
+      auto norm = std::sqrt( detail::dot( q, q, n ) );
+
+      if( norm < 1e-8 * std::sqrt( T( n ) ) )
+        return false;
+
+      for( std::size_t i = 0; i < n; i++ )
+        q[i] /= norm;
+
+      return true;
+    };
+
+    if( n == 0 || !restart( Q.data(), 0 ) )
+      return;
+
+    std::vector<T> w( n );
+
+    for( std::size_t j = 0; j < steps; j++ )
+    {
+      T* q = Q.data() + j * n;
+
+      L.multiply( q, w.data(), 1 );
+
+      alpha.push_back( detail::dot( q, w.data(), n ) );
+
+      orthogonalize( w.data(), j + 1 );
+
+      if( j + 1 == steps )
+        break;
+
+      T* next = Q.data() + ( j + 1 ) * n;
+      T norm  = std::sqrt( detail::dot( w.data(), w.data(), n ) );
+
+      if( norm > tolerance )
+      {
+        for( std::size_t i = 0; i < n; i++ )
+          next[i] = w[i] / norm;
+
+        beta.push_back( norm );
+      }
+      else if( restart( next, j + 1 ) )
+        beta.push_back( T() );
+      else
+        break;
+    }
+  }
+
+  std::size_t _n;
+
+  /** k smallest eigenvalues in ascending order */
+  std::vector<T> _eigenvalues;
+
+  /** Eigenvectors; entry l of row i belongs to the l-th eigenvector */
+  std::vector<T> _eigenvectors;
+};
+
+/**
+  @class ChebyshevHeatKernel
+  @brief Heat kernel signatures based on a Chebyshev expansion
+
+  Approximates the heat operator exp(-tL) by a Chebyshev expansion of the
+  exponential function on the spectrum of the Laplacian. This does not
+  require any eigenpairs; all computations are multiplications of the
+  sparse Laplacian with blocks of probing vectors. The diagonal of the
+  heat operator, i.e. the heat kernel signature, is estimated from these
+  products. Since the Chebyshev polynomials do not depend on the time
+  scale, all time scales are evaluated in a single pass.
+
+  By default, the diagonal is estimated stochastically from random sign
+  vectors. If the number of probes is set to zero, the unit vectors are
+  used instead, which yields the exact diagonal of the expansion at
+  quadratic costs.
+*/
+
+class ChebyshevHeatKernel
+{
+public:
+  using T = double;
+
+  explicit ChebyshevHeatKernel( SparseLaplacian<T> L )
+    : _L( std::move( L ) )
+  {
+  }
+
+  /**
+    Sets the degree of the expansion. If zero, the degree is chosen from
+    the largest time scale such that the truncation error is negligible.
+  */
+
+  void setDegree( std::size_t degree ) noexcept { _degree = degree; }
+
+  /** Sets the number of random probing vectors; zero uses unit vectors */
+  void setNumProbes( std::size_t probes ) noexcept { _numProbes = probes; }
+
+  /** Sets the number of vectors that are multiplied at once */
+  void setBlockSize( std::size_t size ) noexcept { _blockSize = std::max( size, std::size_t(1) ); }
+
+  void setSeed( unsigned seed ) noexcept { _seed = seed; }
+
+  std::size_t degree() const noexcept    { return _degree;    }
+  std::size_t numProbes() const noexcept { return _numProbes; }
+  std::size_t blockSize() const noexcept { return _blockSize; }
+
+  /**
+    Calculates the heat kernel signatures of all vertices for multiple
+    time scales in a single pass. The result is stored in row-major order,
+    i.e. the signature of vertex i occupies the entries [i * m, (i+1) * m)
+    for m time scales.
+  */
+
+  std::vector<T> signatures( const std::vector<T>& times ) const
+  {
+    auto n = _L.size();
+    auto m = times.size();
+
+    std::vector<T> result( n * m, T() );
+
+    if( n == 0 || m == 0 )
+      return result;
+
+    // Any positive bound works for a Laplacian without edges
+    T lambda = std::max( _L.spectralBound(), T(1e-12) );
+
+    auto degree       = this->expansionDegree( times, lambda );
+    auto coefficients = this->coefficients( times, lambda, degree );
+
+    bool exact   = _numProbes == 0;
+    auto probes  = exact ? n : _numProbes;
+    auto b       = std::min( _blockSize, probes );
+
+    std::mt19937 rng( _seed );
+    std::bernoulli_distribution distribution;
+
+    std::vector<T> V( n * b );
+    std::vector<T> X0( n * b );
+    std::vector<T> X1( n * b );
+    std::vector<T> X2( n * b );
+    std::vector<T> norms( n, T() );
+
+    for( std::size_t first = 0; first < probes; first += b )
+    {
+      auto size = std::min( b, probes - first );
+
+      // Probing vectors -----------------------------------------------
+      //
+      // Unused columns of the last block remain zero, so they do not
+      // contribute to the estimate.
+
+      std::fill( V.begin(), V.end(), T() );
+
+      for( std::size_t i = 0; i < n; i++ )
+      {
+        for( std::size_t c = 0; c < size; c++ )
+        {
+          if( exact )
+            V[ i * b + c ] = ( i == first + c ) ? T(1) : T();
+          else
+            V[ i * b + c ] = distribution( rng ) ? T(1) : T(-1);
+        }
+      }
+
+      for( std::size_t i = 0; i < n; i++ )
+        for( std::size_t c = 0; c < size; c++ )
+          norms[i] += V[ i * b + c ] * V[ i * b + c ];
+
+      // Chebyshev recurrence ------------------------------------------
+      //
+      // The Laplacian is scaled to [-1,1] by M = 2/lambda * L - I, and
+      // the recurrence is T_{k+1}(M) = 2 M T_k(M) - T_{k-1}(M).
+
+      X0 = V;
+      this->accumulate( V, X0, coefficients, 0, m, b, result );
+
+      if( degree >= 1 )
+      {
+        this->scaledMultiply( X0, X1, lambda, b );
+        this->accumulate( V, X1, coefficients, 1, m, b, result );
+      }
+
+      for( std::size_t k = 2; k <= degree; k++ )
+      {
+        this->scaledMultiply( X1, X2, lambda, b );
+
+        #pragma omp parallel for
+        for( std::size_t i = 0; i < n * b; i++ )
+          X2[i] = 2 * X2[i] - X0[i];
+
+        this->accumulate( V, X2, coefficients, k, m, b, result );
+
+        X0.swap( X1 );
+        X1.swap( X2 );
+      }
+    }
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < n; i++ )
+      for( std::size_t s = 0; s < m; s++ )
+        result[ i * m + s ] /= norms[i];
+
+    return result;
+  }
+
+  /** Calculates the trace of the heat kernel for multiple time scales */
+  std::vector<T> trace( const std::vector<T>& times ) const
+  {
+    auto m = times.size();
+    auto H = this->signatures( times );
+
+    std::vector<T> result( m, T() );
+
+    for( std::size_t i = 0; i < H.size(); i++ )
+      result[ i % m ] += H[i];
+
+    return result;
+  }
+
+private:
+
+  /** Calculates Y = (2/lambda * L - I) X */
+  void scaledMultiply( const std::vector<T>& X, std::vector<T>& Y, T lambda, std::size_t b ) const
+  {
+    _L.multiply( X.data(), Y.data(), b );
+
+    auto scale = 2 / lambda;
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < X.size(); i++ )
+      Y[i] = scale * Y[i] - X[i];
+  }
+
+  /**
+    Adds the contribution of the k-th Chebyshev polynomial to the
+    signatures of all vertices and all time scales.
+  */
+
+  static void accumulate( const std::vector<T>& V,
+                          const std::vector<T>& X,
+                          const std::vector<T>& coefficients,
+                          std::size_t k,
+                          std::size_t m,
+                          std::size_t b,
+                          std::vector<T>& result )
+  {
+    auto n = result.size() / m;
+    const T* c = coefficients.data() + k * m;
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      T sum = T();
+
+      for( std::size_t j = 0; j < b; j++ )
+        sum += V[ i * b + j ] * X[ i * b + j ];
+
+      for( std::size_t s = 0; s < m; s++ )
+        result[ i * m + s ] += c[s] * sum;
+    }
+  }
+
+  /**
+    Chooses the degree of the expansion. The coefficients of exp(-a(x+1))
+    decay like exp(-k^2 / 2a), with a = t * lambda / 2, so the degree grows
+    with the square root of the largest time scale.
+  */
+
+  std::size_t expansionDegree( const std::vector<T>& times, T lambda ) const
+  {
+    if( _degree != 0 )
+      return _degree;
+
+    T a = T();
+
+    for( auto&& t : times )
+      a = std::max( a, t * lambda / 2 );
+
+    return static_cast<std::size_t>( std::ceil( std::sqrt( 60 * a ) + a / 4 ) ) + 16;
+  }
+
+  /**
+    Calculates the Chebyshev coefficients of exp(-t * lambda * (x+1) / 2)
+    on [-1,1] for all time scales by interpolation at the Chebyshev nodes.
+    The coefficients are stored in row-major order with one row per
+    degree; the first coefficient is halved already.
+  */
+
+  static std::vector<T> coefficients( const std::vector<T>& times, T lambda, std::size_t degree )
+  {
+    auto m     = times.size();
+    auto N     = 2 * ( degree + 1 );
+    auto pi    = std::acos( T(-1) );
+
+    std::vector<T> result( ( degree + 1 ) * m, T() );
+
+    for( std::size_t j = 0; j < N; j++ )
+    {
+      T theta = pi * ( T( j ) + T( 0.5 ) ) / T( N );
+      T x     = std::cos( theta );
+
+      for( std::size_t s = 0; s < m; s++ )
+      {
+        T f = std::exp( -times[s] * lambda * ( x + 1 ) / 2 );
+
+        for( std::size_t k = 0; k <= degree; k++ )
+          result[ k * m + s ] += f * std::cos( T( k ) * theta );
+      }
+    }
+
+    for( std::size_t k = 0; k <= degree; k++ )
+      for( std::size_t s = 0; s < m; s++ )
+        result[ k * m + s ] *= ( k == 0 ? T(1) : T(2) ) / T( N );
+
+    return result;
+  }
+
+  SparseLaplacian<T> _L;
+
+  std::size_t _degree    = 0;
+  std::size_t _numProbes = 64;
+  std::size_t _blockSize = 16;
+
+  unsigned _seed = 42;
+};
+
+} // namespace geometry
+
+} // namespace aleph
+
+#endif
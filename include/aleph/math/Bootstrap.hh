@@ -3,25 +3,99 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <random>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include <cstddef>
+#include <cstdint>
+
 namespace aleph
 {
 
 namespace math
 {
 
+namespace detail
+{
+
+/**
+  @class ReplicateEngine
+  @brief Counter-based random number engine for a single bootstrap replicate
+
+  Every output is obtained by hashing a counter with the SplitMix64
+  finalizer. The initial counter only depends on the seed and on the index
+  of the replicate, so every replicate has its own stream that can be
+  created in constant time. This makes the replicates independent of the
+  order, and the number of threads, in which they are calculated.
+*/
+
+class ReplicateEngine
+{
+public:
+  using result_type = std::uint64_t;
+
+  ReplicateEngine( std::uint64_t seed, std::uint64_t replicate )
+    : _counter( mix( mix( seed ) + replicate ) )
+  {
+  }
+
+  static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  result_type operator()()
+  {
+    _counter += gamma;
+    return mix( _counter );
+  }
+
+private:
+  static constexpr std::uint64_t gamma = 0x9e3779b97f4a7c15ull;
+
+  static std::uint64_t mix( std::uint64_t z )
+  {
+    z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+    z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+    return z ^ ( z >> 31 );
+  }
+
+  std::uint64_t _counter;
+};
+
+} // namespace detail
+
 class Bootstrap
 {
 public:
 
+  /** Creates a bootstrap with a random seed */
+  Bootstrap()
+    : _seed( std::random_device()() )
+  {
+  }
+
+  /**
+    Creates a bootstrap with a fixed seed. All replicates are reproducible,
+    regardless of the number of threads used to calculate them.
+  */
+
+  explicit Bootstrap( std::uint64_t seed )
+    : _seed( seed )
+  {
+  }
+
   /**
     Given a range of data of some type, calculates a set of bootstrap replicates
     for a desired statistic. This function will not perform any type conversions
     in order to preserve all original types. The type of the output data depends
     on the return value type of the functor.
 
+    Replicates are calculated in parallel, and every replicate draws its
+    sample from a random stream of its own. The functor hence needs to be
+    thread-safe, and its return type needs to be default-constructible.
+
     @param[in]  numSamples samples Number of bootstrap samples
     @param[in]  begin      Input iterator to begin of data range
     @param[in]  end        Input iterator to end of data range
@@ -40,24 +114,25 @@ public:
 
     std::vector<SampleValueType> samples( begin, end );
 
-    std::random_device rd;
-    std::mt19937 rng( rd() );
+    if( samples.empty() )
+      throw std::runtime_error( "Unable to bootstrap empty data" );
 
-    std::uniform_int_distribution<std::size_t> distribution( 0, samples.size() - 1 );
-
-    std::vector<FunctorValueType> replicates;
-    replicates.reserve( numSamples );
+    std::vector<FunctorValueType> replicates( numSamples );
 
+    #pragma omp parallel for schedule(dynamic)
     for( unsigned sampleIndex = 0; sampleIndex < numSamples; sampleIndex++ )
     {
+      detail::ReplicateEngine rng( _seed, sampleIndex );
+      std::uniform_int_distribution<std::size_t> distribution( 0, samples.size() - 1 );
+
       std::vector<SampleValueType> sample;
       sample.reserve( samples.size() );
 
       for( std::size_t i = 0; i < samples.size(); i++ )
-        sample.push_back( samples.at( distribution( rng ) ) );
+        sample.push_back( samples[ distribution( rng ) ] );
 
-      replicates.push_back( functor( sample.begin(),
-                                     sample.end() ) );
+      replicates[sampleIndex] = functor( sample.begin(),
+                                         sample.end() );
     }
 
     std::copy( replicates.begin(), replicates.end(), result );
@@ -80,12 +155,14 @@ public:
                           functor,
                           std::back_inserter( estimates ) );
 
-    std::sort( estimates.begin(), estimates.end() );
-
     auto upperPercentile = alpha / 2;
-    auto upperEstimate   = estimates.at( Bootstrap::index( numSamples, upperPercentile ) );
     auto lowerPercentile = 1 - upperPercentile;
-    auto lowerEstimate   = estimates.at( Bootstrap::index( numSamples, lowerPercentile ) );
+    auto estimate        = Bootstrap::quantiles( estimates,
+                                                 Bootstrap::index( numSamples, upperPercentile ),
+                                                 Bootstrap::index( numSamples, lowerPercentile ) );
+
+    auto upperEstimate   = estimate.first;
+    auto lowerEstimate   = estimate.second;
 
     return std::make_pair( 2*theta - lowerEstimate, 2*theta - upperEstimate );
   }
@@ -106,27 +183,51 @@ public:
                           functor,
                           std::back_inserter( estimates ) );
 
-    std::sort( estimates.begin(), estimates.end() );
-
     auto lowerPercentile = alpha / 2;
-    auto lowerEstimate   = estimates.at( Bootstrap::index( numSamples, lowerPercentile ) );
     auto upperPercentile = 1 - lowerPercentile;
-    auto upperEstimate   = estimates.at( Bootstrap::index( numSamples, upperPercentile ) );
 
-    return std::make_pair( lowerEstimate, upperEstimate );
+    return Bootstrap::quantiles( estimates,
+                                 Bootstrap::index( numSamples, lowerPercentile ),
+                                 Bootstrap::index( numSamples, upperPercentile ) );
   }
 
-private:
-
   /** Calculates index at a certain percentile of the data */
   static unsigned index( unsigned int samples, double alpha )
   {
     // This accounts for rounding and works regardless of whether
     // the product samples * alpha is an integer or not. Note the
     // offset of -1. It is required because, say, the 100th value
-    // is at index 99 of the vector.
-    return static_cast<unsigned>( samples * alpha + 0.5 ) - 1;
+    // is at index 99 of the vector. Small percentiles are mapped
+    // to the first value.
+    return std::max( static_cast<unsigned>( samples * alpha + 0.5 ), 1u ) - 1;
   }
+
+  /**
+    Selects the values that would be stored at two indices if the data were
+    sorted. Instead of sorting the data, this uses two selections, so the
+    running time is linear. The data are partially reordered.
+  */
+
+  template <class T> static std::pair<T, T> quantiles( std::vector<T>& data, std::size_t i, std::size_t j )
+  {
+    if( data.empty() || i > j || j >= data.size() )
+      throw std::out_of_range( "Invalid quantile indices" );
+
+    auto first = data.begin() + std::ptrdiff_t( i );
+    auto last  = data.begin() + std::ptrdiff_t( j );
+
+    std::nth_element( data.begin(), first, data.end() );
+
+    // All values after the first index are not smaller than the value
+    // at this index, so the second selection only needs to consider them.
+    if( j > i )
+      std::nth_element( std::next( first ), last, data.end() );
+
+    return std::make_pair( *first, *last );
+  }
+
+private:
+  std::uint64_t _seed;
 };
 
 } // namespace math
@@ -2,14 +2,17 @@
 #define ALEPH_MATH_STEP_FUNCTION_HH__
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <ostream>
-#include <set>
+#include <queue>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
 
 namespace aleph
@@ -18,26 +21,19 @@ namespace aleph
 namespace math
 {
 
-namespace detail
-{
-
-template <class T> T next( T x )
-{
-  if( std::numeric_limits<T>::is_integer )
-    return x+1;
-  else
-    return std::nextafter( x, std::numeric_limits<T>::max() );
-}
+/**
+  @class StepFunction
+  @brief Piecewise constant function with finite support
 
-template <class T> T previous( T x )
-{
-  if( std::numeric_limits<T>::is_integer )
-    return x-1;
-  else
-    return std::nextafter( x, std::numeric_limits<T>::lowest() );
-}
+  A step function is stored as a sorted array of breakpoints. Every
+  breakpoint has a value of its own, and every open interval between two
+  consecutive breakpoints has a constant value. The function vanishes
+  outside of the first and the last breakpoint.
 
-} // namespace detail
+  This representation permits evaluating the function using a binary
+  search, while arithmetic operations of two functions merge their
+  breakpoints in linear time.
+*/
 
 template <class D, class I = D> class StepFunction
 {
@@ -47,174 +43,96 @@ public:
   using Image  = I;
 
   /**
-    Auxiliary class for representing an indicator function interval of the step
-    function. Each indicator function is only non-zero within its interval, and
-    zero outside.
+    Adds a new indicator function to the step function, i.e. the closed
+    interval [a,b] attains the value y. Intervals may share end points; the
+    function attains the value of larger magnitude at such a point. The
+    same rule applies to overlapping intervals. Adding intervals in sorted
+    order only requires constant time.
   */
 
-  class IndicatorFunction
+  void add( D a, D b, I y )
   {
-  public:
-    explicit IndicatorFunction( D a )
-      : _a( a    )
-      , _b( a    )
-      , _y( I(1) )
-    {
-    }
+    if( a > b )
+      throw std::runtime_error( "Invalid interval specified" );
 
-    IndicatorFunction( D a, D b, I y )
-      : _a( a )
-      , _b( b )
-      , _y( y )
+    auto larger = [] ( I x, I y )
     {
-      if( a > b )
-        throw std::runtime_error( "Invalid interval specified" );
-    }
-
-    const D& a() const noexcept { return _a; }
-    const D& b() const noexcept { return _b; }
-
-          I& y()       noexcept { return _y; }
-    const I& y() const noexcept { return _y; }
+      return std::abs( y ) > std::abs( x ) ? y : x;
+    };
 
-    bool contains( D x ) const noexcept
+    if( _x.empty() || a > _x.back() )
     {
-      return this->a() <= x && x <= this->b();
-    }
+      if( !_x.empty() )
+        _values.push_back( I() );
 
-    /** Standard (signed) integral */
-    I integral() const noexcept
-    {
-      return this->y() * static_cast<I>( ( this->b() - this->a() ) );
+      _x.push_back( a );
+      _points.push_back( y );
     }
-
-    /** Unsigned integral raised to a certain power */
-    I integral_p( I p ) const noexcept
+    else if( a == _x.back() )
+      _points.back() = larger( _points.back(), y );
+    else
     {
-      auto value  = std::abs( this->integral() );
-      return std::pow( value, p );
-    }
+      StepFunction g;
+      g.add( a, b, y );
 
-    I operator()( D x ) const noexcept
-    {
-      if( this->contains( x ) )
-        return this->y();
-      else
-        return I();
-    }
-
-    /** Raises the indicator function to a certain power */
-    IndicatorFunction pow( I p ) const noexcept
-    {
-      return IndicatorFunction( this->a(), this->b(), std::pow( this->y(), p ) );
-    }
-
-    // Arithmetic ------------------------------------------------------
-
-    IndicatorFunction& operator*=( I lambda ) noexcept
-    {
-      _y *= lambda;
-      return *this;
-    }
-
-    IndicatorFunction operator*( I lambda ) const noexcept
-    {
-      auto f = *this;
-      f *= lambda;
-      return f;
-    }
-
-    IndicatorFunction& operator/=( I lambda )
-    {
-      // Note that I do not have to handle divisions by zero here
-      // because only the step function is using this class.
-      return this->operator/=( 1/lambda );
-    }
-
-    IndicatorFunction operator/( I lambda ) const
-    {
-      auto f = *this;
-      f /= lambda;
-      return f;
+      *this = merge( *this, g, larger );
+      return;
     }
 
-    // Comparison ------------------------------------------------------
-
-    bool operator<( const IndicatorFunction& other ) const
+    if( b > a )
     {
-      // Permits that intervals intersect in a single point, as this is
-      // simplifies the composition of multiple step functions.
-      return this->b() <= other.a();
+      _x.push_back( b );
+      _points.push_back( y );
+      _values.push_back( y );
     }
-
-  private:
-    D _a;
-    D _b;
-    I _y;
-  };
-
-  /** Adds a new indicator function to the step function */
-  void add( D a, D b, I y ) noexcept
-  {
-    _indicatorFunctions.insert( IndicatorFunction(a,b,y) );
   }
 
-  /** Returns the domain of the function */
-  template <class OutputIterator> void domain( OutputIterator result ) const noexcept
+  /** Returns the domain of the function, i.e. all of its breakpoints */
+  template <class OutputIterator> void domain( OutputIterator result ) const
   {
-    for( auto&& f : _indicatorFunctions )
-    {
-      *result++ = f.a();
-      *result++ = f.b();
-    }
+    std::copy( _x.begin(), _x.end(), result );
   }
 
   /** Returns the image of the function */
-  template <class OutputIterator> void image( OutputIterator result ) const noexcept
+  template <class OutputIterator> void image( OutputIterator result ) const
   {
-    for( auto&& f : _indicatorFunctions )
-      *result++ = f.y();
+    for( std::size_t i = 0; i < _x.size(); i++ )
+    {
+      *result++ = _points[i];
+
+      if( i < _values.size() )
+        *result++ = _values[i];
+    }
   }
 
   /** Returns the function value at a certain position */
   I operator()( D x ) const noexcept
   {
-    I value = I();
-
-    auto contains = [&x] ( const IndicatorFunction& f )
-                    {
-                      return f.contains(x);
-                    };
+    auto it = std::lower_bound( _x.begin(), _x.end(), x );
 
-    // Determine the range in which indicator functions have to be
-    // queried. There is no need to query any function outside the
-    // interval below because it will not contain x.
-    auto itStart = std::find_if( _indicatorFunctions.begin(), _indicatorFunctions.end(), contains );
-    auto itEnd   = std::find_if_not( itStart,                 _indicatorFunctions.end(), contains );
-
-    for( auto it = itStart; it != itEnd; ++it )
-    {
-      auto&& f = *it;
+    if( it == _x.end() )
+      return I();
 
-      // TODO: Not sure whether I really want this. The step functions must not
-      // overlap anyway...
-      if( std::abs( f(x) ) > value )
-        value = f(x);
-    }
+    auto i = static_cast<std::size_t>( std::distance( _x.begin(), it ) );
 
-    return value;
+    if( *it == x )
+      return _points[i];
+    else if( i == 0 )
+      return I();
+    else
+      return _values[i-1];
   }
 
   /** Calculates the maximum (supremum) of the step function */
   I max() const noexcept
   {
-    if( _indicatorFunctions.empty() )
+    if( _x.empty() )
       return I();
 
-    auto max = std::numeric_limits<I>::lowest();
+    auto max = *std::max_element( _points.begin(), _points.end() );
 
-    for( auto&& f : _indicatorFunctions )
-      max = std::max( max, f.y() );
+    if( !_values.empty() )
+      max = std::max( max, *std::max_element( _values.begin(), _values.end() ) );
 
     return max;
   }
@@ -226,122 +144,49 @@ public:
   }
 
   /** Calculates the sum of this step function with another step function */
-  StepFunction& operator+=( const StepFunction& other ) noexcept
+  StepFunction& operator+=( const StepFunction& other )
   {
-    auto&& f = *this;
-    auto&& g = other;
-
-    std::set<D> domain;
-
-    f.domain( std::inserter( domain, domain.begin() ) );
-    g.domain( std::inserter( domain, domain.begin() ) );
-
-    StepFunction<D,I> h;
-
-    if( domain.empty() )
-      return *this;
-
-    auto prev = *domain.begin();
-    auto curr = *domain.begin();
-
-    for( auto it = std::next( domain.begin() ); it != domain.end(); ++it )
-    {
-      curr    = *it;
-
-      auto y1 = f( prev );
-      auto y2 = g( prev );
-      auto y3 = f( curr );
-      auto y4 = g( curr );
-      auto y5 = f( detail::next( prev ) );
-      auto y6 = g( detail::next( prev ) );
-
-      if( y1 == y3 && y2 == y4 )
-        h.add( prev, curr, y1+y2 );
-
-      // A subdivision of the interval [prev, curr] is required because
-      // at least one of the functions differs on the end points of the
-      // interval.
-      else if( y1 != y3 || y2 != y4 )
-      {
-        // Make the interval smaller if we hit a point where at least a
-        // single function changes.
-        if( y1 != y5 || y2 != y6 )
-          prev = detail::next( prev );
-
-        if( y5+y6 != y3+y4 )
-        {
-          // [prev, curr - epsilon]: y5+y6
-          // [curr, curr + epsilon]: y3+y4
-          h.add( prev, detail::previous( curr ), y5+y6 );
-          h.add( curr, detail::next(     curr ), y3+y4 );
-        }
-
-        // FIXME: Not sure whether this is really the best workaround
-        // here or whether I need a different strategy.
-        else
-          h.add( prev, detail::next( curr ), y3+y4 );
-
-        // Ensures that the next interval uses the proper start point for the
-        // indicator function interval.
-        curr = detail::next( curr );
-      }
-
-      prev = curr;
-    }
-
-    *this = h;
-
-    this->clean();
-
+    *this = merge( *this, other, std::plus<I>() );
     return *this;
   }
 
   /** Calculates the sum of this step function with another step function */
-  StepFunction operator+( const StepFunction& rhs ) const noexcept
+  StepFunction operator+( const StepFunction& rhs ) const
   {
-    auto lhs = *this;
-    lhs += rhs;
-    return lhs;
+    return merge( *this, rhs, std::plus<I>() );
   }
 
   /** Calculates the difference of this step function with another step function */
   StepFunction& operator-=( const StepFunction& other )
   {
-    return this->operator+=( -other );
+    *this = merge( *this, other, std::minus<I>() );
+    return *this;
   }
 
   /** Calculates the difference of this step function with another step function */
-  StepFunction operator-( const StepFunction& rhs ) const noexcept
+  StepFunction operator-( const StepFunction& rhs ) const
   {
-    auto lhs = *this;
-    lhs -= rhs;
-    return lhs;
+    return merge( *this, rhs, std::minus<I>() );
   }
 
   /** Unary minus: negates all values in the image of the step function */
-  StepFunction operator-() const noexcept
+  StepFunction operator-() const
   {
-    StepFunction f;
-
-    for( auto&& indicatorFunction : _indicatorFunctions )
-      f.add( indicatorFunction.a(), indicatorFunction.b(), -indicatorFunction.y() );
-
+    auto f = *this;
+    f.transform( [] ( I y ) { return -y; } );
     return f;
   }
 
   /** Adds a scalar to all step function values */
-  StepFunction operator+( I lambda ) const noexcept
+  StepFunction operator+( I lambda ) const
   {
-    StepFunction f;
-
-    for( auto&& indicatorFunction : _indicatorFunctions )
-      f.add( indicatorFunction.a(), indicatorFunction.b(), lambda + indicatorFunction.y() );
-
+    auto f = *this;
+    f.transform( [&lambda] ( I y ) { return lambda + y; } );
     return f;
   }
 
   /** Subtracts a scalar from all step function values */
-  StepFunction operator-( I lambda ) const noexcept
+  StepFunction operator-( I lambda ) const
   {
     return this->operator+( -lambda );
   }
@@ -349,19 +194,12 @@ public:
   /** Multiplies the given step function with a scalar value */
   StepFunction& operator*=( I lambda ) noexcept
   {
-    // The set may not be modified inline because this might result in
-    // a changed sorting order. Hence the need for a copy.
-    std::set<IndicatorFunction> indicatorFunctions;
-
-    for( auto&& indicatorFunction : _indicatorFunctions )
-      indicatorFunctions.insert( indicatorFunction * lambda );
-
-    _indicatorFunctions.swap( indicatorFunctions );
+    this->transform( [&lambda] ( I y ) { return y * lambda; } );
     return *this;
   }
 
   /** Multiplies the given step function with a scalar value */
-  StepFunction operator*( I lambda ) const noexcept
+  StepFunction operator*( I lambda ) const
   {
     auto f = *this;
     f *= lambda;
@@ -388,27 +226,28 @@ public:
   /** Calculates the integral over the domain of the step function */
   I integral() const noexcept
   {
-    if( _indicatorFunctions.empty() )
-      return I();
-
     I value = I();
 
-    for( auto&& f : _indicatorFunctions )
-      value += f.integral();
+    for( std::size_t i = 0; i < _values.size(); i++ )
+      value += _values[i] * static_cast<I>( _x[i+1] - _x[i] );
 
     return value;
   }
 
-  /** Calculates the unsigned integral raised to a certain power */
+  /**
+    Calculates the unsigned integral raised to a certain power. Every
+    interval contributes the absolute value of its integral.
+  */
+
   I integral_p( I p ) const noexcept
   {
-    if( _indicatorFunctions.empty() )
+    if( _values.empty() )
       return I();
 
     I value = I();
 
-    for( auto&& f : _indicatorFunctions )
-      value += f.integral_p( p );
+    for( std::size_t i = 0; i < _values.size(); i++ )
+      value += std::pow( std::abs( _values[i] * static_cast<I>( _x[i+1] - _x[i] ) ), p );
 
     return std::pow( value, 1/p );
   }
@@ -416,85 +255,240 @@ public:
   /** Calculates the absolute value of the function */
   StepFunction& abs() noexcept
   {
-    std::set<IndicatorFunction> indicatorFunctions;
-
-    for( auto&& f : _indicatorFunctions )
-      indicatorFunctions.insert( IndicatorFunction( f.a(), f.b(), std::abs( f.y() ) ) );
-
-    _indicatorFunctions.swap( indicatorFunctions );
+    this->transform( [] ( I y ) { return std::abs( y ); } );
     return *this;
   }
 
   /** Raises the function to a certain power */
   StepFunction& pow( I p )
   {
-    std::set<IndicatorFunction> indicatorFunctions;
-
-    for( auto&& f : _indicatorFunctions )
-      indicatorFunctions.insert( f.pow( p ) );
-
-    _indicatorFunctions.swap( indicatorFunctions );
+    this->transform( [&p] ( I y ) { return std::pow( y, p ); } );
     return *this;
   }
 
   template <class U, class V> friend std::ostream& operator<<( std::ostream&, const StepFunction<U, V>& f );
 
+  /**
+    Sums a range of step functions using a k-way merge of their arrays of
+    breakpoints. At every breakpoint, only the functions that change are
+    updated, so the running time is O(N log k) for N breakpoints in total.
+  */
+
+  template <class InputIterator> static StepFunction sum( InputIterator begin, InputIterator end )
+  {
+    std::vector<const StepFunction*> functions;
+
+    for( auto it = begin; it != end; ++it )
+    {
+      if( !it->_x.empty() )
+        functions.push_back( &( *it ) );
+    }
+
+    // Pairs of the next breakpoint and the index of the corresponding
+    // function, ordered such that the smallest breakpoint is on top
+    using Entry = std::pair<D, std::size_t>;
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    std::vector<std::size_t> positions( functions.size() );
+
+    for( std::size_t k = 0; k < functions.size(); k++ )
+      queue.push( std::make_pair( functions[k]->_x.front(), k ) );
+
+    StepFunction h;
+
+    // Sum of the interval values of all functions at the current position
+    // and the number of functions whose support contains this position;
+    // the sum is reset whenever no function is active in order to avoid
+    // accumulating round-off errors.
+    I current          = I();
+    std::size_t active = 0;
+
+    while( !queue.empty() )
+    {
+      auto x     = queue.top().first;
+      auto point = current;
+      auto next  = current;
+
+      while( !queue.empty() && queue.top().first == x )
+      {
+        auto k = queue.top().second;
+        queue.pop();
+
+        auto&& f = *functions[k];
+        auto i   = positions[k]++;
+
+        auto before = i > 0 ? f._values[i-1] : I();
+        auto after  = i + 1 < f._x.size() ? f._values[i] : I();
+
+        point += f._points[i] - before;
+        next  += after - before;
+
+        if( i == 0 )
+          ++active;
+
+        if( i + 1 < f._x.size() )
+          queue.push( std::make_pair( f._x[i+1], k ) );
+        else
+          --active;
+      }
+
+      current = active > 0 ? next : I();
+
+      h._x.push_back( x );
+      h._points.push_back( point );
+
+      if( !queue.empty() )
+        h._values.push_back( current );
+    }
+
+    h.compact();
+    return h;
+  }
+
 private:
 
+  /** Applies a functor to all values of the function */
+  template <class Functor> void transform( Functor functor )
+  {
+    for( auto&& y : _points )
+      y = functor( y );
+
+    for( auto&& y : _values )
+      y = functor( y );
+  }
+
   /**
-    Performs some cleaning operations of a step function. This involves
-    removing intervals of empty volume, i.e. intervals during which the
-    function value does not change.
+    Combines two step functions using a binary operation. Both arrays of
+    breakpoints are merged, and the operation is applied to the values at
+    every breakpoint and on every interval, which requires linear time.
   */
 
-  void clean()
+  template <class Operation> static StepFunction merge( const StepFunction& f,
+                                                        const StepFunction& g,
+                                                        Operation operation )
   {
-    for( auto it = _indicatorFunctions.begin(); it != _indicatorFunctions.end(); )
+    StepFunction h;
+
+    h._x.reserve( f._x.size() + g._x.size() );
+    h._points.reserve( f._x.size() + g._x.size() );
+    h._values.reserve( f._x.size() + g._x.size() );
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    // Reports the value of a function at position x as well as the value
+    // directly afterwards. The index refers to the first breakpoint that
+    // has not yet been processed and is advanced if x is a breakpoint.
+    auto values = [] ( const StepFunction& f, std::size_t& i, D x )
     {
-      if( it->a() == it->b() )
-        it = _indicatorFunctions.erase( it );
+      if( i < f._x.size() && f._x[i] == x )
+      {
+        auto point = f._points[i];
+        auto value = i + 1 < f._x.size() ? f._values[i] : I();
+
+        ++i;
+        return std::make_pair( point, value );
+      }
+
+      auto value = i > 0 && i < f._x.size() ? f._values[i-1] : I();
+      return std::make_pair( value, value );
+    };
+
+    while( i < f._x.size() || j < g._x.size() )
+    {
+      D x;
+
+      if( i < f._x.size() && j < g._x.size() )
+        x = std::min( f._x[i], g._x[j] );
+      else if( i < f._x.size() )
+        x = f._x[i];
       else
-        ++it;
+        x = g._x[j];
+
+      auto a = values( f, i, x );
+      auto b = values( g, j, x );
+
+      h._x.push_back( x );
+      h._points.push_back( operation( a.first, b.first ) );
+
+      if( i < f._x.size() || j < g._x.size() )
+        h._values.push_back( operation( a.second, b.second ) );
     }
 
-    if( _indicatorFunctions.empty() )
-      return;
+    h.compact();
+    return h;
+  }
 
-    auto prev = _indicatorFunctions.begin();
-    auto curr = prev;
+  /**
+    Removes all breakpoints at which the function does not change, i.e.
+    breakpoints whose value coincides with the values of the adjacent
+    intervals. This keeps the representation minimal.
+  */
 
-    std::set<IndicatorFunction> indicatorFunctions;
+  void compact()
+  {
+    std::size_t n = 0;
 
-    for( ; curr != _indicatorFunctions.end(); )
+    for( std::size_t i = 0; i < _x.size(); i++ )
     {
-      while( curr->y() == prev->y() && curr != _indicatorFunctions.end() )
-        ++curr;
+      auto left  = i > 0             ? _values[i-1] : I();
+      auto right = i + 1 < _x.size() ? _values[i]   : I();
+
+      if( _points[i] == left && left == right )
+        continue;
 
-      indicatorFunctions.insert( IndicatorFunction( prev->a(), std::prev( curr )->b(), prev->y() ) );
+      // Since the breakpoint is kept, the interval to its left ends here;
+      // its value is the one of the last removed interval.
+      if( n > 0 )
+        _values[n-1] = i > 0 ? _values[i-1] : I();
 
-      prev = curr;
+      _x[n]      = _x[i];
+      _points[n] = _points[i];
+      ++n;
     }
 
-    _indicatorFunctions.swap( indicatorFunctions );
+    _x.resize( n );
+    _points.resize( n );
+    _values.resize( n > 0 ? n - 1 : 0 );
   }
 
-  /** All indicator functions of the step function */
-  std::set<IndicatorFunction> _indicatorFunctions;
+  /** Sorted breakpoints of the function */
+  std::vector<D> _x;
+
+  /** Function values at the breakpoints */
+  std::vector<I> _points;
+
+  /** Function values on the open intervals between consecutive breakpoints */
+  std::vector<I> _values;
 };
 
-// TODO: This does not need to be a friend function; it suffices to be
-// implemented using the public interface of the class.
+/**
+  Writes a step function to an output stream. Every interval is written
+  as two points, which is suitable for plotting.
+*/
+
 template <class D, class I> std::ostream& operator<<( std::ostream& o, const StepFunction<D, I>& f )
 {
-  for( auto&& indicatorFunction : f._indicatorFunctions )
+  for( std::size_t i = 0; i < f._values.size(); i++ )
   {
-    o << indicatorFunction.a() << "\t" << indicatorFunction.y() << "\n"
-      << indicatorFunction.b() << "\t" << indicatorFunction.y() << "\n";
+    o << f._x[i]   << "\t" << f._values[i] << "\n"
+      << f._x[i+1] << "\t" << f._values[i] << "\n";
   }
 
   return o;
 }
 
+/**
+  Sums a range of step functions. This is more efficient than adding the
+  functions one after the other.
+*/
+
+template <class InputIterator> typename std::iterator_traits<InputIterator>::value_type sum( InputIterator begin, InputIterator end )
+{
+  using StepFunction = typename std::iterator_traits<InputIterator>::value_type;
+  return StepFunction::sum( begin, end );
+}
+
 /**
   Auxiliary function for normalizing a step function. Given a range
   spanned by a minimum $a$ and a maximum $b$, the image of the step
@@ -507,16 +501,21 @@ template <class D, class I> StepFunction<D,I> normalize( const StepFunction<D,I>
                                                          I a = I(),
                                                          I b = I(1) )
 {
-  std::set<I> image;
-  f.image( std::inserter( image, image.end() ) );
+  std::vector<I> image;
+  f.image( std::back_inserter( image ) );
+
+  if( image.empty() )
+    return f;
+
+  auto minmax = std::minmax_element( image.begin(), image.end() );
 
-  if( image.empty() || image.size() == 1 )
+  if( *minmax.first == *minmax.second )
     return f;
 
   // The minimum value in the image of the function is zero because this
   // value is guaranteed to be attained at some point
-  auto min =  I();
-  auto max = *image.rbegin();
+  auto min = I();
+  auto max = *minmax.second;
 
   auto g = f - min;
   g      = g / ( max - min ); // now scaled between [0,1  ]
@@ -0,0 +1,186 @@
+#ifndef ALEPH_MATH_SYMMETRIC_EIGENVALUES_HH__
+#define ALEPH_MATH_SYMMETRIC_EIGENVALUES_HH__
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace math
+{
+
+namespace detail
+{
+
+/**
+  Calculates the eigenvalues of a symmetric matrix using the cyclic Jacobi
+  method. If the template parameter is non-zero, it specifies the size of
+  the matrix at compile time, which permits the compiler to unroll all
+  loops. Otherwise, the size is taken from the function parameter.
+
+  @param A           Matrix in row-major order; it is destroyed
+  @param n           Number of rows of the matrix; ignored if D is non-zero
+  @param eigenvalues Output array for n eigenvalues, in no particular order
+*/
+
+template <std::size_t D> void jacobiEigenvalues( double* A, std::size_t n, double* eigenvalues )
+{
+  const std::size_t m = D > 0 ? D : n;
+
+  double scale = 0.0;
+
+  for( std::size_t i = 0; i < m * m; i++ )
+    scale += A[i] * A[i];
+
+  for( unsigned sweep = 0; sweep < 64; sweep++ )
+  {
+    double off = 0.0;
+
+    for( std::size_t p = 0; p < m; p++ )
+      for( std::size_t q = p + 1; q < m; q++ )
+        off += A[ p * m + q ] * A[ p * m + q ];
+
+    if( off <= 1e-30 * scale )
+      break;
+
+    for( std::size_t p = 0; p < m; p++ )
+    {
+      for( std::size_t q = p + 1; q < m; q++ )
+      {
+        auto apq = A[ p * m + q ];
+
+        if( apq == 0.0 )
+          continue;
+
+        // Rotation that annihilates the off-diagonal element; the angle
+        // is chosen to be as small as possible for numerical stability.
+        auto theta = ( A[ q * m + q ] - A[ p * m + p ] ) / ( 2.0 * apq );
+        auto t     = std::copysign( 1.0, theta ) / ( std::abs( theta ) + std::sqrt( theta * theta + 1.0 ) );
+        auto c     = 1.0 / std::sqrt( t * t + 1.0 );
+        auto s     = t * c;
+
+        for( std::size_t k = 0; k < m; k++ )
+        {
+          auto akp = A[ k * m + p ];
+          auto akq = A[ k * m + q ];
+
+          A[ k * m + p ] = c * akp - s * akq;
+          A[ k * m + q ] = s * akp + c * akq;
+        }
+
+        for( std::size_t k = 0; k < m; k++ )
+        {
+          auto apk = A[ p * m + k ];
+          auto aqk = A[ q * m + k ];
+
+          A[ p * m + k ] = c * apk - s * aqk;
+          A[ q * m + k ] = s * apk + c * aqk;
+        }
+      }
+    }
+  }
+
+  for( std::size_t i = 0; i < m; i++ )
+    eigenvalues[i] = A[ i * m + i ];
+}
+
+/** Closed-form eigenvalues of a symmetric 2x2 matrix */
+inline void eigenvalues2( const double* A, double* eigenvalues )
+{
+  auto mean = 0.5 * ( A[0] + A[3] );
+  auto diff = 0.5 * ( A[0] - A[3] );
+  auto r    = std::hypot( diff, A[1] );
+
+  eigenvalues[0] = mean + r;
+  eigenvalues[1] = mean - r;
+}
+
+} // namespace detail
+
+/**
+  @class SymmetricEigenvalues
+  @brief Eigenvalues of small, dense, symmetric matrices
+
+  Calculates all eigenvalues of a symmetric matrix without any external
+  dependencies. The solver is meant to be used for many small matrices,
+  such as local covariance matrices, so it re-uses its memory. Matrices
+  of up to eight rows are handled by solvers whose size is fixed at
+  compile time; 2x2 matrices are solved in closed form.
+*/
+
+class SymmetricEigenvalues
+{
+public:
+
+  /**
+    Calculates the eigenvalues of a symmetric matrix, which is stored in
+    row-major order, and stores them in descending order.
+
+    @param A           Matrix with n rows and n columns
+    @param n           Number of rows
+    @param eigenvalues Output array for n eigenvalues
+  */
+
+  void operator()( const double* A, std::size_t n, double* eigenvalues )
+  {
+    _A.assign( A, A + n * n );
+
+    switch( n )
+    {
+    case 0:
+      return;
+    case 1:
+      eigenvalues[0] = A[0];
+      break;
+    case 2:
+      detail::eigenvalues2( A, eigenvalues );
+      break;
+    case 3:
+      detail::jacobiEigenvalues<3>( _A.data(), n, eigenvalues );
+      break;
+    case 4:
+      detail::jacobiEigenvalues<4>( _A.data(), n, eigenvalues );
+      break;
+    case 5:
+      detail::jacobiEigenvalues<5>( _A.data(), n, eigenvalues );
+      break;
+    case 6:
+      detail::jacobiEigenvalues<6>( _A.data(), n, eigenvalues );
+      break;
+    case 7:
+      detail::jacobiEigenvalues<7>( _A.data(), n, eigenvalues );
+      break;
+    case 8:
+      detail::jacobiEigenvalues<8>( _A.data(), n, eigenvalues );
+      break;
+    default:
+      detail::jacobiEigenvalues<0>( _A.data(), n, eigenvalues );
+      break;
+    }
+
+    std::sort( eigenvalues, eigenvalues + n, std::greater<double>() );
+  }
+
+  /** @overload operator()() */
+  std::vector<double> operator()( const std::vector<double>& A, std::size_t n )
+  {
+    std::vector<double> eigenvalues( n );
+    this->operator()( A.data(), n, eigenvalues.data() );
+
+    return eigenvalues;
+  }
+
+private:
+  std::vector<double> _A;
+};
+
+} // namespace math
+
+} // namespace aleph
+
+#endif
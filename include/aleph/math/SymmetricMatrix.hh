@@ -79,7 +79,7 @@ public:
     std::swap( _data   , other._data    );
   }
 
-  SymmetricMatrix& operator==( SymmetricMatrix other )
+  SymmetricMatrix& operator=( SymmetricMatrix other )
   {
     this->swap( other );
     return *this;
@@ -7,19 +7,63 @@
 
 #include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
 
-#include <aleph/persistenceDiagrams/distances/detail/Munkres.hh>
-#include <aleph/persistenceDiagrams/distances/detail/Orthogonal.hh>
+#include <aleph/persistenceDiagrams/distances/detail/Auction.hh>
+#include <aleph/persistenceDiagrams/distances/detail/JonkerVolgenant.hh>
 
 #include <algorithm>
 #include <iterator>
 #include <limits>
 #include <random>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include <cmath>
+
 namespace aleph
 {
 
+/**
+  @struct MeanOptions
+  @brief Options for the calculation of the Fréchet mean
+
+  The calculation stops as soon as the optimal pairings do not change any
+  more, the relative change of the cost drops below the tolerance, or the
+  maximum number of iterations has been reached.
+*/
+
+struct MeanOptions
+{
+  MeanOptions()
+    : seed( std::random_device()() )
+  {
+  }
+
+  /** Maximum number of iterations of a single run */
+  unsigned maxIterations = 100;
+
+  /** Tolerance for the relative change of the cost between iterations */
+  double tolerance = 0.0;
+
+  /**
+    Number of runs with different, randomly chosen, initial diagrams. The
+    result with the smallest cost is kept. Runs are performed in parallel.
+  */
+
+  unsigned restarts = 1;
+
+  /**
+    Relative error of the pairings. If positive, the pairings are only
+    approximated using the auction algorithm, which is faster for large
+    diagrams. Else, optimal pairings are calculated.
+  */
+
+  double relativeError = 0.0;
+
+  /** Seed for choosing the initial diagrams */
+  unsigned seed;
+};
+
 namespace detail
 {
 
@@ -37,6 +81,10 @@ struct Pairing
 
   double cost;
   std::vector<Pair> pairs;
+
+  // Dual variables of the assignment problem; these are only available
+  // for optimal pairings and permit warm starts.
+  std::vector<double> duals;
 };
 
 template <
@@ -50,172 +98,222 @@ template <
   if( D1.dimension() != D2.dimension() )
     throw std::runtime_error( "Dimensions do not coincide" );
 
-  auto size = D1.size() + D2.size();
+  using Point = typename PersistenceDiagram<DataType>::Point;
 
-  distances::detail::Matrix<DataType> costs( size );
+  std::vector<Point> P( D1.begin(), D1.end() );
+  std::vector<Point> Q( D2.begin(), D2.end() );
 
-  using IndexType = decltype( costs.n() );
+  distances::detail::JonkerVolgenant<Point, Distance> solver( P, Q, static_cast<double>( power ) );
 
-  IndexType row = IndexType();
-  IndexType col = IndexType();
-
-  Distance dist;
+  Pairing pairing;
 
-  // Regular block of matrix -------------------------------------------
-  //
-  // This block stores the distances between individual points of the
-  // respective persistence diagrams.
+  // The pairs are returned in the order dictated by the first persistence
+  // diagram.
+  pairing.cost  = solver();
+  pairing.pairs = solver.pairs();
+  pairing.duals = solver.duals();
 
-  for( auto&& p1 : D1 )
-  {
-    col = IndexType();
+  return pairing;
+}
 
-    for( auto&& p2 : D2 )
-    {
-      auto d = std::pow( dist( p1, p2 ), power );
+/**
+  Calculates an optimal pairing between two persistence diagrams, starting
+  from a previous pairing. This is faster if the diagrams are similar to
+  the ones of the previous pairing, e.g. during an iterative algorithm.
+*/
 
-      costs( row, col ) = d;
+template <
+  class DataType,
+  class Distance = aleph::distances::InfinityDistance<DataType>
+> Pairing optimalPairing( const PersistenceDiagram<DataType>& D1,
+                          const PersistenceDiagram<DataType>& D2,
+                          DataType power,
+                          const Pairing& previous )
+{
+  if( D1.dimension() != D2.dimension() )
+    throw std::runtime_error( "Dimensions do not coincide" );
 
-      // This block needs to be completely zero, as it contains the distances
-      // between the individual orthogonal projections of the points.
-      costs( col + D1.size(), row + D2.size() ) = DataType();
+  using Point = typename PersistenceDiagram<DataType>::Point;
 
-      ++col;
-    }
+  std::vector<Point> P( D1.begin(), D1.end() );
+  std::vector<Point> Q( D2.begin(), D2.end() );
 
-    ++row;
-  }
+  distances::detail::JonkerVolgenant<Point, Distance> solver( P, Q, static_cast<double>( power ) );
 
-  // Orthogonal projection of the first diagram ------------------------
+  Pairing pairing;
 
-  row = IndexType();
-  col = D2.size();
+  pairing.cost  = solver( previous.pairs, previous.duals );
+  pairing.pairs = solver.pairs();
+  pairing.duals = solver.duals();
 
-  for( auto&& p1 : D1 )
-  {
-    row = IndexType();
+  return pairing;
+}
 
-    for( auto&& p2 : D1 )
-    {
-      DataType d = DataType();
+/**
+  Approximates an optimal pairing between two persistence diagrams using
+  the auction algorithm. The cost of the pairing is at most a factor of
+  (1 + relativeError)^power larger than the optimal cost. Since unpaired
+  points cannot be handled by the auction, the optimal pairing is used if
+  any of them is present.
+*/
 
-      if( p1 == p2 )
-        d = std::pow( distances::detail::orthogonalDistance<Distance>( p1 ), power );
-      else
-        d = std::numeric_limits<DataType>::max();
+template <
+  class DataType,
+  class Distance = aleph::distances::InfinityDistance<DataType>
+> Pairing approximatePairing( const PersistenceDiagram<DataType>& D1,
+                              const PersistenceDiagram<DataType>& D2,
+                              DataType power,
+                              double relativeError )
+{
+  if( D1.dimension() != D2.dimension() )
+    throw std::runtime_error( "Dimensions do not coincide" );
 
-      costs( row, col ) = d;
+  using Point = typename PersistenceDiagram<DataType>::Point;
 
-      ++row;
-    }
+  auto isUnpaired = [] ( const Point& p )
+  {
+    return p.isUnpaired();
+  };
 
-    ++col;
-  }
+  if( std::any_of( D1.begin(), D1.end(), isUnpaired ) || std::any_of( D2.begin(), D2.end(), isUnpaired ) )
+    return optimalPairing<DataType, Distance>( D1, D2, power );
 
-  // Orthogonal projection of the second diagram -----------------------
+  std::vector<Point> P( D1.begin(), D1.end() );
+  std::vector<Point> Q( D2.begin(), D2.end() );
 
-  row = D1.size();
-  col = IndexType();
+  distances::detail::Auction<Point, Distance> auction( P, Q, static_cast<double>( power ), relativeError );
 
-  for( auto&& p1 : D2 )
-  {
-    col = IndexType();
+  Pairing pairing;
 
-    for( auto&& p2 : D2 )
-    {
-      DataType d = DataType();
+  pairing.cost  = auction();
+  pairing.pairs = auction.pairs();
 
-      if( p1 == p2 )
-        d = std::pow( distances::detail::orthogonalDistance<Distance>( p1 ), power );
-      else
-        d = std::numeric_limits<DataType>::max();
+  return pairing;
+}
 
-      costs( row, col ) = d;
+/**
+  Updates a pairing after points of its first diagram have been removed.
+  The mapping assigns every previous index of a point to its new index,
+  or to an invalid index if the point has been removed. Pairs that refer
+  to removed points are dropped.
+*/
+
+inline Pairing remapPairing( const Pairing& pairing,
+                             const std::vector<std::size_t>& mapping,
+                             std::size_t n,
+                             std::size_t m )
+{
+  auto npos = std::numeric_limits<std::size_t>::max();
+  auto k    = mapping.size();
 
-      ++col;
-    }
+  Pairing result;
+  result.cost = pairing.cost;
 
-    ++row;
-  }
+  auto row = [&] ( std::size_t r )
+  {
+    return r < k ? mapping[r] : n + ( r - k );
+  };
 
-  // Assignment problem solving ----------------------------------------
+  auto column = [&] ( std::size_t c )
+  {
+    return c < m ? c : mapping[c - m] == npos ? npos : m + mapping[c - m];
+  };
 
-  distances::detail::Munkres<DataType> solver( costs );
+  for( auto&& pair : pairing.pairs )
+  {
+    auto r = row( pair.first );
+    auto c = column( pair.second );
 
-  auto M                                           = solver();
-  aleph::math::KahanSummation<DataType> totalCosts = DataType();
+    if( r != npos && c != npos )
+      result.pairs.push_back( std::make_pair( r, c ) );
+  }
 
-  Pairing pairing;
+  std::sort( result.pairs.begin(), result.pairs.end() );
 
-  for( row = IndexType(); row < M.n(); row++ )
+  if( pairing.duals.size() == k + m )
   {
-    for( col = IndexType(); col < M.n(); col++ )
+    result.duals.resize( n + m );
+
+    for( std::size_t c = 0; c < k + m; c++ )
     {
-      if( M( row, col ) == IndexType() )
-      {
-        // This ensures that pairs are returned in the order dictated by
-        // the first persistence diagram.
-        pairing.pairs.push_back( std::make_pair( row, col ) );
-        totalCosts += costs( row, col );
-      }
+      auto d = column( c );
+      if( d != npos )
+        result.duals[d] = pairing.duals[c];
     }
   }
 
-  pairing.cost = totalCosts;
-  return pairing;
+  return result;
 }
 
-} // namespace detail
+/**
+  Performs a single run of the Fréchet mean calculation, starting from a
+  given diagram. Returns the mean along with its cost.
+*/
 
-template <class InputIterator> auto mean( InputIterator begin, InputIterator end ) -> typename std::iterator_traits<InputIterator>::value_type
+template <class PersistenceDiagram> std::pair<PersistenceDiagram, double> mean( const std::vector<PersistenceDiagram>& persistenceDiagrams,
+                                                                                PersistenceDiagram Y,
+                                                                                const MeanOptions& options )
 {
-  using PersistenceDiagram = typename std::iterator_traits<InputIterator>::value_type;
-  using DataType           = typename PersistenceDiagram::DataType;
+  using DataType  = typename PersistenceDiagram::DataType;
+  using IndexType = std::size_t;
 
-  std::vector<PersistenceDiagram> persistenceDiagrams( begin, end );
-  PersistenceDiagram Y;
+  auto npos  = std::numeric_limits<IndexType>::max();
+  auto power = DataType( 2 );
+  auto n     = persistenceDiagrams.size();
 
+  // Calculates all pairings for the current diagram, using the previous
+  // pairings as a warm start if available. Costs are stored along with
+  // the pairings and summed afterwards, so no synchronization is needed.
+  auto match = [&] ( const PersistenceDiagram& X, const std::vector<Pairing>& previous )
   {
-    std::random_device rd;
-    std::default_random_engine rng( rd() );
-    std::uniform_int_distribution<decltype( persistenceDiagrams.size() )> distribution( 0, persistenceDiagrams.size() - 1 );
+    std::vector<Pairing> pairings( n );
 
-    Y = persistenceDiagrams.at( distribution( rng ) );
-    Y.removeDiagonal();
-  }
-
-  aleph::math::KahanSummation<double> cost = 0.0;
+    #pragma omp parallel for schedule(dynamic)
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      if( options.relativeError > 0.0 )
+        pairings[i] = approximatePairing( X, persistenceDiagrams[i], power, options.relativeError );
+      else if( !previous.empty() )
+        pairings[i] = optimalPairing( X, persistenceDiagrams[i], power, previous[i] );
+      else
+        pairings[i] = optimalPairing( X, persistenceDiagrams[i], power );
+    }
 
-  std::vector<detail::Pairing> pairings;
-  pairings.resize( decltype(pairings)::size_type( std::distance( begin, end ) ) );
+    return pairings;
+  };
 
-  #pragma omp parallel for
-  for( auto it = begin; it < end; ++it )
+  auto totalCost = [] ( const std::vector<Pairing>& pairings )
   {
-    auto i      = decltype(pairings)::size_type( std::distance( begin, it ) );
-    pairings[i] = detail::optimalPairing( Y, *it );
+    aleph::math::KahanSummation<double> cost = 0.0;
 
-    #pragma omp critical
-    {
-      cost += pairings.back().cost;
-    }
-  }
+    for( auto&& pairing : pairings )
+      cost += pairing.cost;
+
+    return double( cost );
+  };
 
-  bool stop = false;
-  while( !stop )
+  auto pairings = match( Y, {} );
+  auto cost     = totalCost( pairings );
+
+  for( unsigned iteration = 0; iteration < options.maxIterations; iteration++ )
   {
     PersistenceDiagram Z;
+    Z.setDimension( Y.dimension() );
 
     auto k = Y.size();
-    for( decltype(k) i = 0; i < k; i++ )
+
+    // Maps the indices of points in Y to the indices of the points in Z;
+    // points on the diagonal are removed.
+    std::vector<IndexType> mapping( k, npos );
+
+    for( IndexType i = 0; i < k; i++ )
     {
       aleph::math::KahanSummation<DataType> x0 = DataType(); // off-diagonal
       aleph::math::KahanSummation<DataType> y0 = DataType(); // off-diagonal
       aleph::math::KahanSummation<DataType> x1 = DataType();
       aleph::math::KahanSummation<DataType> y1 = DataType();
 
-      using DifferenceType = typename std::iterator_traits<InputIterator>::difference_type;
-      DifferenceType index = 0;
+      using DifferenceType = typename PersistenceDiagram::ConstIterator::difference_type;
 
       {
         auto point = *std::next( Y.begin(), DifferenceType( i ) );
@@ -230,9 +328,10 @@ template <class InputIterator> auto mean( InputIterator begin, InputIterator end
       // to ensure that the arithmetical mean is weighted correctly.
       unsigned numOffDiagonalPoints = 0;
 
-      for( auto&& pairing : pairings )
+      for( IndexType j = 0; j < n; j++ )
       {
-        auto&& diagram = *( std::next( begin, index ) );
+        auto&& diagram = persistenceDiagrams[j];
+        auto&& pairing = pairings[j];
 
         // Off-diagonal assignment
         if( pairing.pairs.at(i).second < diagram.size() )
@@ -244,50 +343,105 @@ template <class InputIterator> auto mean( InputIterator begin, InputIterator end
 
           numOffDiagonalPoints++;
         }
-
-        ++index;
       }
 
-      auto x = ( x0 + ( DataType( persistenceDiagrams.size() - numOffDiagonalPoints ) ) * x1 ) / DataType( pairings.size() );
-      auto y = ( y0 + ( DataType( persistenceDiagrams.size() - numOffDiagonalPoints ) ) * y1 ) / DataType( pairings.size() );
+      auto x = ( x0 + ( DataType( n - numOffDiagonalPoints ) ) * x1 ) / DataType( n );
+      auto y = ( y0 + ( DataType( n - numOffDiagonalPoints ) ) * y1 ) / DataType( n );
 
-      Z.add( x,y );
+      if( x != y )
+      {
+        mapping[i] = Z.size();
+        Z.add( x,y );
+      }
     }
 
+    std::vector<Pairing> previous;
+    previous.reserve( n );
+
+    for( IndexType j = 0; j < n; j++ )
+      previous.push_back( remapPairing( pairings[j], mapping, Z.size(), persistenceDiagrams[j].size() ) );
+
+    auto newPairings = match( Z, previous );
+    auto newCost     = totalCost( newPairings );
+
     Y = Z;
-    Y.removeDiagonal();
 
-    {
-      std::vector<detail::Pairing> newPairings;
-      newPairings.resize( decltype(newPairings)::size_type( std::distance( begin, end ) ) );
+    // The diagram is a fixed point if none of the pairings changed.
+    bool unchanged = true;
 
-      aleph::math::KahanSummation<double> newCost = 0.0;
+    for( IndexType j = 0; j < n && unchanged; j++ )
+      unchanged = previous[j].pairs == newPairings[j].pairs;
 
-      #pragma omp parallel for
-      for( auto it = begin; it < end; ++it )
-      {
-        auto i         = decltype(newPairings)::size_type( std::distance( begin, it ) );
-        newPairings[i] = detail::optimalPairing( Y, *it );
+    bool converged = unchanged || std::abs( cost - newCost ) <= options.tolerance * cost;
 
-        #pragma omp critical
-        {
-          newCost += newPairings.back().cost;
-        }
-      }
+    pairings.swap( newPairings );
+    cost = newCost;
 
-      if( newPairings == pairings )
-        stop = true;
-      else
-      {
-        pairings.swap( newPairings );
-        cost = newCost;
-      }
-    }
+    if( converged )
+      break;
   }
 
-  return Y;
+  return std::make_pair( Y, cost );
 }
 
+} // namespace detail
+
+/**
+  Calculates the Fréchet mean of a range of persistence diagrams with
+  respect to the 2-Wasserstein distance, following the algorithm in
+
+    Fréchet Means for Distributions of Persistence Diagrams
+    Katharine Turner, Yuriy Mileyko, Sayan Mukherjee, and John Harer
+    Discrete & Computational Geometry 52, pp. 44--70, 2014
+
+  Starting from a randomly chosen diagram, every point is moved to the mean
+  of the points it is paired with. Pairings are warm-started from the ones
+  of the previous iteration. The algorithm only converges to a local
+  minimum, so several restarts may be used.
+
+  @param begin   Iterator to the first persistence diagram
+  @param end     Iterator after the last persistence diagram
+  @param options Options for convergence, restarts, and approximations
+
+  @returns Mean persistence diagram
+*/
+
+template <class InputIterator> auto mean( InputIterator begin, InputIterator end,
+                                          const MeanOptions& options = MeanOptions() ) -> typename std::iterator_traits<InputIterator>::value_type
+{
+  using PersistenceDiagram = typename std::iterator_traits<InputIterator>::value_type;
+
+  std::vector<PersistenceDiagram> persistenceDiagrams( begin, end );
+
+  if( persistenceDiagrams.empty() )
+    return PersistenceDiagram();
+
+  auto restarts = std::max( options.restarts, 1u );
+
+  std::vector< std::pair<PersistenceDiagram, double> > results( restarts );
+
+  // If only a single run is performed, the pairings of every iteration are
+  // calculated in parallel instead.
+  #pragma omp parallel for schedule(dynamic) if( restarts > 1 )
+  for( unsigned run = 0; run < restarts; run++ )
+  {
+    std::default_random_engine rng( options.seed + run );
+    std::uniform_int_distribution<decltype( persistenceDiagrams.size() )> distribution( 0, persistenceDiagrams.size() - 1 );
+
+    auto Y = persistenceDiagrams.at( distribution( rng ) );
+    Y.removeDiagonal();
+
+    results[run] = detail::mean( persistenceDiagrams, Y, options );
+  }
+
+  auto best = std::min_element( results.begin(), results.end(),
+                                [] ( const std::pair<PersistenceDiagram, double>& a, const std::pair<PersistenceDiagram, double>& b )
+                                {
+                                  return a.second < b.second;
+                                } );
+
+  return best->first;
+}
 
 } // namespace aleph
 
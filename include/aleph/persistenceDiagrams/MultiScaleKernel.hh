@@ -6,9 +6,15 @@
 #include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
 #include <utility>
+#include <vector>
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 namespace aleph
 {
@@ -97,6 +103,368 @@ template <class T> double multiScalePseudoMetric( const PersistenceDiagram<T>& D
   return std::sqrt( kxx + kyy - 2*kxy );
 }
 
+namespace detail
+{
+
+/**
+  Evaluates the exponential function for an array of non-positive values
+  and replaces the values by the result. The implementation uses a range
+  reduction to the interval [-ln(2)/2, ln(2)/2], followed by a polynomial
+  approximation, and does not contain any branches, so that the compiler
+  is able to vectorize the loop. The relative error is in the order of the
+  machine precision.
+*/
+
+inline void exponentials( double* values, std::size_t n )
+{
+  const double log2e = 1.4426950408889634;
+  const double ln2hi = 6.93145751953125e-1;
+  const double ln2lo = 1.42860682030941723212e-6;
+
+  #pragma omp simd
+  for( std::size_t i = 0; i < n; i++ )
+  {
+    // Values below this threshold would result in denormalized numbers;
+    // their contribution is negligible anyway.
+    auto x = std::max( values[i], -700.0 );
+    auto k = std::floor( x * log2e + 0.5 );
+    auto r = ( x - k * ln2hi ) - k * ln2lo;
+
+    auto p = 1.0 / 6227020800.0;
+    p      = p * r + 1.0 / 479001600.0;
+    p      = p * r + 1.0 / 39916800.0;
+    p      = p * r + 1.0 / 3628800.0;
+    p      = p * r + 1.0 / 362880.0;
+    p      = p * r + 1.0 / 40320.0;
+    p      = p * r + 1.0 / 5040.0;
+    p      = p * r + 1.0 / 720.0;
+    p      = p * r + 1.0 / 120.0;
+    p      = p * r + 1.0 / 24.0;
+    p      = p * r + 1.0 / 6.0;
+    p      = p * r + 0.5;
+    p      = p * r + 1.0;
+    p      = p * r + 1.0;
+
+    // Multiply by 2^k by constructing the exponent of the floating point
+    // number directly.
+    auto bits = static_cast<std::uint64_t>( static_cast<std::int64_t>( k ) + 1023 ) << 52;
+    double scale;
+    std::memcpy( &scale, &bits, sizeof( double ) );
+
+    values[i] = p * scale;
+  }
+}
+
+/**
+  @class MultiScaleKernelGrid
+  @brief Spatial grid for the truncated evaluation of the multi-scale kernel
+
+  Stores the points of a persistence diagram in a uniform grid whose cell
+  size is the truncation radius of the kernel. Points of another diagram
+  whose distance to a query point is smaller than the truncation radius
+  are thus always contained in one of the nine cells around the query.
+
+  Unpaired points are ignored because their contribution is undefined.
+*/
+
+class MultiScaleKernelGrid
+{
+public:
+  using Cell = std::pair<std::int64_t, std::int64_t>;
+
+  MultiScaleKernelGrid() = default;
+
+  template <class T> MultiScaleKernelGrid( const PersistenceDiagram<T>& D, double radius )
+    : _radius( radius )
+  {
+    std::vector< std::pair<Cell, std::pair<double, double> > > points;
+    points.reserve( D.size() );
+
+    for( auto&& p : D )
+    {
+      if( p.isUnpaired() )
+        continue;
+
+      auto x = static_cast<double>( p.x() );
+      auto y = static_cast<double>( p.y() );
+
+      points.push_back( std::make_pair( this->cell( x, y ), std::make_pair( x, y ) ) );
+    }
+
+    std::sort( points.begin(), points.end() );
+
+    _x.reserve( points.size() );
+    _y.reserve( points.size() );
+
+    for( std::size_t i = 0; i < points.size(); i++ )
+    {
+      if( i == 0 || points[i].first != points[i-1].first )
+      {
+        _cells.push_back( points[i].first );
+        _offsets.push_back( i );
+      }
+
+      _x.push_back( points[i].second.first );
+      _y.push_back( points[i].second.second );
+    }
+
+    _offsets.push_back( points.size() );
+  }
+
+  /** @returns Number of points in the grid */
+  std::size_t size() const noexcept
+  {
+    return _x.size();
+  }
+
+  /** @returns x-coordinates of all points, sorted by their cells */
+  const std::vector<double>& x() const noexcept
+  {
+    return _x;
+  }
+
+  /** @returns y-coordinates of all points, sorted by their cells */
+  const std::vector<double>& y() const noexcept
+  {
+    return _y;
+  }
+
+  /**
+    Enumerates all ranges of points that are stored in the cells around
+    a query point. The functor is called with the first and the last
+    index of every range.
+  */
+
+  template <class Functor> void neighbours( double x, double y, Functor functor ) const
+  {
+    // Without truncation, all points are neighbours.
+    if( !std::isfinite( _radius ) )
+    {
+      functor( std::size_t( 0 ), this->size() );
+      return;
+    }
+
+    auto c = this->cell( x, y );
+
+    for( std::int64_t dx = -1; dx <= 1; dx++ )
+    {
+      Cell first = std::make_pair( c.first + dx, c.second - 1 );
+      Cell last  = std::make_pair( c.first + dx, c.second + 1 );
+
+      auto it = std::lower_bound( _cells.begin(), _cells.end(), first );
+
+      for( ; it != _cells.end() && *it <= last; ++it )
+      {
+        auto index = static_cast<std::size_t>( std::distance( _cells.begin(), it ) );
+        functor( _offsets[index], _offsets[index+1] );
+      }
+    }
+  }
+
+private:
+  Cell cell( double x, double y ) const
+  {
+    if( !std::isfinite( _radius ) )
+      return std::make_pair( std::int64_t( 0 ), std::int64_t( 0 ) );
+
+    return std::make_pair( static_cast<std::int64_t>( std::floor( x / _radius ) ),
+                           static_cast<std::int64_t>( std::floor( y / _radius ) ) );
+  }
+
+  double _radius = std::numeric_limits<double>::infinity();
+
+  std::vector<Cell> _cells;
+  std::vector<std::size_t> _offsets;
+
+  std::vector<double> _x;
+  std::vector<double> _y;
+};
+
+/**
+  Calculates the sum of the multi-scale kernel contributions of all pairs
+  of points of two grids, skipping all pairs whose distance exceeds the
+  truncation radius. The squared distances are collected in a buffer, so
+  that the exponential function can be evaluated in batches.
+*/
+
+inline double multiScaleKernelSum( const MultiScaleKernelGrid& F,
+                                   const MultiScaleKernelGrid& G,
+                                   double radius,
+                                   double scale )
+{
+  const std::size_t batchSize = 256;
+
+  // Positive and negative contributions share one buffer; the latter are
+  // stored from the end.
+  std::vector<double> buffer( 2 * batchSize );
+
+  std::size_t numPositive = 0;
+  std::size_t numNegative = 0;
+
+  auto squaredRadius = radius * radius;
+
+  aleph::math::KahanSummation<double> sum = 0.0;
+
+  auto flush = [&] ()
+  {
+    detail::exponentials( buffer.data(), numPositive );
+    detail::exponentials( buffer.data() + batchSize, numNegative );
+
+    double s = 0.0;
+
+    for( std::size_t i = 0; i < numPositive; i++ )
+      s += buffer[i];
+
+    for( std::size_t i = 0; i < numNegative; i++ )
+      s -= buffer[batchSize + i];
+
+    sum += s;
+
+    numPositive = 0;
+    numNegative = 0;
+  };
+
+  auto&& gx = G.x();
+  auto&& gy = G.y();
+
+  for( std::size_t i = 0; i < F.size(); i++ )
+  {
+    auto x = F.x()[i];
+    auto y = F.y()[i];
+
+    // Regular contributions
+    G.neighbours( x, y, [&] ( std::size_t first, std::size_t last )
+    {
+      for( std::size_t j = first; j < last; j++ )
+      {
+        auto dx = x - gx[j];
+        auto dy = y - gy[j];
+        auto d  = dx*dx + dy*dy;
+
+        if( d <= squaredRadius )
+        {
+          buffer[numPositive++] = -d / scale;
+          if( numPositive == batchSize )
+            flush();
+        }
+      }
+    } );
+
+    // Contributions of the mirrored points. The distance between a point
+    // and a mirrored point is equal to the distance between the mirrored
+    // point and the point, so the mirrored query can use the same grid.
+    G.neighbours( y, x, [&] ( std::size_t first, std::size_t last )
+    {
+      for( std::size_t j = first; j < last; j++ )
+      {
+        auto dx = y - gx[j];
+        auto dy = x - gy[j];
+        auto d  = dx*dx + dy*dy;
+
+        if( d <= squaredRadius )
+        {
+          buffer[batchSize + numNegative++] = -d / scale;
+          if( numNegative == batchSize )
+            flush();
+        }
+      }
+    } );
+  }
+
+  flush();
+  return sum;
+}
+
+} // namespace detail
+
+/**
+  Calculates the Gram matrix of the multi-scale kernel for a range of
+  persistence diagrams.
+
+  Contributions of pairs of points are skipped if they are smaller than
+  the given tolerance. This is done by storing every diagram in a grid,
+  such that only the points in neighbouring cells have to be considered.
+  Hence, every entry of the Gram matrix differs from the exact value by at
+  most the product of the number of point pairs, the tolerance, and the
+  normalization factor of the kernel. A tolerance of zero disables the
+  truncation.
+
+  All pairs of diagrams are processed in parallel. Unpaired points are
+  ignored.
+
+  @param begin     Iterator to the first persistence diagram
+  @param end       Iterator after the last persistence diagram
+  @param sigma     Scale parameter of the kernel
+  @param tolerance Tolerance for a single contribution
+*/
+
+template <class InputIterator> std::vector< std::vector<double> > multiScaleKernelGramMatrix( InputIterator begin,
+                                                                                             InputIterator end,
+                                                                                             double sigma,
+                                                                                             double tolerance = 1e-12 )
+{
+  auto scale  = 8.0 * M_PI;
+  auto radius = tolerance > 0.0 && tolerance < 1.0 ? std::sqrt( -scale * std::log( tolerance ) )
+                                                   : std::numeric_limits<double>::infinity();
+
+  std::vector<typename std::iterator_traits<InputIterator>::value_type> diagrams( begin, end );
+  std::vector<detail::MultiScaleKernelGrid> grids( diagrams.size() );
+
+  #pragma omp parallel for schedule(dynamic)
+  for( std::size_t i = 0; i < diagrams.size(); i++ )
+    grids[i] = detail::MultiScaleKernelGrid( diagrams[i], radius );
+
+  auto n = grids.size();
+  std::vector< std::vector<double> > K( n, std::vector<double>( n ) );
+
+  #pragma omp parallel for schedule(dynamic)
+  for( std::size_t row = 0; row < n; row++ )
+  {
+    for( std::size_t col = row; col < n; col++ )
+    {
+      auto k = 1.0 / ( scale * sigma ) * detail::multiScaleKernelSum( grids[row], grids[col], radius, scale );
+
+      K[row][col] = k;
+      K[col][row] = k;
+    }
+  }
+
+  return K;
+}
+
+/**
+  Calculates the matrix of all pairwise multi-scale pseudo-metric values
+  for a range of persistence diagrams. The self-similarities of all
+  diagrams are calculated only once.
+
+  @see multiScaleKernelGramMatrix()
+*/
+
+template <class InputIterator> std::vector< std::vector<double> > multiScalePseudoMetricMatrix( InputIterator begin,
+                                                                                               InputIterator end,
+                                                                                               double sigma,
+                                                                                               double tolerance = 1e-12 )
+{
+  auto K = multiScaleKernelGramMatrix( begin, end, sigma, tolerance );
+  auto n = K.size();
+
+  std::vector< std::vector<double> > D( n, std::vector<double>( n ) );
+
+  for( std::size_t row = 0; row < n; row++ )
+  {
+    for( std::size_t col = row + 1; col < n; col++ )
+    {
+      // Prevent negative values caused by rounding errors
+      auto d = std::sqrt( std::max( K[row][row] + K[col][col] - 2 * K[row][col], 0.0 ) );
+
+      D[row][col] = d;
+      D[col][row] = d;
+    }
+  }
+
+  return D;
+}
+
 }
 
 #endif
@@ -0,0 +1,549 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_PAIRWISE_DISTANCES_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_PAIRWISE_DISTANCES_HH__
+
+#include <aleph/geometry/distances/Infinity.hh>
+
+#include <aleph/math/SymmetricMatrix.hh>
+
+#include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+#include <aleph/persistenceDiagrams/SlicedWasserstein.hh>
+
+#include <aleph/persistenceDiagrams/distances/Wasserstein.hh>
+
+#include <aleph/persistenceDiagrams/distances/detail/KDTree.hh>
+
+#include <aleph/utilities/String.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace aleph
+{
+
+/**
+  @struct PairwiseDistancesOptions
+  @brief Options for the calculation of pairwise distances
+
+  If a checkpoint file is given, every calculated distance is appended to
+  it. An existing checkpoint file is read before starting the calculation
+  and all distances that it contains are skipped. This permits resuming a
+  long calculation that has been interrupted.
+
+  The identifier of the calculation is stored in the checkpoint file. It
+  should describe the metric, its parameters, and the inputs, so that it
+  is impossible to resume from a checkpoint of a different calculation;
+  see `checkpointIdentifier()`.
+*/
+
+struct PairwiseDistancesOptions
+{
+  /** Filename of the checkpoint file; if empty, no checkpoints are written */
+  std::string checkpoint;
+
+  /** Number of distances after which the checkpoint file is flushed */
+  std::size_t checkpointInterval = 64;
+
+  /** Identifier of the calculation; must not contain any newlines */
+  std::string identifier;
+};
+
+/**
+  Creates an identifier of a pairwise distance calculation for checkpoint
+  files. The identifier contains the name of the metric, the power, and a
+  hash of all inputs, e.g. their filenames, in the given order.
+
+  @param metric Name of the metric, including further parameters
+  @param power  Power of the metric
+  @param inputs Description of all inputs, e.g. a list of filenames
+*/
+
+inline std::string checkpointIdentifier( const std::string& metric,
+                                         double power,
+                                         const std::vector<std::string>& inputs )
+{
+  // FNV-1a hash of all inputs; every input is terminated by a zero byte
+  // to distinguish, say, "ab", "c" from "a", "bc".
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+
+  for( auto&& input : inputs )
+  {
+    for( auto&& c : input )
+      hash = ( hash ^ static_cast<unsigned char>( c ) ) * 0x100000001b3ull;
+
+    hash = hash * 0x100000001b3ull;
+  }
+
+  std::ostringstream stream;
+  stream << std::setprecision( std::numeric_limits<double>::max_digits10 )
+         << metric << " p=" << power
+         << " inputs=" << inputs.size() << ":" << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash;
+
+  return stream.str();
+}
+
+namespace detail
+{
+
+// Removes leading and trailing whitespace of an identifier
+inline std::string trimIdentifier( const std::string& identifier )
+{
+  auto first = identifier.find_first_not_of( " \t\r" );
+  auto last  = identifier.find_last_not_of( " \t\r" );
+
+  if( first == std::string::npos )
+    return std::string();
+
+  return identifier.substr( first, last - first + 1 );
+}
+
+// Reads a checkpoint file and stores all distances in the matrix. Every
+// pair that has been read is marked as finished. A line is only complete
+// if it is terminated by a newline; an incomplete last line, which occurs
+// if the calculation has been interrupted, is ignored. Distances may be
+// infinite, e.g. for diagrams with different numbers of unpaired points.
+inline void readCheckpoint( const std::string& filename,
+                            std::size_t n,
+                            const std::string& identifier,
+                            aleph::math::SymmetricMatrix<double>& distances,
+                            aleph::math::SymmetricMatrix<bool>& finished )
+{
+  std::ifstream in( filename );
+  if( !in )
+    return;
+
+  std::string line;
+
+  if( !std::getline( in, line ) )
+    return;
+
+  {
+    std::istringstream converter( line );
+    std::string header;
+    std::size_t size = 0;
+
+    if( !( converter >> header >> size ) || header != "pairwise_distances" )
+      throw std::runtime_error( "Unable to parse checkpoint file" );
+
+    if( size != n )
+      throw std::runtime_error( "Checkpoint file refers to a different number of items" );
+
+    std::string rest;
+    std::getline( converter, rest );
+
+    if( trimIdentifier( rest ) != trimIdentifier( identifier ) )
+      throw std::runtime_error( "Checkpoint file refers to a different calculation" );
+  }
+
+  aleph::utilities::Tokenizer tokenizer;
+
+  while( std::getline( in, line ) )
+  {
+    if( in.eof() )
+      break;
+
+    auto&& tokens = tokenizer( line );
+
+    if( tokens.empty() )
+      continue;
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+    double d      = 0.0;
+
+    if(    tokens.size() != 3
+        || !aleph::utilities::parse( tokens[0], i )
+        || !aleph::utilities::parse( tokens[1], j )
+        || !aleph::utilities::parse( tokens[2], d )
+        || i >= n || j >= n )
+      throw std::runtime_error( "Unable to parse distance in checkpoint file" );
+
+    distances( i, j ) = d;
+    finished( i, j )  = true;
+  }
+}
+
+} // namespace detail
+
+/**
+  Calculates all pairwise distances between a set of items, e.g. a set of
+  persistence diagrams, and returns them as a symmetric matrix. Only one
+  half of the matrix is evaluated.
+
+  The calculation is controlled by a metric, which has to provide:
+
+  - a type `Cache` for storing the results of preprocessing an item
+  - a function `Cache prepare( const Item& ) const` for preprocessing an
+    item, e.g. by sorting its points or by building a search structure
+  - a function `double cost( const Cache&, const Cache& ) const` that
+    estimates the cost of calculating the distance between two items
+  - a function `double operator()( const Cache&, const Cache& ) const` for
+    calculating the distance between two items
+
+  Every item is preprocessed exactly once. Afterwards, all pairs of items
+  are sorted in descending order of their estimated cost and distributed
+  dynamically among all threads. Starting with the most expensive pairs
+  keeps threads from idling at the end of the calculation.
+
+  @param items   Items whose distances are calculated
+  @param metric  Metric for preprocessing items and calculating distances
+  @param options Options, e.g. for writing checkpoints
+
+  @returns Symmetric matrix of pairwise distances
+*/
+
+template <class Item, class Metric> aleph::math::SymmetricMatrix<double> pairwiseDistances( const std::vector<Item>& items,
+                                                                                           const Metric& metric,
+                                                                                           const PairwiseDistancesOptions& options = PairwiseDistancesOptions() )
+{
+  using Cache = typename Metric::Cache;
+
+  auto n = items.size();
+
+  aleph::math::SymmetricMatrix<double> distances( n );
+  aleph::math::SymmetricMatrix<bool>   finished( n );
+
+  if( !options.checkpoint.empty() )
+    detail::readCheckpoint( options.checkpoint, n, options.identifier, distances, finished );
+
+  // Preprocessing -----------------------------------------------------
+
+  std::vector<Cache> caches( n );
+
+  #pragma omp parallel for schedule(dynamic)
+  for( std::size_t i = 0; i < n; i++ )
+    caches[i] = metric.prepare( items[i] );
+
+  // Scheduling --------------------------------------------------------
+
+  using Pair = std::pair<std::size_t, std::size_t>;
+
+  std::vector< std::pair<double, Pair> > pairs;
+  pairs.reserve( n * ( n - ( n > 0 ? 1 : 0 ) ) / 2 );
+
+  for( std::size_t i = 0; i < n; i++ )
+  {
+    for( std::size_t j = i + 1; j < n; j++ )
+    {
+      if( !finished( i, j ) )
+        pairs.push_back( std::make_pair( metric.cost( caches[i], caches[j] ), std::make_pair( i, j ) ) );
+    }
+  }
+
+  std::stable_sort( pairs.begin(), pairs.end(),
+                    [] ( const std::pair<double, Pair>& a, const std::pair<double, Pair>& b )
+                    {
+                      return a.first > b.first;
+                    } );
+
+  // Calculation -------------------------------------------------------
+
+  // The checkpoint file is rewritten with all distances that are known
+  // so far. This removes incomplete lines of an interrupted calculation,
+  // so that new distances can be appended safely.
+
+  std::ofstream out;
+
+  if( !options.checkpoint.empty() )
+  {
+    out.open( options.checkpoint, std::ios::trunc );
+    if( !out )
+      throw std::runtime_error( "Unable to open checkpoint file" );
+
+    out.precision( std::numeric_limits<double>::max_digits10 );
+    out << "pairwise_distances " << n;
+
+    if( !options.identifier.empty() )
+      out << " " << detail::trimIdentifier( options.identifier );
+
+    out << "\n";
+
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      for( std::size_t j = i + 1; j < n; j++ )
+      {
+        if( finished( i, j ) )
+          out << i << " " << j << " " << distances( i, j ) << "\n";
+      }
+    }
+
+    out << std::flush;
+  }
+
+  std::size_t written = 0;
+
+  #pragma omp parallel for schedule(dynamic, 1)
+  for( std::size_t k = 0; k < pairs.size(); k++ )
+  {
+    auto i = pairs[k].second.first;
+    auto j = pairs[k].second.second;
+    auto d = metric( caches[i], caches[j] );
+
+    // Every pair is written by exactly one thread, and all pairs refer
+    // to different entries of the matrix.
+    distances( i, j ) = d;
+
+    if( out.is_open() )
+    {
+      #pragma omp critical
+      {
+        out << i << " " << j << " " << d << "\n";
+
+        if( ++written % std::max( options.checkpointInterval, std::size_t( 1 ) ) == 0 )
+          out << std::flush;
+      }
+    }
+  }
+
+  if( out.is_open() )
+    out << std::flush;
+
+  return distances;
+}
+
+namespace distances
+{
+
+/**
+  @class HausdorffMetric
+  @brief Hausdorff distance metric for pairwise calculations
+
+  Preprocesses a persistence diagram by storing its points in a kd-tree,
+  so that nearest neighbours may be found quickly. Unpaired points are
+  stored separately, sorted by their creation value, because they have
+  a finite distance only to each other. The results are consistent with
+  `hausdorffDistance()` for the infinity distance.
+*/
+
+template <class T> class HausdorffMetric
+{
+public:
+  struct Cache
+  {
+    std::vector<T> x;
+    std::vector<T> y;
+    std::vector<T> unpaired;
+
+    detail::KDTree<T> tree;
+  };
+
+  Cache prepare( const PersistenceDiagram<T>& D ) const
+  {
+    Cache cache;
+
+    for( auto&& p : D )
+    {
+      if( p.isUnpaired() )
+        cache.unpaired.push_back( p.x() );
+      else
+      {
+        cache.x.push_back( p.x() );
+        cache.y.push_back( p.y() );
+      }
+    }
+
+    std::sort( cache.unpaired.begin(), cache.unpaired.end() );
+
+    cache.tree = detail::KDTree<T>( cache.x, cache.y );
+    return cache;
+  }
+
+  double cost( const Cache& C1, const Cache& C2 ) const
+  {
+    auto n = static_cast<double>( C1.x.size() + C1.unpaired.size() );
+    auto m = static_cast<double>( C2.x.size() + C2.unpaired.size() );
+
+    return ( n + m ) * std::log2( 2 + n + m );
+  }
+
+  double operator()( const Cache& C1, const Cache& C2 ) const
+  {
+    auto n = C1.x.size() + C1.unpaired.size();
+    auto m = C2.x.size() + C2.unpaired.size();
+
+    if( n == 0 && m == 0 )
+      return 0.0;
+    else if( n == 0 || m == 0 )
+      return static_cast<double>( std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max() );
+
+    return static_cast<double>( std::max( this->supremum( C1, C2 ), this->supremum( C2, C1 ) ) );
+  }
+
+private:
+
+  // Calculates the maximum distance of a point of the first diagram to its
+  // nearest neighbour in the second diagram.
+  T supremum( const Cache& C1, const Cache& C2 ) const
+  {
+    T result = std::numeric_limits<T>::lowest();
+
+    auto difference = [] ( T a, T b )
+    {
+      return a >= b ? a - b : b - a;
+    };
+
+    for( std::size_t i = 0; i < C1.x.size(); i++ )
+    {
+      auto x = C1.x[i];
+      auto y = C1.y[i];
+
+      // A paired point has an infinite distance to all unpaired points, so
+      // the infimum is attained in the tree, provided it is not empty.
+      T infimum = std::numeric_limits<T>::max();
+
+      if( !C2.tree.empty() )
+      {
+        auto cost = [&] ( std::size_t j )
+        {
+          return std::max( difference( x, C2.x[j] ), difference( y, C2.y[j] ) );
+        };
+
+        auto bound = [&] ( T xMin, T xMax, T yMin, T yMax )
+        {
+          auto dx = x < xMin ? xMin - x : x > xMax ? x - xMax : T();
+          auto dy = y < yMin ? yMin - y : y > yMax ? y - yMax : T();
+
+          return std::max( dx, dy );
+        };
+
+        auto best     = detail::KDTree<T>::npos;
+        auto second   = detail::KDTree<T>::npos;
+        T bestValue   = T();
+        T secondValue = T();
+
+        C2.tree.bestTwo( cost, bound, best, bestValue, second, secondValue );
+
+        if( best != detail::KDTree<T>::npos )
+          infimum = std::min( infimum, bestValue );
+      }
+
+      result = std::max( result, infimum );
+    }
+
+    for( auto&& x : C1.unpaired )
+    {
+      T infimum = std::numeric_limits<T>::max();
+
+      if( !C2.unpaired.empty() )
+      {
+        auto it = std::lower_bound( C2.unpaired.begin(), C2.unpaired.end(), x );
+
+        if( it != C2.unpaired.end() )
+          infimum = std::min( infimum, difference( x, *it ) );
+
+        if( it != C2.unpaired.begin() )
+          infimum = std::min( infimum, difference( x, *std::prev( it ) ) );
+      }
+
+      result = std::max( result, infimum );
+    }
+
+    return result;
+  }
+};
+
+/**
+  @class WassersteinMetric
+  @brief Wasserstein distance metric for pairwise calculations
+
+  Calculates the Wasserstein distance for a given power. A positive relative
+  error selects the approximate calculation of `wassersteinDistance()`.
+
+  Preprocesses a persistence diagram by separating its paired and unpaired
+  points, sorting the unpaired points, and calculating the distances of all
+  paired points to the diagonal. Both solvers use this data directly.
+*/
+
+template <class T> class WassersteinMetric
+{
+public:
+  using Cache = detail::WassersteinDiagram<T>;
+
+  WassersteinMetric( T power = T( 1 ), T relativeError = T() )
+    : _power( power )
+    , _relativeError( relativeError )
+  {
+  }
+
+  Cache prepare( const PersistenceDiagram<T>& D ) const
+  {
+    return Cache( D, _power );
+  }
+
+  double cost( const Cache& D1, const Cache& D2 ) const
+  {
+    auto n = static_cast<double>( D1.size() + D2.size() );
+
+    // The exact solver requires cubic time in the worst case, whereas the
+    // auction algorithm is closer to quadratic time.
+    if( _relativeError > T() )
+      return n * n;
+    else
+      return n * n * n;
+  }
+
+  double operator()( const Cache& D1, const Cache& D2 ) const
+  {
+    return static_cast<double>( detail::wassersteinDistance( D1, D2, _power, _relativeError ) );
+  }
+
+private:
+  T _power;
+  T _relativeError;
+};
+
+/**
+  @class SlicedWassersteinMetric
+  @brief Sliced Wasserstein distance metric for pairwise calculations
+
+  Preprocesses a persistence diagram by calculating its sketch, i.e. its
+  sorted projections for a fixed set of directions.
+*/
+
+class SlicedWassersteinMetric
+{
+public:
+
+  // The sketch cannot be default-constructed, so it is stored in a vector
+  // that is either empty or contains exactly one element.
+  using Cache = std::vector<SlicedWassersteinSketch>;
+
+  SlicedWassersteinMetric( unsigned directions = 50 )
+    : _directions( directions )
+  {
+  }
+
+  template <class T> Cache prepare( const PersistenceDiagram<T>& D ) const
+  {
+    return Cache( 1, SlicedWassersteinSketch( D, _directions ) );
+  }
+
+  double cost( const Cache& S1, const Cache& S2 ) const
+  {
+    return static_cast<double>( _directions ) * static_cast<double>( S1.front().size() + S2.front().size() );
+  }
+
+  double operator()( const Cache& S1, const Cache& S2 ) const
+  {
+    return slicedWassersteinDistance( S1.front(), S2.front() );
+  }
+
+private:
+  unsigned _directions;
+};
+
+} // namespace distances
+
+} // namespace aleph
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_PERSISTENCE_IMAGE_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_PERSISTENCE_IMAGE_HH__
+
+#include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+/**
+  @struct PersistenceImageOptions
+  @brief Parameters of the rasterisation of persistence images
+
+  Describes the grid of a persistence image. Points of a persistence
+  diagram are transformed into birth--persistence coordinates, i.e. the
+  horizontal axis of the image corresponds to the creation value and the
+  vertical axis corresponds to the persistence of a point. The grid covers
+  the range [xMin, xMax] x [yMin, yMax] using width x height pixels.
+*/
+
+struct PersistenceImageOptions
+{
+  double xMin = 0.0;
+  double xMax = 1.0;
+  double yMin = 0.0;
+  double yMax = 1.0;
+
+  unsigned width  = 20;
+  unsigned height = 20;
+
+  /** Standard deviation of the Gaussian that is placed at every point */
+  double sigma = 0.1;
+
+  /**
+    Persistence value at which the weighting function saturates. Points
+    with a lower persistence are weighted with (persistence/threshold)^k,
+    where k is the weight exponent, while all other points have a weight
+    of 1. A non-positive threshold disables the weighting.
+  */
+
+  double weightThreshold = 0.0;
+  double weightExponent  = 1.0;
+
+  /**
+    Support of the Gaussian in multiples of its standard deviation. Pixels
+    outside of the support are not updated. A non-positive value results in
+    updating all pixels.
+  */
+
+  double truncation = 5.0;
+};
+
+/**
+  Adjusts the range of a persistence image such that all paired points of
+  a range of persistence diagrams are covered. The range is padded by the
+  standard deviation of the Gaussian so that the mass of points close to
+  the boundary is not lost. The number of pixels is kept.
+*/
+
+template <class InputIterator> void fitPersistenceImage( InputIterator begin, InputIterator end,
+                                                         PersistenceImageOptions& options )
+{
+  auto xMin = std::numeric_limits<double>::max();
+  auto xMax = std::numeric_limits<double>::lowest();
+  auto yMin = std::numeric_limits<double>::max();
+  auto yMax = std::numeric_limits<double>::lowest();
+
+  for( auto it = begin; it != end; ++it )
+  {
+    for( auto&& p : *it )
+    {
+      if( p.isUnpaired() )
+        continue;
+
+      auto x = static_cast<double>( p.x() );
+      auto y = static_cast<double>( p.y() ) - x;
+
+      xMin = std::min( xMin, x );
+      xMax = std::max( xMax, x );
+      yMin = std::min( yMin, y );
+      yMax = std::max( yMax, y );
+    }
+  }
+
+  if( xMin > xMax )
+    return;
+
+  options.xMin = xMin - options.sigma;
+  options.xMax = xMax + options.sigma;
+  options.yMin = std::max( 0.0, yMin - options.sigma );
+  options.yMax = yMax + options.sigma;
+}
+
+namespace detail
+{
+
+/**
+  Integrates a one-dimensional Gaussian with mean mu over all pixels of an
+  axis. Only the pixels within the support of the Gaussian are evaluated;
+  their range is reported via the first and last index. Returns false if
+  no pixel is covered.
+*/
+
+inline bool integrateGaussian( double mu, double sigma, double min, double max,
+                               unsigned n, double truncation,
+                               std::vector<double>& values,
+                               unsigned& first, unsigned& last )
+{
+  auto delta = ( max - min ) / n;
+
+  first = 0;
+  last  = n;
+
+  if( truncation > 0 )
+  {
+    auto lower = std::floor( ( mu - truncation * sigma - min ) / delta );
+    auto upper = std::ceil(  ( mu + truncation * sigma - min ) / delta );
+
+    if( upper <= 0 || lower >= n )
+      return false;
+
+    first = static_cast<unsigned>( std::max( 0.0, lower ) );
+    last  = static_cast<unsigned>( std::min( double( n ), upper ) );
+  }
+
+  values.resize( last - first );
+
+  // The integral over a pixel is the difference of the cumulative
+  // distribution function at its boundaries. Every boundary is only
+  // evaluated once.
+  auto scale = 1.0 / ( sigma * std::sqrt( 2.0 ) );
+  auto cdf   = [&] ( unsigned i )
+  {
+    return std::erf( ( min + i * delta - mu ) * scale );
+  };
+
+  auto left = cdf( first );
+
+  for( unsigned i = first; i < last; i++ )
+  {
+    auto right        = cdf( i + 1 );
+    values[i - first] = 0.5 * ( right - left );
+    left              = right;
+  }
+
+  return true;
+}
+
+/**
+  Rasterises a persistence diagram into a pre-allocated image of the size
+  given by the options. The image is stored in row-major order, with rows
+  corresponding to persistence values. Values are added to the image, so
+  it needs to be zeroed by the client.
+*/
+
+template <class T> void persistenceImage( const PersistenceDiagram<T>& D,
+                                          const PersistenceImageOptions& options,
+                                          float* image )
+{
+  // Since the Gaussian is separable, its integral over a pixel is the
+  // product of two one-dimensional integrals. Every point thus requires
+  // only O(w+h) evaluations of the error function, and its contribution
+  // is an outer product that is restricted to the support.
+  std::vector<double> gx;
+  std::vector<double> gy;
+
+  for( auto&& p : D )
+  {
+    if( p.isUnpaired() )
+      continue;
+
+    auto x = static_cast<double>( p.x() );
+    auto y = static_cast<double>( p.y() ) - x;
+
+    auto weight = 1.0;
+
+    if( options.weightThreshold > 0 && y < options.weightThreshold )
+      weight = y > 0 ? std::pow( y / options.weightThreshold, options.weightExponent ) : 0.0;
+
+    if( weight == 0.0 )
+      continue;
+
+    unsigned x0 = 0, x1 = 0;
+    unsigned y0 = 0, y1 = 0;
+
+    if( !integrateGaussian( x, options.sigma, options.xMin, options.xMax, options.width, options.truncation, gx, x0, x1 ) )
+      continue;
+
+    if( !integrateGaussian( y, options.sigma, options.yMin, options.yMax, options.height, options.truncation, gy, y0, y1 ) )
+      continue;
+
+    for( unsigned j = y0; j < y1; j++ )
+    {
+      auto factor = weight * gy[j - y0];
+      auto row    = image + std::size_t( j ) * options.width;
+
+      for( unsigned i = x0; i < x1; i++ )
+        row[i] += static_cast<float>( factor * gx[i - x0] );
+    }
+  }
+}
+
+/** Checks that the options describe a valid grid */
+inline void checkPersistenceImageOptions( const PersistenceImageOptions& options )
+{
+  if( options.width == 0 || options.height == 0 )
+    throw std::runtime_error( "Persistence image must not be empty" );
+
+  if( !( options.xMin < options.xMax ) || !( options.yMin < options.yMax ) )
+    throw std::runtime_error( "Invalid range for persistence image" );
+
+  if( !( options.sigma > 0 ) )
+    throw std::runtime_error( "Standard deviation must be positive" );
+}
+
+} // namespace detail
+
+/**
+  Calculates the persistence image of a persistence diagram, following
+
+    Persistence Images: A Stable Vector Representation of Persistent Homology
+    Henry Adams et al.
+    Journal of Machine Learning Research 18, pp. 1--35, 2017
+
+  Every paired point is transformed into birth--persistence coordinates
+  and replaced by a weighted Gaussian, which is integrated over every
+  pixel. Unpaired points are ignored. The image is returned in row-major
+  order, i.e. the value of pixel (i,j) is stored at index j * width + i,
+  where j refers to the persistence axis.
+*/
+
+template <class T> std::vector<float> persistenceImage( const PersistenceDiagram<T>& D,
+                                                        const PersistenceImageOptions& options = PersistenceImageOptions() )
+{
+  detail::checkPersistenceImageOptions( options );
+
+  std::vector<float> image( std::size_t( options.width ) * options.height );
+  detail::persistenceImage( D, options, image.data() );
+
+  return image;
+}
+
+/**
+  Calculates the persistence images of a range of persistence diagrams.
+  The images are stored contiguously in a single matrix in row-major
+  order, with one row of width * height values per diagram. Diagrams are
+  processed in parallel, and every thread writes to its own rows only.
+*/
+
+template <class InputIterator> std::vector<float> persistenceImages( InputIterator begin, InputIterator end,
+                                                                     const PersistenceImageOptions& options = PersistenceImageOptions() )
+{
+  detail::checkPersistenceImageOptions( options );
+
+  using Diagram = typename std::iterator_traits<InputIterator>::value_type;
+
+  std::vector<const Diagram*> diagrams;
+  for( auto it = begin; it != end; ++it )
+    diagrams.push_back( &( *it ) );
+
+  auto size = std::size_t( options.width ) * options.height;
+  std::vector<float> images( diagrams.size() * size );
+
+  #pragma omp parallel for schedule(dynamic)
+  for( std::size_t i = 0; i < diagrams.size(); i++ )
+    detail::persistenceImage( *diagrams[i], options, images.data() + i * size );
+
+  return images;
+}
+
+} // namespace aleph
+
+#endif
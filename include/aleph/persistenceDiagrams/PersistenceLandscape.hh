@@ -0,0 +1,896 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_PERSISTENCE_LANDSCAPE_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_PERSISTENCE_LANDSCAPE_HH__
+
+#include <aleph/math/KahanSummation.hh>
+
+#include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace detail
+{
+
+/**
+  Calculates the integral of |f|^p over a segment of length dx, where f is
+  linear with values a and b at the end points of the segment. Segments in
+  which f changes its sign are split at the root.
+*/
+
+inline double integratePower( double dx, double a, double b, double p )
+{
+  if( dx <= 0 )
+    return 0.0;
+
+  if( ( a < 0 && b > 0 ) || ( a > 0 && b < 0 ) )
+  {
+    auto t = a / ( a - b );
+    return integratePower( t * dx, a, 0.0, p ) + integratePower( ( 1 - t ) * dx, 0.0, b, p );
+  }
+
+  a = std::abs( a );
+  b = std::abs( b );
+
+  if( a > b )
+    std::swap( a, b );
+
+  if( p == 1 )
+    return dx * ( a + b ) / 2;
+  else if( p == 2 )
+    return dx * ( a * a + a * b + b * b ) / 3;
+  else if( b == 0 )
+    return 0.0;
+
+  // The integral is dx * (b^{p+1} - a^{p+1}) / ((p+1) * (b-a)). In order to
+  // avoid cancellations for similar values, it is rewritten in terms of the
+  // relative difference of both values.
+  auto q = ( b - a ) / b;
+
+  if( q == 0 )
+    return dx * std::pow( b, p );
+
+  auto ratio = -std::expm1( ( p + 1 ) * std::log1p( -q ) ) / q;
+  return dx * std::pow( b, p ) * ratio / ( p + 1 );
+}
+
+} // namespace detail
+
+/**
+  @class PersistenceLandscape
+  @brief Exact piecewise-linear persistence landscape
+
+  Stores the persistence landscape of a persistence diagram as described in
+
+    Statistical Topological Data Analysis using Persistence Landscapes
+    Peter Bubenik
+    Journal of Machine Learning Research 16, pp. 77--102, 2015
+
+  Every level of the landscape is a piecewise-linear function, which is
+  represented by its sorted breakpoints. The function vanishes outside of
+  its first and last breakpoint. Arithmetic operations merge breakpoints
+  in linear time, while evaluations use a binary search.
+*/
+
+class PersistenceLandscape
+{
+public:
+  using Point = std::pair<double, double>;
+  using Level = std::vector<Point>;
+
+  /** Creates an empty landscape, i.e. the zero function */
+  PersistenceLandscape() = default;
+
+  /**
+    Creates the persistence landscape of a persistence diagram, using the
+    sweep of
+
+      A persistence landscapes toolbox for topological statistics
+      Peter Bubenik and Paweł Dłotko
+      Journal of Symbolic Computation 78, pp. 91--114, 2017
+
+    The pending intervals are kept in a balanced search tree, ordered by
+    increasing birth and decreasing death, so that removing an interval
+    or re-inserting the remaining part of a partially covered interval
+    requires logarithmic time. Every level is traced from left to right
+    in a single pass over the tree. Unpaired and diagonal points are
+    ignored because they do not contribute a finite function.
+  */
+
+  template <class T> explicit PersistenceLandscape( const PersistenceDiagram<T>& D )
+  {
+    // Sort by increasing birth and, in case of ties, by decreasing death,
+    // so that longer intervals appear first.
+    auto compare = [] ( const Point& p, const Point& q )
+    {
+      return p.first < q.first || ( p.first == q.first && p.second > q.second );
+    };
+
+    std::multiset<Point, decltype(compare)> A( compare );
+
+    for( auto&& p : D )
+    {
+      auto b = static_cast<double>( p.x() );
+      auto d = static_cast<double>( p.y() );
+
+      if( p.isUnpaired() || !std::isfinite( b ) || !std::isfinite( d ) || !( b < d ) )
+        continue;
+
+      A.insert( A.end(), std::make_pair( b, d ) );
+    }
+
+    while( !A.empty() )
+    {
+      Level L;
+
+      auto b = A.begin()->first;
+      auto d = A.begin()->second;
+
+      A.erase( A.begin() );
+
+      L.push_back( std::make_pair( b, 0.0 ) );
+      L.push_back( std::make_pair( ( b + d ) / 2, ( d - b ) / 2 ) );
+
+      // Every interval preceding this position has already been checked
+      // and dies before the current interval.
+      auto position = A.begin();
+
+      while( true )
+      {
+        while( position != A.end() && position->second <= d )
+          ++position;
+
+        if( position == A.end() )
+        {
+          L.push_back( std::make_pair( d, 0.0 ) );
+          break;
+        }
+
+        auto b2 = position->first;
+        auto d2 = position->second;
+
+        position = A.erase( position );
+
+        if( b2 > d )
+          L.push_back( std::make_pair( d, 0.0 ) );
+
+        if( b2 >= d )
+          L.push_back( std::make_pair( b2, 0.0 ) );
+        else
+        {
+          L.push_back( std::make_pair( ( b2 + d ) / 2, ( d - b2 ) / 2 ) );
+
+          // The part of the interval that is not covered by the current
+          // level belongs to the next level. The current position is a
+          // good hint for inserting it. Since it dies before the new
+          // current interval, the scan skips it in any case.
+          A.insert( position, std::make_pair( b2, d ) );
+        }
+
+        L.push_back( std::make_pair( ( b2 + d2 ) / 2, ( d2 - b2 ) / 2 ) );
+
+        b = b2;
+        d = d2;
+      }
+
+      _levels.push_back( std::move( L ) );
+    }
+  }
+
+  /**
+    Calculates the sum of a range of landscapes. The breakpoints of every
+    level are merged once for all landscapes with a heap, and the sum is
+    updated incrementally from the slopes of all functions. This avoids
+    merging an ever-growing list of breakpoints for every summand.
+  */
+
+  template <class InputIterator> static PersistenceLandscape sum( InputIterator begin, InputIterator end )
+  {
+    std::vector<const PersistenceLandscape*> landscapes;
+    std::size_t numLevels = 0;
+
+    for( auto it = begin; it != end; ++it )
+    {
+      landscapes.push_back( &( *it ) );
+      numLevels = std::max( numLevels, it->_levels.size() );
+    }
+
+    PersistenceLandscape result;
+    result._levels.resize( numLevels );
+
+    for( std::size_t k = 0; k < numLevels; k++ )
+    {
+      std::vector<const Level*> levels;
+
+      for( auto&& landscape : landscapes )
+        if( k < landscape->_levels.size() && !landscape->_levels[k].empty() )
+          levels.push_back( &landscape->_levels[k] );
+
+      result._levels[k] = sumLevels( levels );
+    }
+
+    return result;
+  }
+
+  /** @returns Number of levels of the landscape */
+  std::size_t levels() const noexcept
+  {
+    return _levels.size();
+  }
+
+  /** @returns Breakpoints of a given level of the landscape */
+  const Level& level( std::size_t k ) const
+  {
+    return _levels.at( k );
+  }
+
+  /**
+    Evaluates a given level of the landscape. Levels beyond the number of
+    stored levels vanish.
+  */
+
+  double operator()( std::size_t k, double x ) const
+  {
+    if( k >= _levels.size() )
+      return 0.0;
+
+    auto&& L = _levels[k];
+
+    if( L.empty() || x <= L.front().first || x >= L.back().first )
+      return 0.0;
+
+    auto it = std::upper_bound( L.begin(), L.end(), x,
+                                [] ( double x, const Point& p )
+                                {
+                                  return x < p.first;
+                                } );
+
+    return interpolate( *std::prev( it ), *it, x );
+  }
+
+  PersistenceLandscape& operator+=( const PersistenceLandscape& other )
+  {
+    return this->combine( other, [] ( double a, double b ) { return a + b; } );
+  }
+
+  PersistenceLandscape& operator-=( const PersistenceLandscape& other )
+  {
+    return this->combine( other, [] ( double a, double b ) { return a - b; } );
+  }
+
+  PersistenceLandscape& operator*=( double lambda )
+  {
+    for( auto&& L : _levels )
+      for( auto&& p : L )
+        p.second *= lambda;
+
+    return *this;
+  }
+
+  /**
+    Calculates the L^p norm of the landscape, i.e. the pth root of the sum
+    of the integrals of |\lambda_k|^p over all levels. An infinite value
+    of p yields the maximum norm. All integrals are calculated exactly.
+  */
+
+  double norm( double p = 2.0 ) const
+  {
+    if( std::isinf( p ) )
+    {
+      double result = 0.0;
+
+      for( auto&& L : _levels )
+        for( auto&& q : L )
+          result = std::max( result, std::abs( q.second ) );
+
+      return result;
+    }
+
+    aleph::math::KahanSummation<double> result = 0.0;
+
+    for( auto&& L : _levels )
+    {
+      for( std::size_t i = 1; i < L.size(); i++ )
+        result += detail::integratePower( L[i].first - L[i-1].first, L[i-1].second, L[i].second, p );
+    }
+
+    return std::pow( static_cast<double>( result ), 1.0 / p );
+  }
+
+  /**
+    Calculates the inner product of two landscapes, i.e. the sum of the
+    integrals of \lambda_k \mu_k over all levels. Since both functions are
+    linear between merged breakpoints, Simpson's rule is exact.
+  */
+
+  friend double innerProduct( const PersistenceLandscape& L1, const PersistenceLandscape& L2 )
+  {
+    aleph::math::KahanSummation<double> result = 0.0;
+
+    auto n = std::min( L1._levels.size(), L2._levels.size() );
+
+    for( std::size_t k = 0; k < n; k++ )
+    {
+      double x0 = 0.0, f0 = 0.0, g0 = 0.0;
+      bool first = true;
+
+      merge( L1._levels[k], L2._levels[k], [&] ( double x, double f, double g )
+      {
+        if( !first )
+          result += ( x - x0 ) / 6 * ( 2 * f0 * g0 + f0 * g + f * g0 + 2 * f * g );
+
+        x0    = x;
+        f0    = f;
+        g0    = g;
+        first = false;
+      } );
+    }
+
+    return result;
+  }
+
+private:
+
+  static double interpolate( const Point& p, const Point& q, double x )
+  {
+    auto dx = q.first - p.first;
+    if( dx <= 0 )
+      return q.second;
+
+    return p.second + ( q.second - p.second ) * ( x - p.first ) / dx;
+  }
+
+  /**
+    Merges the breakpoints of two levels and reports the values of both
+    functions at every merged breakpoint. This requires linear time.
+  */
+
+  template <class Functor> static void merge( const Level& F, const Level& G, Functor functor )
+  {
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    // Value of a level at position x, provided that all breakpoints up to
+    // index i lie before x
+    auto value = [] ( const Level& L, std::size_t i, double x )
+    {
+      if( i == 0 || i >= L.size() )
+        return 0.0;
+      else
+        return interpolate( L[i-1], L[i], x );
+    };
+
+    while( i < F.size() || j < G.size() )
+    {
+      auto x = std::numeric_limits<double>::infinity();
+
+      if( i < F.size() )
+        x = F[i].first;
+      if( j < G.size() )
+        x = std::min( x, G[j].first );
+
+      double f, g;
+
+      if( i < F.size() && F[i].first == x )
+        f = F[i++].second;
+      else
+        f = value( F, i, x );
+
+      if( j < G.size() && G[j].first == x )
+        g = G[j++].second;
+      else
+        g = value( G, j, x );
+
+      functor( x, f, g );
+    }
+  }
+
+  /** Slope of a level between a breakpoint and its successor */
+  static double slope( const Level& L, std::size_t i )
+  {
+    if( i + 1 >= L.size() )
+      return 0.0;
+
+    auto dx = L[i+1].first - L[i].first;
+    return dx > 0 ? ( L[i+1].second - L[i].second ) / dx : 0.0;
+  }
+
+  /**
+    Sums a set of levels by merging their breakpoints with a heap. Every
+    level is treated as a function that vanishes outside its breakpoints,
+    so the sum may jump at the first or last breakpoint of a level. This
+    requires O(n log m) time for n breakpoints of m levels.
+  */
+
+  static Level sumLevels( const std::vector<const Level*>& levels )
+  {
+    using Entry = std::pair<double, std::size_t>;
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    std::vector<std::size_t> cursors( levels.size(), 0 );
+
+    for( std::size_t j = 0; j < levels.size(); j++ )
+      queue.push( std::make_pair( levels[j]->front().first, j ) );
+
+    Level result;
+
+    aleph::math::KahanSummation<double> value = 0.0;
+    aleph::math::KahanSummation<double> gradient = 0.0;
+
+    double x0          = 0.0;
+    std::size_t active = 0;
+
+    while( !queue.empty() )
+    {
+      auto x = queue.top().first;
+
+      if( !result.empty() )
+        value += static_cast<double>( gradient ) * ( x - x0 );
+
+      double left = value;
+
+      // Process all breakpoints at this position; a level may contain
+      // more than one of them.
+      while( !queue.empty() && queue.top().first == x )
+      {
+        auto j   = queue.top().second;
+        auto&& L = *levels[j];
+
+        queue.pop();
+
+        auto i0 = cursors[j];
+        auto i1 = i0;
+
+        while( i1 + 1 < L.size() && L[i1+1].first == x )
+          ++i1;
+
+        cursors[j] = i1 + 1;
+
+        auto before = i0 == 0 ? 0.0 : L[i0].second;
+        auto after  = i1 + 1 == L.size() ? 0.0 : L[i1].second;
+
+        value += after - before;
+        gradient += slope( L, i1 ) - ( i0 == 0 ? 0.0 : slope( L, i0 - 1 ) );
+
+        if( i0 == 0 )
+          ++active;
+
+        if( i1 + 1 == L.size() )
+          --active;
+        else
+          queue.push( std::make_pair( L[i1+1].first, j ) );
+      }
+
+      // Outside the support of all levels, the sum vanishes, so rounding
+      // errors do not accumulate over gaps.
+      if( active == 0 )
+      {
+        value    = 0.0;
+        gradient = 0.0;
+      }
+
+      double right = value;
+
+      // A jump is represented by two breakpoints at the same position;
+      // the left value is only required if it differs from the right one.
+      if( left != right && !result.empty() )
+        result.push_back( std::make_pair( x, left ) );
+
+      result.push_back( std::make_pair( x, right ) );
+      x0 = x;
+    }
+
+    return result;
+  }
+
+  template <class Operation> PersistenceLandscape& combine( const PersistenceLandscape& other, Operation operation )
+  {
+    if( _levels.size() < other._levels.size() )
+      _levels.resize( other._levels.size() );
+
+    for( std::size_t k = 0; k < _levels.size(); k++ )
+    {
+      static const Level empty;
+
+      auto&& G = k < other._levels.size() ? other._levels[k] : empty;
+      Level L;
+      L.reserve( _levels[k].size() + G.size() );
+
+      merge( _levels[k], G, [&] ( double x, double f, double g )
+      {
+        L.push_back( std::make_pair( x, operation( f, g ) ) );
+      } );
+
+      _levels[k].swap( L );
+    }
+
+    return *this;
+  }
+
+  std::vector<Level> _levels;
+};
+
+/**
+  @struct PersistenceLandscapeGrid
+  @brief Sampling grid of discretised persistence landscapes
+
+  Describes the equidistant samples at which the levels of a discretised
+  persistence landscape are evaluated. Landscapes can only be combined if
+  they share the same grid.
+*/
+
+struct PersistenceLandscapeGrid
+{
+  double xMin = 0.0;
+  double xMax = 1.0;
+
+  unsigned samples = 100;
+  unsigned levels  = 5;
+
+  bool operator==( const PersistenceLandscapeGrid& other ) const noexcept
+  {
+    return xMin == other.xMin && xMax == other.xMax && samples == other.samples && levels == other.levels;
+  }
+
+  bool operator!=( const PersistenceLandscapeGrid& other ) const noexcept
+  {
+    return !this->operator==( other );
+  }
+};
+
+/**
+  @class DiscretePersistenceLandscape
+  @brief Persistence landscape that is sampled on a fixed grid
+
+  Stores the first levels of a persistence landscape at the samples of a
+  grid. The values are stored contiguously, one row per level, so all
+  operations are simple loops over the samples. Integrals are calculated
+  using the trapezoidal rule.
+*/
+
+class DiscretePersistenceLandscape
+{
+public:
+
+  /** Creates a vanishing landscape on a given grid */
+  explicit DiscretePersistenceLandscape( const PersistenceLandscapeGrid& grid )
+    : _grid( grid )
+  {
+    if( grid.samples < 2 || grid.levels == 0 )
+      throw std::runtime_error( "Grid requires at least two samples and one level" );
+
+    if( !( grid.xMin < grid.xMax ) )
+      throw std::runtime_error( "Invalid range for grid" );
+
+    _values.assign( std::size_t( grid.levels ) * grid.samples, 0.0 );
+  }
+
+  /**
+    Creates a discretised persistence landscape of a persistence diagram.
+    Every interval only updates the samples in its support, and every
+    sample keeps the largest values of the tent functions covering it in
+    a small sorted buffer.
+  */
+
+  template <class T> DiscretePersistenceLandscape( const PersistenceDiagram<T>& D,
+                                                   const PersistenceLandscapeGrid& grid )
+    : DiscretePersistenceLandscape( grid )
+  {
+    auto K     = std::size_t( grid.levels );
+    auto S     = std::size_t( grid.samples );
+    auto delta = this->delta();
+
+    // Sample-major buffer of the largest values, sorted in descending order
+    std::vector<double> buffer( K * S, 0.0 );
+
+    for( auto&& p : D )
+    {
+      auto b = static_cast<double>( p.x() );
+      auto d = static_cast<double>( p.y() );
+
+      if( p.isUnpaired() || !std::isfinite( b ) || !std::isfinite( d ) || !( b < d ) )
+        continue;
+
+      auto lower = std::ceil(  ( b - grid.xMin ) / delta );
+      auto upper = std::floor( ( d - grid.xMin ) / delta );
+
+      if( upper < 0 || lower > double( S - 1 ) )
+        continue;
+
+      auto first = static_cast<std::size_t>( std::max( 0.0, lower ) );
+      auto last  = static_cast<std::size_t>( std::min( double( S - 1 ), upper ) );
+
+      for( auto i = first; i <= last; i++ )
+      {
+        auto t     = grid.xMin + double( i ) * delta;
+        auto value = std::min( t - b, d - t );
+
+        auto values = buffer.data() + i * K;
+
+        if( value <= values[K-1] )
+          continue;
+
+        auto k = K - 1;
+        while( k > 0 && values[k-1] < value )
+        {
+          values[k] = values[k-1];
+          --k;
+        }
+
+        values[k] = value;
+      }
+    }
+
+    for( std::size_t i = 0; i < S; i++ )
+      for( std::size_t k = 0; k < K; k++ )
+        _values[k * S + i] = buffer[i * K + k];
+  }
+
+  /** @returns Grid of the landscape */
+  const PersistenceLandscapeGrid& grid() const noexcept
+  {
+    return _grid;
+  }
+
+  /** @returns Distance between two consecutive samples */
+  double delta() const noexcept
+  {
+    return ( _grid.xMax - _grid.xMin ) / ( _grid.samples - 1 );
+  }
+
+  /** @returns Value of a level at a given sample */
+  double operator()( std::size_t k, std::size_t i ) const
+  {
+    return _values.at( k * _grid.samples + i );
+  }
+
+  /** @returns Contiguous values of the landscape, one row per level */
+  const std::vector<double>& values() const noexcept
+  {
+    return _values;
+  }
+
+  DiscretePersistenceLandscape& operator+=( const DiscretePersistenceLandscape& other )
+  {
+    this->check( other );
+
+    for( std::size_t i = 0; i < _values.size(); i++ )
+      _values[i] += other._values[i];
+
+    return *this;
+  }
+
+  DiscretePersistenceLandscape& operator-=( const DiscretePersistenceLandscape& other )
+  {
+    this->check( other );
+
+    for( std::size_t i = 0; i < _values.size(); i++ )
+      _values[i] -= other._values[i];
+
+    return *this;
+  }
+
+  DiscretePersistenceLandscape& operator*=( double lambda )
+  {
+    for( auto&& value : _values )
+      value *= lambda;
+
+    return *this;
+  }
+
+  /**
+    Calculates the L^p norm of the landscape. An infinite value of p
+    yields the maximum norm.
+  */
+
+  double norm( double p = 2.0 ) const
+  {
+    if( std::isinf( p ) )
+    {
+      double result = 0.0;
+
+      for( auto&& value : _values )
+        result = std::max( result, std::abs( value ) );
+
+      return result;
+    }
+
+    auto S     = std::size_t( _grid.samples );
+    auto delta = this->delta();
+
+    aleph::math::KahanSummation<double> result = 0.0;
+
+    for( std::size_t k = 0; k < _grid.levels; k++ )
+    {
+      auto values = _values.data() + k * S;
+      double sum  = 0.0;
+
+      for( std::size_t i = 0; i < S; i++ )
+      {
+        auto value = p == 1 ? std::abs( values[i] ) : std::pow( std::abs( values[i] ), p );
+        sum       += ( i == 0 || i + 1 == S ) ? value / 2 : value;
+      }
+
+      result += delta * sum;
+    }
+
+    return std::pow( static_cast<double>( result ), 1.0 / p );
+  }
+
+  /** Calculates the inner product of two landscapes on the same grid */
+  friend double innerProduct( const DiscretePersistenceLandscape& L1, const DiscretePersistenceLandscape& L2 )
+  {
+    L1.check( L2 );
+
+    auto S     = std::size_t( L1._grid.samples );
+    auto delta = L1.delta();
+
+    aleph::math::KahanSummation<double> result = 0.0;
+
+    for( std::size_t k = 0; k < L1._grid.levels; k++ )
+    {
+      auto f     = L1._values.data() + k * S;
+      auto g     = L2._values.data() + k * S;
+      double sum = 0.0;
+
+      for( std::size_t i = 0; i < S; i++ )
+        sum += ( i == 0 || i + 1 == S ) ? f[i] * g[i] / 2 : f[i] * g[i];
+
+      result += delta * sum;
+    }
+
+    return result;
+  }
+
+private:
+
+  void check( const DiscretePersistenceLandscape& other ) const
+  {
+    if( _grid != other._grid )
+      throw std::runtime_error( "Grids of landscapes do not coincide" );
+  }
+
+  PersistenceLandscapeGrid _grid;
+  std::vector<double> _values;
+};
+
+inline PersistenceLandscape operator+( PersistenceLandscape L1, const PersistenceLandscape& L2 )
+{
+  return L1 += L2;
+}
+
+inline PersistenceLandscape operator-( PersistenceLandscape L1, const PersistenceLandscape& L2 )
+{
+  return L1 -= L2;
+}
+
+inline PersistenceLandscape operator*( double lambda, PersistenceLandscape L )
+{
+  return L *= lambda;
+}
+
+inline DiscretePersistenceLandscape operator+( DiscretePersistenceLandscape L1, const DiscretePersistenceLandscape& L2 )
+{
+  return L1 += L2;
+}
+
+inline DiscretePersistenceLandscape operator-( DiscretePersistenceLandscape L1, const DiscretePersistenceLandscape& L2 )
+{
+  return L1 -= L2;
+}
+
+inline DiscretePersistenceLandscape operator*( double lambda, DiscretePersistenceLandscape L )
+{
+  return L *= lambda;
+}
+
+/**
+  Calculates the L^p distance between two persistence landscapes, i.e.
+  the norm of their difference. This works for exact as well as for
+  discretised landscapes.
+*/
+
+template <class Landscape> double landscapeDistance( const Landscape& L1, const Landscape& L2, double p = 2.0 )
+{
+  return ( L1 - L2 ).norm( p );
+}
+
+namespace detail
+{
+
+/** Sums a range of landscapes by adding them one after the other */
+template <class InputIterator, class Landscape> Landscape sumLandscapes( InputIterator begin, InputIterator end, const Landscape& )
+{
+  auto result = *begin;
+
+  for( auto it = std::next( begin ); it != end; ++it )
+    result += *it;
+
+  return result;
+}
+
+/** Sums a range of exact landscapes by merging all breakpoints at once */
+template <class InputIterator> PersistenceLandscape sumLandscapes( InputIterator begin, InputIterator end, const PersistenceLandscape& )
+{
+  return PersistenceLandscape::sum( begin, end );
+}
+
+} // namespace detail
+
+/**
+  Calculates the average of a non-empty range of persistence landscapes.
+  This works for exact as well as for discretised landscapes.
+*/
+
+template <class InputIterator> typename std::iterator_traits<InputIterator>::value_type averageLandscape( InputIterator begin, InputIterator end )
+{
+  if( begin == end )
+    throw std::runtime_error( "Unable to average empty range of landscapes" );
+
+  auto result = detail::sumLandscapes( begin, end, *begin );
+  auto n      = std::distance( begin, end );
+
+  result *= 1.0 / double( n );
+  return result;
+}
+
+/**
+  Calculates the persistence landscapes of a range of persistence diagrams
+  in parallel.
+*/
+
+template <class InputIterator> std::vector<PersistenceLandscape> persistenceLandscapes( InputIterator begin, InputIterator end )
+{
+  using Diagram = typename std::iterator_traits<InputIterator>::value_type;
+
+  std::vector<const Diagram*> diagrams;
+  for( auto it = begin; it != end; ++it )
+    diagrams.push_back( &( *it ) );
+
+  std::vector<PersistenceLandscape> landscapes( diagrams.size() );
+
+  #pragma omp parallel for schedule(dynamic)
+  for( std::size_t i = 0; i < diagrams.size(); i++ )
+    landscapes[i] = PersistenceLandscape( *diagrams[i] );
+
+  return landscapes;
+}
+
+/**
+  Calculates the discretised persistence landscapes of a range of
+  persistence diagrams in parallel. All landscapes share the same grid.
+*/
+
+template <class InputIterator> std::vector<DiscretePersistenceLandscape> persistenceLandscapes( InputIterator begin, InputIterator end,
+                                                                                               const PersistenceLandscapeGrid& grid )
+{
+  using Diagram = typename std::iterator_traits<InputIterator>::value_type;
+
+  std::vector<const Diagram*> diagrams;
+  for( auto it = begin; it != end; ++it )
+    diagrams.push_back( &( *it ) );
+
+  std::vector<DiscretePersistenceLandscape> landscapes( diagrams.size(), DiscretePersistenceLandscape( grid ) );
+
+  #pragma omp parallel for schedule(dynamic)
+  for( std::size_t i = 0; i < diagrams.size(); i++ )
+    landscapes[i] = DiscretePersistenceLandscape( *diagrams[i], grid );
+
+  return landscapes;
+}
+
+} // namespace aleph
+
+#endif
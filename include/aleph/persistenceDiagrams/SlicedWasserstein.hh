@@ -0,0 +1,290 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_SLICED_WASSERSTEIN_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_SLICED_WASSERSTEIN_HH__
+
+#include <aleph/math/KahanSummation.hh>
+
+#include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+/**
+  @class SlicedWassersteinSketch
+  @brief Precomputed projections of a persistence diagram
+
+  Stores the projections of all points of a persistence diagram, as well as
+  the projections of their orthogonal projections onto the diagonal, onto a
+  fixed set of directions. The directions are spread uniformly over the half
+  circle. For every direction, the projections are sorted, so the sliced
+  Wasserstein distance between two sketches only requires merging them.
+
+  The sketch follows the definition in
+
+    Sliced Wasserstein Kernel for Persistence Diagrams
+    Mathieu Carrière, Marco Cuturi, and Steve Oudot
+    Proceedings of the 34th International Conference on Machine Learning, 2017
+
+  Unpaired points are ignored because their projections are not finite.
+*/
+
+class SlicedWassersteinSketch
+{
+public:
+
+  /**
+    Creates a sketch of a persistence diagram.
+
+    @param D          Persistence diagram
+    @param directions Number of directions to use for the projections
+  */
+
+  template <class T> SlicedWassersteinSketch( const PersistenceDiagram<T>& D, unsigned directions )
+    : _directions( directions )
+  {
+    if( directions == 0 )
+      throw std::runtime_error( "Number of directions must be positive" );
+
+    std::vector<double> x;
+    std::vector<double> y;
+
+    x.reserve( D.size() );
+    y.reserve( D.size() );
+
+    for( auto&& p : D )
+    {
+      if( p.isUnpaired() )
+        continue;
+
+      x.push_back( static_cast<double>( p.x() ) );
+      y.push_back( static_cast<double>( p.y() ) );
+    }
+
+    _size = x.size();
+
+    _points.reserve( _size * _directions );
+    _diagonal.reserve( _size * _directions );
+
+    for( unsigned k = 0; k < _directions; k++ )
+    {
+      auto theta = -M_PI / 2 + M_PI * k / _directions;
+      auto c     = std::cos( theta );
+      auto s     = std::sin( theta );
+
+      auto begin = _points.size();
+
+      for( std::size_t i = 0; i < _size; i++ )
+      {
+        _points.push_back( c * x[i] + s * y[i] );
+        _diagonal.push_back( ( c + s ) * ( x[i] + y[i] ) / 2 );
+      }
+
+      std::sort( _points.begin() + std::ptrdiff_t( begin ), _points.end() );
+      std::sort( _diagonal.begin() + std::ptrdiff_t( begin ), _diagonal.end() );
+    }
+  }
+
+  /** @returns Number of directions of the sketch */
+  unsigned directions() const noexcept
+  {
+    return _directions;
+  }
+
+  /** @returns Number of points of the sketch */
+  std::size_t size() const noexcept
+  {
+    return _size;
+  }
+
+  /** @returns Sorted projections of the points for a given direction */
+  const double* points( unsigned direction ) const noexcept
+  {
+    return _points.data() + direction * _size;
+  }
+
+  /** @returns Sorted projections of the diagonal points for a given direction */
+  const double* diagonal( unsigned direction ) const noexcept
+  {
+    return _diagonal.data() + direction * _size;
+  }
+
+private:
+  unsigned _directions;
+  std::size_t _size = 0;
+
+  std::vector<double> _points;
+  std::vector<double> _diagonal;
+};
+
+namespace detail
+{
+
+/**
+  Calculates the 1-Wasserstein distance between two sets of values on the
+  real line. The first set is the union of two sorted sequences, while the
+  second set is the union of two other sorted sequences. Both unions need
+  to have the same size. The unions are merged on the fly, so no further
+  memory is required.
+*/
+
+inline double slicedDistance( const double* a, std::size_t na,
+                              const double* b, std::size_t nb,
+                              const double* c, std::size_t nc,
+                              const double* d, std::size_t nd )
+{
+  std::size_t i = 0, j = 0, k = 0, l = 0;
+  double result = 0.0;
+
+  auto next = [] ( const double* u, std::size_t& iu, std::size_t nu,
+                   const double* v, std::size_t& iv, std::size_t nv )
+  {
+    if( iv >= nv || ( iu < nu && u[iu] <= v[iv] ) )
+      return u[iu++];
+    else
+      return v[iv++];
+  };
+
+  for( std::size_t n = 0; n < na + nb; n++ )
+  {
+    auto x = next( a, i, na, b, j, nb );
+    auto y = next( c, k, nc, d, l, nd );
+
+    result += std::abs( x - y );
+  }
+
+  return result;
+}
+
+} // namespace detail
+
+/**
+  Calculates the sliced Wasserstein distance between two sketches of
+  persistence diagrams. The sketches must use the same number of
+  directions. A single evaluation requires linear time in the number of
+  points for every direction.
+*/
+
+inline double slicedWassersteinDistance( const SlicedWassersteinSketch& S1,
+                                         const SlicedWassersteinSketch& S2 )
+{
+  if( S1.directions() != S2.directions() )
+    throw std::runtime_error( "Number of directions does not coincide" );
+
+  aleph::math::KahanSummation<double> sum = 0.0;
+
+  for( unsigned k = 0; k < S1.directions(); k++ )
+  {
+    // The first diagram is augmented by the diagonal points of the second
+    // diagram, and vice versa, so that both sets have the same size.
+    sum += detail::slicedDistance( S1.points( k ),   S1.size(),
+                                   S2.diagonal( k ), S2.size(),
+                                   S2.points( k ),   S2.size(),
+                                   S1.diagonal( k ), S1.size() );
+  }
+
+  return sum / S1.directions();
+}
+
+/**
+  Calculates the sliced Wasserstein distance between two persistence
+  diagrams, using a given number of directions. When many distances need
+  to be calculated, using the sketches directly is more efficient.
+*/
+
+template <class T> double slicedWassersteinDistance( const PersistenceDiagram<T>& D1,
+                                                     const PersistenceDiagram<T>& D2,
+                                                     unsigned directions = 50 )
+{
+  return slicedWassersteinDistance( SlicedWassersteinSketch( D1, directions ),
+                                    SlicedWassersteinSketch( D2, directions ) );
+}
+
+/**
+  Calculates the sliced Wasserstein kernel between two persistence
+  diagrams, i.e. a Gaussian of their sliced Wasserstein distance.
+*/
+
+inline double slicedWassersteinKernel( const SlicedWassersteinSketch& S1,
+                                       const SlicedWassersteinSketch& S2,
+                                       double sigma )
+{
+  auto d = slicedWassersteinDistance( S1, S2 );
+  return std::exp( -d / ( 2 * sigma * sigma ) );
+}
+
+template <class T> double slicedWassersteinKernel( const PersistenceDiagram<T>& D1,
+                                                   const PersistenceDiagram<T>& D2,
+                                                   double sigma,
+                                                   unsigned directions = 50 )
+{
+  return slicedWassersteinKernel( SlicedWassersteinSketch( D1, directions ),
+                                  SlicedWassersteinSketch( D2, directions ),
+                                  sigma );
+}
+
+/**
+  Calculates the matrix of all pairwise sliced Wasserstein distances
+  between a range of persistence diagrams. Every diagram is sketched only
+  once. The pairs are processed in parallel.
+*/
+
+template <class InputIterator> std::vector< std::vector<double> > slicedWassersteinDistances( InputIterator begin,
+                                                                                             InputIterator end,
+                                                                                             unsigned directions = 50 )
+{
+  auto n = static_cast<std::size_t>( std::distance( begin, end ) );
+
+  std::vector<SlicedWassersteinSketch> sketches;
+  sketches.reserve( n );
+
+  for( auto it = begin; it != end; ++it )
+    sketches.emplace_back( *it, directions );
+
+  std::vector< std::vector<double> > distances( n, std::vector<double>( n ) );
+
+  #pragma omp parallel for schedule(dynamic)
+  for( std::size_t row = 0; row < n; row++ )
+  {
+    for( std::size_t col = row + 1; col < n; col++ )
+    {
+      auto d = slicedWassersteinDistance( sketches[row], sketches[col] );
+
+      distances[row][col] = d;
+      distances[col][row] = d;
+    }
+  }
+
+  return distances;
+}
+
+/**
+  Calculates the Gram matrix of the sliced Wasserstein kernel for a range
+  of persistence diagrams.
+*/
+
+template <class InputIterator> std::vector< std::vector<double> > slicedWassersteinGramMatrix( InputIterator begin,
+                                                                                              InputIterator end,
+                                                                                              double sigma,
+                                                                                              unsigned directions = 50 )
+{
+  auto K = slicedWassersteinDistances( begin, end, directions );
+
+  for( auto&& row : K )
+  {
+    for( auto&& value : row )
+      value = std::exp( -value / ( 2 * sigma * sigma ) );
+  }
+
+  return K;
+}
+
+} // namespace aleph
+
+#endif
@@ -4,12 +4,16 @@
 #include <aleph/geometry/distances/Infinity.hh>
 
 #include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+#include <aleph/persistenceDiagrams/distances/detail/HopcroftKarp.hh>
+#include <aleph/persistenceDiagrams/distances/detail/KDTree.hh>
 #include <aleph/persistenceDiagrams/distances/detail/Orthogonal.hh>
 
-#include <boost/iterator/counting_iterator.hpp>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <vector>
 
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/max_cardinality_matching.hpp>
+#include <cmath>
 
 namespace aleph
 {
@@ -17,89 +21,6 @@ namespace aleph
 namespace distances
 {
 
-namespace detail
-{
-
-template <class T> struct Edge
-{
-  std::size_t source;
-  std::size_t target;
-
-  T weight;
-
-  Edge( std::size_t s, std::size_t t, T w )
-    : source( s )
-    , target( t )
-    , weight( w )
-  {
-  }
-
-  bool operator<( const Edge& other ) const
-  {
-    return weight < other.weight;
-  }
-};
-
-template <class T> struct CheckMatchingCardinality
-{
-  using GraphType          = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
-  using MatchingVectorType = std::vector<boost::graph_traits<GraphType>::vertex_descriptor>;
-
-  CheckMatchingCardinality( std::size_t size, typename std::vector<Edge<T> >::const_iterator begin )
-    : _maximumSize( size )
-    , _last( begin )
-    , _graph( 2 * size )
-    , _mates( 2 * size )
-  {
-    boost::add_edge( begin->source, begin->target, _graph );
-  }
-
-  bool operator()( typename std::vector<Edge<T> >::const_iterator /* it1 */, typename std::vector<Edge<T> >::const_iterator it2 )
-  {
-    // The new edge lies beyond the edges that are already known, so the
-    // edges between the last edge and the new iterator position need to
-    // be added.
-    if( it2 > _last )
-    {
-      do
-      {
-        ++_last;
-        boost::add_edge( _last->source, _last->target, _graph );
-      }
-      while( _last != it2 );
-    }
-
-    // The new edge lies behind the edges that are already known, so the
-    // surplus edges need to be removed.
-    else
-    {
-      do
-      {
-        boost::remove_edge( _last->source, _last->target, _graph );
-        --_last;
-      }
-      while( _last != it2 );
-    }
-
-    boost::edmonds_maximum_cardinality_matching( _graph,
-                                                 &_mates[0] );
-
-    // Look out for _perfect matchings_ in the bipartite graph. Any other
-    // maximum cardinality matching does not qualify for the Bottleneck
-    // distance.
-    return boost::matching_size( _graph, &_mates[0] ) == _maximumSize;
-  }
-
-  std::size_t _maximumSize;
-
-  typename std::vector<Edge<T> >::const_iterator _last;
-
-  GraphType          _graph; // Input data
-  MatchingVectorType _mates; // Edges of the matching
-};
-
-} // namespace detail
-
 /**
   Calculates the Bottleneck distance between two persistence diagrams.
   The algorithm used for this involves checking a (complete) bipartite
@@ -112,97 +33,192 @@ template <class T> struct CheckMatchingCardinality
 
   on page 191.
 
-  The implementation has been inspired by Dmitriy Morozov's "Dionysus"
-  framework.
+  Instead of creating all edges of the bipartite graph, the perfect
+  matchings are found by a geometric variant of the Hopcroft--Karp
+  algorithm that queries a kd-tree for neighbours. The matching of a
+  threshold is re-used for the next threshold of the search.
 
-  @param D1 First persistence diagram
-  @param D2 Second persistence diagram
+  Unpaired points can only be matched with each other. Their cost is
+  calculated separately by matching them in the order of their creation
+  values.
+
+  @param D1      First persistence diagram
+  @param D2      Second persistence diagram
+  @param epsilon Relative error; if set to a positive value, the search
+                 stops as soon as the distance is known up to a factor of
+                 (1+epsilon), and an upper bound is returned. Otherwise,
+                 the exact distance is calculated.
 
   @returns Bottleneck distance between the two persistence diagrams
 */
 
-
 template <
   class DataType,
   class Distance = InfinityDistance<DataType>
 > DataType bottleneckDistance( const PersistenceDiagram<DataType>& D1,
-                               const PersistenceDiagram<DataType>& D2 )
+                               const PersistenceDiagram<DataType>& D2,
+                               DataType epsilon = DataType() )
 {
-  auto n           = D1.size();
-  auto m           = D2.size();
-  auto maximumSize = n + m;
+  using Point = typename PersistenceDiagram<DataType>::Point;
 
-  using SizeType = decltype(n);
-  using Edge     = detail::Edge<DataType>;
+  // Unpaired points ---------------------------------------------------
 
-  std::vector<Edge> edges;
+  std::vector<Point> P;
+  std::vector<Point> Q;
 
-  // Diagonal edges ----------------------------------------------------
+  std::vector<DataType> unpairedP;
+  std::vector<DataType> unpairedQ;
 
-  for( SizeType i = n; i < maximumSize; i++ )
-    for( SizeType j = maximumSize + i; j < 2 * maximumSize; j++ )
-      edges.push_back( Edge( static_cast<std::size_t>(i), static_cast<std::size_t>(j), DataType() ) );
+  for( auto&& p : D1 )
+  {
+    if( p.isUnpaired() )
+      unpairedP.push_back( p.x() );
+    else
+      P.push_back( p );
+  }
+
+  for( auto&& q : D2 )
+  {
+    if( q.isUnpaired() )
+      unpairedQ.push_back( q.x() );
+    else
+      Q.push_back( q );
+  }
 
-  SizeType i = 0;
+  if( unpairedP.size() != unpairedQ.size() )
+  {
+    return std::numeric_limits<DataType>::has_infinity ? std::numeric_limits<DataType>::infinity()
+                                                       : std::numeric_limits<DataType>::max();
+  }
 
-  // Edges between regular points --------------------------------------
+  std::sort( unpairedP.begin(), unpairedP.end() );
+  std::sort( unpairedQ.begin(), unpairedQ.end() );
 
-  Distance distance;
+  DataType unpairedCost = DataType();
 
-  for( auto it1 = D1.begin(); it1 != D1.end(); ++it1 )
+  for( std::size_t i = 0; i < unpairedP.size(); i++ )
   {
-    auto j = maximumSize;
+    auto d       = unpairedP[i] >= unpairedQ[i] ? unpairedP[i] - unpairedQ[i] : unpairedQ[i] - unpairedP[i];
+    unpairedCost = std::max( unpairedCost, d );
+  }
 
-    for( auto it2 = D2.begin(); it2 != D2.end(); ++it2 )
-    {
-      auto weight = distance( *it1, *it2 );
+  if( P.empty() && Q.empty() )
+    return unpairedCost;
 
-      edges.push_back( Edge( static_cast<std::size_t>(i), static_cast<std::size_t>(j),
-                             weight ) );
+  // Search for matchings ----------------------------------------------
+  //
+  // Matching every point with its projection is always possible, so the
+  // largest distance to the diagonal is an upper bound. The search is a
+  // bisection over this interval, using the geometric matching algorithm
+  // as the decision procedure.
 
-      ++j;
-    }
+  detail::HopcroftKarp<Point, Distance> matching( P, Q );
 
-    ++i;
-  }
+  DataType lower = DataType();
+  DataType upper = DataType();
+
+  for( auto&& p : P )
+    upper = std::max( upper, detail::orthogonalDistance<Distance>( p ) );
+
+  for( auto&& q : Q )
+    upper = std::max( upper, detail::orthogonalDistance<Distance>( q ) );
 
-  // Edges between points and their projections ------------------------
+  if( matching( lower ) )
+    return unpairedCost;
 
-  i = 0;
+  // For the exact calculation, the bisection only needs to narrow down
+  // the interval until it contains few edge weights. Afterwards, these
+  // are enumerated explicitly.
+  DataType tolerance = epsilon > DataType() ? epsilon : DataType( std::sqrt( std::numeric_limits<DataType>::epsilon() ) );
 
-  for( auto it1 = D1.begin(); it1 != D1.end(); ++it1 )
+  while( upper - lower > tolerance * lower )
   {
-    edges.push_back( Edge( static_cast<std::size_t>(i), static_cast<std::size_t>(maximumSize + m + i),
-                           aleph::distances::detail::orthogonalDistance<Distance>( *it1 ) ) );
+    auto middle = lower + ( upper - lower ) / 2;
 
-    ++i;
+    if( middle <= lower || middle >= upper )
+      break;
+
+    if( matching( middle ) )
+      upper = middle;
+    else
+      lower = middle;
   }
 
-  i = maximumSize;
+  if( epsilon > DataType() )
+    return std::max( upper, unpairedCost );
+
+  // Collect candidate edge weights ------------------------------------
+  //
+  // The distance is attained by an edge whose weight lies in the half-open
+  // interval (lower, upper]. Only edges within this interval are of
+  // interest.
+
+  std::vector<DataType> weights;
 
-  for( auto it2 = D2.begin(); it2 != D2.end(); ++it2 )
   {
-    edges.push_back( Edge( static_cast<std::size_t>(n + i - maximumSize), static_cast<std::size_t>(i),
-                           aleph::distances::detail::orthogonalDistance<Distance>( *it2 ) ) );
+    std::vector<DataType> x;
+    std::vector<DataType> y;
+
+    for( auto&& q : Q )
+    {
+      x.push_back( q.x() );
+      y.push_back( q.y() );
+    }
+
+    detail::KDTree<DataType> tree( x, y );
+    std::vector<std::size_t> indices;
+
+    Distance dist;
+
+    for( auto&& p : P )
+    {
+      indices.clear();
+      tree.range( p.x(), p.y(), upper, std::back_inserter( indices ) );
+
+      for( auto&& index : indices )
+      {
+        auto d = dist( p, Q[index] );
+        if( d > lower && d <= upper )
+          weights.push_back( d );
+      }
+    }
+
+    for( auto&& p : P )
+    {
+      auto d = detail::orthogonalDistance<Distance>( p );
+      if( d > lower && d <= upper )
+        weights.push_back( d );
+    }
+
+    for( auto&& q : Q )
+    {
+      auto d = detail::orthogonalDistance<Distance>( q );
+      if( d > lower && d <= upper )
+        weights.push_back( d );
+    }
   }
 
-  // Identify matchings ------------------------------------------------
+  std::sort( weights.begin(), weights.end() );
+  weights.erase( std::unique( weights.begin(), weights.end() ), weights.end() );
 
-  std::sort( edges.begin(), edges.end() );
+  // Binary search over the remaining weights. The upper bound is always
+  // a valid solution, even though it need not be an edge weight.
 
-  // Perform binary search over edge sets. Starting from the empty graph, use
-  // more and more edges to find out the first graph that permits a maximum
-  // cardinality matching.
+  std::size_t lo = 0;
+  std::size_t hi = weights.size();
 
-  using EdgeIteratorType     = typename std::vector<Edge>::const_iterator;
-  using CountingIteratorType = boost::counting_iterator<EdgeIteratorType>;
+  while( lo < hi )
+  {
+    auto mid = lo + ( hi - lo ) / 2;
 
-  auto itEdge = std::upper_bound( CountingIteratorType( edges.begin() ),
-                                  CountingIteratorType( edges.end() ),
-                                  edges.begin(),
-                                  detail::CheckMatchingCardinality<DataType>( maximumSize, edges.begin() ) );
+    if( matching( weights[mid] ) )
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
 
-  return (*itEdge)->weight;
+  auto result = lo < weights.size() ? weights[lo] : upper;
+  return std::max( result, unpairedCost );
 }
 
 } // namespace distances
@@ -4,12 +4,14 @@
 #include <aleph/geometry/distances/Infinity.hh>
 #include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
 
-#include <aleph/persistenceDiagrams/distances/detail/Munkres.hh>
+#include <aleph/persistenceDiagrams/distances/detail/Auction.hh>
+#include <aleph/persistenceDiagrams/distances/detail/JonkerVolgenant.hh>
 #include <aleph/persistenceDiagrams/distances/detail/Orthogonal.hh>
 
 #include <algorithm>
 #include <limits>
 #include <stdexcept>
+#include <vector>
 
 #include <cmath>
 
@@ -19,121 +21,151 @@ namespace aleph
 namespace distances
 {
 
-template <
-  class DataType,
-  class Distance = InfinityDistance<DataType>
-> DataType wassersteinDistance( const PersistenceDiagram<DataType>& D1,
-                                const PersistenceDiagram<DataType>& D2,
-                                DataType power = DataType( 1 ) )
+namespace detail
 {
-  if( D1.dimension() != D2.dimension() )
-    throw std::runtime_error( "Dimensions do not coincide" );
-
-  auto size = D1.size() + D2.size();
 
-  detail::Matrix<DataType> costs( size );
+/**
+  @struct WassersteinDiagram
+  @brief Persistence diagram prepared for Wasserstein distance calculations
 
-  using IndexType = decltype( costs.n() );
+  Unpaired points can only be matched with each other, so they are stored
+  separately, sorted by their creation values; matching them in this order
+  is optimal. The distances of all paired points to the diagonal, raised
+  to the power of the distance, are calculated only once. This permits
+  re-using a diagram in many distance calculations.
+*/
 
-  IndexType row = IndexType();
-  IndexType col = IndexType();
-
-  Distance dist;
+template <
+  class DataType,
+  class Distance = InfinityDistance<DataType>
+> struct WassersteinDiagram
+{
+  using Point     = typename PersistenceDiagram<DataType>::Point;
+  using Assignment = JonkerVolgenant<Point, Distance>;
 
-  // Regular block of matrix -------------------------------------------
-  //
-  // This block stores the distances between individual points of the
-  // respective persistence diagrams.
+  WassersteinDiagram() = default;
 
-  for( auto&& p1 : D1 )
+  WassersteinDiagram( const PersistenceDiagram<DataType>& D, DataType power )
+    : dimension( D.dimension() )
   {
-    col = IndexType();
-
-    for( auto&& p2 : D2 )
+    for( auto&& p : D )
     {
-      auto d = std::pow( dist( p1, p2 ), power );
-
-      costs( row, col ) = d;
+      if( p.isUnpaired() )
+        unpaired.push_back( p.x() );
+      else
+        points.push_back( p );
+    }
 
-      // This block needs to be completely zero, as it contains the distances
-      // between the individual orthogonal projections of the points.
-      costs( col + D1.size(), row + D2.size() ) = DataType();
+    std::sort( unpaired.begin(), unpaired.end() );
 
-      ++col;
-    }
+    orthogonal = Assignment::orthogonalDistances( points, static_cast<double>( power ) );
+  }
 
-    ++row;
+  /** @returns Total number of points */
+  std::size_t size() const noexcept
+  {
+    return points.size() + unpaired.size();
   }
 
-  // Orthogonal projection of the first diagram ------------------------
+  std::size_t dimension = 0;
 
-  row = IndexType();
-  col = D2.size();
+  std::vector<Point> points;       // Paired points
+  std::vector<DataType> unpaired;  // Creation values of unpaired points, sorted
+  std::vector<double> orthogonal;  // Powered distances of paired points to the diagonal
+};
 
-  for( auto&& p1 : D1 )
-  {
-    row = IndexType();
+/**
+  Calculates the Wasserstein distance between two prepared persistence
+  diagrams, which have to be prepared for the same power. A positive
+  relative error selects the auction algorithm; otherwise, the distance
+  is calculated exactly.
+*/
 
-    for( auto&& p2 : D1 )
-    {
-      DataType d = DataType();
+template <
+  class DataType,
+  class Distance
+> DataType wassersteinDistance( const WassersteinDiagram<DataType, Distance>& D1,
+                                const WassersteinDiagram<DataType, Distance>& D2,
+                                DataType power,
+                                DataType relativeError )
+{
+  using Point = typename PersistenceDiagram<DataType>::Point;
 
-      if( p1 == p2 )
-        d = std::pow( detail::orthogonalDistance<Distance>( p1 ), power );
-      else
-        d = std::numeric_limits<DataType>::max();
+  if( D1.dimension != D2.dimension )
+    throw std::runtime_error( "Dimensions do not coincide" );
 
-      costs( row, col ) = d;
+  if( D1.unpaired.size() != D2.unpaired.size() )
+  {
+    return std::numeric_limits<DataType>::has_infinity ? std::numeric_limits<DataType>::infinity()
+                                                       : std::numeric_limits<DataType>::max();
+  }
 
-      ++row;
-    }
+  double unpairedCost = 0.0;
 
-    ++col;
+  for( std::size_t i = 0; i < D1.unpaired.size(); i++ )
+  {
+    auto x        = D1.unpaired[i];
+    auto y        = D2.unpaired[i];
+    auto d        = x >= y ? x - y : y - x;
+    unpairedCost += std::pow( static_cast<double>( d ), static_cast<double>( power ) );
   }
 
-  // Orthogonal projection of the second diagram -----------------------
-
-  row = D1.size();
-  col = IndexType();
+  double totalCosts = unpairedCost;
 
-  for( auto&& p1 : D2 )
+  if( relativeError > DataType() )
   {
-    col = IndexType();
+    Auction<Point, Distance> auction( D1.points, D2.points,
+                                      D1.orthogonal, D2.orthogonal,
+                                      static_cast<double>( power ),
+                                      static_cast<double>( relativeError ) );
 
-    for( auto&& p2 : D2 )
-    {
-      DataType d = DataType();
-
-      if( p1 == p2 )
-        d = std::pow( detail::orthogonalDistance<Distance>( p1 ), power );
-      else
-        d = std::numeric_limits<DataType>::max();
+    totalCosts += auction();
+  }
+  else
+  {
+    JonkerVolgenant<Point, Distance> solver( D1.points, D2.points,
+                                             D1.orthogonal, D2.orthogonal,
+                                             static_cast<double>( power ) );
 
-      costs( row, col ) = d;
+    totalCosts += solver();
+  }
 
-      ++col;
-    }
+  return static_cast<DataType>( std::pow( totalCosts, 1 / static_cast<double>( power ) ) );
+}
 
-    ++row;
-  }
+} // namespace detail
 
-  // Assignment problem solving ----------------------------------------
+/**
+  Calculates the Wasserstein distance between two persistence diagrams.
 
-  detail::Munkres<DataType> solver( costs );
+  By default, the distance is calculated exactly by solving the assignment
+  problem with a shortest augmenting path method. Setting a positive
+  relative error instead uses the auction algorithm with epsilon-scaling
+  and geometric queries, which is considerably faster for large diagrams.
+  The auction stops as soon as the distance is known up to the given
+  relative error.
 
-  auto M              = solver();
-  DataType totalCosts = DataType();
+  @param D1            First persistence diagram
+  @param D2            Second persistence diagram
+  @param power         Exponent of the Wasserstein distance
+  @param relativeError Maximum relative error; zero requests the exact
+                       distance
 
-  for( row = IndexType(); row < M.n(); row++ )
-  {
-    for( col = IndexType(); col < M.n(); col++ )
-    {
-      if( M( row, col ) == IndexType() )
-        totalCosts += costs( row, col );
-    }
-  }
+  @returns Wasserstein distance between the two persistence diagrams
+*/
 
-  return std::pow( totalCosts, 1 / power );
+template <
+  class DataType,
+  class Distance = InfinityDistance<DataType>
+> DataType wassersteinDistance( const PersistenceDiagram<DataType>& D1,
+                                const PersistenceDiagram<DataType>& D2,
+                                DataType power = DataType( 1 ),
+                                DataType relativeError = DataType() )
+{
+  return detail::wassersteinDistance( detail::WassersteinDiagram<DataType, Distance>( D1, power ),
+                                      detail::WassersteinDiagram<DataType, Distance>( D2, power ),
+                                      power,
+                                      relativeError );
 }
 
 } // namespace distances
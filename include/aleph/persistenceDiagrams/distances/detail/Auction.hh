@@ -0,0 +1,502 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_DISTANCES_DETAIL_AUCTION_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_DISTANCES_DETAIL_AUCTION_HH__
+
+#include <aleph/persistenceDiagrams/distances/detail/KDTree.hh>
+#include <aleph/persistenceDiagrams/distances/detail/Orthogonal.hh>
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace distances
+{
+
+namespace detail
+{
+
+/**
+  @class Auction
+  @brief Auction algorithm for the Wasserstein distance of two diagrams
+
+  Solves the assignment problem between two persistence diagrams using
+  the auction algorithm with epsilon-scaling, as described in
+
+    Geometry Helps to Compare Persistence Diagrams
+    Michael Kerber, Dmitriy Morozov, and Arnur Nigmetov
+    Journal of Experimental Algorithmics 22, 2017
+
+  Bidders are the points of the first diagram, followed by the projections
+  of the points of the second diagram. Items are the points of the second
+  diagram, followed by the projections of the points of the first diagram.
+  Since all diagonal points are interchangeable, a point may be assigned to
+  any projection at the cost of its distance to the diagonal.
+
+  The best items for a bidder are determined without scanning all items:
+  the points of the second diagram are stored in a kd-tree whose weights
+  are the prices of the items, while the projections are kept in ordered
+  sets. The L-infinity distance to a bounding box is used for pruning the
+  kd-tree, so the distance functor must be bounded from below by it.
+
+  Epsilon-scaling is performed until the relative error of the distance,
+  estimated using the dual solution, drops below the requested value.
+*/
+
+template <class Point, class Distance> class Auction
+{
+public:
+  using IndexType = std::size_t;
+  using ValueType = double;
+  using Pair      = std::pair<IndexType, IndexType>;
+
+  static constexpr IndexType npos = std::numeric_limits<IndexType>::max();
+
+  /**
+    Creates a new auction between two sets of points.
+
+    @param P             Points of the first diagram
+    @param Q             Points of the second diagram
+    @param power         Exponent of the Wasserstein distance
+    @param relativeError Maximum relative error of the distance
+  */
+
+  Auction( const std::vector<Point>& P, const std::vector<Point>& Q,
+           ValueType power,
+           ValueType relativeError )
+    : Auction( P, Q,
+               orthogonalDistances( P, power ),
+               orthogonalDistances( Q, power ),
+               power,
+               relativeError )
+  {
+  }
+
+  /**
+    Creates a new auction between two sets of points whose distances to
+    the diagonal, raised to the given power, are already known. This is
+    useful if the same diagram takes part in many auctions.
+
+    @param P             Points of the first diagram
+    @param Q             Points of the second diagram
+    @param orthogonalP   Powered distances of the first diagram to the diagonal
+    @param orthogonalQ   Powered distances of the second diagram to the diagonal
+    @param power         Exponent of the Wasserstein distance
+    @param relativeError Maximum relative error of the distance
+  */
+
+  Auction( const std::vector<Point>& P, const std::vector<Point>& Q,
+           const std::vector<ValueType>& orthogonalP,
+           const std::vector<ValueType>& orthogonalQ,
+           ValueType power,
+           ValueType relativeError )
+    : _P( P )
+    , _Q( Q )
+    , _n( P.size() )
+    , _m( Q.size() )
+    , _power( power )
+    , _relativeError( relativeError )
+    , _orthogonalP( orthogonalP )
+    , _orthogonalQ( orthogonalQ )
+    , _prices( _n + _m, ValueType() )
+    , _bidderToItem( _n + _m, npos )
+    , _itemToBidder( _n + _m, npos )
+  {
+    std::vector<ValueType> x;
+    std::vector<ValueType> y;
+
+    x.reserve( _m );
+    y.reserve( _m );
+
+    for( auto&& q : _Q )
+    {
+      x.push_back( static_cast<ValueType>( q.x() ) );
+      y.push_back( static_cast<ValueType>( q.y() ) );
+    }
+
+    _tree = KDTree<ValueType>( x, y );
+
+    for( IndexType j = 0; j < _m; j++ )
+      _normalItems.insert( std::make_pair( _orthogonalQ[j], j ) );
+
+    for( IndexType j = _m; j < _m + _n; j++ )
+      _diagonalItems.insert( std::make_pair( ValueType(), j ) );
+  }
+
+  /** @returns Distances of all points to the diagonal, raised to the given power */
+  static std::vector<ValueType> orthogonalDistances( const std::vector<Point>& P, ValueType power )
+  {
+    std::vector<ValueType> distances;
+    distances.reserve( P.size() );
+
+    for( auto&& p : P )
+      distances.push_back( std::pow( static_cast<ValueType>( orthogonalDistance<Distance>( p ) ), power ) );
+
+    return distances;
+  }
+
+  /**
+    Runs the auction and returns the cost of the assignment, i.e. the sum
+    of all costs raised to the given power.
+  */
+
+  ValueType operator()()
+  {
+    ValueType maxCost = ValueType();
+
+    for( auto&& c : _orthogonalP )
+      maxCost = std::max( maxCost, c );
+
+    for( auto&& c : _orthogonalQ )
+      maxCost = std::max( maxCost, c );
+
+    // All points lie on the diagonal (or there are no points at all), so
+    // the trivial assignment is optimal.
+    if( maxCost == ValueType() )
+    {
+      for( IndexType b = 0; b < _n + _m; b++ )
+        this->assign( b, b < _n ? _m + b : b - _n );
+
+      _cost = ValueType();
+      return _cost;
+    }
+
+    ValueType epsilon    = maxCost / 4;
+    ValueType minEpsilon = maxCost * std::numeric_limits<ValueType>::epsilon();
+
+    while( true )
+    {
+      this->run( epsilon );
+
+      _cost           = this->cost();
+      auto lowerBound = std::max( this->lowerBound(), ValueType() );
+
+      if( _cost <= ValueType() )
+        break;
+
+      if( lowerBound > ValueType() )
+      {
+        auto d = std::pow( _cost,      1 / _power );
+        auto l = std::pow( lowerBound, 1 / _power );
+
+        if( ( d - l ) / l <= _relativeError )
+          break;
+      }
+
+      if( epsilon <= minEpsilon )
+        break;
+
+      epsilon /= 5;
+    }
+
+    return _cost;
+  }
+
+  /**
+    Reports the assignment as pairs of indices. The pairs use the indexing
+    of the dense formulation of the assignment problem: rows are the points
+    of the first diagram, followed by the projections of the second one,
+    while columns are the points of the second diagram, followed by the
+    projections of the first diagram. A point is always reported together
+    with its own projection. Pairs are sorted by their row.
+  */
+
+  std::vector<Pair> pairs() const
+  {
+    std::vector<Pair> result;
+    result.reserve( _n + _m );
+
+    std::vector<bool> usedRows( _n + _m, false );
+    std::vector<bool> usedCols( _n + _m, false );
+
+    for( IndexType i = 0; i < _n; i++ )
+    {
+      auto item = _bidderToItem[i];
+      auto col  = item < _m ? item : _m + i;
+
+      result.push_back( std::make_pair( i, col ) );
+
+      usedRows[i]   = true;
+      usedCols[col] = true;
+    }
+
+    for( IndexType j = 0; j < _m; j++ )
+    {
+      if( !usedCols[j] )
+      {
+        result.push_back( std::make_pair( _n + j, j ) );
+
+        usedRows[_n + j] = true;
+        usedCols[j]      = true;
+      }
+    }
+
+    // The remaining projections are matched with each other, which does
+    // not incur any costs.
+    IndexType col = _m;
+
+    for( IndexType row = _n; row < _n + _m; row++ )
+    {
+      if( usedRows[row] )
+        continue;
+
+      while( usedCols[col] )
+        ++col;
+
+      result.push_back( std::make_pair( row, col ) );
+      usedCols[col] = true;
+    }
+
+    std::sort( result.begin(), result.end() );
+    return result;
+  }
+
+private:
+
+  // Performs a single auction with a fixed epsilon until all bidders have
+  // been assigned to an item. Prices are kept from previous rounds.
+  void run( ValueType epsilon )
+  {
+    std::fill( _bidderToItem.begin(), _bidderToItem.end(), npos );
+    std::fill( _itemToBidder.begin(), _itemToBidder.end(), npos );
+
+    std::vector<IndexType> unassigned;
+    unassigned.reserve( _n + _m );
+
+    for( IndexType b = _n + _m; b > 0; b-- )
+      unassigned.push_back( b - 1 );
+
+    while( !unassigned.empty() )
+    {
+      auto bidder = unassigned.back();
+      unassigned.pop_back();
+
+      IndexType best   = npos;
+      IndexType second = npos;
+      ValueType bestValue   = ValueType();
+      ValueType secondValue = ValueType();
+
+      this->bestTwo( bidder, best, bestValue, second, secondValue );
+
+      if( second == npos )
+        secondValue = bestValue;
+
+      auto price = _prices[best] + ( secondValue - bestValue ) + epsilon;
+
+      // Prevent stalling due to the limited precision of prices
+      if( price <= _prices[best] )
+        price = std::nextafter( _prices[best], std::numeric_limits<ValueType>::max() );
+
+      this->setPrice( best, price );
+
+      auto previous = _itemToBidder[best];
+      if( previous != npos )
+      {
+        _bidderToItem[previous] = npos;
+        unassigned.push_back( previous );
+      }
+
+      this->assign( bidder, best );
+    }
+  }
+
+  void assign( IndexType bidder, IndexType item )
+  {
+    _bidderToItem[bidder] = item;
+    _itemToBidder[item]   = bidder;
+  }
+
+  void setPrice( IndexType item, ValueType price )
+  {
+    if( item < _m )
+    {
+      _normalItems.erase( std::make_pair( _orthogonalQ[item] + _prices[item], item ) );
+      _normalItems.insert( std::make_pair( _orthogonalQ[item] + price, item ) );
+
+      _tree.setWeight( item, price );
+    }
+    else
+    {
+      _diagonalItems.erase( std::make_pair( _prices[item], item ) );
+      _diagonalItems.insert( std::make_pair( price, item ) );
+    }
+
+    _prices[item] = price;
+  }
+
+  // Calculates the cost of assigning a bidder to an item
+  ValueType cost( IndexType bidder, IndexType item ) const
+  {
+    if( bidder < _n )
+    {
+      if( item < _m )
+        return std::pow( static_cast<ValueType>( Distance()( _P[bidder], _Q[item] ) ), _power );
+      else
+        return _orthogonalP[bidder];
+    }
+    else
+    {
+      if( item < _m )
+        return _orthogonalQ[item];
+      else
+        return ValueType();
+    }
+  }
+
+  // Calculates the total cost of the current assignment
+  ValueType cost() const
+  {
+    ValueType result = ValueType();
+
+    for( IndexType b = 0; b < _n + _m; b++ )
+      result += this->cost( b, _bidderToItem[b] );
+
+    return result;
+  }
+
+  // Calculates a lower bound of the optimal cost from the current prices,
+  // using the dual of the assignment problem.
+  ValueType lowerBound() const
+  {
+    ValueType result = ValueType();
+
+    for( IndexType b = 0; b < _n + _m; b++ )
+    {
+      IndexType best   = npos;
+      IndexType second = npos;
+      ValueType bestValue   = ValueType();
+      ValueType secondValue = ValueType();
+
+      this->bestTwo( b, best, bestValue, second, secondValue );
+      result += bestValue;
+    }
+
+    for( auto&& price : _prices )
+      result -= price;
+
+    return result;
+  }
+
+  // Determines the two items that minimize the sum of the assignment cost
+  // and the price for a given bidder.
+  void bestTwo( IndexType bidder,
+                IndexType& best, ValueType& bestValue,
+                IndexType& second, ValueType& secondValue ) const
+  {
+    best        = npos;
+    second      = npos;
+    bestValue   = std::numeric_limits<ValueType>::max();
+    secondValue = std::numeric_limits<ValueType>::max();
+
+    auto update = [&] ( IndexType item, ValueType value )
+    {
+      if( item == npos )
+        return;
+
+      if( value < bestValue )
+      {
+        second      = best;
+        secondValue = bestValue;
+        best        = item;
+        bestValue   = value;
+      }
+      else if( value < secondValue )
+      {
+        second      = item;
+        secondValue = value;
+      }
+    };
+
+    // Diagonal items --------------------------------------------------
+    //
+    // All diagonal items have the same cost for a bidder, so only the two
+    // cheapest ones need to be considered.
+
+    {
+      auto offset = bidder < _n ? _orthogonalP[bidder] : ValueType();
+      auto it     = _diagonalItems.begin();
+
+      for( unsigned i = 0; i < 2 && it != _diagonalItems.end(); i++, ++it )
+        update( it->second, offset + it->first );
+    }
+
+    // Normal items ----------------------------------------------------
+
+    if( bidder < _n )
+    {
+      auto&& p = _P[bidder];
+      auto x   = static_cast<ValueType>( p.x() );
+      auto y   = static_cast<ValueType>( p.y() );
+
+      auto costFunction = [this, &p] ( IndexType item )
+      {
+        return std::pow( static_cast<ValueType>( Distance()( p, _Q[item] ) ), _power );
+      };
+
+      auto boundFunction = [this, x, y] ( ValueType xMin, ValueType xMax, ValueType yMin, ValueType yMax )
+      {
+        auto dx = std::max( { xMin - x, x - xMax, ValueType() } );
+        auto dy = std::max( { yMin - y, y - yMax, ValueType() } );
+
+        return std::pow( std::max( dx, dy ), _power );
+      };
+
+      IndexType item1 = npos;
+      IndexType item2 = npos;
+      ValueType value1 = ValueType();
+      ValueType value2 = ValueType();
+
+      _tree.bestTwo( costFunction, boundFunction, item1, value1, item2, value2 );
+
+      update( item1, value1 );
+      update( item2, value2 );
+    }
+
+    // The costs of a diagonal bidder only depend on the item, so the items
+    // are already sorted accordingly.
+    else
+    {
+      auto it = _normalItems.begin();
+
+      for( unsigned i = 0; i < 2 && it != _normalItems.end(); i++, ++it )
+        update( it->second, it->first );
+    }
+  }
+
+  const std::vector<Point>& _P;
+  const std::vector<Point>& _Q;
+
+  std::size_t _n;
+  std::size_t _m;
+
+  ValueType _power;
+  ValueType _relativeError;
+  ValueType _cost = ValueType();
+
+  std::vector<ValueType> _orthogonalP; // Powered distances to the diagonal
+  std::vector<ValueType> _orthogonalQ; // Powered distances to the diagonal
+
+  std::vector<ValueType> _prices;
+  std::vector<IndexType> _bidderToItem;
+  std::vector<IndexType> _itemToBidder;
+
+  KDTree<ValueType> _tree;                                    // Normal items, weighted by their prices
+  std::set< std::pair<ValueType, IndexType> > _normalItems;   // Normal items, ordered by cost and price for diagonal bidders
+  std::set< std::pair<ValueType, IndexType> > _diagonalItems; // Diagonal items, ordered by price
+};
+
+template <class Point, class Distance> constexpr typename Auction<Point, Distance>::IndexType Auction<Point, Distance>::npos;
+
+} // namespace detail
+
+} // namespace distances
+
+} // namespace aleph
+
+#endif
@@ -0,0 +1,450 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_DISTANCES_DETAIL_HOPCROFT_KARP_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_DISTANCES_DETAIL_HOPCROFT_KARP_HH__
+
+#include <aleph/persistenceDiagrams/distances/detail/KDTree.hh>
+#include <aleph/persistenceDiagrams/distances/detail/Orthogonal.hh>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace distances
+{
+
+namespace detail
+{
+
+/**
+  @class HopcroftKarp
+  @brief Geometric bipartite matching for the bottleneck distance
+
+  Checks whether the bipartite graph of two persistence diagrams, whose
+  edges are restricted to a threshold, contains a perfect matching. The
+  graph is never materialized. Instead, neighbours are obtained by range
+  queries in a kd-tree, following the approach in
+
+    Geometry Helps in Bottleneck Matching and Related Problems
+    Alon Efrat, Alon Itai, and Matthew J. Katz
+    Algorithmica 31, pp. 1--28, 2001
+
+  The two sides of the graph are set up as usual for persistence diagram
+  distances. The first side contains the n points of the first diagram,
+  followed by the projections of the m points of the second diagram. The
+  second side contains the m points of the second diagram, followed by
+  the projections of the n points of the first diagram. A point may only
+  be matched to its own projection, whereas projections may be matched
+  with each other at zero cost.
+
+  The matching is kept between subsequent calls. Increasing a threshold
+  retains all matched edges, while decreasing it only removes the edges
+  that are too long. This makes the class suitable for searching over a
+  set of thresholds.
+*/
+
+template <class Point, class Distance> class HopcroftKarp
+{
+public:
+  using DataType  = decltype( Distance().operator()( std::declval<Point>(), std::declval<Point>() ) );
+  using IndexType = std::size_t;
+
+  static constexpr IndexType npos = std::numeric_limits<IndexType>::max();
+
+  HopcroftKarp( const std::vector<Point>& P, const std::vector<Point>& Q )
+    : _P( P )
+    , _Q( Q )
+    , _n( P.size() )
+    , _m( Q.size() )
+    , _mateA( _n + _m, npos )
+    , _mateB( _n + _m, npos )
+  {
+    _x.reserve( _m );
+    _y.reserve( _m );
+
+    for( auto&& q : _Q )
+    {
+      _x.push_back( q.x() );
+      _y.push_back( q.y() );
+    }
+
+    _tree = KDTree<DataType>( _x, _y );
+
+    _orthogonalP.reserve( _n );
+    _orthogonalQ.reserve( _m );
+
+    for( auto&& p : _P )
+      _orthogonalP.push_back( orthogonalDistance<Distance>( p ) );
+
+    for( auto&& q : _Q )
+      _orthogonalQ.push_back( orthogonalDistance<Distance>( q ) );
+  }
+
+  /** @returns Number of vertices on each side of the bipartite graph */
+  std::size_t size() const noexcept
+  {
+    return _n + _m;
+  }
+
+  /** @returns Current number of matched edges */
+  std::size_t matchingSize() const noexcept
+  {
+    return static_cast<std::size_t>( std::count_if( _mateA.begin(), _mateA.end(), [] ( IndexType b ) { return b != npos; } ) );
+  }
+
+  /**
+    Checks whether the graph whose edges have a weight of at most the given
+    threshold permits a perfect matching.
+  */
+
+  bool operator()( DataType threshold )
+  {
+    if( threshold < _threshold )
+    {
+      for( IndexType a = 0; a < _n + _m; a++ )
+      {
+        auto b = _mateA[a];
+        if( b != npos && this->weight( a, b ) > threshold )
+        {
+          _mateA[a] = npos;
+          _mateB[b] = npos;
+        }
+      }
+    }
+
+    _threshold = threshold;
+
+    auto size = this->matchingSize();
+
+    while( size < _n + _m )
+    {
+      auto augmentations = this->phase();
+      if( augmentations == 0 )
+        break;
+
+      size += augmentations;
+    }
+
+    return size == _n + _m;
+  }
+
+  /** @returns Weight of an edge between two vertices, or infinity if no edge exists */
+  DataType weight( IndexType a, IndexType b ) const
+  {
+    if( a < _n )
+    {
+      if( b < _m )
+        return Distance()( _P[a], _Q[b] );
+      else if( b - _m == a )
+        return _orthogonalP[a];
+    }
+    else
+    {
+      if( b >= _m )
+        return DataType();
+      else if( a - _n == b )
+        return _orthogonalQ[b];
+    }
+
+    return std::numeric_limits<DataType>::has_infinity ? std::numeric_limits<DataType>::infinity()
+                                                       : std::numeric_limits<DataType>::max();
+  }
+
+private:
+
+  // Performs a single phase of the algorithm, i.e. a layered breadth-first
+  // search followed by a depth-first search for vertex-disjoint augmenting
+  // paths. Returns the number of augmentations.
+  std::size_t phase()
+  {
+    auto infinity = std::numeric_limits<std::size_t>::max();
+
+    _layerA.assign( _n + _m, infinity );
+    _layerB.assign( _n + _m, infinity );
+
+    std::vector<IndexType> layer;
+
+    for( IndexType a = 0; a < _n + _m; a++ )
+    {
+      if( _mateA[a] == npos )
+      {
+        _layerA[a] = 0;
+        layer.push_back( a );
+      }
+    }
+
+    // Breadth-first search ----------------------------------------------
+    //
+    // Every vertex on the second side is visited at most once, so it can
+    // be removed from the search structures afterwards.
+
+    auto tree = _tree;
+
+    std::vector<IndexType> projections;
+    projections.reserve( _n );
+
+    for( IndexType i = 0; i < _n; i++ )
+      projections.push_back( _m + i );
+
+    std::vector<bool> visited( _n + _m, false );
+
+    bool found        = false;
+    std::size_t depth = 0;
+
+    auto visit = [&] ( IndexType b, std::vector<IndexType>& next )
+    {
+      visited[b] = true;
+      _layerB[b] = depth + 1;
+
+      if( _mateB[b] == npos )
+        found = true;
+      else
+      {
+        _layerA[ _mateB[b] ] = depth + 1;
+        next.push_back( _mateB[b] );
+      }
+    };
+
+    while( !layer.empty() && !found )
+    {
+      std::vector<IndexType> next;
+
+      for( auto&& a : layer )
+      {
+        this->neighbours( a, tree, projections, visited, [&] ( IndexType b ) { visit( b, next ); } );
+
+        if( projections.empty() && tree.empty() )
+          break;
+      }
+
+      layer.swap( next );
+      ++depth;
+    }
+
+    if( !found )
+      return 0;
+
+    // Depth-first search ------------------------------------------------
+    //
+    // The layered graph is stored implicitly. For every layer, a separate
+    // kd-tree contains the unused points of the second diagram. Used
+    // vertices are removed so that the paths are vertex-disjoint.
+
+    std::vector< std::vector<IndexType> > pointsPerLayer( depth + 1 );
+    std::vector< std::vector<IndexType> > projectionsPerLayer( depth + 1 );
+
+    for( IndexType b = 0; b < _n + _m; b++ )
+    {
+      if( _layerB[b] == infinity )
+        continue;
+
+      if( b < _m )
+        pointsPerLayer[ _layerB[b] ].push_back( b );
+      else
+        projectionsPerLayer[ _layerB[b] ].push_back( b );
+    }
+
+    std::vector< KDTree<DataType> > trees;
+    trees.reserve( depth + 1 );
+
+    for( auto&& indices : pointsPerLayer )
+      trees.emplace_back( _x, _y, indices );
+
+    std::vector<bool> used( _n + _m, false );
+    std::size_t augmentations = 0;
+
+    for( IndexType root = 0; root < _n + _m; root++ )
+    {
+      if( _mateA[root] != npos || _layerA[root] != 0 )
+        continue;
+
+      // Explicit stack of vertices of the first side and the vertices of
+      // the second side that have been used to reach them.
+      std::vector<IndexType> stack( 1, root );
+      std::vector<IndexType> path;
+
+      while( !stack.empty() )
+      {
+        auto a = stack.back();
+        auto l = _layerA[a];
+
+        if( l + 1 > depth )
+        {
+          stack.pop_back();
+          if( !path.empty() )
+            path.pop_back();
+
+          continue;
+        }
+
+        auto b = this->next( a, trees[l+1], projectionsPerLayer[l+1], used );
+
+        if( b == npos )
+        {
+          stack.pop_back();
+          if( !path.empty() )
+            path.pop_back();
+
+          continue;
+        }
+
+        used[b] = true;
+        trees[l+1].remove( b );
+
+        if( _mateB[b] == npos )
+        {
+          path.push_back( b );
+
+          // Augment along the path; the path contains the vertices of the
+          // second side in the order of the stack.
+          for( std::size_t i = 0; i < stack.size(); i++ )
+          {
+            _mateA[ stack[i] ] = path[i];
+            _mateB[ path[i]  ] = stack[i];
+          }
+
+          ++augmentations;
+          break;
+        }
+        else
+        {
+          path.push_back( b );
+          stack.push_back( _mateB[b] );
+        }
+      }
+    }
+
+    return augmentations;
+  }
+
+  // Enumerates all unvisited neighbours of a vertex on the first side and
+  // removes them from the search structures.
+  template <class Functor> void neighbours( IndexType a,
+                                            KDTree<DataType>& tree,
+                                            std::vector<IndexType>& projections,
+                                            std::vector<bool>& visited,
+                                            Functor functor )
+  {
+    if( a < _n )
+    {
+      auto&& p = _P[a];
+
+      auto predicate = [&] ( IndexType b )
+      {
+        return Distance()( p, _Q[b] ) <= _threshold;
+      };
+
+      IndexType b = npos;
+      while( ( b = tree.find( p.x(), p.y(), _threshold, predicate ) ) != KDTree<DataType>::npos )
+      {
+        tree.remove( b );
+        functor( b );
+      }
+
+      if( !visited[_m + a] && _orthogonalP[a] <= _threshold )
+        functor( _m + a );
+    }
+    else
+    {
+      auto j = a - _n;
+
+      if( tree.contains( j ) && _orthogonalQ[j] <= _threshold )
+      {
+        tree.remove( j );
+        functor( j );
+      }
+
+      // All projections are neighbours of each other, so all of them are
+      // visited at once.
+      for( auto&& b : projections )
+      {
+        if( !visited[b] )
+          functor( b );
+      }
+
+      projections.clear();
+    }
+  }
+
+  // Searches for an unused neighbour of a vertex on the first side in the
+  // subsequent layer of the layered graph.
+  IndexType next( IndexType a,
+                  const KDTree<DataType>& tree,
+                  std::vector<IndexType>& projections,
+                  const std::vector<bool>& used )
+  {
+    if( a < _n )
+    {
+      auto&& p = _P[a];
+
+      auto predicate = [&] ( IndexType b )
+      {
+        return Distance()( p, _Q[b] ) <= _threshold;
+      };
+
+      auto b = tree.find( p.x(), p.y(), _threshold, predicate );
+      if( b != KDTree<DataType>::npos )
+        return b;
+
+      auto c = _m + a;
+      if( !used[c] && _layerB[c] == _layerA[a] + 1 && _orthogonalP[a] <= _threshold )
+        return c;
+    }
+    else
+    {
+      auto j = a - _n;
+
+      if( tree.contains( j ) && _orthogonalQ[j] <= _threshold )
+        return j;
+
+      // Projections are only ever used once, so they may be removed from
+      // the layer as soon as they have been encountered.
+      while( !projections.empty() )
+      {
+        auto b = projections.back();
+        projections.pop_back();
+
+        if( !used[b] )
+          return b;
+      }
+    }
+
+    return npos;
+  }
+
+  const std::vector<Point>& _P;
+  const std::vector<Point>& _Q;
+
+  std::size_t _n;
+  std::size_t _m;
+
+  std::vector<DataType> _x; // x-coordinates of the second diagram
+  std::vector<DataType> _y; // y-coordinates of the second diagram
+
+  std::vector<DataType> _orthogonalP;
+  std::vector<DataType> _orthogonalQ;
+
+  KDTree<DataType> _tree;
+
+  std::vector<IndexType> _mateA;
+  std::vector<IndexType> _mateB;
+
+  std::vector<std::size_t> _layerA;
+  std::vector<std::size_t> _layerB;
+
+  DataType _threshold = DataType();
+};
+
+template <class Point, class Distance> constexpr typename HopcroftKarp<Point, Distance>::IndexType HopcroftKarp<Point, Distance>::npos;
+
+} // namespace detail
+
+} // namespace distances
+
+} // namespace aleph
+
+#endif
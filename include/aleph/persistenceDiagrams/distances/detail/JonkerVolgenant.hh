@@ -0,0 +1,497 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_DISTANCES_DETAIL_JONKER_VOLGENANT_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_DISTANCES_DETAIL_JONKER_VOLGENANT_HH__
+
+#include <aleph/math/KahanSummation.hh>
+
+#include <aleph/persistenceDiagrams/distances/detail/Orthogonal.hh>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <cmath>
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace distances
+{
+
+namespace detail
+{
+
+/**
+  @class JonkerVolgenant
+  @brief Exact assignment solver for the Wasserstein distance of two diagrams
+
+  Solves the assignment problem between two persistence diagrams using the
+  shortest augmenting path method of
+
+    A Shortest Augmenting Path Algorithm for Dense and Sparse Linear
+    Assignment Problems
+    Roy Jonker and Anton Volgenant
+    Computing 38, pp. 325--340, 1987
+
+  The cost matrix is never stored. Rows are the points of the first diagram,
+  followed by the projections of the points of the second diagram. Columns
+  are the points of the second diagram, followed by the projections of the
+  points of the first diagram. A point may only be assigned to its own
+  projection, whereas projections may be assigned to each other at zero
+  cost. Costs are calculated on demand, so the solver only requires linear
+  memory for the dual variables and the shortest path search.
+
+  Edges with a non-finite cost, such as the ones between paired and unpaired
+  points, are considered to be absent. If no perfect matching exists, the
+  cost of the assignment is infinite.
+*/
+
+template <class Point, class Distance> class JonkerVolgenant
+{
+public:
+  using IndexType = std::size_t;
+  using ValueType = double;
+  using Pair      = std::pair<IndexType, IndexType>;
+
+  static constexpr IndexType npos = std::numeric_limits<IndexType>::max();
+
+  /**
+    Creates a new assignment problem between two sets of points.
+
+    @param P     Points of the first diagram
+    @param Q     Points of the second diagram
+    @param power Exponent of the Wasserstein distance
+  */
+
+  JonkerVolgenant( const std::vector<Point>& P, const std::vector<Point>& Q,
+                   ValueType power )
+    : JonkerVolgenant( P, Q,
+                       orthogonalDistances( P, power ),
+                       orthogonalDistances( Q, power ),
+                       power )
+  {
+  }
+
+  /**
+    Creates a new assignment problem between two sets of points whose
+    distances to the diagonal, raised to the given power, are already
+    known. This is useful if the same diagram takes part in many
+    assignment problems.
+
+    @param P           Points of the first diagram
+    @param Q           Points of the second diagram
+    @param orthogonalP Powered distances of the first diagram to the diagonal
+    @param orthogonalQ Powered distances of the second diagram to the diagonal
+    @param power       Exponent of the Wasserstein distance
+  */
+
+  JonkerVolgenant( const std::vector<Point>& P, const std::vector<Point>& Q,
+                   const std::vector<ValueType>& orthogonalP,
+                   const std::vector<ValueType>& orthogonalQ,
+                   ValueType power )
+    : _P( P )
+    , _Q( Q )
+    , _n( P.size() )
+    , _m( Q.size() )
+    , _power( power )
+    , _orthogonalP( orthogonalP )
+    , _orthogonalQ( orthogonalQ )
+    , _v( _n + _m, ValueType() )
+    , _rowToColumn( _n + _m, npos )
+    , _columnToRow( _n + _m, npos )
+  {
+  }
+
+  /** @returns Distances of all points to the diagonal, raised to the given power */
+  static std::vector<ValueType> orthogonalDistances( const std::vector<Point>& P, ValueType power )
+  {
+    std::vector<ValueType> distances;
+    distances.reserve( P.size() );
+
+    for( auto&& p : P )
+      distances.push_back( raise( static_cast<ValueType>( orthogonalDistance<Distance>( p ) ), power ) );
+
+    return distances;
+  }
+
+  /**
+    Solves the assignment problem and returns its cost, i.e. the sum of all
+    costs raised to the given power.
+  */
+
+  ValueType operator()()
+  {
+    this->reduceColumns();
+    return this->solve();
+  }
+
+  /**
+    Solves the assignment problem, starting from a previous solution of a
+    similar problem, e.g. one whose points have moved slightly. All pairs
+    that remain optimal with respect to the previous dual variables of the
+    columns are kept; only the remaining rows need to be augmented.
+
+    @param pairs Previous assignment, using the indexing scheme described
+                 above
+    @param duals Previous dual variables of the columns
+
+    @returns Cost of the assignment
+  */
+
+  ValueType operator()( const std::vector<Pair>& pairs, const std::vector<ValueType>& duals )
+  {
+    if( duals.size() != _n + _m )
+      return this->operator()();
+
+    _v = duals;
+
+    for( auto&& pair : pairs )
+    {
+      auto row    = pair.first;
+      auto column = pair.second;
+
+      if( row >= _n + _m || column >= _n + _m )
+        continue;
+
+      if( _rowToColumn[row] != npos || _columnToRow[column] != npos )
+        continue;
+
+      // The pair is only kept if its column minimizes the reduced costs
+      // of the row; this is the invariant of the shortest path search.
+      auto c = this->cost( row, column );
+      if( !std::isfinite( c ) )
+        continue;
+
+      auto minimum = std::numeric_limits<ValueType>::infinity();
+
+      this->forEachColumn( row, [&] ( IndexType k, ValueType d )
+      {
+        minimum = std::min( minimum, d - _v[k] );
+      } );
+
+      if( c - _v[column] <= minimum )
+      {
+        _rowToColumn[row]    = column;
+        _columnToRow[column] = row;
+      }
+    }
+
+    return this->solve();
+  }
+
+  /** @returns Dual variables of the columns, e.g. for a subsequent warm start */
+  const std::vector<ValueType>& duals() const noexcept
+  {
+    return _v;
+  }
+
+  /** @returns Cost of the current assignment */
+  ValueType cost() const noexcept
+  {
+    return _cost;
+  }
+
+  /**
+    Reports the assignment as pairs of indices, ordered by their rows. The
+    pairs use the indexing scheme described above.
+  */
+
+  std::vector<Pair> pairs() const
+  {
+    std::vector<Pair> result;
+    result.reserve( _n + _m );
+
+    for( IndexType row = 0; row < _n + _m; row++ )
+      result.push_back( std::make_pair( row, _rowToColumn[row] ) );
+
+    return result;
+  }
+
+private:
+
+  // Augments all free rows and calculates the cost of the assignment. If
+  // no perfect matching exists, the assignment is completed arbitrarily.
+  ValueType solve()
+  {
+    bool feasible = true;
+
+    for( IndexType row = 0; row < _n + _m && feasible; row++ )
+    {
+      if( _rowToColumn[row] == npos )
+        feasible = this->augment( row );
+    }
+
+    if( !feasible )
+    {
+      // Complete the assignment arbitrarily in order to be able to report
+      // a permutation in any case.
+      IndexType column = 0;
+
+      for( IndexType row = 0; row < _n + _m; row++ )
+      {
+        if( _rowToColumn[row] != npos )
+          continue;
+
+        while( _columnToRow[column] != npos )
+          ++column;
+
+        _rowToColumn[row]    = column;
+        _columnToRow[column] = row;
+      }
+
+      _cost = std::numeric_limits<ValueType>::infinity();
+      return _cost;
+    }
+
+    aleph::math::KahanSummation<ValueType> cost = ValueType();
+
+    for( IndexType row = 0; row < _n + _m; row++ )
+      cost += this->cost( row, _rowToColumn[row] );
+
+    _cost = cost;
+    return _cost;
+  }
+
+  ValueType raise( ValueType x ) const
+  {
+    return raise( x, _power );
+  }
+
+  static ValueType raise( ValueType x, ValueType power )
+  {
+    if( power == 1 )
+      return x;
+    else if( power == 2 )
+      return x * x;
+    else
+      return std::pow( x, power );
+  }
+
+  // Calculates the cost of assigning a row to a column. The cost is
+  // infinite if the corresponding edge does not exist.
+  ValueType cost( IndexType row, IndexType column ) const
+  {
+    if( row < _n )
+    {
+      if( column < _m )
+        return this->raise( static_cast<ValueType>( Distance()( _P[row], _Q[column] ) ) );
+      else if( column - _m == row )
+        return _orthogonalP[row];
+    }
+    else
+    {
+      if( column >= _m )
+        return ValueType();
+      else if( row - _n == column )
+        return _orthogonalQ[column];
+    }
+
+    return std::numeric_limits<ValueType>::infinity();
+  }
+
+  // Enumerates all edges of a row, i.e. all columns with a finite cost.
+  template <class Functor> void forEachColumn( IndexType row, Functor functor ) const
+  {
+    auto visit = [&] ( IndexType column, ValueType c )
+    {
+      if( std::isfinite( c ) )
+        functor( column, c );
+    };
+
+    if( row < _n )
+    {
+      for( IndexType column = 0; column < _m; column++ )
+        visit( column, this->raise( static_cast<ValueType>( Distance()( _P[row], _Q[column] ) ) ) );
+
+      visit( _m + row, _orthogonalP[row] );
+    }
+    else
+    {
+      visit( row - _n, _orthogonalQ[row - _n] );
+
+      for( IndexType column = _m; column < _m + _n; column++ )
+        visit( column, ValueType() );
+    }
+  }
+
+  // Enumerates all edges of a column, i.e. all rows with a finite cost.
+  template <class Functor> void forEachRow( IndexType column, Functor functor ) const
+  {
+    auto visit = [&] ( IndexType row, ValueType c )
+    {
+      if( std::isfinite( c ) )
+        functor( row, c );
+    };
+
+    if( column < _m )
+    {
+      for( IndexType row = 0; row < _n; row++ )
+        visit( row, this->raise( static_cast<ValueType>( Distance()( _P[row], _Q[column] ) ) ) );
+
+      visit( _n + column, _orthogonalQ[column] );
+    }
+    else
+    {
+      visit( column - _m, _orthogonalP[column - _m] );
+
+      for( IndexType row = _n; row < _n + _m; row++ )
+        visit( row, ValueType() );
+    }
+  }
+
+  // Initializes the dual variables of the columns with their minimum cost
+  // and assigns every column to a free row that attains it. This yields a
+  // feasible dual solution for which all assigned edges are tight.
+  void reduceColumns()
+  {
+    for( IndexType column = _n + _m; column-- > 0; )
+    {
+      auto minimum = std::numeric_limits<ValueType>::infinity();
+      auto best    = npos;
+
+      this->forEachRow( column, [&] ( IndexType row, ValueType c )
+      {
+        if( c < minimum || ( c == minimum && _rowToColumn[best] != npos && _rowToColumn[row] == npos ) )
+        {
+          minimum = c;
+          best    = row;
+        }
+      } );
+
+      _v[column] = std::isfinite( minimum ) ? minimum : ValueType();
+
+      if( best != npos && _rowToColumn[best] == npos )
+      {
+        _rowToColumn[best]   = column;
+        _columnToRow[column] = best;
+      }
+    }
+  }
+
+  // Searches for a shortest augmenting path, with respect to the reduced
+  // costs, that starts in a free row and augments the assignment along it.
+  // Returns false if no augmenting path exists.
+  bool augment( IndexType source )
+  {
+    auto infinity = std::numeric_limits<ValueType>::infinity();
+
+    _distance.assign( _n + _m, infinity );
+    _predecessor.assign( _n + _m, npos );
+    _final.assign( _n + _m, false );
+
+    // Columns that have been reached but whose distance is not yet final
+    std::vector<IndexType> todo;
+
+    // Columns whose distance is final
+    std::vector<IndexType> ready;
+
+    auto relax = [&] ( IndexType row, ValueType offset )
+    {
+      this->forEachColumn( row, [&] ( IndexType column, ValueType c )
+      {
+        if( _final[column] )
+          return;
+
+        auto d = offset + c - _v[column];
+        if( d < _distance[column] )
+        {
+          if( _distance[column] == infinity )
+            todo.push_back( column );
+
+          _distance[column]    = d;
+          _predecessor[column] = row;
+        }
+      } );
+    };
+
+    relax( source, ValueType() );
+
+    IndexType sink = npos;
+
+    while( sink == npos )
+    {
+      if( todo.empty() )
+        return false;
+
+      auto position = std::size_t( 0 );
+      for( std::size_t k = 1; k < todo.size(); k++ )
+      {
+        if( _distance[ todo[k] ] < _distance[ todo[position] ] )
+          position = k;
+      }
+
+      auto column    = todo[position];
+      todo[position] = todo.back();
+      todo.pop_back();
+
+      _final[column] = true;
+      ready.push_back( column );
+
+      auto row = _columnToRow[column];
+
+      if( row == npos )
+        sink = column;
+      else
+      {
+        // The assigned edge is tight, so the dual variable of the row is
+        // given by its reduced cost.
+        auto u = this->cost( row, column ) - _v[column];
+        relax( row, _distance[column] - u );
+      }
+    }
+
+    // Update the dual variables of all columns that have been finalized;
+    // this keeps all reduced costs non-negative.
+    for( auto&& column : ready )
+      _v[column] += _distance[column] - _distance[sink];
+
+    // Augment along the path
+    auto column = sink;
+    IndexType row;
+
+    do
+    {
+      row                  = _predecessor[column];
+      _columnToRow[column] = row;
+      std::swap( _rowToColumn[row], column );
+    }
+    while( row != source );
+
+    return true;
+  }
+
+  const std::vector<Point>& _P;
+  const std::vector<Point>& _Q;
+
+  std::size_t _n;
+  std::size_t _m;
+
+  ValueType _power;
+
+  std::vector<ValueType> _orthogonalP;
+  std::vector<ValueType> _orthogonalQ;
+
+  std::vector<ValueType> _v; // dual variables of the columns
+
+  std::vector<IndexType> _rowToColumn;
+  std::vector<IndexType> _columnToRow;
+
+  // Storage for the shortest path search; this is kept in order to avoid
+  // repeated allocations.
+  std::vector<ValueType> _distance;
+  std::vector<IndexType> _predecessor;
+  std::vector<bool>      _final;
+
+  ValueType _cost = ValueType();
+};
+
+template <class Point, class Distance> constexpr typename JonkerVolgenant<Point, Distance>::IndexType JonkerVolgenant<Point, Distance>::npos;
+
+} // namespace detail
+
+} // namespace distances
+
+} // namespace aleph
+
+#endif
@@ -0,0 +1,477 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_DISTANCES_DETAIL_KD_TREE_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_DISTANCES_DETAIL_KD_TREE_HH__
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace distances
+{
+
+namespace detail
+{
+
+/**
+  @class KDTree
+  @brief Two-dimensional kd-tree for geometric matching algorithms
+
+  This kd-tree stores the points of a persistence diagram, referred to by
+  an external index, and supports the operations required by the matching
+  algorithms for persistence diagram distances:
+
+  - range queries with respect to the L-infinity metric, i.e. queries for
+    an axis-aligned box around a query point
+  - removal of points, e.g. for marking them as visited in a search
+  - additive weights for every point, e.g. prices in an auction
+
+  The tree is stored implicitly in a single array. A node corresponds to a
+  range of this array, with the median of the range being its point. This
+  makes it possible to update the information of a node along the path
+  from the root without storing any pointers.
+*/
+
+template <class T> class KDTree
+{
+public:
+  using IndexType = std::size_t;
+
+  /** Denotes an invalid index, e.g. if a query did not yield any results */
+  static constexpr IndexType npos = std::numeric_limits<IndexType>::max();
+
+  KDTree() = default;
+
+  /**
+    Creates a new kd-tree from a range of coordinates. Indices of points
+    are assigned consecutively, i.e. the first point has index 0, and so
+    on.
+
+    @param x x-coordinates of the points
+    @param y y-coordinates of the points
+  */
+
+  KDTree( const std::vector<T>& x, const std::vector<T>& y )
+  {
+    std::vector<IndexType> indices( x.size() );
+    for( IndexType i = 0; i < indices.size(); i++ )
+      indices[i] = i;
+
+    this->build( x, y, indices );
+  }
+
+  /**
+    Creates a new kd-tree from a subset of points. Only points whose index
+    is mentioned in the vector of indices will be stored in the tree.
+
+    @param x       x-coordinates of all points
+    @param y       y-coordinates of all points
+    @param indices Indices of the points to store
+  */
+
+  KDTree( const std::vector<T>& x, const std::vector<T>& y, const std::vector<IndexType>& indices )
+  {
+    this->build( x, y, indices );
+  }
+
+  /** @returns Number of points that have not been removed */
+  std::size_t size() const noexcept
+  {
+    return _nodes.empty() ? 0 : _nodes[ middle( 0, _nodes.size() ) ].alive;
+  }
+
+  /** @returns true if all points have been removed */
+  bool empty() const noexcept
+  {
+    return this->size() == 0;
+  }
+
+  /** @returns true if the point with the given index is stored and has not been removed */
+  bool contains( IndexType index ) const noexcept
+  {
+    return index < _positions.size() && _positions[index] != npos && !_nodes[ _positions[index] ].removed;
+  }
+
+  // Modification ------------------------------------------------------
+
+  /** Removes a point from the tree; removing a point multiple times is harmless */
+  void remove( IndexType index )
+  {
+    if( !this->contains( index ) )
+      return;
+
+    auto position             = _positions[index];
+    _nodes[position].removed = true;
+
+    this->update( 0, _nodes.size(), position );
+  }
+
+  /** Sets the additive weight of a point */
+  void setWeight( IndexType index, T weight )
+  {
+    if( index >= _positions.size() || _positions[index] == npos )
+      return;
+
+    auto position            = _positions[index];
+    _nodes[position].weight = weight;
+
+    this->update( 0, _nodes.size(), position );
+  }
+
+  /** @returns Additive weight of a point */
+  T weight( IndexType index ) const
+  {
+    return _nodes.at( _positions.at( index ) ).weight;
+  }
+
+  // Queries -----------------------------------------------------------
+
+  /**
+    Searches for an arbitrary point whose L-infinity distance to a query
+    point is at most the given radius. Points that do not satisfy the
+    additional predicate are skipped. This permits using the tree as a
+    filter for other metrics that are bounded from below by L-infinity.
+
+    @param x         x-coordinate of the query point
+    @param y         y-coordinate of the query point
+    @param radius    Radius of the query box
+    @param predicate Predicate that is evaluated for the index of every
+                     point inside the query box
+
+    @returns Index of a point in the query box that satisfies the
+             predicate, or npos if no such point exists
+  */
+
+  template <class Predicate> IndexType find( T x, T y, T radius, Predicate predicate ) const
+  {
+    if( _nodes.empty() )
+      return npos;
+
+    return this->find( 0, _nodes.size(), x, y, radius, predicate );
+  }
+
+  /** Searches for an arbitrary point in the L-infinity ball around a query point */
+  IndexType find( T x, T y, T radius ) const
+  {
+    return this->find( x, y, radius, [] ( IndexType ) { return true; } );
+  }
+
+  /**
+    Reports all points whose L-infinity distance to a query point is at
+    most the given radius, regardless of whether they have been removed.
+
+    @param x      x-coordinate of the query point
+    @param y      y-coordinate of the query point
+    @param radius Radius of the query box
+    @param result Output iterator for the indices of all points
+  */
+
+  template <class OutputIterator> void range( T x, T y, T radius, OutputIterator result ) const
+  {
+    if( _nodes.empty() )
+      return;
+
+    this->range( 0, _nodes.size(), x, y, radius, result );
+  }
+
+  /**
+    Searches for the two points minimizing a cost function plus the weight
+    of the point. This is required for the bidding phase of an auction. A
+    lower bound for the cost over a bounding box is used for pruning.
+
+    @param cost  Cost function, evaluated for the index of a point
+    @param bound Lower bound of the cost function for a bounding box, given
+                 as (xMin, xMax, yMin, yMax)
+
+    @param best       Index of the best point, or npos
+    @param bestValue  Value of the best point
+    @param second     Index of the second-best point, or npos
+    @param secondValue Value of the second-best point
+  */
+
+  template <class Cost, class Bound> void bestTwo( Cost cost, Bound bound,
+                                                   IndexType& best, T& bestValue,
+                                                   IndexType& second, T& secondValue ) const
+  {
+    best        = npos;
+    second      = npos;
+    bestValue   = std::numeric_limits<T>::max();
+    secondValue = std::numeric_limits<T>::max();
+
+    if( _nodes.empty() )
+      return;
+
+    this->bestTwo( 0, _nodes.size(), cost, bound, best, bestValue, second, secondValue );
+  }
+
+private:
+
+  struct Node
+  {
+    IndexType index; // External index of the point
+    T x;             // x-coordinate of the point
+    T y;             // y-coordinate of the point
+    T weight;        // Additive weight of the point
+
+    T xMin;          // Bounding box of the subtree
+    T xMax;
+    T yMin;
+    T yMax;
+
+    T minWeight;           // Minimum weight of the points in the subtree
+    std::size_t alive;     // Number of points in the subtree that have not been removed
+    bool removed;
+  };
+
+  static IndexType middle( IndexType lo, IndexType hi ) noexcept
+  {
+    return lo + ( hi - lo ) / 2;
+  }
+
+  void build( const std::vector<T>& x, const std::vector<T>& y, const std::vector<IndexType>& indices )
+  {
+    _nodes.clear();
+    _nodes.reserve( indices.size() );
+
+    IndexType maxIndex = 0;
+
+    for( auto&& index : indices )
+    {
+      Node node;
+      node.index     = index;
+      node.x         = x[index];
+      node.y         = y[index];
+      node.weight    = T();
+      node.xMin      = node.x;
+      node.xMax      = node.x;
+      node.yMin      = node.y;
+      node.yMax      = node.y;
+      node.minWeight = T();
+      node.alive     = 1;
+      node.removed   = false;
+
+      _nodes.push_back( node );
+
+      maxIndex = std::max( maxIndex, index + 1 );
+    }
+
+    this->build( 0, _nodes.size(), 0 );
+
+    _positions.assign( maxIndex, npos );
+
+    for( IndexType position = 0; position < _nodes.size(); position++ )
+      _positions[ _nodes[position].index ] = position;
+  }
+
+  void build( IndexType lo, IndexType hi, unsigned depth )
+  {
+    if( lo >= hi )
+      return;
+
+    auto mid = middle( lo, hi );
+
+    if( depth % 2 == 0 )
+    {
+      std::nth_element( _nodes.begin() + static_cast<std::ptrdiff_t>( lo ),
+                        _nodes.begin() + static_cast<std::ptrdiff_t>( mid ),
+                        _nodes.begin() + static_cast<std::ptrdiff_t>( hi ),
+                        [] ( const Node& a, const Node& b ) { return a.x < b.x; } );
+    }
+    else
+    {
+      std::nth_element( _nodes.begin() + static_cast<std::ptrdiff_t>( lo ),
+                        _nodes.begin() + static_cast<std::ptrdiff_t>( mid ),
+                        _nodes.begin() + static_cast<std::ptrdiff_t>( hi ),
+                        [] ( const Node& a, const Node& b ) { return a.y < b.y; } );
+    }
+
+    this->build( lo, mid, depth + 1 );
+    this->build( mid + 1, hi, depth + 1 );
+
+    this->aggregate( lo, hi );
+  }
+
+  // Recalculates the bounding box and the aggregated attributes of the
+  // node for the given range from its children.
+  void aggregate( IndexType lo, IndexType hi )
+  {
+    auto mid   = middle( lo, hi );
+    auto& node = _nodes[mid];
+
+    node.xMin      = node.x;
+    node.xMax      = node.x;
+    node.yMin      = node.y;
+    node.yMax      = node.y;
+    node.alive     = node.removed ? 0 : 1;
+    node.minWeight = node.removed ? std::numeric_limits<T>::max() : node.weight;
+
+    auto merge = [&node, this] ( IndexType l, IndexType h )
+    {
+      if( l >= h )
+        return;
+
+      auto&& child = _nodes[ middle( l, h ) ];
+
+      node.xMin      = std::min( node.xMin, child.xMin );
+      node.xMax      = std::max( node.xMax, child.xMax );
+      node.yMin      = std::min( node.yMin, child.yMin );
+      node.yMax      = std::max( node.yMax, child.yMax );
+      node.alive    += child.alive;
+      node.minWeight = std::min( node.minWeight, child.minWeight );
+    };
+
+    merge( lo, mid );
+    merge( mid + 1, hi );
+  }
+
+  // Updates all nodes on the path from the root to the given position,
+  // starting from the bottom.
+  void update( IndexType lo, IndexType hi, IndexType position )
+  {
+    auto mid = middle( lo, hi );
+
+    if( position < mid )
+      this->update( lo, mid, position );
+    else if( position > mid )
+      this->update( mid + 1, hi, position );
+
+    this->aggregate( lo, hi );
+  }
+
+  // Checks whether the bounding box of a node is disjoint from the query
+  // box. The differences are calculated in the same manner as in the
+  // distance functor in order to prevent rounding errors from excluding
+  // points that lie on the boundary of the query box.
+  static bool disjoint( const Node& node, T x, T y, T radius ) noexcept
+  {
+    return ( x > node.xMax && x - node.xMax > radius ) || ( node.xMin > x && node.xMin - x > radius )
+        || ( y > node.yMax && y - node.yMax > radius ) || ( node.yMin > y && node.yMin - y > radius );
+  }
+
+  static bool inside( const Node& node, T x, T y, T radius ) noexcept
+  {
+    auto dx = x >= node.x ? x - node.x : node.x - x;
+    auto dy = y >= node.y ? y - node.y : node.y - y;
+
+    return dx <= radius && dy <= radius;
+  }
+
+  template <class Predicate> IndexType find( IndexType lo, IndexType hi,
+                                             T x, T y, T radius,
+                                             Predicate& predicate ) const
+  {
+    if( lo >= hi )
+      return npos;
+
+    auto mid    = middle( lo, hi );
+    auto&& node = _nodes[mid];
+
+    if( node.alive == 0 || disjoint( node, x, y, radius ) )
+      return npos;
+
+    if( !node.removed && inside( node, x, y, radius ) && predicate( node.index ) )
+      return node.index;
+
+    auto index = this->find( lo, mid, x, y, radius, predicate );
+    if( index != npos )
+      return index;
+
+    return this->find( mid + 1, hi, x, y, radius, predicate );
+  }
+
+  template <class OutputIterator> void range( IndexType lo, IndexType hi,
+                                              T x, T y, T radius,
+                                              OutputIterator& result ) const
+  {
+    if( lo >= hi )
+      return;
+
+    auto mid    = middle( lo, hi );
+    auto&& node = _nodes[mid];
+
+    if( disjoint( node, x, y, radius ) )
+      return;
+
+    if( inside( node, x, y, radius ) )
+      *result++ = node.index;
+
+    this->range( lo, mid, x, y, radius, result );
+    this->range( mid + 1, hi, x, y, radius, result );
+  }
+
+  template <class Cost, class Bound> void bestTwo( IndexType lo, IndexType hi,
+                                                   Cost& cost, Bound& bound,
+                                                   IndexType& best, T& bestValue,
+                                                   IndexType& second, T& secondValue ) const
+  {
+    if( lo >= hi )
+      return;
+
+    auto mid    = middle( lo, hi );
+    auto&& node = _nodes[mid];
+
+    if( node.alive == 0 )
+      return;
+
+    // Pruning: no point in this subtree can improve the second-best
+    // value, so there is no need to descend further.
+    if( bound( node.xMin, node.xMax, node.yMin, node.yMax ) + node.minWeight >= secondValue )
+      return;
+
+    if( !node.removed )
+    {
+      auto value = cost( node.index ) + node.weight;
+
+      if( value < bestValue )
+      {
+        second      = best;
+        secondValue = bestValue;
+        best        = node.index;
+        bestValue   = value;
+      }
+      else if( value < secondValue )
+      {
+        second      = node.index;
+        secondValue = value;
+      }
+    }
+
+    // Descend into the more promising child first in order to improve
+    // the pruning.
+    auto lower = [&] ( IndexType l, IndexType h )
+    {
+      if( l >= h || _nodes[ middle(l,h) ].alive == 0 )
+        return std::numeric_limits<T>::max();
+
+      auto&& child = _nodes[ middle(l,h) ];
+      return bound( child.xMin, child.xMax, child.yMin, child.yMax ) + child.minWeight;
+    };
+
+    if( lower( lo, mid ) <= lower( mid + 1, hi ) )
+    {
+      this->bestTwo( lo, mid, cost, bound, best, bestValue, second, secondValue );
+      this->bestTwo( mid + 1, hi, cost, bound, best, bestValue, second, secondValue );
+    }
+    else
+    {
+      this->bestTwo( mid + 1, hi, cost, bound, best, bestValue, second, secondValue );
+      this->bestTwo( lo, mid, cost, bound, best, bestValue, second, secondValue );
+    }
+  }
+
+  std::vector<Node> _nodes;          // Nodes of the implicit tree
+  std::vector<IndexType> _positions; // Maps external indices to positions in the tree
+};
+
+template <class T> constexpr typename KDTree<T>::IndexType KDTree<T>::npos;
+
+} // namespace detail
+
+} // namespace distances
+
+} // namespace aleph
+
+#endif
@@ -0,0 +1,395 @@
+#ifndef ALEPH_PERSISTENCE_DIAGRAMS_IO_ARCHIVE_HH__
+#define ALEPH_PERSISTENCE_DIAGRAMS_IO_ARCHIVE_HH__
+
+#include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+
+#include <aleph/utilities/MemoryMappedFile.hh>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace aleph
+{
+
+namespace io
+{
+
+/*
+  Binary archive of persistence diagrams
+  --------------------------------------
+
+  An archive stores many persistence diagrams in a single file. All values
+  use the byte order of the machine that wrote the archive. The file starts
+  with a header:
+
+    - 8 bytes: magic string "ALEPHPDA"
+    - 4 bytes: byte order mark 0x01020304
+    - 2 bytes: version of the format
+    - 2 bytes: size of a single value, i.e. 4 for float, 8 for double
+    - 8 bytes: number of persistence diagrams
+    - 8 bytes: offset of the index
+    - 8 bytes: reserved; always zero
+
+  Every persistence diagram is stored in columns, i.e. all creation values
+  are followed by all destruction values, followed by the name. Columns
+  start at offsets that are a multiple of 8. The file ends with the index,
+  which contains five 64-bit values for every diagram: the offset of its
+  columns, its number of points, its dimension, and the offset and length
+  of its name.
+*/
+
+namespace detail
+{
+
+struct ArchiveHeader
+{
+  char magic[8];
+  std::uint32_t byteOrder;
+  std::uint16_t version;
+  std::uint16_t valueSize;
+  std::uint64_t count;
+  std::uint64_t indexOffset;
+  std::uint64_t reserved;
+};
+
+struct ArchiveEntry
+{
+  std::uint64_t offset;
+  std::uint64_t size;
+  std::uint64_t dimension;
+  std::uint64_t nameOffset;
+  std::uint64_t nameLength;
+};
+
+static_assert( sizeof( ArchiveHeader ) == 40, "Unexpected padding in archive header" );
+static_assert( sizeof( ArchiveEntry  ) == 40, "Unexpected padding in archive entry"  );
+
+constexpr const char*   archiveMagic     = "ALEPHPDA";
+constexpr std::uint32_t archiveByteOrder = 0x01020304;
+constexpr std::uint16_t archiveVersion   = 1;
+
+} // namespace detail
+
+/**
+  @class ArchiveWriter
+  @brief Writes persistence diagrams to a binary archive
+
+  Diagrams are appended one after the other, so they do not have to be
+  kept in memory. All values are stored using the type \p T, which needs
+  to be either \c float or \c double. The index is written when the writer
+  is closed or destroyed.
+*/
+
+template <class T> class ArchiveWriter
+{
+public:
+  static_assert( std::is_same<T, float>::value || std::is_same<T, double>::value,
+                 "Archives only support single and double precision values" );
+
+  explicit ArchiveWriter( const std::string& filename )
+    : _out( filename, std::ios::binary | std::ios::trunc )
+  {
+    if( !_out )
+      throw std::runtime_error( "Unable to open output file" );
+
+    // Placeholder; the header is only complete once the index has been
+    // written.
+    this->writeHeader();
+  }
+
+  ~ArchiveWriter()
+  {
+    try
+    {
+      this->close();
+    }
+    catch( ... )
+    {
+    }
+  }
+
+  ArchiveWriter( const ArchiveWriter& )            = delete;
+  ArchiveWriter& operator=( const ArchiveWriter& ) = delete;
+
+  /** Appends a persistence diagram, along with an optional name */
+  template <class Diagram> void operator()( const Diagram& D, const std::string& name = std::string() )
+  {
+    if( _closed )
+      throw std::runtime_error( "Unable to write to closed archive" );
+
+    std::vector<T> x;
+    std::vector<T> y;
+
+    x.reserve( D.size() );
+    y.reserve( D.size() );
+
+    for( auto&& p : D )
+    {
+      x.push_back( static_cast<T>( p.x() ) );
+      y.push_back( static_cast<T>( p.y() ) );
+    }
+
+    detail::ArchiveEntry entry;
+
+    entry.offset     = _offset;
+    entry.size       = D.size();
+    entry.dimension  = D.dimension();
+    entry.nameOffset = _offset + 2 * sizeof(T) * D.size();
+    entry.nameLength = name.size();
+
+    this->write( x.data(), sizeof(T) * x.size() );
+    this->write( y.data(), sizeof(T) * y.size() );
+    this->write( name.data(), name.size() );
+    this->align();
+
+    _index.push_back( entry );
+  }
+
+  /** Writes the index and finishes the archive */
+  void close()
+  {
+    if( _closed )
+      return;
+
+    _closed      = true;
+    _indexOffset = _offset;
+
+    this->write( _index.data(), sizeof( detail::ArchiveEntry ) * _index.size() );
+
+    _out.seekp( 0 );
+    this->writeHeader();
+    _out.close();
+
+    if( _out.fail() )
+      throw std::runtime_error( "Unable to write archive" );
+  }
+
+private:
+  void write( const void* data, std::size_t n )
+  {
+    if( n == 0 )
+      return;
+
+    _out.write( static_cast<const char*>( data ), static_cast<std::streamsize>( n ) );
+    _offset += n;
+
+    if( !_out )
+      throw std::runtime_error( "Unable to write archive" );
+  }
+
+  // Pads the output such that the next column starts at a multiple of 8
+  void align()
+  {
+    static const char padding[8] = {};
+
+    if( _offset % 8 != 0 )
+      this->write( padding, 8 - _offset % 8 );
+  }
+
+  void writeHeader()
+  {
+    detail::ArchiveHeader header;
+
+    std::memcpy( header.magic, detail::archiveMagic, sizeof( header.magic ) );
+
+    header.byteOrder   = detail::archiveByteOrder;
+    header.version     = detail::archiveVersion;
+    header.valueSize   = sizeof(T);
+    header.count       = _index.size();
+    header.indexOffset = _indexOffset;
+    header.reserved    = 0;
+
+    _out.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+
+    if( _offset == 0 )
+      _offset = sizeof( header );
+  }
+
+  std::ofstream _out;
+  std::vector<detail::ArchiveEntry> _index;
+
+  std::uint64_t _offset      = 0;
+  std::uint64_t _indexOffset = 0;
+
+  bool _closed = false;
+};
+
+/**
+  @class Archive
+  @brief Random access to persistence diagrams in a binary archive
+
+  Maps an archive into memory and provides access to individual diagrams
+  without parsing the file. Only the header and the index are validated
+  when opening the archive; the columns of a diagram can be accessed in
+  place, or converted to a persistence diagram of an arbitrary type.
+*/
+
+class Archive
+{
+public:
+  explicit Archive( const std::string& filename )
+    : _file( filename )
+  {
+    if( _file.size() < sizeof( detail::ArchiveHeader ) )
+      throw std::runtime_error( "File is too small to be an archive" );
+
+    std::memcpy( &_header, _file.data(), sizeof( _header ) );
+
+    if( std::memcmp( _header.magic, detail::archiveMagic, sizeof( _header.magic ) ) != 0 )
+      throw std::runtime_error( "File is not an archive of persistence diagrams" );
+
+    if( _header.byteOrder != detail::archiveByteOrder )
+      throw std::runtime_error( "Archive uses a different byte order" );
+
+    if( _header.version != detail::archiveVersion )
+      throw std::runtime_error( "Unsupported archive version" );
+
+    if( _header.valueSize != sizeof(float) && _header.valueSize != sizeof(double) )
+      throw std::runtime_error( "Unsupported value size in archive" );
+
+    auto indexSize = _header.count * sizeof( detail::ArchiveEntry );
+
+    if(    _header.indexOffset < sizeof( detail::ArchiveHeader )
+        || _header.indexOffset > _file.size()
+        || _header.count > ( _file.size() - _header.indexOffset ) / sizeof( detail::ArchiveEntry )
+        || _header.indexOffset + indexSize != _file.size() )
+      throw std::runtime_error( "Archive index is corrupted" );
+
+    _index.resize( static_cast<std::size_t>( _header.count ) );
+
+    if( !_index.empty() )
+      std::memcpy( _index.data(), _file.data() + _header.indexOffset, indexSize );
+
+    for( auto&& entry : _index )
+    {
+      auto columns = entry.size * _header.valueSize;
+
+      if(    entry.offset % 8 != 0
+          || entry.offset < sizeof( detail::ArchiveHeader )
+          || entry.offset > _header.indexOffset
+          || entry.size > ( _header.indexOffset - entry.offset ) / ( 2 * _header.valueSize )
+          || entry.nameOffset != entry.offset + 2 * columns
+          || entry.nameLength > _header.indexOffset - entry.nameOffset )
+        throw std::runtime_error( "Archive entry is corrupted" );
+    }
+  }
+
+  /** @returns Number of persistence diagrams in the archive */
+  std::size_t size() const noexcept
+  {
+    return _index.size();
+  }
+
+  /** @returns Size of a single stored value in bytes */
+  std::size_t valueSize() const noexcept
+  {
+    return _header.valueSize;
+  }
+
+  /** @returns Number of points of the given persistence diagram */
+  std::size_t size( std::size_t i ) const
+  {
+    return static_cast<std::size_t>( this->entry(i).size );
+  }
+
+  /** @returns Dimension of the given persistence diagram */
+  std::size_t dimension( std::size_t i ) const
+  {
+    return static_cast<std::size_t>( this->entry(i).dimension );
+  }
+
+  /** @returns Name of the given persistence diagram; may be empty */
+  std::string name( std::size_t i ) const
+  {
+    auto&& e = this->entry(i);
+    return std::string( _file.data() + e.nameOffset, static_cast<std::size_t>( e.nameLength ) );
+  }
+
+  /**
+    @returns Pointer to the creation values of the given persistence
+    diagram. The values are not copied, so the pointer remains valid as
+    long as the archive exists. The type \p T needs to match the type of
+    the stored values.
+  */
+
+  template <class T> const T* births( std::size_t i ) const
+  {
+    return this->column<T>( i, 0 );
+  }
+
+  /** @returns Pointer to the destruction values of the given persistence diagram */
+  template <class T> const T* deaths( std::size_t i ) const
+  {
+    return this->column<T>( i, 1 );
+  }
+
+  /**
+    Converts a persistence diagram of the archive. The stored values are
+    converted to \p T if necessary.
+  */
+
+  template <class T> PersistenceDiagram<T> diagram( std::size_t i ) const
+  {
+    if( _header.valueSize == sizeof(float) )
+      return this->convert<float, T>(i);
+    else
+      return this->convert<double, T>(i);
+  }
+
+private:
+  const detail::ArchiveEntry& entry( std::size_t i ) const
+  {
+    if( i >= _index.size() )
+      throw std::out_of_range( "Invalid index for archive" );
+
+    return _index[i];
+  }
+
+  template <class T> const T* column( std::size_t i, std::size_t j ) const
+  {
+    static_assert( std::is_same<T, float>::value || std::is_same<T, double>::value,
+                   "Archives only support single and double precision values" );
+
+    if( sizeof(T) != _header.valueSize )
+      throw std::runtime_error( "Requested type does not match type of archive values" );
+
+    auto&& e = this->entry(i);
+
+    // The file is mapped at a page boundary and every column starts at an
+    // offset that is a multiple of 8, so the values are properly aligned.
+    return reinterpret_cast<const T*>( _file.data() + e.offset + j * e.size * sizeof(T) );
+  }
+
+  template <class S, class T> PersistenceDiagram<T> convert( std::size_t i ) const
+  {
+    auto x = this->column<S>( i, 0 );
+    auto y = this->column<S>( i, 1 );
+    auto n = this->size(i);
+
+    PersistenceDiagram<T> D;
+    D.setDimension( this->dimension(i) );
+
+    for( std::size_t k = 0; k < n; k++ )
+      D.add( static_cast<T>( x[k] ), static_cast<T>( y[k] ) );
+
+    return D;
+  }
+
+  aleph::utilities::MemoryMappedFile _file;
+
+  detail::ArchiveHeader _header;
+  std::vector<detail::ArchiveEntry> _index;
+};
+
+} // namespace io
+
+} // namespace aleph
+
+#endif
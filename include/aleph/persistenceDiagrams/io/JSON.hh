@@ -1,8 +1,6 @@
 #ifndef ALEPH_PERSISTENCE_DIAGRAMS_IO_JSON_HH__
 #define ALEPH_PERSISTENCE_DIAGRAMS_IO_JSON_HH__
 
-#include <aleph/config/RapidJSON.hh>
-
 #include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
 
 #include <aleph/utilities/String.hh>
@@ -10,12 +8,13 @@
 #include <fstream>
 #include <istream>
 #include <ostream>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
+#include <utility>
+#include <vector>
 
-#ifdef ALEPH_WITH_RAPID_JSON
-  #include <rapidjson/document.h>
-  #include <rapidjson/istreamwrapper.h>
-#endif
+#include <cctype>
 
 namespace aleph
 {
@@ -23,45 +22,241 @@ namespace aleph
 namespace io
 {
 
+namespace detail
+{
+
 /**
-  Writes a persistence diagram to an output stream, using the JSON
-  format. The diagram will be serialized such that its points will
-  be stored in the field ``data`` as a two-dimensional array. Note
-  that infinite values will be encoded as strings. Additional data
-  about the diagram, e.g. its dimension, are stored in name--value
-  pairs.
+  @class JSONStream
+  @brief Minimal pull parser for JSON data
+
+  Reads JSON tokens directly from the buffer of an input stream, without
+  ever building a document in memory. Clients request the tokens they
+  expect, and malformed input results in an exception. Values that are
+  of no interest may be skipped without storing them.
 */
 
-template <class Diagram> void writeJSON( std::ostream& o, const Diagram& D, const std::string& name = std::string() )
+class JSONStream
+{
+public:
+  explicit JSONStream( std::istream& in )
+    : _buffer( in.rdbuf() )
+  {
+    if( !_buffer )
+      throw std::runtime_error( "Unable to read from input stream" );
+  }
+
+  /** Skips whitespace and returns the next character, or EOF */
+  int peek()
+  {
+    int c = _buffer->sgetc();
+
+    while( c != std::char_traits<char>::eof() && std::isspace( c ) )
+      c = _buffer->snextc();
+
+    return c;
+  }
+
+  /** Consumes the next character if it matches the given one */
+  bool consume( char c )
+  {
+    if( this->peek() == c )
+    {
+      _buffer->sbumpc();
+      return true;
+    }
+
+    return false;
+  }
+
+  /** Consumes the next character, which is required to match */
+  void expect( char c )
+  {
+    if( !this->consume( c ) )
+      throw std::runtime_error( std::string( "Malformed JSON: expected '" ) + c + "'" );
+  }
+
+  /** Reads a string, resolving simple escape sequences */
+  std::string string()
+  {
+    this->expect( '"' );
+
+    std::string result;
+
+    for( ;; )
+    {
+      int c = _buffer->sbumpc();
+
+      if( c == std::char_traits<char>::eof() )
+        throw std::runtime_error( "Malformed JSON: unterminated string" );
+      else if( c == '"' )
+        break;
+      else if( c == '\\' )
+      {
+        c = _buffer->sbumpc();
+
+        switch( c )
+        {
+        case 'b':
+          result.push_back( '\b' );
+          break;
+        case 'f':
+          result.push_back( '\f' );
+          break;
+        case 'n':
+          result.push_back( '\n' );
+          break;
+        case 'r':
+          result.push_back( '\r' );
+          break;
+        case 't':
+          result.push_back( '\t' );
+          break;
+        case 'u':
+          // Unicode escapes are kept verbatim because they do not appear
+          // in any of the fields that need to be interpreted.
+          result += "\\u";
+          break;
+        default:
+          if( c == std::char_traits<char>::eof() )
+            throw std::runtime_error( "Malformed JSON: unterminated string" );
+
+          result.push_back( static_cast<char>( c ) );
+          break;
+        }
+      }
+      else
+        result.push_back( static_cast<char>( c ) );
+    }
+
+    return result;
+  }
+
+  /** Reads a number or a literal such as true, false, or null */
+  std::string scalar()
+  {
+    std::string result;
+
+    int c = this->peek();
+    while( c != std::char_traits<char>::eof() && ( std::isalnum( c ) || c == '-' || c == '+' || c == '.' ) )
+    {
+      result.push_back( static_cast<char>( c ) );
+      c = _buffer->snextc();
+    }
+
+    if( result.empty() )
+      throw std::runtime_error( "Malformed JSON: expected value" );
+
+    return result;
+  }
+
+  /** Reads a string or a scalar value and returns its textual representation */
+  std::string value()
+  {
+    if( this->peek() == '"' )
+      return this->string();
+    else
+      return this->scalar();
+  }
+
+  /** Skips an arbitrary value, including nested objects and arrays */
+  void skip()
+  {
+    int c = this->peek();
+
+    if( c == '{' || c == '[' )
+    {
+      char close = c == '{' ? '}' : ']';
+      _buffer->sbumpc();
+
+      if( this->consume( close ) )
+        return;
+
+      do
+      {
+        if( close == '}' )
+        {
+          this->string();
+          this->expect( ':' );
+        }
+
+        this->skip();
+      }
+      while( this->consume( ',' ) );
+
+      this->expect( close );
+    }
+    else
+      this->value();
+  }
+
+private:
+  std::streambuf* _buffer;
+};
+
+/** Escapes a string such that it may be stored in a JSON file */
+inline std::string escapeJSON( const std::string& s )
+{
+  std::string result;
+  result.reserve( s.size() );
+
+  for( auto c : s )
+  {
+    if( c == '"' || c == '\\' )
+      result.push_back( '\\' );
+
+    result.push_back( c );
+  }
+
+  return result;
+}
+
+/** Writes a single persistence diagram with a given indentation */
+template <class Diagram> void writeJSON( std::ostream& o, const Diagram& D, const std::string& name, const std::string& indent )
 {
   std::string level = "  ";
 
-  o << "{\n";
+  o << indent << "{\n";
 
-  o << level << "\"betti\": "     << D.betti()     << ",\n"
-    << level << "\"dimension\": " << D.dimension() << ",\n";
+  o << indent << level << "\"betti\": "     << D.betti()     << ",\n"
+    << indent << level << "\"dimension\": " << D.dimension() << ",\n";
 
   if( !name.empty() )
-    o << level << "\"name\": " << "\"" << name << "\",\n";
+    o << indent << level << "\"name\": " << "\"" << escapeJSON( name ) << "\",\n";
 
-  o << level << "\"size\": "      << D.size()      << ",\n"
-    << level << "\"diagram\": "   << "[\n";
+  o << indent << level << "\"size\": "      << D.size()      << ",\n"
+    << indent << level << "\"diagram\": "   << "[\n";
 
   for( auto it = D.begin(); it != D.end(); ++it )
   {
     if( it != D.begin() )
       o << ",\n";
 
-    o << level << level << "["
-                        << "\"" << it->x() << "\""
-                        << ","
-                        << "\"" << it->y() << "\""
-                        << "]";
+    o << indent << level << level << "["
+                                  << "\"" << it->x() << "\""
+                                  << ","
+                                  << "\"" << it->y() << "\""
+                                  << "]";
   }
 
   o << "\n"
-    << level << "]\n"
-    << "}";
+    << indent << level << "]\n"
+    << indent << "}";
+}
+
+} // namespace detail
+
+/**
+  Writes a persistence diagram to an output stream, using the JSON
+  format. The diagram will be serialized such that its points will
+  be stored in the field ``data`` as a two-dimensional array. Note
+  that infinite values will be encoded as strings. Additional data
+  about the diagram, e.g. its dimension, are stored in name--value
+  pairs.
+*/
+
+template <class Diagram> void writeJSON( std::ostream& o, const Diagram& D, const std::string& name = std::string() )
+{
+  detail::writeJSON( o, D, name, std::string() );
 }
 
 /**
@@ -79,65 +274,330 @@ template <class Diagram> void writeJSON( const std::string& filename, const Diag
 }
 
 /**
-  Reads multiple persistence diagrams from an input stream in JSON
-  format. The stream is checked for consistency; appropriate error
-  messages will be raised if necessary.
+  @class JSONWriter
+  @brief Streaming writer for multiple persistence diagrams
+
+  Writes persistence diagrams one after the other into the array of
+  persistence diagrams of a JSON file. No diagram needs to be kept in
+  memory after it has been written. The array is closed when the writer
+  is closed or destroyed.
 */
 
-template <class T> std::vector< aleph::PersistenceDiagram<T> > readJSON( std::istream& in )
+class JSONWriter
 {
-#ifdef ALEPH_WITH_RAPID_JSON
+public:
+  explicit JSONWriter( std::ostream& o )
+    : _o( o )
+  {
+    _o << "{\n"
+       << "  \"diagrams\": [";
+  }
 
-  rapidjson::Document document;
+  ~JSONWriter()
+  {
+    this->close();
+  }
+
+  JSONWriter( const JSONWriter& )            = delete;
+  JSONWriter& operator=( const JSONWriter& ) = delete;
 
+  /** Appends a persistence diagram to the output */
+  template <class Diagram> void operator()( const Diagram& D, const std::string& name = std::string() )
   {
-    rapidjson::IStreamWrapper isw( in );
-    document.ParseStream( isw );
+    if( _closed )
+      throw std::runtime_error( "Unable to write to closed JSON writer" );
+
+    _o << ( _first ? "\n" : ",\n" );
+    _first = false;
+
+    detail::writeJSON( _o, D, name, "    " );
   }
 
+  /** Finishes the output; subsequent calls have no effect */
+  void close()
+  {
+    if( _closed )
+      return;
+
+    _o << "\n"
+       << "  ]\n"
+       << "}\n";
+
+    _closed = true;
+  }
+
+private:
+  std::ostream& _o;
+
+  bool _first  = true;
+  bool _closed = false;
+};
+
+/**
+  @class JSONReader
+  @brief Streaming reader for persistence diagrams in JSON format
+
+  Reads persistence diagrams one at a time from an input stream. The
+  stream may either contain an object with an array of diagrams in its
+  ``diagrams`` field, as written by JSONWriter, or a single diagram, as
+  written by writeJSON(). Only the current diagram is kept in memory, so
+  arbitrarily large files can be processed. Every diagram is checked for
+  consistency; appropriate error messages will be raised if necessary.
+*/
+
+template <class T> class JSONReader
+{
+public:
   using PersistenceDiagram = aleph::PersistenceDiagram<T>;
 
-  std::vector<PersistenceDiagram> persistenceDiagrams;
+  explicit JSONReader( std::istream& in )
+    : _stream( in )
+  {
+    _stream.expect( '{' );
+
+    if( _stream.consume( '}' ) )
+    {
+      _state = State::Done;
+      return;
+    }
+
+    Entry entry;
+    bool isDiagram = false;
+
+    do
+    {
+      auto key = _stream.string();
+      _stream.expect( ':' );
+
+      if( key == "diagrams" )
+      {
+        _stream.expect( '[' );
+        _state = State::Array;
+        return;
+      }
+      else
+        isDiagram = this->field( key, entry ) || isDiagram;
+    }
+    while( _stream.consume( ',' ) );
+
+    _stream.expect( '}' );
+
+    if( !isDiagram )
+      throw std::runtime_error( "Unable to find array of persistence diagrams" );
+
+    _pending = std::move( entry );
+    _state   = State::Single;
+  }
+
+  /**
+    Reads the next persistence diagram.
+
+    @param D Persistence diagram to fill
+
+    @returns true if a diagram has been read, or false if the input has
+    been exhausted
+  */
+
+  bool operator()( PersistenceDiagram& D )
+  {
+    switch( _state )
+    {
+    case State::Done:
+      return false;
+
+    case State::Single:
+      _state = State::Done;
+      this->finish( _pending, D );
+      return true;
+
+    case State::Array:
+      break;
+    }
+
+    if( _stream.consume( ']' ) )
+    {
+      // Skip all remaining fields of the enclosing object
+      while( _stream.consume( ',' ) )
+      {
+        _stream.string();
+        _stream.expect( ':' );
+        _stream.skip();
+      }
+
+      _stream.expect( '}' );
+      _state = State::Done;
+      return false;
+    }
+
+    if( !_first )
+      _stream.expect( ',' );
+
+    _first = false;
+
+    Entry entry;
+
+    _stream.expect( '{' );
+
+    if( !_stream.consume( '}' ) )
+    {
+      do
+      {
+        auto key = _stream.string();
+        _stream.expect( ':' );
+
+        this->field( key, entry );
+      }
+      while( _stream.consume( ',' ) );
+
+      _stream.expect( '}' );
+    }
+
+    this->finish( entry, D );
+    return true;
+  }
+
+  /** @returns Name of the most recently read diagram, if any */
+  const std::string& name() const noexcept
+  {
+    return _name;
+  }
 
-  if( !document.HasMember( "diagrams" ) )
-    throw std::runtime_error( "Unable to find array of persistence diagrams" );
+private:
+  enum class State
+  {
+    Array,
+    Single,
+    Done
+  };
 
-  for( auto&& diagram : document["diagrams"].GetArray() )
+  struct Entry
   {
-    auto dimension = diagram["dimension"].GetUint();
-    auto betti     = diagram["betti"].GetUint();
-    auto size      = diagram["size"].GetUint();
+    PersistenceDiagram D;
+    std::string name;
+
+    bool hasBetti = false;
+    bool hasSize  = false;
 
-    PersistenceDiagram persistenceDiagram;
-    persistenceDiagram.setDimension( dimension );
+    std::size_t betti = 0;
+    std::size_t size  = 0;
+  };
 
-    for( auto&& point : diagram["diagram"].GetArray() )
+  // Reads the value of a field of a persistence diagram. Returns true if
+  // the field belongs to a persistence diagram.
+  bool field( const std::string& key, Entry& entry )
+  {
+    if( key == "betti" )
+    {
+      entry.betti    = aleph::utilities::parse<std::size_t>( _stream.value() );
+      entry.hasBetti = true;
+    }
+    else if( key == "dimension" )
+      entry.D.setDimension( aleph::utilities::parse<std::size_t>( _stream.value() ) );
+    else if( key == "name" )
+      entry.name = _stream.value();
+    else if( key == "size" )
     {
-      auto x  = aleph::utilities::convert<T>( point[0].GetString() );
-      auto y  = aleph::utilities::convert<T>( point[1].GetString() );
+      entry.size    = aleph::utilities::parse<std::size_t>( _stream.value() );
+      entry.hasSize = true;
+    }
+    else if( key == "diagram" )
+    {
+      _stream.expect( '[' );
+
+      if( !_stream.consume( ']' ) )
+      {
+        do
+        {
+          _stream.expect( '[' );
+
+          auto x = aleph::utilities::parse<T>( _stream.value() );
+          _stream.expect( ',' );
+          auto y = aleph::utilities::parse<T>( _stream.value() );
+
+          _stream.expect( ']' );
+
+          entry.D.add( x,y );
+        }
+        while( _stream.consume( ',' ) );
 
-      persistenceDiagram.add( x,y );
+        _stream.expect( ']' );
+      }
     }
+    else
+    {
+      _stream.skip();
+      return false;
+    }
+
+    return true;
+  }
 
-    if( persistenceDiagram.size() != size )
+  void finish( Entry& entry, PersistenceDiagram& D )
+  {
+    if( entry.hasSize && entry.D.size() != entry.size )
       throw std::runtime_error( "Stored number of points does not match number of points in persistence diagram" );
 
-    if( persistenceDiagram.betti() != betti )
+    if( entry.hasBetti && entry.D.betti() != entry.betti )
       throw std::runtime_error( "Stored Betti number does not match Betti number of persistence diagram" );
 
-    persistenceDiagrams.emplace_back( persistenceDiagram );
+    D     = std::move( entry.D );
+    _name = std::move( entry.name );
   }
 
-  return persistenceDiagrams;
+  detail::JSONStream _stream;
+  State _state = State::Done;
+  bool _first  = true;
 
-#else
+  Entry _pending;
+  std::string _name;
+};
 
-  // I'm only doing this because the compiler should not complain about
-  // unused parameters.
-  (void) in;
+/**
+  Reads multiple persistence diagrams from an input stream in JSON
+  format and reports every diagram, along with its name, to a functor.
+  Diagrams are processed one at a time, so the memory requirements do
+  not depend on the size of the input.
+*/
 
-  return {};
-#endif
+template <class T, class Functor> void readJSON( std::istream& in, Functor functor )
+{
+  JSONReader<T> reader( in );
+  aleph::PersistenceDiagram<T> D;
+
+  while( reader( D ) )
+    functor( std::move( D ), reader.name() );
+}
+
+/**
+  Reads multiple persistence diagrams from a JSON input file and reports
+  every diagram, along with its name, to a functor.
+*/
+
+template <class T, class Functor> void readJSON( const std::string& filename, Functor functor )
+{
+  std::ifstream in( filename );
+  if( !in )
+    throw std::runtime_error( "Unable to read input file" );
+
+  readJSON<T>( in, functor );
+}
+
+/**
+  Reads multiple persistence diagrams from an input stream in JSON
+  format. The stream is checked for consistency; appropriate error
+  messages will be raised if necessary.
+*/
+
+template <class T> std::vector< aleph::PersistenceDiagram<T> > readJSON( std::istream& in )
+{
+  std::vector< aleph::PersistenceDiagram<T> > persistenceDiagrams;
+
+  readJSON<T>( in, [&persistenceDiagrams] ( aleph::PersistenceDiagram<T>&& D, const std::string& )
+                   {
+                     persistenceDiagrams.emplace_back( std::move( D ) );
+                   } );
+
+  return persistenceDiagrams;
 }
 
 /**
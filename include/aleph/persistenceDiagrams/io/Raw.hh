@@ -37,21 +37,20 @@ template <class T> PersistenceDiagram<T> load( const std::string& filename )
   using namespace aleph::utilities;
 
   PersistenceDiagram<T> persistenceDiagram;
+  Tokenizer tokenizer;
 
   std::string line;
   while( std::getline( in, line ) )
   {
-    line = trim( line );
+    auto&& tokens = tokenizer( line );
 
-    if( line.empty() || line.front() == '#' )
+    if( tokens.empty() || tokens.front().front() == '#' )
       continue;
 
-    auto tokens = split( line );
-
     if( tokens.size() >= 2 )
     {
-      T a = convert<T>( tokens[0] );
-      T b = convert<T>( tokens[1] );
+      T a = parse<T>( tokens[0] );
+      T b = parse<T>( tokens[1] );
 
       persistenceDiagram.add( a, b );
     }
@@ -85,6 +85,17 @@ public:
     return _isDualized;
   }
 
+  /**
+    Marks the matrix as being dualized or not. This does not change the
+    columns of the matrix; it is only required when the matrix has been
+    restored from a file, for example.
+  */
+
+  void setDualized( bool value = true )
+  {
+    _isDualized = value;
+  }
+
   // Comparison --------------------------------------------------------
 
   bool operator==( const BoundaryMatrix& other ) const
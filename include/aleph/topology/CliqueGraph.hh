@@ -3,10 +3,13 @@
 
 #include <aleph/topology/SimplicialComplex.hh>
 
+#include <algorithm>
 #include <iterator>
 #include <list>
 #include <map>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace aleph
@@ -111,6 +114,103 @@ template <class Simplex> SimplicialComplex<Simplex> getCliqueGraph( const Simpli
   return L;
 }
 
+/**
+  Extracts the clique graphs of all dimensions k in [minK, maxK] at once.
+  In contrast to calling getCliqueGraph() for every dimension, this only
+  requires a single pass over the simplicial complex: all k-simplices in
+  the requested range are assigned to their boundary faces in one shared
+  co-face index, from which the edges of every clique graph are created.
+
+  The clique graphs of the individual dimensions are built concurrently
+  if OpenMP is available.
+
+  @param K    Simplicial complex; the filtration order is used to assign
+              vertex indices, as in getCliqueGraph()
+
+  @param minK Minimum dimension of the clique graphs
+  @param maxK Maximum dimension of the clique graphs
+
+  @returns Vector of clique graphs, indexed by their dimension k. Entries
+           whose dimension is less than minK are empty.
+*/
+
+template <class Simplex> std::vector< SimplicialComplex<Simplex> > getCliqueGraphs( const SimplicialComplex<Simplex>& K, unsigned minK, unsigned maxK )
+{
+  using DataType   = typename Simplex::DataType;
+  using VertexType = typename Simplex::VertexType;
+
+  // Every simplex of the clique graph is described by its index in the
+  // filtration order of the simplicial complex and its data. Storing the
+  // data here saves me from having to look it up again afterwards.
+  using Node = std::pair<std::size_t, DataType>;
+
+  std::vector< SimplicialComplex<Simplex> > cliqueGraphs( maxK + 1 );
+
+  if( minK > maxK )
+    return cliqueGraphs;
+
+  // Shared co-face index: for every k, this maps the (k-1)-dimensional
+  // faces to their k-dimensional co-faces. The nodes for the clique graph
+  // of dimension k are stored separately.
+  std::vector< std::unordered_map<Simplex, std::vector<Node> > > cofaceMaps( maxK + 1 );
+  std::vector< std::vector<Node> > nodes( maxK + 1 );
+
+  {
+    std::size_t index = 0;
+    for( auto it = K.begin(); it != K.end(); ++it, ++index )
+    {
+      auto k = it->dimension();
+      if( k < minK || k > maxK )
+        continue;
+
+      nodes[k].push_back( std::make_pair( index, it->data() ) );
+
+      for( auto itFace = it->begin_boundary(); itFace != it->end_boundary(); ++itFace )
+        cofaceMaps[k][ *itFace ].push_back( nodes[k].back() );
+    }
+  }
+
+  auto n = static_cast<long>( maxK ) - static_cast<long>( minK ) + 1;
+
+  #pragma omp parallel for schedule(dynamic)
+  for( long i = 0; i < n; i++ )
+  {
+    auto k = static_cast<std::size_t>( minK ) + static_cast<std::size_t>( i );
+
+    std::vector<Simplex> simplices;
+    simplices.reserve( nodes[k].size() );
+
+    for( auto&& node : nodes[k] )
+      simplices.push_back( Simplex( VertexType( node.first ), node.second ) );
+
+    for( auto&& pair : cofaceMaps[k] )
+    {
+      auto&& cofaces = pair.second;
+
+      for( std::size_t u = 0; u < cofaces.size(); u++ )
+      {
+        for( std::size_t v = u+1; v < cofaces.size(); v++ )
+        {
+          // Same weight assignment as for the individual clique graphs,
+          // i.e. assuming a growth process.
+          auto data = std::max( cofaces[u].second, cofaces[v].second );
+
+          simplices.push_back( Simplex( {VertexType( cofaces[u].first ), VertexType( cofaces[v].first )}, data ) );
+        }
+      }
+    }
+
+    // Release the memory of the co-face index as soon as possible; it
+    // is not required any more for this dimension.
+    std::unordered_map<Simplex, std::vector<Node> >().swap( cofaceMaps[k] );
+
+    cliqueGraphs[k] = SimplicialComplex<Simplex>( std::make_move_iterator( simplices.begin() ),
+                                                  std::make_move_iterator( simplices.end() ) );
+  }
+
+  return cliqueGraphs;
+}
+
 } // namespace topology
 
 } // namespace aleph
@@ -1,17 +1,17 @@
 #ifndef ALEPH_TOPOLOGY_MESH_HH__
 #define ALEPH_TOPOLOGY_MESH_HH__
 
-#include <cassert>
-
 #include <algorithm>
 #include <iterator>
 #include <limits>
-#include <memory>
 #include <stdexcept>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <cstddef>
+
 #include <aleph/topology/UnionFind.hh>
 
 namespace aleph
@@ -27,158 +27,105 @@ namespace topology
   This data structure is capable of representing two-dimensional piecewise
   linear manifolds. In order to speed up standard queries, this class uses
   a standard half-edge data structure.
+
+  All elements of the mesh are stored in contiguous arrays and refer to
+  each other by their index, so traversals do not have to follow pointers
+  scattered across the heap. Every vertex has an ID, which is used by all
+  public functions; if IDs are assigned consecutively, they are equal to
+  the internal indices and no look-up is required.
+
+  Faces should preferably be added in bulk via addFaces(), which pairs all
+  half-edges at once. Adding faces one after the other is supported, but
+  the boundary of the mesh needs to be updated for every face.
 */
 
 template <class Position = float, class Data = float> class Mesh
 {
 public:
-  struct Face;
-  struct HalfEdge;
-  struct Vertex;
-
-  using Index           = std::size_t;
-
-  using FacePointer     = std::shared_ptr<Face>;
-  using HalfEdgePointer = std::shared_ptr<HalfEdge>;
-  using VertexPointer   = std::shared_ptr<Vertex>;
-
-  struct HalfEdge
-  {
-    FacePointer   face;
-    VertexPointer vertex;
-
-    HalfEdgePointer next; // Next half-edge (counter-clockwise)
-    HalfEdgePointer prev; // Previous half-edge
-    HalfEdgePointer pair; // Opposite half-edge
-
-    VertexPointer source() const noexcept
-    {
-      return pair->vertex;
-    }
-
-    VertexPointer target() const noexcept
-    {
-      return vertex;
-    }
-  };
+  using Index = std::size_t;
 
-  struct Face
-  {
-    HalfEdgePointer edge;
-
-    /**
-      Collects all vertices of the given face. Vertex IDs will be
-      returned in the order in which they are traversed along the
-      face.
-    */
-
-    std::vector<Index> vertices() const
-    {
-      std::vector<Index> v;
-
-      auto e = edge;
-
-      do
-      {
-        v.push_back( e->source()->id );
-        e = e->next;
-      }
-      while( e != edge );
-
-      return v;
-    }
-  };
-
-  struct Vertex
-  {
-    Index    id   = Index();
-    Position x    = Position();
-    Position y    = Position();
-    Position z    = Position();
-    Data     data = Data();
-
-    HalfEdgePointer edge;
-  };
+  /** Invalid index, used for missing faces or edges */
+  static constexpr Index invalid = std::numeric_limits<Index>::max();
 
   // Mesh attributes ---------------------------------------------------
 
-  std::vector<Index> vertices() const noexcept
+  std::vector<Index> vertices() const
   {
-    std::vector<Index> result;
-    result.reserve( _vertices.size() );
-
-    for( auto&& pair : _vertices )
-      result.push_back( pair.first );
-
-    return result;
+    return _ids;
   }
 
   std::size_t numVertices() const noexcept
   {
-    return _vertices.size();
+    return _ids.size();
   }
 
-  // TODO: Better return type?
-  std::vector< std::vector<Index> > faces() const noexcept
-  {
-    std::unordered_set<FacePointer> faces;
-
-    for( auto&& pair : _vertices )
-    {
-      auto&& vertex = pair.second;
-      auto&& edge   = vertex->edge;
-      auto&& face   = edge->face;
-
-      if( face )
-        faces.insert( face );
-    }
+  /**
+    Collects all faces of the mesh. Every face is described by the IDs of
+    its vertices, in the order in which they were specified.
+  */
 
+  std::vector< std::vector<Index> > faces() const
+  {
     std::vector< std::vector<Index> > results;
-    results.reserve( faces.size() );
+    results.reserve( _faceEdge.size() );
 
-    for( auto&& face : faces )
-      results.push_back( face->vertices() );
+    for( Index f = 0; f < _faceEdge.size(); f++ )
+      results.push_back( this->faceVertices( f ) );
 
     return results;
   }
 
   std::size_t numFaces() const noexcept
   {
-    std::unordered_set<FacePointer> faces;
-
-    for( auto&& pair : _vertices )
-    {
-      auto&& vertex = pair.second;
-      auto&& edge   = vertex->edge;
-      auto&& face   = edge->face;
-
-      if( face )
-        faces.insert( face );
-    }
+    return _faceEdge.size();
+  }
 
-    return faces.size();
+  /** @returns Number of half-edges, including those on the boundary */
+  std::size_t numHalfEdges() const noexcept
+  {
+    return _heTarget.size();
   }
 
   // Mesh modification -------------------------------------------------
 
+  /** Reserves storage for the given number of vertices */
+  void reserveVertices( std::size_t n )
+  {
+    _ids.reserve( n );
+    _positions.reserve( 3*n );
+    _data.reserve( n );
+    _vertexEdge.reserve( n );
+  }
+
   /** Adds a new vertex to the mesh */
-  void addVertex( Position x, Position y, Position z, Data data = Data(), Index id = std::numeric_limits<Index>::max() )
+  void addVertex( Position x, Position y, Position z, Data data = Data(), Index id = invalid )
   {
-    Vertex v;
+    Index index = _ids.size();
 
-    v.id   = id == std::numeric_limits<Index>::max() ? std::max( _vertices.size(), _largestVertexID ) : id;
-    v.x    = x;
-    v.y    = y;
-    v.z    = z;
-    v.data = data;
+    if( id == invalid )
+      id = _ids.empty() ? 0 : std::max( _ids.size(), _largestVertexID + 1 );
 
-    auto pair = _vertices.insert( std::make_pair( v.id,
-                                  std::make_shared<Vertex>( v ) ) );
+    if( _consecutiveIDs && id != index )
+    {
+      // Vertex IDs are no longer equal to their indices, so I need to
+      // start keeping track of them.
+      _consecutiveIDs = false;
+
+      for( Index i = 0; i < _ids.size(); i++ )
+        _indices[ _ids[i] ] = i;
+    }
 
-    if( !pair.second )
+    if( !_consecutiveIDs && !_indices.insert( std::make_pair( id, index ) ).second )
       throw std::runtime_error( "Vertex ID must be unique" );
 
-    _largestVertexID = std::max( _largestVertexID, v.id );
+    _ids.push_back( id );
+    _positions.push_back( x );
+    _positions.push_back( y );
+    _positions.push_back( z );
+    _data.push_back( data );
+    _vertexEdge.push_back( invalid );
+
+    _largestVertexID = std::max( _largestVertexID, id );
   }
 
   /**
@@ -189,127 +136,126 @@ public:
 
   template <class InputIterator> void addFace( InputIterator begin, InputIterator end )
   {
-    FacePointer face = std::make_shared<Face>();
+    std::vector<Index> face;
 
-    // Stores all half-edges created (or found) by this function in the
-    // order in which they belong to the face.
-    std::vector<HalfEdgePointer> edges;
-    edges.reserve( static_cast<std::size_t>( std::distance( begin, end ) ) );
+    for( auto it = begin; it != end; ++it )
+      face.push_back( this->index( static_cast<Index>( *it ) ) );
 
-    for( InputIterator it = begin; it != end; ++it )
-    {
-      auto curr = it;
-      auto next = std::next( it );
+    if( face.size() < 3 )
+      throw std::runtime_error( "Face requires at least three vertices" );
 
-      if( next == end )
-        next = begin;
+    // Look up existing half-edges before modifying anything, because the
+    // traversal relies on the boundary being linked properly.
+    std::vector<Index> existing( face.size() );
 
-      auto source = _vertices.at( *curr );   // Edge source vertex
-      auto target = _vertices.at( *next );   // Edge target vertex
-      auto edge   = getEdge( *curr, *next ); // Edge
+    for( std::size_t i = 0; i < face.size(); i++ )
+      existing[i] = this->findHalfEdge( face[i], face[ (i+1) % face.size() ] );
 
-      // Case 1: A new edge. Create a new edge and a new pair. Set edges
-      // of source and target vertex correctly. Moreover, initialize the
-      // paired edge with sensible default values.
-      if( !edge )
-      {
-        edge      = std::make_shared<HalfEdge>();
-        auto pair = std::make_shared<HalfEdge>();
+    Index f     = _faceEdge.size();
+    Index first = invalid;
+
+    std::vector<Index> edges;
+    edges.reserve( face.size() );
+
+    for( std::size_t i = 0; i < face.size(); i++ )
+    {
+      auto u = face[i];
+      auto v = face[ (i+1) % face.size() ];
+      auto e = existing[i];
 
-        pair->vertex = source; // This is flipped by design: We point to the
-                               // target vertex of the flipped edge. This is
-                               // just the source vertex again.
+      // Case 1: A new edge. Create a new half-edge along with its pair,
+      // which forms part of the boundary until another face claims it.
+      if( e == invalid )
+      {
+        e = this->addHalfEdge( v, f );
+        this->addHalfEdge( u, invalid );
 
-        pair->pair   = edge;
-        edge->pair   = pair;
+        _hePair[e]   = e+1;
+        _hePair[e+1] = e;
 
-        if( !source->edge )
-          source->edge = edge;
+        if( _vertexEdge[u] == invalid )
+          _vertexEdge[u] = e;
 
-        if( !target->edge )
-          target->edge = pair;
+        if( _vertexEdge[v] == invalid )
+          _vertexEdge[v] = e+1;
       }
 
+      // Case 2: The half-edge already exists on the boundary
+      else if( _heFace[e] == invalid )
+        _heFace[e] = f;
+      else
+        throw std::runtime_error( "Edge is already part of a face with the same orientation" );
+
       // Ensures that the first edge that is specified for the new face
       // will be set as the outgoing edge of the face. This is not just
       // a 'cosmetic' choice but also ensures that vertex IDs for every
       // face are reported in the original order.
-      if( !face->edge )
-        face->edge = edge;
-
-      assert( !edge->face );
-      assert(  edge->pair );
+      if( first == invalid )
+        first = e;
 
-      edge->face   = face;
-      edge->vertex = target;
-
-      edges.push_back( edge );
+      edges.push_back( e );
     }
 
-    // Set 'next' and 'prev' pointers correctly ------------------------
-    //
-    // We first traverse all edges that bound the current face. Here, it
-    // should be possible to traverse the face directly, so we require a
-    // proper pointer in both directions.
+    _faceEdge.push_back( first );
 
-    for( auto itEdge = edges.begin(); itEdge != edges.end(); ++itEdge )
+    for( std::size_t i = 0; i < edges.size(); i++ )
     {
-      auto curr = itEdge;
-      auto prev = std::prev( curr );
-      auto next = std::next( curr );
+      auto curr = edges[i];
+      auto next = edges[ (i+1) % edges.size() ];
 
-      if( curr == edges.begin() )
-        prev = std::prev( edges.end() );
+      _heNext[curr] = next;
+      _hePrev[next] = curr;
+    }
 
-      if( next == edges.end() )
-        next = edges.begin();
+    this->linkBoundary();
+  }
 
-      auto&& edge = *itEdge;
+  /**
+    Adds multiple faces to the mesh at once. Every face is a container of
+    vertex IDs, whose order determines the orientation of the face. All
+    half-edges are paired by sorting them, and the boundary of the mesh is
+    only updated once, so this is considerably faster than adding faces
+    one after the other.
+
+    The function throws if an edge is shared by more than two faces, or if
+    two faces sharing an edge are oriented inconsistently.
+  */
 
-      edge->next = *next;
-      edge->prev = *prev;
-    }
+  template <class InputIterator> void addFaces( InputIterator begin, InputIterator end )
+  {
+    // Remove existing boundary edges: the pairing below recreates them
+    // for all edges that remain unpaired.
+    this->removeBoundary();
 
-    // Extend boundary -------------------------------------------------
-    //
-    // Traverse all vertices whose paired edges have an empty face. Any
-    // of these edges is part of the boundary face.
+    for( auto it = begin; it != end; ++it )
+      this->appendFace( std::begin( *it ), std::end( *it ) );
 
-    for( auto&& pair : _vertices )
-    {
-      auto&& vertex = pair.second;
+    this->pairHalfEdges();
+    this->linkBoundary();
+  }
 
-      if( !vertex->edge || vertex->edge->pair->face )
-        continue;
+  /**
+    Adds multiple faces to the mesh at once, using a compressed format:
+    the vertex IDs of face i are stored in the range [offsets[i],
+    offsets[i+1]) of the given vector of vertices. This avoids storing
+    every face in a separate container.
+  */
 
-      auto curr = vertex->edge->target();
-      auto edge = vertex->edge->pair;
+  template <class T> void addFaces( const std::vector<T>& offsets, const std::vector<T>& vertices )
+  {
+    this->removeBoundary();
 
-      do
-      {
-        assert( !edge->face );
-        auto edges = this->getEdges( *curr );
-
-        for( auto&& e : edges )
-        {
-          if( !e->pair->face )
-          {
-            e->pair->next = edge;
-            edge->prev    = e->pair;
-
-            edge          = e->pair;
-            curr          = e->pair->pair->target();
-            break;
-          }
-        }
-      }
-      while( curr != vertex );
+    for( std::size_t i = 0; i + 1 < offsets.size(); i++ )
+    {
+      if( offsets[i] > offsets[i+1] || std::size_t( offsets[i+1] ) > vertices.size() )
+        throw std::runtime_error( "Invalid offsets for faces" );
 
-      // Close the loop around the boundary face by adding a pointer to
-      // the identified edge.
-      vertex->edge->pair->next = edge;
-      edge->prev               = vertex->edge->pair;
+      this->appendFace( vertices.begin() + static_cast<std::ptrdiff_t>( offsets[i] ),
+                        vertices.begin() + static_cast<std::ptrdiff_t>( offsets[i+1] ) );
     }
+
+    this->pairHalfEdges();
+    this->linkBoundary();
   }
 
   // Mesh queries ------------------------------------------------------
@@ -317,8 +263,39 @@ public:
   /** Returns data stored at a certain vertex */
   Data data( Index id ) const
   {
-    auto v = this->getVertex( id );
-    return v->data;
+    return _data[ this->index( id ) ];
+  }
+
+  /** Returns the position of a certain vertex */
+  std::tuple<Position, Position, Position> position( Index id ) const
+  {
+    auto i = this->index( id );
+    return std::make_tuple( _positions[3*i], _positions[3*i+1], _positions[3*i+2] );
+  }
+
+  /**
+    Maps a vertex ID to its index, i.e. its position in the vector that is
+    returned by vertices(). Per-vertex arrays are indexed this way.
+  */
+
+  Index index( Index id ) const
+  {
+    if( _consecutiveIDs )
+    {
+      if( id >= _ids.size() )
+        throw std::out_of_range( "Unknown vertex ID" );
+
+      return id;
+    }
+    else
+      return _indices.at( id );
+  }
+
+  /** Checks whether a vertex is part of the boundary of the mesh */
+  bool isBoundary( Index id ) const
+  {
+    auto e = _vertexEdge[ this->index( id ) ];
+    return e != invalid && _heFace[e] == invalid;
   }
 
   /**
@@ -330,34 +307,34 @@ public:
   {
     Mesh M;
 
-    auto vertex = this->getVertex( id );
-    auto faces  = this->getFaces( *vertex );
+    auto faces = this->incidentFaces( this->index( id ) );
 
     {
       std::unordered_set<Index> vertices;
 
       for( auto&& f : faces )
       {
-        auto&& v = f->vertices();
+        auto&& v = this->faceVertices( f );
         vertices.insert( v.begin(), v.end() );
       }
 
       for( auto&& v : vertices )
       {
-        auto oldVertex = this->getVertex( v );
+        auto i = this->index( v );
 
-        M.addVertex( oldVertex->x, oldVertex->y, oldVertex->z,
-                     oldVertex->data,
-                     oldVertex->id );
+        M.addVertex( _positions[3*i], _positions[3*i+1], _positions[3*i+2],
+                     _data[i],
+                     v );
       }
     }
 
+    std::vector< std::vector<Index> > starFaces;
+    starFaces.reserve( faces.size() );
+
     for( auto&& f : faces )
-    {
-      auto&& vertices = f->vertices();
-      M.addFace( vertices.begin(), vertices.end() );
-    }
+      starFaces.push_back( this->faceVertices( f ) );
 
+    M.addFaces( starFaces.begin(), starFaces.end() );
     return M;
   }
 
@@ -370,67 +347,46 @@ public:
     in an order that is consistent with the orientation of the mesh.
   */
 
-  std::vector<Index> link( Index id ) const noexcept
+  std::vector<Index> link( Index id ) const
   {
-    auto&& vertex     = this->getVertex( id );
-    auto&& neighbours = this->getNeighbours( *vertex );
-
     std::vector<Index> result;
-    result.reserve( neighbours.size() );
 
-    for( auto&& neighbour : neighbours )
-      result.push_back( neighbour->id );
+    this->forEachNeighbour( this->index( id ), [this, &result] ( Index v )
+    {
+      result.push_back( _ids[v] );
+    } );
 
     return result;
   }
 
-  std::vector<Index> getLowerNeighbours( Index id ) const noexcept
+  std::vector<Index> getLowerNeighbours( Index id ) const
   {
-    auto&& vertex     = this->getVertex( id );
-    auto&& neighbours = this->getNeighbours( *vertex );
-    auto&& data       = vertex->data;
-
-    neighbours.erase( std::remove_if( neighbours.begin(), neighbours.end(),
-                                      [&data] ( const VertexPointer& neighbour )
-                                      {
-                                        return neighbour->data >= data;
-                                      } ),
-                      neighbours.end() );
-
     std::vector<Index> result;
-    result.reserve( neighbours.size() );
 
-    std::transform( neighbours.begin(), neighbours.end(), std::back_inserter( result ),
-                    [] ( const VertexPointer& neighbour )
-                    {
-                      return neighbour->id;
-                    } );
+    auto u    = this->index( id );
+    auto data = _data[u];
+
+    this->forEachNeighbour( u, [this, &data, &result] ( Index v )
+    {
+      if( _data[v] < data )
+        result.push_back( _ids[v] );
+    } );
 
     return result;
   }
 
-  std::vector<Index> getHigherNeighbours( Index id ) const noexcept
+  std::vector<Index> getHigherNeighbours( Index id ) const
   {
-    auto&& vertex     = this->getVertex( id );
-    auto&& neighbours = this->getNeighbours( *vertex );
-    auto&& data       = vertex->data;
-
-    neighbours.erase( std::remove_if( neighbours.begin(), neighbours.end(),
-                                      [&data] ( const VertexPointer& neighbour )
-                                      {
-                                        return neighbour->data <= data;
-                                      } ),
-                      neighbours.end() );
-
     std::vector<Index> result;
-    result.reserve( neighbours.size() );
 
-    std::transform( neighbours.begin(), neighbours.end(), std::back_inserter( result ),
-                    [] ( const VertexPointer& neighbour )
-                    {
-                      return neighbour->id;
-                    } );
+    auto u    = this->index( id );
+    auto data = _data[u];
 
+    this->forEachNeighbour( u, [this, &data, &result] ( Index v )
+    {
+      if( _data[v] > data )
+        result.push_back( _ids[v] );
+    } );
 
     return result;
   }
@@ -442,30 +398,32 @@ public:
 
   bool hasEdge( Index u, Index v ) const
   {
-    auto&& source = this->getVertex(u);
-    auto&& target = this->getVertex(v);
+    auto source = this->index(u);
+    auto target = this->index(v);
 
-    auto neighbours = this->getNeighbours( *source );
+    bool found = false;
 
-    return std::find( neighbours.begin(), neighbours.end(), target ) != neighbours.end();
+    this->forEachNeighbour( source, [&found, &target] ( Index w )
+    {
+      found = found || w == target;
+    } );
+
+    return found;
   }
 
   /** Counts the number of connected components */
-  std::size_t numConnectedComponents() const noexcept
+  std::size_t numConnectedComponents() const
   {
     auto&& vertices = this->vertices();
 
     UnionFind<Index> uf( vertices.begin(), vertices.end() );
 
-    for( auto&& vertex : vertices )
+    // Every edge of the mesh is stored as two half-edges, so it suffices
+    // to consider one of them.
+    for( Index e = 0; e < _heTarget.size(); e++ )
     {
-      auto&& v      = _vertices.at( vertex );
-      auto&& e      = v->edge;
-      auto&& source = e->source()->id;
-      auto&& target = e->target()->id;
-
-      // Actually, the order does not matter one bit here...
-      uf.merge( target, source );
+      if( e < _hePair[e] )
+        uf.merge( _ids[ _heTarget[e] ], _ids[ _heTarget[ _hePair[e] ] ] );
     }
 
     std::vector<Index> roots;
@@ -476,115 +434,352 @@ public:
 
 private:
 
-  /** Gets all vertices that are adjacent to a given vertex */
-  std::vector<VertexPointer> getNeighbours( const Vertex& v ) const noexcept
+  /** Source vertex of a half-edge */
+  Index source( Index e ) const noexcept
   {
-    std::vector<VertexPointer> neighbours;
+    return _heTarget[ _hePair[e] ];
+  }
 
-    auto edge = v.edge;
-    do
+  /**
+    Appends the half-edges of a face without pairing them. Every half-edge
+    already knows its successor and predecessor within the face, though.
+  */
+
+  template <class InputIterator> void appendFace( InputIterator begin, InputIterator end )
+  {
+    auto n = static_cast<std::size_t>( std::distance( begin, end ) );
+
+    if( n < 3 )
+      throw std::runtime_error( "Face requires at least three vertices" );
+
+    Index f    = _faceEdge.size();
+    Index base = _heTarget.size();
+
+    _faceEdge.push_back( base );
+
+    auto vertex = begin;
+
+    for( std::size_t i = 0; i < n; i++ )
     {
-      if( edge )
-        neighbours.push_back( edge->target() );
-      else
-        break;
+      auto next = std::next( vertex );
+      if( next == end )
+        next = begin;
+
+      Index e = this->addHalfEdge( this->index( static_cast<Index>( *next ) ), f );
 
-      edge = edge->prev->pair;
+      _heNext[e] = base + ( i + 1 ) % n;
+      _hePrev[e] = base + ( i + n - 1 ) % n;
+
+      vertex = next;
     }
-    while( edge != v.edge && edge->source()->id == v.id );
+  }
+
+  /** Appends a half-edge and returns its index */
+  Index addHalfEdge( Index target, Index face )
+  {
+    Index e = _heTarget.size();
 
-    return neighbours;
+    _heTarget.push_back( target );
+    _heFace.push_back( face );
+    _heNext.push_back( invalid );
+    _hePrev.push_back( invalid );
+    _hePair.push_back( invalid );
+
+    return e;
   }
 
-  /** Gets all edges that are incident on a given vertex. */
-  std::vector<HalfEdgePointer> getEdges( const Vertex& v ) const noexcept
+  /** Collects all vertex IDs of a face in traversal order */
+  std::vector<Index> faceVertices( Index f ) const
   {
-    std::vector<HalfEdgePointer> edges;
+    std::vector<Index> v;
+
+    auto first = _faceEdge[f];
+    auto e     = first;
 
-    auto edge = v.edge;
     do
     {
-      if( edge )
-        edges.push_back( edge );
-      else
-        break;
-
-      edge = edge->pair->next;
+      v.push_back( _ids[ this->source(e) ] );
+      e = _heNext[e];
     }
-    while( edge != v.edge );
+    while( e != first );
 
-    return edges;
+    return v;
   }
 
-  /** Gets all faces that are incident on a given vertex */
-  std::vector<FacePointer> getFaces( const Vertex& v ) const noexcept
+  /**
+    Calls a functor for all outgoing half-edges of a vertex. The number of
+    steps is bounded in order to guarantee termination for vertices whose
+    neighbourhood is not a disk or a half-disk.
+  */
+
+  template <class Functor> void forEachOutgoingEdge( Index u, Functor f ) const
   {
-    std::vector<FacePointer> faces;
+    auto first = _vertexEdge[u];
+    if( first == invalid )
+      return;
 
-    auto edge = v.edge;
-    do
+    auto e = first;
+
+    for( std::size_t steps = 0; steps < _heTarget.size(); steps++ )
     {
-      if( edge && edge->face )
-        faces.push_back( edge->face );
-      else
+      f( e );
+
+      e = _heNext[ _hePair[e] ];
+
+      if( e == first || e == invalid || this->source(e) != u )
+        break;
+    }
+  }
+
+  /** Calls a functor for all vertices adjacent to a given vertex */
+  template <class Functor> void forEachNeighbour( Index u, Functor f ) const
+  {
+    auto first = _vertexEdge[u];
+    if( first == invalid )
+      return;
+
+    // Traverse in the opposite direction of forEachOutgoingEdge() so that
+    // the link is reported in a consistent orientation.
+    auto e = first;
+
+    for( std::size_t steps = 0; steps < _heTarget.size(); steps++ )
+    {
+      f( _heTarget[e] );
+
+      if( _hePrev[e] == invalid )
         break;
 
-      edge = edge->pair->next;
+      e = _hePair[ _hePrev[e] ];
+
+      if( e == first || this->source(e) != u )
+        break;
     }
-    while( edge != v.edge );
+  }
+
+  /** Gets all faces that are incident on a given vertex */
+  std::vector<Index> incidentFaces( Index u ) const
+  {
+    std::vector<Index> faces;
+
+    this->forEachOutgoingEdge( u, [this, &faces] ( Index e )
+    {
+      if( _heFace[e] != invalid )
+        faces.push_back( _heFace[e] );
+    } );
 
     return faces;
   }
 
   /**
-    Check whether a given (directed) edge already exists. If so,
-    a pointer to the edge is being returned.
+    Check whether a given (directed) half-edge already exists. If so, its
+    index is returned; else, the function returns an invalid index.
   */
 
-  HalfEdgePointer getEdge( Index u, Index v ) const noexcept
+  Index findHalfEdge( Index u, Index v ) const
   {
-    auto source = _vertices.at(u);           // Edge source vertex
-    auto target = _vertices.at(v);           // Edge target vertex
-    auto edges  = this->getEdges( *source ); // Incident edges
-
-    auto itEdge = std::find_if( edges.begin(), edges.end(),
-                                [&source, &target] ( const HalfEdgePointer& edge )
-                                {
-                                  return edge->source() == source && edge->target() == target;
-                                } );
-
-    if( itEdge != edges.end() )
-      return *itEdge;
-    else
-      return nullptr;
+    Index result = invalid;
+
+    this->forEachOutgoingEdge( u, [this, &result, &v] ( Index e )
+    {
+      if( _heTarget[e] == v )
+        result = e;
+    } );
+
+    return result;
+  }
+
+  /**
+    Removes all half-edges on the boundary, i.e. those without a face, and
+    updates the indices of the remaining half-edges.
+  */
+
+  void removeBoundary()
+  {
+    std::vector<Index> map( _heTarget.size(), invalid );
+    Index n = 0;
+
+    for( Index e = 0; e < _heTarget.size(); e++ )
+      if( _heFace[e] != invalid )
+        map[e] = n++;
+
+    if( n == _heTarget.size() )
+      return;
+
+    auto remap = [&map] ( Index e )
+    {
+      return e == invalid ? invalid : map[e];
+    };
+
+    for( Index e = 0; e < _heTarget.size(); e++ )
+    {
+      if( map[e] == invalid )
+        continue;
+
+      auto i = map[e];
+
+      _heTarget[i] = _heTarget[e];
+      _heFace[i]   = _heFace[e];
+      _heNext[i]   = remap( _heNext[e] );
+      _hePrev[i]   = remap( _hePrev[e] );
+      _hePair[i]   = remap( _hePair[e] );
+    }
+
+    _heTarget.resize( n );
+    _heFace.resize( n );
+    _heNext.resize( n );
+    _hePrev.resize( n );
+    _hePair.resize( n );
+
+    for( auto&& e : _faceEdge )
+      e = remap( e );
   }
 
   /**
-    Returns vertex with the given ID. This is an internal function
-    that is used to obtain all information about a vertex.
+    Pairs all half-edges of all faces by sorting them according to their
+    vertices. Unpaired half-edges obtain a new pair on the boundary.
   */
 
-  VertexPointer getVertex( Index id ) const
+  void pairHalfEdges()
   {
-    return _vertices.at( id );
+    struct Entry
+    {
+      Index a;      // Smaller vertex
+      Index b;      // Larger vertex
+      Index source; // Source vertex
+      Index edge;   // Half-edge
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve( _heTarget.size() );
+
+    // The source of a half-edge is the target of its predecessor within
+    // the face, which is known even if the half-edge is not yet paired.
+    for( Index e = 0; e < _heTarget.size(); e++ )
+    {
+      auto s = _heTarget[ _hePrev[e] ];
+      auto t = _heTarget[e];
+
+      entries.push_back( { std::min(s,t), std::max(s,t), s, e } );
+    }
+
+    std::sort( entries.begin(), entries.end(),
+               [] ( const Entry& x, const Entry& y )
+               {
+                 return std::tie( x.a, x.b, x.edge ) < std::tie( y.a, y.b, y.edge );
+               } );
+
+    for( std::size_t i = 0; i < entries.size(); )
+    {
+      std::size_t j = i;
+      while( j < entries.size() && entries[j].a == entries[i].a && entries[j].b == entries[i].b )
+        ++j;
+
+      if( j - i > 2 )
+        throw std::runtime_error( "Edge is shared by more than two faces" );
+      else if( j - i == 2 )
+      {
+        if( entries[i].source == entries[i+1].source )
+          throw std::runtime_error( "Faces sharing an edge are oriented inconsistently" );
+
+        _hePair[ entries[i].edge ]   = entries[i+1].edge;
+        _hePair[ entries[i+1].edge ] = entries[i].edge;
+      }
+      else
+      {
+        auto e = entries[i].edge;
+        auto b = this->addHalfEdge( entries[i].source, invalid );
+
+        _hePair[e] = b;
+        _hePair[b] = e;
+      }
+
+      i = j;
+    }
+
+    std::fill( _vertexEdge.begin(), _vertexEdge.end(), invalid );
+
+    for( Index e = 0; e < _heTarget.size(); e++ )
+    {
+      auto u = this->source(e);
+      if( _vertexEdge[u] == invalid )
+        _vertexEdge[u] = e;
+    }
   }
 
   /**
-   Stores largest vertex ID. This is required in order to ensure
-   that vertex IDs are not assigned multiple times when the user
-   adds vertices one after the other.
+    Links all half-edges on the boundary such that they form cycles. The
+    successor of a boundary half-edge is the boundary half-edge starting
+    at its target. Afterwards, every vertex on the boundary uses its
+    outgoing boundary half-edge, so that traversals around the vertex
+    visit all incident faces.
   */
 
-  Index _largestVertexID = Index();
+  void linkBoundary()
+  {
+    std::vector<Index> outgoing( _ids.size(), invalid );
+
+    for( Index e = 0; e < _heTarget.size(); e++ )
+    {
+      if( _heFace[e] == invalid )
+      {
+        outgoing[ this->source(e) ] = e;
+        _hePrev[e]                  = invalid;
+      }
+    }
+
+    for( Index e = 0; e < _heTarget.size(); e++ )
+    {
+      if( _heFace[e] != invalid )
+        continue;
+
+      auto next  = outgoing[ _heTarget[e] ];
+      _heNext[e] = next;
+
+      if( next != invalid )
+        _hePrev[next] = e;
+
+      _vertexEdge[ this->source(e) ] = outgoing[ this->source(e) ];
+    }
+  }
+
+  // Vertices ----------------------------------------------------------
+
+  std::vector<Index>    _ids;        // External IDs
+  std::vector<Position> _positions;  // x, y, z for every vertex
+  std::vector<Data>     _data;
+  std::vector<Index>    _vertexEdge; // Outgoing half-edge
+
+  // Half-edges --------------------------------------------------------
+
+  std::vector<Index> _heTarget;
+  std::vector<Index> _heFace;
+  std::vector<Index> _heNext;   // Next half-edge (counter-clockwise)
+  std::vector<Index> _hePrev;   // Previous half-edge
+  std::vector<Index> _hePair;   // Opposite half-edge
+
+  // Faces -------------------------------------------------------------
+
+  std::vector<Index> _faceEdge;
 
   /**
-    Stores all vertex pointers. This is sufficient to store the
-    complete mesh.
+    Indicates whether vertex IDs are equal to their indices. If not, the
+    map of indices needs to be used.
   */
 
-  std::unordered_map<Index, VertexPointer> _vertices;
+  bool _consecutiveIDs = true;
+  std::unordered_map<Index, Index> _indices;
+
+  /**
+   Stores largest vertex ID. This is required in order to ensure
+   that vertex IDs are not assigned multiple times when the user
+   adds vertices one after the other.
+  */
+
+  Index _largestVertexID = Index();
 };
 
+template <class Position, class Data> constexpr typename Mesh<Position, Data>::Index Mesh<Position, Data>::invalid;
+
 } // namespace topology
 
 } // namespace aleph
@@ -2,12 +2,10 @@
 #define ALEPH_TOPOLOGY_MORSE_SMALE_COMPLEX__
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
-// TODO: Remove after debugging
-#include <iostream>
-
-#include <aleph/topology/UnionFind.hh>
+#include <cstddef>
 
 namespace aleph
 {
@@ -15,102 +13,310 @@ namespace aleph
 namespace topology
 {
 
+/** Classification of a vertex with respect to a scalar function */
+enum class CriticalPointType : int
+{
+  Regular = 0,
+  Minimum = 1,
+  Saddle  = 2,
+  Maximum = 3
+};
+
+/**
+  @struct MorseSmaleSegmentation
+  @brief Per-vertex segmentation of a mesh induced by a scalar function
+
+  All arrays are indexed like the vertices of the mesh, i.e. in the order
+  of `Mesh::vertices()`, so they can be written directly as vertex
+  properties by the PLY and VTK writers. Labels refer to vertex IDs.
+*/
+
+template <class Index> struct MorseSmaleSegmentation
+{
+  /** Type of every vertex */
+  std::vector<CriticalPointType> types;
+
+  /** Neighbour of steepest ascent of every vertex; maxima point to themselves */
+  std::vector<Index> ascent;
+
+  /** Neighbour of steepest descent of every vertex; minima point to themselves */
+  std::vector<Index> descent;
+
+  /**
+    Maximum that is reached by following the steepest ascent. All vertices
+    with the same maximum form its descending manifold.
+  */
+
+  std::vector<Index> descendingManifolds;
+
+  /**
+    Minimum that is reached by following the steepest descent. All vertices
+    with the same minimum form its ascending manifold.
+  */
+
+  std::vector<Index> ascendingManifolds;
+
+  /**
+    Cell of the Morse--Smale complex, i.e. the intersection of a descending
+    and an ascending manifold. Cells are numbered consecutively.
+  */
+
+  std::vector<Index> cells;
+
+  std::vector<Index> minima;
+  std::vector<Index> saddles;
+  std::vector<Index> maxima;
+
+  /** @returns Types as integers, e.g. for writing them to a file */
+  std::vector<int> typesAsIntegers() const
+  {
+    std::vector<int> result( types.size() );
+
+    std::transform( types.begin(), types.end(), result.begin(),
+                    [] ( CriticalPointType t ) { return static_cast<int>( t ); } );
+
+    return result;
+  }
+};
+
+namespace detail
+{
+
+/**
+  Resolves a forest of parent pointers in parallel by pointer jumping:
+  in every round, each element replaces its parent by the parent of its
+  parent, until all elements point to the root of their tree. This
+  requires a logarithmic number of rounds in the depth of the forest.
+*/
+
+template <class Index> void pointerJumping( std::vector<Index>& parent )
+{
+  std::vector<Index> next( parent.size() );
+  bool changed = true;
+
+  while( changed )
+  {
+    changed = false;
+
+    #pragma omp parallel for reduction(||:changed)
+    for( std::size_t i = 0; i < parent.size(); i++ )
+    {
+      next[i]  = parent[ parent[i] ];
+      changed  = changed || next[i] != parent[i];
+    }
+
+    parent.swap( next );
+  }
+}
+
+} // namespace detail
+
+/**
+  @class MorseSmaleComplex
+  @brief Calculates critical points and a Morse--Smale segmentation of a mesh
+
+  The data stored at the vertices of a mesh is interpreted as a piecewise
+  linear function. Ties are broken by the index of a vertex, which
+  simulates a function with distinct values.
+
+  Every vertex is processed independently and in parallel: its steepest
+  ascent and descent are determined among its neighbours, and its type is
+  determined by counting the number of contiguous segments of its lower
+  and upper link. Afterwards, the ascending and descending manifolds are
+  resolved by pointer jumping.
+*/
+
 template <class Mesh> class MorseSmaleComplex
 {
 public:
-  void operator()( const Mesh& M )
-  {
-    std::cerr << "\n";
+  using Index        = typename Mesh::Index;
+  using Segmentation = MorseSmaleSegmentation<Index>;
 
+  Segmentation operator()( const Mesh& M ) const
+  {
     auto&& vertices = M.vertices();
+    auto n          = vertices.size();
+
+    std::vector<decltype( M.data( Index() ) )> values( n );
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < n; i++ )
+      values[i] = M.data( vertices[i] );
 
-    for( auto&& vertex : vertices )
+    // Simulation of simplicity: ties are broken by the index of the
+    // vertex, so no two vertices are considered to be equal.
+    auto less = [&values] ( Index i, Index j )
     {
-      auto higherNeigbours = M.getHigherNeighbours( vertex );
-      auto lowerNeighbours = M.getLowerNeighbours( vertex );
+      return values[i] < values[j] || ( values[i] == values[j] && i < j );
+    };
 
-      std::size_t nl = 0;
-      std::size_t nu = 0;
+    Segmentation S;
 
-      std::tie( nl, nu ) = contiguousSegments( M, vertex );
+    S.types.resize( n );
+    S.ascent.resize( n );
+    S.descent.resize( n );
 
-      std::cerr << "[" << vertex << "]: ";
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      auto&& link = M.link( vertices[i] );
 
-      if( higherNeigbours.empty() )
-        std::cerr << "Maximum\n";
-      else if( lowerNeighbours.empty() )
-        std::cerr << "Minimum\n";
-      else
+      std::vector<Index> neighbours;
+      neighbours.reserve( link.size() );
+
+      for( auto&& id : link )
+        neighbours.push_back( M.index( id ) );
+
+      // For boundary vertices, the link is a path whose first vertex is
+      // reported first, while its remaining vertices are reported in the
+      // order of the path; rotating the link makes it contiguous.
+      bool isBoundary = M.isBoundary( vertices[i] );
+
+      if( isBoundary && !neighbours.empty() )
+        std::rotate( neighbours.begin(), neighbours.begin() + 1, neighbours.end() );
+
+      Index ascent  = Index( i );
+      Index descent = Index( i );
+
+      for( auto&& j : neighbours )
       {
-        std::cerr << "Saddle\n";
-        std::cerr << "  +: ";
-        for( auto&& n : higherNeigbours )
-          std::cerr << n << " " ;
-        std::cerr << "\n";
-
-        std::cerr << "  -: ";
-        for( auto&& n : lowerNeighbours )
-          std::cerr << n << " " ;
-        std::cerr << "\n";
+        if( less( ascent, j ) )
+          ascent = j;
+
+        if( less( j, descent ) )
+          descent = j;
       }
 
-      std::cerr << "  nl: " << nl << "\n"
-                << "  nu: " << nu << "\n\n";
+      S.ascent[i]  = ascent;
+      S.descent[i] = descent;
+      S.types[i]   = classify( Index( i ), neighbours, isBoundary, less );
+    }
+
+    S.descendingManifolds = S.ascent;
+    S.ascendingManifolds  = S.descent;
+
+    detail::pointerJumping( S.descendingManifolds );
+    detail::pointerJumping( S.ascendingManifolds );
+
+    // Cells -----------------------------------------------------------
+    //
+    // Every pair of a minimum and a maximum that occurs for some vertex
+    // forms a cell; cells are numbered in the order of their pairs.
+
+    {
+      std::vector< std::pair<Index, Index> > pairs( n );
 
+      #pragma omp parallel for
+      for( std::size_t i = 0; i < n; i++ )
+        pairs[i] = std::make_pair( S.ascendingManifolds[i], S.descendingManifolds[i] );
+
+      auto unique = pairs;
+
+      std::sort( unique.begin(), unique.end() );
+      unique.erase( std::unique( unique.begin(), unique.end() ), unique.end() );
+
+      S.cells.resize( n );
+
+      #pragma omp parallel for
+      for( std::size_t i = 0; i < n; i++ )
+      {
+        S.cells[i] = static_cast<Index>(
+          std::lower_bound( unique.begin(), unique.end(), pairs[i] ) - unique.begin() );
+      }
+    }
+
+    // Translate indices to IDs ----------------------------------------
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      S.ascent[i]              = vertices[ S.ascent[i] ];
+      S.descent[i]             = vertices[ S.descent[i] ];
+      S.descendingManifolds[i] = vertices[ S.descendingManifolds[i] ];
+      S.ascendingManifolds[i]  = vertices[ S.ascendingManifolds[i] ];
     }
+
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      switch( S.types[i] )
+      {
+      case CriticalPointType::Minimum:
+        S.minima.push_back( vertices[i] );
+        break;
+      case CriticalPointType::Saddle:
+        S.saddles.push_back( vertices[i] );
+        break;
+      case CriticalPointType::Maximum:
+        S.maxima.push_back( vertices[i] );
+        break;
+      case CriticalPointType::Regular:
+        break;
+      }
+    }
+
+    return S;
   }
+
 private:
 
   /**
-    Calculates the number of contiguous segments in the link of
-    a vertex, with respect to the given mesh.
+    Classifies a vertex by counting the contiguous segments of its lower
+    and its upper link. The link of an interior vertex is a cycle, while
+    the link of a boundary vertex is a path.
   */
 
-  static std::pair<std::size_t, std::size_t> contiguousSegments( const Mesh& M, typename Mesh::Index id )
+  template <class Less> static CriticalPointType classify( Index i,
+                                                           const std::vector<Index>& link,
+                                                           bool isBoundary,
+                                                           Less less )
   {
-    using Index = typename Mesh::Index;
-
-    auto data = M.data(id);
-    auto link = M.link(id);
-
-    std::vector<Index> upperLink;
-    std::vector<Index> lowerLink;
+    if( link.empty() )
+      return CriticalPointType::Regular;
 
-    std::copy_if( link.begin(), link.end(), std::back_inserter( upperLink ), [&data, &M] ( Index& u ) { return M.data(u) >= data; } );
-    std::copy_if( link.begin(), link.end(), std::back_inserter( lowerLink ), [&data, &M] ( Index& u ) { return M.data(u) <= data; } );
+    std::size_t numLower = 0;
+    std::size_t numUpper = 0;
+    std::size_t n        = link.size();
 
-    auto&& numConnectedComponents = [&M, &id] ( const std::vector<Index>& link )
+    for( std::size_t k = 0; k < n; k++ )
     {
-      auto curr = link.begin();
-      auto next = std::next( curr );
+      bool lower = less( link[k], i );
 
-      UnionFind<Index> uf( link.begin(), link.end() );
+      // A segment starts at every vertex whose predecessor belongs to the
+      // other part of the link.
+      bool starts = false;
 
-      for( ; curr != link.end(); )
+      if( k == 0 )
+        starts = isBoundary || less( link[n-1], i ) != lower;
+      else
+        starts = less( link[k-1], i ) != lower;
+
+      if( starts )
       {
-        if( next == link.end() )
-          next = link.begin();
-
-        auto u    = id;
-        auto v    = *curr++;
-        auto w    = *next++;
-
-        if( M.hasEdge(u,v) )
-        {
-          if( M.hasEdge(v,w) )
-            uf.merge(v,w);
-        }
+        if( lower )
+          ++numLower;
         else
-          throw std::runtime_error( "Edge to link centre vertex does not exist" );
+          ++numUpper;
       }
+    }
 
-      std::vector<Index> roots;
-      uf.roots( std::back_inserter(roots) );
-
-      return roots.size();
-    };
+    // A cyclic link that does not change at all has no starting vertex
+    // by the definition above.
+    if( numLower + numUpper == 0 )
+    {
+      if( less( link.front(), i ) )
+        numLower = 1;
+      else
+        numUpper = 1;
+    }
 
-    return std::make_pair( numConnectedComponents( lowerLink ), numConnectedComponents( upperLink ) );
+    if( numUpper == 0 )
+      return CriticalPointType::Maximum;
+    else if( numLower == 0 )
+      return CriticalPointType::Minimum;
+    else if( isBoundary ? numLower + numUpper > 2 : numLower > 1 )
+      return CriticalPointType::Saddle;
+    else
+      return CriticalPointType::Regular;
   }
 };
 
@@ -0,0 +1,408 @@
+#ifndef ALEPH_TOPOLOGY_STRUCTURED_GRID_HH__
+#define ALEPH_TOPOLOGY_STRUCTURED_GRID_HH__
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace topology
+{
+
+/**
+  @struct GridSlab
+  @brief Contiguous range of layers of a structured grid
+
+  Structured grids are stored in row-major order, i.e. the last dimension
+  varies fastest. A slab contains a range of consecutive layers along the
+  first, i.e. the slowest, dimension. Readers use slabs to stream grids
+  that do not fit into memory; the engines below consume slabs in order
+  and only keep the data they still require.
+*/
+
+template <class T> struct GridSlab
+{
+  /** Dimensions of the full grid, slowest dimension first */
+  std::vector<std::size_t> dimensions;
+
+  /** Index of the first layer of the slab along the first dimension */
+  std::size_t offset = 0;
+
+  /** Number of layers in the slab */
+  std::size_t layers = 0;
+
+  /** Values of the slab in row-major order */
+  std::vector<T> values;
+
+  /** @returns Number of values in a single layer */
+  std::size_t layerSize() const noexcept
+  {
+    std::size_t size = 1;
+    for( std::size_t d = 1; d < dimensions.size(); d++ )
+      size *= dimensions[d];
+
+    return size;
+  }
+
+  /** @returns true if this is the last slab of the grid */
+  bool isLast() const noexcept
+  {
+    return !dimensions.empty() && offset + layers == dimensions.front();
+  }
+};
+
+namespace detail
+{
+
+/** @returns Number of directions, i.e. bits, that are set in a mask */
+inline std::size_t numDirections( unsigned mask ) noexcept
+{
+  std::size_t result = 0;
+  for( ; mask != 0; mask &= mask - 1 )
+    ++result;
+
+  return result;
+}
+
+/**
+  Buffers the layers of a structured grid that is being streamed in slabs.
+  Cells are anchored at their vertex with the smallest coordinates, so the
+  cells of a layer may only be created once its next layer is available.
+  Hence, every new slab completes all but its last layer, and the buffer
+  never stores more than one slab plus one layer.
+*/
+
+template <class T> class GridLayers
+{
+public:
+
+  /**
+    Appends a slab to the buffer.
+
+    @returns Range of layers whose cells may be created now
+  */
+
+  template <class U> std::pair<std::size_t, std::size_t> push( const GridSlab<U>& slab )
+  {
+    if( slab.dimensions.empty() || slab.dimensions.size() > 16 )
+      throw std::runtime_error( "Unsupported number of grid dimensions" );
+
+    if( slab.values.size() != slab.layers * slab.layerSize() )
+      throw std::runtime_error( "Number of values does not match slab size" );
+
+    if( slab.offset == 0 )
+    {
+      _dimensions = slab.dimensions;
+      _layerSize  = slab.layerSize();
+      _first      = 0;
+
+      _values.clear();
+
+      _strides.assign( _dimensions.size(), 1 );
+
+      for( std::size_t d = _dimensions.size() - 1; d > 0; d-- )
+        _strides[d-1] = _strides[d] * _dimensions[d];
+    }
+    else
+    {
+      if( slab.dimensions != _dimensions || slab.offset != _first + this->layers() )
+        throw std::runtime_error( "Grid slabs must be contiguous and ordered" );
+
+      // Only the last layer of the previous slab is still required
+      // because its cells have not been created yet.
+      auto numDiscarded = this->layers() - 1;
+
+      _values.erase( _values.begin(),
+                     _values.begin() + static_cast<std::ptrdiff_t>( numDiscarded * _layerSize ) );
+
+      _first += numDiscarded;
+    }
+
+    _values.insert( _values.end(), slab.values.begin(), slab.values.end() );
+
+    auto end = _first + this->layers();
+
+    if( !slab.isLast() )
+      --end;
+
+    return std::make_pair( _first, end );
+  }
+
+  /** @returns Value of a vertex, specified by its global index */
+  const T& operator[]( std::size_t index ) const
+  {
+    return _values[ index - _first * _layerSize ];
+  }
+
+  std::size_t layers() const noexcept
+  {
+    return _layerSize > 0 ? _values.size() / _layerSize : 0;
+  }
+
+  std::size_t layerSize() const noexcept                 { return _layerSize;  }
+  const std::vector<std::size_t>& dimensions() const noexcept { return _dimensions; }
+  const std::vector<std::size_t>& strides() const noexcept    { return _strides;    }
+
+  /**
+    @returns Bit mask of all dimensions along which the given vertex has
+    a successor in the grid
+  */
+
+  unsigned successors( std::size_t index ) const noexcept
+  {
+    unsigned mask = 0;
+
+    for( std::size_t d = 0; d < _dimensions.size(); d++ )
+    {
+      auto c = ( index / _strides[d] ) % _dimensions[d];
+      if( c + 1 < _dimensions[d] )
+        mask |= 1u << d;
+    }
+
+    return mask;
+  }
+
+  /** @returns Offset of the vertex that is reached by moving along all dimensions in a mask */
+  std::size_t offset( unsigned mask ) const noexcept
+  {
+    std::size_t result = 0;
+
+    for( std::size_t d = 0; d < _dimensions.size(); d++ )
+      if( mask & ( 1u << d ) )
+        result += _strides[d];
+
+    return result;
+  }
+
+private:
+  std::vector<std::size_t> _dimensions;
+  std::vector<std::size_t> _strides;
+
+  std::size_t _layerSize = 0;
+  std::size_t _first     = 0;
+
+  std::vector<T> _values;
+};
+
+} // namespace detail
+
+/**
+  @class FreudenthalTriangulation
+  @brief Incremental lower-star triangulation of structured grids
+
+  Triangulates a structured grid of arbitrary dimension with the
+  Freudenthal (or Kuhn) triangulation, which splits every cube of the grid
+  into simplices along its main diagonal. Every simplex is anchored at its
+  smallest vertex v and described by a chain of nested sets of dimensions
+  S_1 < S_2 < ... < S_k; its vertices are v, v + e(S_1), ..., v + e(S_k).
+
+  The grid is consumed in slabs, as provided by the grid readers. Every
+  call emits all simplices that can be created with the data seen so far,
+  so the memory required for the input is bounded by the slab size. By
+  default, simplices are assigned the maximum of their vertex values,
+  which results in the lower-star filtration of the grid.
+*/
+
+template <class Simplex> class FreudenthalTriangulation
+{
+public:
+  using DataType   = typename Simplex::DataType;
+  using VertexType = typename Simplex::VertexType;
+
+  /** Restricts the triangulation to simplices of at most the given dimension */
+  void setMaxDimension( std::size_t dimension ) noexcept
+  {
+    _maxDimension = dimension;
+  }
+
+  std::size_t maxDimension() const noexcept
+  {
+    return _maxDimension;
+  }
+
+  template <class T, class OutputIterator> void operator()( const GridSlab<T>& slab, OutputIterator result )
+  {
+    this->operator()( slab, result, [] ( DataType a, DataType b ) { return std::max(a,b); } );
+  }
+
+  template <class T, class OutputIterator, class Functor> void operator()( const GridSlab<T>& slab, OutputIterator result, Functor f )
+  {
+    auto range = _layers.push( slab );
+
+    if( slab.offset == 0 )
+      _chains = chains( slab.dimensions.size() );
+
+    std::vector<VertexType> vertices;
+    vertices.reserve( slab.dimensions.size() + 1 );
+
+    auto layerSize = _layers.layerSize();
+
+    for( std::size_t i = range.first * layerSize; i < range.second * layerSize; i++ )
+    {
+      auto successors = _layers.successors( i );
+
+      for( auto&& chain : _chains )
+      {
+        if( chain.size() > _maxDimension )
+          break;
+
+        if( !chain.empty() && ( chain.back() & ~successors ) != 0 )
+          continue;
+
+        vertices.assign( 1, static_cast<VertexType>( i ) );
+        DataType value = static_cast<DataType>( _layers[i] );
+
+        for( auto&& mask : chain )
+        {
+          auto j = i + _layers.offset( mask );
+
+          vertices.push_back( static_cast<VertexType>( j ) );
+          value = f( value, static_cast<DataType>( _layers[j] ) );
+        }
+
+        *result++ = Simplex( vertices.begin(), vertices.end(), value );
+      }
+    }
+  }
+
+private:
+
+  /**
+    Enumerates all chains of strictly nested, non-empty sets of dimensions.
+    Chains are extended in the order in which they are created, so they are
+    sorted by their length. Sets are represented as bit masks.
+  */
+
+  static std::vector< std::vector<unsigned> > chains( std::size_t dimension )
+  {
+    std::vector< std::vector<unsigned> > result( 1 );
+    unsigned full = ( 1u << dimension ) - 1;
+
+    for( std::size_t k = 0; k < result.size(); k++ )
+    {
+      unsigned last = result[k].empty() ? 0 : result[k].back();
+
+      // Every strict superset of the last set extends the chain
+      for( unsigned mask = 1; mask <= full; mask++ )
+      {
+        if( ( mask & last ) == last && mask != last )
+        {
+          auto chain = result[k];
+          chain.push_back( mask );
+
+          result.push_back( chain );
+        }
+      }
+    }
+
+    return result;
+  }
+
+  std::size_t _maxDimension = std::size_t( -1 );
+
+  detail::GridLayers<DataType> _layers;
+  std::vector< std::vector<unsigned> > _chains;
+};
+
+/**
+  @struct GridCube
+  @brief Elementary cube of a structured grid
+
+  Every cube is anchored at its smallest vertex and spans the dimensions
+  of a bit mask; its dimension is the number of bits that are set. The
+  value of a cube is taken from its vertices.
+*/
+
+template <class T> struct GridCube
+{
+  std::size_t anchor;
+  unsigned directions;
+  T value;
+
+  std::size_t dimension() const noexcept
+  {
+    return detail::numDirections( directions );
+  }
+};
+
+/**
+  @class CubicalGridFiltration
+  @brief Incremental cubical filtration of structured grids
+
+  Creates all elementary cubes of a structured grid, i.e. vertices, edges,
+  squares, cubes, and so on, from slabs of the grid. As for the simplicial
+  variant, every call emits all cubes that can be created with the data
+  seen so far. By default, cubes are assigned the maximum of their vertex
+  values, which corresponds to the lower-star filtration of the grid.
+*/
+
+template <class T> class CubicalGridFiltration
+{
+public:
+
+  /** Restricts the filtration to cubes of at most the given dimension */
+  void setMaxDimension( std::size_t dimension ) noexcept
+  {
+    _maxDimension = dimension;
+  }
+
+  std::size_t maxDimension() const noexcept
+  {
+    return _maxDimension;
+  }
+
+  template <class U, class OutputIterator> void operator()( const GridSlab<U>& slab, OutputIterator result )
+  {
+    this->operator()( slab, result, [] ( T a, T b ) { return std::max(a,b); } );
+  }
+
+  template <class U, class OutputIterator, class Functor> void operator()( const GridSlab<U>& slab, OutputIterator result, Functor f )
+  {
+    auto range     = _layers.push( slab );
+    auto layerSize = _layers.layerSize();
+
+    for( std::size_t i = range.first * layerSize; i < range.second * layerSize; i++ )
+    {
+      auto successors = _layers.successors( i );
+
+      // Enumerates all subsets of the valid directions; the corners of
+      // every cube are in turn enumerated as subsets of its directions.
+      for( unsigned directions = 0; ; directions = ( directions - successors ) & successors )
+      {
+        if( detail::numDirections( directions ) > _maxDimension )
+        {
+          if( directions == successors )
+            break;
+          else
+            continue;
+        }
+
+        T value = static_cast<T>( _layers[i] );
+
+        for( unsigned corner = directions; corner != 0; corner = ( corner - 1 ) & directions )
+          value = f( value, static_cast<T>( _layers[ i + _layers.offset( corner ) ] ) );
+
+        *result++ = GridCube<T>{ i, directions, value };
+
+        if( directions == successors )
+          break;
+      }
+    }
+  }
+
+private:
+  std::size_t _maxDimension = std::size_t( -1 );
+
+  detail::GridLayers<T> _layers;
+};
+
+} // namespace topology
+
+} // namespace aleph
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef ALEPH_TOPOLOGY_WEIGHTED_GRAPH_HH__
+#define ALEPH_TOPOLOGY_WEIGHTED_GRAPH_HH__
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+
+namespace aleph
+{
+
+namespace topology
+{
+
+/**
+  @class WeightedGraph
+  @brief Undirected weighted graph in compressed sparse row format
+
+  The neighbours of all vertices are stored in a single contiguous array,
+  sorted by vertex. An array of offsets indicates where the neighbours of
+  every vertex start. Since the graph is undirected, every edge is stored
+  twice, once for each of its vertices. Neighbours of a vertex are sorted
+  in ascending order.
+
+  This representation is considerably more compact than a simplicial
+  complex and is meant for large graphs that are only traversed.
+*/
+
+template <class Vertex, class Weight> class WeightedGraph
+{
+public:
+  using VertexType = Vertex;
+  using WeightType = Weight;
+
+  /** Creates an empty graph */
+  WeightedGraph()
+    : _offsets( 1, 0 )
+  {
+  }
+
+  /**
+    Creates a graph from its arrays. The array of offsets needs to contain
+    one more entry than there are vertices; the neighbours of a vertex u
+    are stored in the range [offsets[u], offsets[u+1]) of the targets and
+    weights arrays.
+  */
+
+  WeightedGraph( std::vector<std::size_t> offsets,
+                 std::vector<Vertex> targets,
+                 std::vector<Weight> weights )
+    : _offsets( std::move( offsets ) )
+    , _targets( std::move( targets ) )
+    , _weights( std::move( weights ) )
+  {
+    if(    _offsets.empty()
+        || _offsets.back() != _targets.size()
+        || _targets.size() != _weights.size() )
+      throw std::runtime_error( "Inconsistent arrays for weighted graph" );
+  }
+
+  /** @returns Number of vertices */
+  std::size_t size() const noexcept
+  {
+    return _offsets.size() - 1;
+  }
+
+  /** @returns Number of undirected edges */
+  std::size_t edges() const noexcept
+  {
+    return _targets.size() / 2;
+  }
+
+  /** @returns Number of neighbours of a vertex */
+  std::size_t degree( Vertex u ) const
+  {
+    return _offsets.at( std::size_t(u) + 1 ) - _offsets.at( std::size_t(u) );
+  }
+
+  /** @returns k-th neighbour of a vertex */
+  Vertex neighbour( Vertex u, std::size_t k ) const
+  {
+    return _targets[ _offsets.at( std::size_t(u) ) + k ];
+  }
+
+  /** @returns Weight of the edge to the k-th neighbour of a vertex */
+  Weight weight( Vertex u, std::size_t k ) const
+  {
+    return _weights[ _offsets.at( std::size_t(u) ) + k ];
+  }
+
+  const std::vector<std::size_t>& offsets() const noexcept { return _offsets; }
+  const std::vector<Vertex>&      targets() const noexcept { return _targets; }
+  const std::vector<Weight>&      weights() const noexcept { return _weights; }
+
+private:
+  std::vector<std::size_t> _offsets;
+  std::vector<Vertex>      _targets;
+  std::vector<Weight>      _weights;
+};
+
+} // namespace topology
+
+} // namespace aleph
+
+#endif
@@ -0,0 +1,565 @@
+#ifndef ALEPH_TOPOLOGY_IO_BINARY_HH__
+#define ALEPH_TOPOLOGY_IO_BINARY_HH__
+
+#include <aleph/topology/BoundaryMatrix.hh>
+
+#include <aleph/utilities/MemoryMappedFile.hh>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace aleph
+{
+
+namespace topology
+{
+
+namespace io
+{
+
+/*
+  Binary cache format
+  -------------------
+
+  Simplicial complexes and boundary matrices can be stored in a binary
+  format that is meant for caching expensive construction stages. Files
+  are not portable between machines of different byte order. Every file
+  starts with a header of 48 bytes:
+
+    - 8 bytes: magic string, "ALEPHSC" for simplicial complexes, and
+               "ALEPHBM" for boundary matrices
+    - 4 bytes: byte order mark 0x01020304
+    - 2 bytes: version of the format
+    - 2 bytes: flags; bit 0 indicates a dualized boundary matrix
+    - 2 bytes: type code of vertices (complex) or indices (matrix)
+    - 2 bytes: type code of data values (complex only)
+    - 4 bytes: reserved; always zero
+    - 8 bytes: number of simplices or columns
+    - 8 bytes: total number of vertices or indices
+    - 8 bytes: checksum of everything following the header
+
+  The header is followed by flat arrays, each of which is padded to a
+  multiple of 8 bytes:
+
+    - offsets of every simplex or column, including the end offset
+    - vertices of all simplices, or indices of all columns
+    - data values of all simplices, or dimensions of all columns
+
+  Simplices are stored in their filtration order. The checksum treats
+  the payload as a sequence of 64-bit words and combines them using the
+  FNV-1a scheme.
+*/
+
+namespace detail
+{
+
+struct BinaryHeader
+{
+  char magic[8];
+  std::uint32_t byteOrder;
+  std::uint16_t version;
+  std::uint16_t flags;
+  std::uint16_t indexType;
+  std::uint16_t dataType;
+  std::uint32_t reserved;
+  std::uint64_t count;
+  std::uint64_t entries;
+  std::uint64_t checksum;
+};
+
+static_assert( sizeof( BinaryHeader ) == 48, "Unexpected padding in binary header" );
+
+constexpr const char*   binaryComplexMagic = "ALEPHSC";
+constexpr const char*   binaryMatrixMagic  = "ALEPHBM";
+constexpr std::uint32_t binaryByteOrder    = 0x01020304;
+constexpr std::uint16_t binaryVersion      = 1;
+constexpr std::uint16_t binaryDualized     = 0x1;
+
+/**
+  Encodes an arithmetic type such that mismatches between the stored
+  types and the requested types can be detected.
+*/
+
+template <class T> constexpr std::uint16_t typeCode()
+{
+  static_assert( std::is_arithmetic<T>::value, "Binary format only supports arithmetic types" );
+
+  return static_cast<std::uint16_t>(
+    ( std::is_floating_point<T>::value ? 0x200 : std::is_signed<T>::value ? 0x100 : 0 ) | sizeof(T) );
+}
+
+constexpr std::size_t padded( std::size_t n )
+{
+  return ( n + 7 ) / 8 * 8;
+}
+
+class Checksum
+{
+public:
+  /** Adds a range of bytes whose length is a multiple of 8 */
+  void operator()( const char* data, std::size_t n )
+  {
+    for( std::size_t i = 0; i < n; i += 8 )
+    {
+      std::uint64_t word;
+      std::memcpy( &word, data + i, sizeof( word ) );
+
+      _hash = ( _hash ^ word ) * 0x100000001b3ull;
+    }
+  }
+
+  std::uint64_t value() const noexcept
+  {
+    return _hash;
+  }
+
+private:
+  std::uint64_t _hash = 0xcbf29ce484222325ull;
+};
+
+class BinaryOutput
+{
+public:
+  BinaryOutput( const std::string& filename, const BinaryHeader& header )
+    : _out( filename, std::ios::binary | std::ios::trunc )
+    , _header( header )
+  {
+    if( !_out )
+      throw std::runtime_error( "Unable to open output file" );
+
+    // Placeholder; the checksum is only known at the end
+    _out.write( reinterpret_cast<const char*>( &_header ), sizeof( _header ) );
+  }
+
+  /** Writes an array and pads it to a multiple of 8 bytes */
+  template <class T> void operator()( const std::vector<T>& values )
+  {
+    auto n    = sizeof(T) * values.size();
+    auto full = n / 8 * 8;
+    auto data = reinterpret_cast<const char*>( values.data() );
+
+    _checksum( data, full );
+    _out.write( data, static_cast<std::streamsize>( full ) );
+
+    if( full != n )
+    {
+      char tail[8] = {};
+      std::memcpy( tail, data + full, n - full );
+
+      _checksum( tail, 8 );
+      _out.write( tail, 8 );
+    }
+  }
+
+  void close()
+  {
+    _header.checksum = _checksum.value();
+
+    _out.seekp( 0 );
+    _out.write( reinterpret_cast<const char*>( &_header ), sizeof( _header ) );
+    _out.close();
+
+    if( _out.fail() )
+      throw std::runtime_error( "Unable to write binary file" );
+  }
+
+private:
+  std::ofstream _out;
+  BinaryHeader _header;
+  Checksum _checksum;
+};
+
+/**
+  Maps a binary file into memory and checks its header, its layout, and
+  optionally its checksum. Provides pointers to the arrays in the file.
+*/
+
+template <class I, class D> class BinaryInput
+{
+public:
+  BinaryInput( const std::string& filename, const char* magic, bool verify )
+    : _file( filename )
+  {
+    if( _file.size() < sizeof( _header ) )
+      throw std::runtime_error( "File is too small to be a binary file" );
+
+    std::memcpy( &_header, _file.data(), sizeof( _header ) );
+
+    if( std::memcmp( _header.magic, magic, sizeof( _header.magic ) ) != 0 )
+      throw std::runtime_error( "File does not contain the requested type of data" );
+
+    if( _header.byteOrder != binaryByteOrder )
+      throw std::runtime_error( "Binary file uses a different byte order" );
+
+    if( _header.version != binaryVersion )
+      throw std::runtime_error( "Unsupported version of binary file" );
+
+    if( _header.indexType != typeCode<I>() || _header.dataType != typeCode<D>() )
+      throw std::runtime_error( "Stored types do not match requested types" );
+
+    auto available = _file.size() - sizeof( _header );
+
+    if(    _header.count   >= available / sizeof( std::uint64_t )
+        || _header.entries >  available / sizeof(I)
+        || _header.count   >  available / sizeof(D) )
+      throw std::runtime_error( "Binary file is truncated" );
+
+    auto count   = static_cast<std::size_t>( _header.count );
+    auto entries = static_cast<std::size_t>( _header.entries );
+
+    auto offsetsSize = padded( sizeof( std::uint64_t ) * ( count + 1 ) );
+    auto indicesSize = padded( sizeof(I) * entries );
+    auto dataSize    = padded( sizeof(D) * count );
+
+    if( sizeof( _header ) + offsetsSize + indicesSize + dataSize != _file.size() )
+      throw std::runtime_error( "Binary file size does not match its header" );
+
+    if( verify )
+    {
+      Checksum checksum;
+      checksum( _file.data() + sizeof( _header ), _file.size() - sizeof( _header ) );
+
+      if( checksum.value() != _header.checksum )
+        throw std::runtime_error( "Checksum of binary file does not match" );
+    }
+
+    // The file is mapped at a page boundary, and every array starts at a
+    // multiple of 8 bytes, so all pointers are properly aligned.
+    auto base = _file.data() + sizeof( _header );
+
+    _offsets = reinterpret_cast<const std::uint64_t*>( base );
+    _indices = reinterpret_cast<const I*>( base + offsetsSize );
+    _data    = reinterpret_cast<const D*>( base + offsetsSize + indicesSize );
+
+    if( _offsets[0] != 0 || _offsets[count] != _header.entries )
+      throw std::runtime_error( "Binary file contains invalid offsets" );
+
+    for( std::size_t i = 0; i < count; i++ )
+    {
+      if( _offsets[i] > _offsets[i+1] )
+        throw std::runtime_error( "Binary file contains invalid offsets" );
+    }
+  }
+
+  const BinaryHeader& header() const noexcept { return _header; }
+
+  std::size_t size() const noexcept
+  {
+    return static_cast<std::size_t>( _header.count );
+  }
+
+  std::pair<const I*, const I*> range( std::size_t i ) const
+  {
+    if( i >= this->size() )
+      throw std::out_of_range( "Invalid index for binary file" );
+
+    return std::make_pair( _indices + _offsets[i], _indices + _offsets[i+1] );
+  }
+
+  D data( std::size_t i ) const
+  {
+    if( i >= this->size() )
+      throw std::out_of_range( "Invalid index for binary file" );
+
+    return _data[i];
+  }
+
+private:
+  aleph::utilities::MemoryMappedFile _file;
+  BinaryHeader _header;
+
+  const std::uint64_t* _offsets = nullptr;
+  const I* _indices             = nullptr;
+  const D* _data                = nullptr;
+};
+
+template <class I, class D> BinaryHeader makeBinaryHeader( const char* magic, std::size_t count, std::size_t entries, std::uint16_t flags )
+{
+  BinaryHeader header;
+
+  std::memcpy( header.magic, magic, sizeof( header.magic ) );
+
+  header.byteOrder = binaryByteOrder;
+  header.version   = binaryVersion;
+  header.flags     = flags;
+  header.indexType = typeCode<I>();
+  header.dataType  = typeCode<D>();
+  header.reserved  = 0;
+  header.count     = count;
+  header.entries   = entries;
+  header.checksum  = 0;
+
+  return header;
+}
+
+} // namespace detail
+
+/**
+  @class SimplicialComplexView
+  @brief Read-only view of a simplicial complex in binary format
+
+  Maps a simplicial complex that has been written by BinaryWriter into
+  memory. Vertices and data values are accessed in place, so no parsing
+  is required. The types of the simplex need to match the stored types.
+*/
+
+template <class Simplex> class SimplicialComplexView
+{
+public:
+  using DataType   = typename Simplex::DataType;
+  using VertexType = typename Simplex::VertexType;
+
+  /**
+    Opens a simplicial complex in binary format.
+
+    @param filename Input file
+    @param verify   Flag indicating whether the checksum is verified; this
+                    requires reading the complete file
+  */
+
+  explicit SimplicialComplexView( const std::string& filename, bool verify = true )
+    : _input( filename, detail::binaryComplexMagic, verify )
+  {
+  }
+
+  /** @returns Number of simplices */
+  std::size_t size() const noexcept
+  {
+    return _input.size();
+  }
+
+  /** @returns Range of vertices of the given simplex, in descending order */
+  std::pair<const VertexType*, const VertexType*> vertices( std::size_t i ) const
+  {
+    return _input.range( i );
+  }
+
+  /** @returns Data value of the given simplex */
+  DataType data( std::size_t i ) const
+  {
+    return _input.data( i );
+  }
+
+  /** @returns Simplex at the given position of the filtration */
+  Simplex operator[]( std::size_t i ) const
+  {
+    auto range = this->vertices( i );
+    return Simplex( range.first, range.second, this->data( i ) );
+  }
+
+private:
+  detail::BinaryInput<VertexType, DataType> _input;
+};
+
+/**
+  @class BoundaryMatrixView
+  @brief Read-only view of a boundary matrix in binary format
+
+  Maps a boundary matrix that has been written by BinaryWriter into memory
+  and provides access to its columns in place.
+*/
+
+template <class Index> class BoundaryMatrixView
+{
+public:
+  explicit BoundaryMatrixView( const std::string& filename, bool verify = true )
+    : _input( filename, detail::binaryMatrixMagic, verify )
+  {
+  }
+
+  /** @returns Number of columns */
+  std::size_t size() const noexcept
+  {
+    return _input.size();
+  }
+
+  /** @returns Range of indices of the given column, in ascending order */
+  std::pair<const Index*, const Index*> column( std::size_t j ) const
+  {
+    return _input.range( j );
+  }
+
+  /** @returns Dimension of the given column */
+  Index dimension( std::size_t j ) const
+  {
+    return _input.data( j );
+  }
+
+  bool isDualized() const noexcept
+  {
+    return _input.header().flags & detail::binaryDualized;
+  }
+
+private:
+  detail::BinaryInput<Index, Index> _input;
+};
+
+/**
+  @class BinaryWriter
+  @brief Writes simplicial complexes and boundary matrices in binary format
+
+  The binary format stores the filtration order, the vertices, and the
+  data values of a simplicial complex, or the columns of a boundary
+  matrix, in flat arrays. Files are versioned and checksummed, so they
+  are suitable for caching expensive calculations between runs.
+*/
+
+class BinaryWriter
+{
+public:
+  template <class SimplicialComplex> void operator()( const std::string& filename, const SimplicialComplex& K )
+  {
+    using Simplex    = typename SimplicialComplex::ValueType;
+    using DataType   = typename Simplex::DataType;
+    using VertexType = typename Simplex::VertexType;
+
+    std::vector<std::uint64_t> offsets;
+    std::vector<VertexType> vertices;
+    std::vector<DataType> data;
+
+    offsets.reserve( K.size() + 1 );
+    data.reserve( K.size() );
+
+    offsets.push_back( 0 );
+
+    for( auto&& simplex : K )
+    {
+      vertices.insert( vertices.end(), simplex.begin(), simplex.end() );
+
+      offsets.push_back( vertices.size() );
+      data.push_back( simplex.data() );
+    }
+
+    detail::BinaryOutput output( filename,
+                                 detail::makeBinaryHeader<VertexType, DataType>( detail::binaryComplexMagic,
+                                                                                 K.size(),
+                                                                                 vertices.size(),
+                                                                                 0 ) );
+
+    output( offsets );
+    output( vertices );
+    output( data );
+    output.close();
+  }
+
+  template <class Representation> void operator()( const std::string& filename, const BoundaryMatrix<Representation>& M )
+  {
+    using Index = typename Representation::Index;
+
+    auto numColumns = static_cast<std::size_t>( M.getNumColumns() );
+
+    std::vector<std::uint64_t> offsets;
+    std::vector<Index> indices;
+    std::vector<Index> dimensions;
+
+    offsets.reserve( numColumns + 1 );
+    dimensions.reserve( numColumns );
+
+    offsets.push_back( 0 );
+
+    for( std::size_t j = 0; j < numColumns; j++ )
+    {
+      auto column = M.getColumn( static_cast<Index>( j ) );
+
+      indices.insert( indices.end(), column.begin(), column.end() );
+
+      offsets.push_back( indices.size() );
+      dimensions.push_back( M.getDimension( static_cast<Index>( j ) ) );
+    }
+
+    detail::BinaryOutput output( filename,
+                                 detail::makeBinaryHeader<Index, Index>( detail::binaryMatrixMagic,
+                                                                         numColumns,
+                                                                         indices.size(),
+                                                                         M.isDualized() ? detail::binaryDualized : 0 ) );
+
+    output( offsets );
+    output( indices );
+    output( dimensions );
+    output.close();
+  }
+};
+
+/**
+  @class BinaryReader
+  @brief Reads simplicial complexes and boundary matrices in binary format
+
+  Files need to have been written by BinaryWriter, using the same types.
+  Any inconsistency, including a mismatched checksum, results in an
+  exception. If only parts of the data are required, a view can be used
+  instead in order to avoid copying.
+
+  @see SimplicialComplexView
+  @see BoundaryMatrixView
+*/
+
+class BinaryReader
+{
+public:
+  template <class SimplicialComplex> void operator()( const std::string& filename, SimplicialComplex& K )
+  {
+    using Simplex = typename SimplicialComplex::ValueType;
+
+    SimplicialComplexView<Simplex> view( filename, _verifyChecksum );
+
+    std::vector<Simplex> simplices;
+    simplices.reserve( view.size() );
+
+    for( std::size_t i = 0; i < view.size(); i++ )
+      simplices.push_back( view[i] );
+
+    K = SimplicialComplex( simplices.begin(), simplices.end() );
+  }
+
+  template <class Representation> void operator()( const std::string& filename, BoundaryMatrix<Representation>& M )
+  {
+    using Index = typename Representation::Index;
+
+    BoundaryMatrixView<Index> view( filename, _verifyChecksum );
+
+    BoundaryMatrix<Representation> result;
+    result.setNumColumns( static_cast<Index>( view.size() ) );
+
+    for( std::size_t j = 0; j < view.size(); j++ )
+    {
+      auto column = view.column( j );
+
+      result.setColumn( static_cast<Index>( j ), column.first, column.second );
+      result.setDimension( static_cast<Index>( j ), view.dimension( j ) );
+    }
+
+    result.setDualized( view.isDualized() );
+
+    M = std::move( result );
+  }
+
+  /** Sets whether checksums are verified when reading; this is the default */
+  void setVerifyChecksum( bool value = true ) noexcept
+  {
+    _verifyChecksum = value;
+  }
+
+  bool verifyChecksum() const noexcept
+  {
+    return _verifyChecksum;
+  }
+
+private:
+  bool _verifyChecksum = true;
+};
+
+} // namespace io
+
+} // namespace topology
+
+} // namespace aleph
+
+#endif
@@ -48,42 +48,43 @@ public:
     using VertexType        = typename Simplex::VertexType;
 
     std::string line;
+    Tokenizer tokenizer;
 
     std::set<Simplex> vertices;
     std::vector<Simplex> edges;
 
     std::size_t lastID = 0;
 
-    while( in )
+    while( std::getline( in, line ) )
     {
-      std::getline( in, line );
+      StringView view = line;
 
       if( _trimLines )
-        line = trim( line );
-
-      // TODO: Make this configurable and permit splitting by different
-      // tokens such as commas
-      auto tokens = split( line );
+        view = trim( view );
 
       // Skip empty lines and comments
-      if( line.empty() || std::find( _commentTokens.begin(), _commentTokens.end(), line.front() ) != _commentTokens.end() )
+      if( view.empty() || std::find( _commentTokens.begin(), _commentTokens.end(), view.front() ) != _commentTokens.end() )
         continue;
 
+      // TODO: Make this configurable and permit splitting by different
+      // tokens such as commas
+      auto&& tokens = tokenizer( view );
+
       if( tokens.size() >= 2 )
       {
         VertexType u = VertexType();
         VertexType v = VertexType();
 
         // TODO: Make order of vertices & weights configurable?
-        if( tokens[0].find_first_not_of( "0123456789" ) == std::string::npos )
+        if( std::all_of( tokens[0].begin(), tokens[0].end(), [] ( char c ) { return c >= '0' && c <= '9'; } ) )
         {
-          u = convert<VertexType>( tokens[0] );
-          v = convert<VertexType>( tokens[1] );
+          u = parse<VertexType>( tokens[0] );
+          v = parse<VertexType>( tokens[1] );
         }
         else
         {
-          auto&& us = tokens[0];
-          auto&& vs = tokens[1];
+          auto us = tokens[0].str();
+          auto vs = tokens[1].str();
 
           if( _nodeLabels.find(us) == _nodeLabels.end() )
             _nodeLabels[us] = lastID++;
@@ -97,7 +98,7 @@ public:
 
         DataType w = DataType();
         if( tokens.size() >= 3 && _readWeights )
-          w = convert<DataType>( tokens[2] );
+          w = parse<DataType>( tokens[2] );
 
         edges.push_back( Simplex( { u, v }, w ) );
 
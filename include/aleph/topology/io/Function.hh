@@ -3,6 +3,8 @@
 
 #include <aleph/topology/BoundaryMatrix.hh>
 
+#include <aleph/utilities/String.hh>
+
 #include <algorithm>
 #include <fstream>
 #include <iterator>
@@ -155,15 +157,21 @@ template <class SimplicialComplex, class Functor> std::vector<SimplicialComplex>
   std::vector<SimplicialComplex> complexes;
 
   std::string line;
+  aleph::utilities::Tokenizer tokenizer;
+
   while( std::getline( in, line ) )
   {
     std::vector<DataType> functionValues;
 
-    std::istringstream stream( line );
+    // Like a stream, stop at the first token that is not a number
+    for( auto&& token : tokenizer( line ) )
+    {
+      DataType value = DataType();
+      if( !aleph::utilities::parse( token, value ) )
+        break;
 
-    std::copy( std::istream_iterator<DataType>( stream ),
-               std::istream_iterator<DataType>(),
-               std::back_inserter( functionValues ) );
+      functionValues.push_back( value );
+    }
 
     SimplicialComplex K;
 
@@ -1,10 +1,10 @@
 #ifndef ALEPH_TOPOLOGY_IO_GML_HH__
 #define ALEPH_TOPOLOGY_IO_GML_HH__
 
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <set>
-#include <regex>
 #include <sstream>
 #include <stack>
 #include <string>
@@ -63,17 +63,18 @@ public:
     using VertexType        = typename Simplex::VertexType;
 
     std::string line;
-    std::set<std::string> levels     = { "graph", "node", "edge" };
-    std::set<std::string> attributes = { "id", "label", "source", "target", "value", "weight" };
+    Tokenizer tokenizer;
 
-    auto isLevel = [&levels] ( const std::string& name )
+    auto isLevel = [] ( StringView name )
     {
-      return levels.find( name ) != levels.end();
+      return name == "graph" || name == "node" || name == "edge";
     };
 
-    auto isAttribute = [&attributes] ( const std::string& name )
+    auto isAttribute = [] ( StringView name )
     {
-      return attributes.find( name ) != attributes.end();
+      return    name == "id"     || name == "label"
+             || name == "source" || name == "target"
+             || name == "value"  || name == "weight";
     };
 
     // Specifies the current level the parser is in. May be either one
@@ -88,29 +89,23 @@ public:
     Node node;
     Edge edge;
 
-    std::regex reAttribute = std::regex( "([[:alpha:]]+)[[:space:]]*.*" );
-    std::regex reKeyValue  = std::regex( "([[:alpha:]]+)[[:space:]]+([[:alnum:]\\.]+)" );
-    std::regex reLabel     = std::regex( "(label)[[:space:]]+\"([^\"]+)\"" );
-
     while( std::getline( in, line ) )
     {
-      line        = trim( line );
-      auto tokens = split( line );
+      auto view   = trim( StringView( line ) );
+      auto&& tokens = tokenizer( view );
 
-      // Skip comment lines. This is somewhat wasteful because I am
-      // splitting the complete string even though I merely need to
-      // know the first token.
+      // Skip comment lines. Only the first token is relevant here.
       if( tokens.empty() == false && ( tokens.front() == "comment" || tokens.front() == "Creator" ) )
         continue;
 
       // A new level may also be opened "inline" by specifying a name
       // and the opening bracket at the same time.
-      bool newLevel = isLevel( line ) || ( tokens.size() == 2 && tokens.back() == "[" && isLevel( tokens.front() ) );
+      bool newLevel = isLevel( view ) || ( tokens.size() == 2 && tokens.back() == "[" && isLevel( tokens.front() ) );
 
       // Detecting a new level
       if( newLevel )
       {
-        auto level = tokens.size() == 2 ? tokens.front() : line;
+        auto level = tokens.size() == 2 ? tokens.front().str() : view.str();
 
         if( lastLevel.empty() )
           lastLevel = level;
@@ -127,14 +122,14 @@ public:
       }
 
       // Opening a new level
-      else if( line == "[" )
+      else if( view == "[" )
       {
         currentLevel.push( lastLevel );
         lastLevel = "";
       }
 
       // Closing a new level
-      else if( line == "]" )
+      else if( view == "]" )
       {
         if( currentLevel.top() == "node" )
           _nodes.push_back( node );
@@ -155,43 +150,59 @@ public:
         if( currentLevel.empty() )
           throw std::runtime_error( "Expected a non-empty current level" );
 
-        std::smatch matches;
-
         auto* dict = currentLevel.top() == "node" ? &node.dict
                                                   : currentLevel.top() == "edge" ? &edge.dict
                                                                                  : currentLevel.top() == "graph" ? &graph.dict
                                                                                                                  : throw std::runtime_error( "Current level is unknown" );
 
-        if( std::regex_match( line, matches, reAttribute ) )
+        // The name of an attribute consists of all letters at the
+        // beginning of the line.
+        auto length = static_cast<std::size_t>(
+          std::find_if_not( view.begin(), view.end(),
+                            [] ( char c )
+                            {
+                              return std::isalpha( static_cast<unsigned char>( c ) );
+                            } ) - view.begin() );
+
+        auto name = view.substr( 0, length );
+
+        if( !name.empty() && isAttribute( name ) )
         {
-          auto name = matches[1];
-          if( isAttribute( name ) )
+          std::string value;
+
+          // Special matching for labels: the label is enclosed in quotes,
+          // which must be the last character of the line.
+          if( name == "label" )
           {
-            // Special matching for labels
-            if( name == "label" )
-              std::regex_match( line, matches, reLabel );
-
-            // Regular matching for all other attributes
-            else
-              std::regex_match( line, matches, reKeyValue );
-
-            auto value = matches[2];
-
-            if( name == "id" )
-              node.id = value;
-            else if( name == "source" )
-              edge.source = value;
-            else if( name == "target" )
-              edge.target = value;
-
-            // Just add it to the dictionary of optional values
-            else
-             dict->operator[]( name ) = value;
+            auto rest  = trim( view.substr( length ) );
+            auto first = rest.find( '"' );
+            auto last  = rest.find( '"', first + 1 );
+
+            if(    length < view.size() && std::isspace( static_cast<unsigned char>( view[length] ) )
+                && first == 0 && last == rest.size() - 1 && last > 1 )
+              value = rest.substr( 1, last - 1 ).str();
           }
-          // Skip unknown attributes...
+
+          // Regular matching for all other attributes: the value is the
+          // only token following the name.
+          else if( tokens.size() == 2 && tokens.front() == name )
+            value = tokens.back().str();
+
+          if( name == "id" )
+            node.id = value;
+          else if( name == "source" )
+            edge.source = value;
+          else if( name == "target" )
+            edge.target = value;
+
+          // Just add it to the dictionary of optional values
           else
-          {
-          }
+           dict->operator[]( name.str() ) = value;
+        }
+
+        // Skip unknown attributes...
+        else
+        {
         }
       }
     }
@@ -239,9 +250,9 @@ public:
       auto id = getID( node.id );
 
       if( node.dict.find( "weight" ) != node.dict.end() )
-        simplices.push_back( Simplex( id, convert<DataType>( node.dict.at( "weight" ) ) ) );
+        simplices.push_back( Simplex( id, parse<DataType>( node.dict.at( "weight" ) ) ) );
       else if( node.dict.find( "value" ) != node.dict.end() )
-        simplices.push_back( Simplex( id, convert<DataType>( node.dict.at( "value" ) ) ) );
+        simplices.push_back( Simplex( id, parse<DataType>( node.dict.at( "value" ) ) ) );
       else
         simplices.push_back( Simplex( id ) );
     }
@@ -285,9 +296,9 @@ public:
 
       // Use converted weight
       else if( edge.dict.find( "weight" ) != edge.dict.end() )
-        simplices.push_back( Simplex( {u,v}, convert<DataType>( edge.dict.at( "weight" ) ) ) );
+        simplices.push_back( Simplex( {u,v}, parse<DataType>( edge.dict.at( "weight" ) ) ) );
       else if( edge.dict.find( "value" ) != edge.dict.end() )
-        simplices.push_back( Simplex( {u,v}, convert<DataType>( edge.dict.at( "value" ) ) ) );
+        simplices.push_back( Simplex( {u,v}, parse<DataType>( edge.dict.at( "value" ) ) ) );
     }
 
     _graph = graph;
@@ -7,11 +7,16 @@
   #include <H5Cpp.h>
 #endif
 
+#include <aleph/topology/StructuredGrid.hh>
+
 #include <algorithm>
+#include <iterator>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
-#include <cassert>
+#include <cstddef>
 
 namespace aleph
 {
@@ -23,19 +28,103 @@ namespace io
 {
 
 /**
-  @class HDF5SimpleDataSpaceReader
-  @brief Supports reading simple data spaces from HDF5 files
-
-  This class provides a parser for extracting *simple data spaces* from
-  HDF5 files. In other words, this class can extract scalar fields from
-  HDF5 files. The class can only extract one field at a time. Moreover,
-  it requires knowledge about which group and which data set to parse.
+  @class HDF5GridReader
+  @brief Streams N-dimensional data sets from HDF5 files in slabs
+
+  This class reads a data set of arbitrary dimension, interpreting it as
+  a structured grid in row-major order. Instead of reading the complete
+  data set at once, it selects hyperslabs along the first dimension and
+  passes them to a consumer, e.g. one of the grid engines. Hence, only a
+  single slab needs to be kept in memory.
+
+  For chunked data sets, every slab contains one row of chunks, so every
+  chunk is read exactly once. Otherwise, slabs are chosen such that they
+  contain approximately the number of values specified by the user.
+
+  Since slabs always extend over all trailing dimensions, a slab of a
+  chunked data set contains the depth of a chunk times a complete layer
+  of values, regardless of the slab size. The trailing dimensions are
+  not tiled, so chunks that are deep along the first dimension require
+  correspondingly more memory.
+
+  Integral and floating point data sets are supported; values are
+  converted to the requested type by the library.
 */
 
-class HDF5SimpleDataSpaceReader
+class HDF5GridReader
 {
 public:
 
+  /**
+    Reads the data set and calls the consumer for every slab, in the order
+    of the slabs in the file. The consumer receives a `GridSlab<T>`.
+  */
+
+  template <class T, class Consumer> void read( const std::string& filename, Consumer consumer )
+  {
+#ifdef ALEPH_WITH_HDF5
+    using namespace H5;
+
+    H5File file( filename, H5F_ACC_RDONLY );
+
+    auto&& group     = file.openGroup( _groupName );
+    auto&& dataSet   = group.openDataSet( _dataSetName );
+    auto&& fileSpace = dataSet.getSpace();
+    auto&& rank      = fileSpace.getSimpleExtentNdims();
+
+    if( rank <= 0 )
+      throw std::runtime_error( "Data set is not a simple data space" );
+
+    auto typeClass = dataSet.getTypeClass();
+
+    if( typeClass != H5T_INTEGER && typeClass != H5T_FLOAT )
+      throw std::runtime_error( "Data set does not contain numerical values" );
+
+    std::vector<hsize_t> dimensions( static_cast<std::size_t>( rank ) );
+    fileSpace.getSimpleExtentDims( dimensions.data(), nullptr );
+
+    GridSlab<T> slab;
+    slab.dimensions.assign( dimensions.begin(), dimensions.end() );
+
+    auto layerSize      = slab.layerSize();
+    auto layersPerSlab  = this->layersPerSlab( dataSet, layerSize );
+
+    std::vector<hsize_t> start( dimensions.size(), 0 );
+    std::vector<hsize_t> count( dimensions );
+
+    for( std::size_t offset = 0; offset < dimensions.front(); offset += layersPerSlab )
+    {
+      auto layers = std::min( layersPerSlab, std::size_t( dimensions.front() ) - offset );
+
+      start.front() = offset;
+      count.front() = layers;
+
+      fileSpace.selectHyperslab( H5S_SELECT_SET, count.data(), start.data() );
+
+      DataSpace memorySpace( rank, count.data() );
+
+      slab.offset = offset;
+      slab.layers = layers;
+      slab.values.resize( layers * layerSize );
+
+      dataSet.read( slab.values.data(), nativeType<T>(), memorySpace, fileSpace );
+
+      consumer( static_cast<const GridSlab<T>&>( slab ) );
+    }
+#else
+    (void) filename;
+    (void) consumer;
+
+    throw std::runtime_error( "HDF5 support is not available" );
+#endif
+  }
+
+  /**
+    Reads the data set and stores it in a simplicial complex, using the
+    Freudenthal triangulation of the grid. The simplicial complex is
+    created incrementally, slab by slab.
+  */
+
   template <class SimplicialComplex> void operator()( const std::string& filename, SimplicialComplex& K )
   {
     using Simplex  = typename SimplicialComplex::ValueType;
@@ -46,125 +135,181 @@ public:
 
   template <class SimplicialComplex, class Functor> void operator()( const std::string& filename, SimplicialComplex& K, Functor f )
   {
-#ifdef ALEPH_WITH_HDF5
-    using namespace H5;
+    using Simplex  = typename SimplicialComplex::ValueType;
+    using DataType = typename Simplex::DataType;
 
-    H5File file( filename, H5F_ACC_RDONLY );
+    FreudenthalTriangulation<Simplex> triangulation;
+    triangulation.setMaxDimension( _maxDimension );
 
-    auto&& group       = file.openGroup( _groupName );
-    auto&& dataSet     = group.openDataSet( _dataSetName );
-    auto&& dataSpace   = dataSet.getSpace();
-    auto&& dimension   = dataSpace.getSimpleExtentNdims();
-    auto&& numVertices = dataSpace.getSimpleExtentNpoints();
+    std::vector<Simplex> simplices;
 
-    if( dimension != 2 )
-      return;
+    this->read<DataType>( filename, [&] ( const GridSlab<DataType>& slab )
+    {
+      triangulation( slab, std::back_inserter( simplices ), f );
+    } );
 
-    std::size_t width  = 0;
-    std::size_t height = 0;
+    K = SimplicialComplex( simplices.begin(), simplices.end() );
+  }
 
-    {
-      hsize_t* dimensions = new hsize_t[ dimension ];
+  // Getters -----------------------------------------------------------
 
-      dataSpace.getSimpleExtentDims( dimensions,
-                                     nullptr );
+  std::string groupName() const noexcept   { return _groupName; }
+  std::string dataSetName() const noexcept { return _dataSetName; }
+  std::size_t slabSize() const noexcept    { return _slabSize; }
+  std::size_t maxDimension() const noexcept { return _maxDimension; }
 
-      width  = dimensions[0];
-      height = dimensions[1];
+  // Setters -----------------------------------------------------------
 
-      assert( width * height == std::size_t( numVertices ) );
-    }
+  void setGroupName( const std::string& name ) noexcept   { _groupName = name;   }
+  void setDataSetName( const std::string& name ) noexcept { _dataSetName = name; }
 
-    using Simplex    = typename SimplicialComplex::ValueType;
-    using DataType   = typename Simplex::DataType;
-    using VertexType = typename Simplex::VertexType;
+  /**
+    Sets the approximate number of values per slab for data sets that are
+    not chunked. Slabs always contain at least one layer.
+  */
 
-    auto n    = width * height;
-    auto data = read<DataType>( dataSet, n );
+  void setSlabSize( std::size_t size ) noexcept { _slabSize = size; }
 
-    std::vector<Simplex> simplices;
+  /** Restricts the triangulation to simplices of at most the given dimension */
+  void setMaxDimension( std::size_t dimension ) noexcept { _maxDimension = dimension; }
 
-    // 0-skeleton ------------------------------------------------------
-    //
-    // This is easy, as we can just copy all data directly into the
-    // simplex data structure.
+private:
 
-    for( std::size_t i = 0; i < n; i++ )
-      simplices.push_back( Simplex( static_cast<VertexType>( i ), data.at(i) ) );
+#ifdef ALEPH_WITH_HDF5
 
-    // 1-skeleton & 2-skeleton -----------------------------------------
-    //
-    // This is a little bit more involved, but an auxiliary functor
-    // helps us map coordinates to indices directly.
+  /** @returns Number of layers to read at once */
+  std::size_t layersPerSlab( const H5::DataSet& dataSet, std::size_t layerSize ) const
+  {
+    auto&& properties = dataSet.getCreatePlist();
 
-    auto coordinatesToIndex = [&width] ( std::size_t x, std::size_t y )
+    if( properties.getLayout() == H5D_CHUNKED )
     {
-      return y * width + x;
-    };
+      auto rank = dataSet.getSpace().getSimpleExtentNdims();
 
-    for( std::size_t y = 0; y < height; y++ )
+      std::vector<hsize_t> chunk( static_cast<std::size_t>( rank ) );
+      properties.getChunk( rank, chunk.data() );
+
+      return std::max( std::size_t( chunk.front() ), std::size_t( 1 ) );
+    }
+
+    return std::max( _slabSize / std::max( layerSize, std::size_t( 1 ) ), std::size_t( 1 ) );
+  }
+
+  /**
+    Maps a type to its native HDF5 type, which is used as the memory type
+    for reading; the library performs the conversion from the file type.
+  */
+
+  template <class T> static const H5::PredType& nativeType()
+  {
+    static_assert( std::is_arithmetic<T>::value, "Grid values must be arithmetic" );
+
+    if( std::is_floating_point<T>::value )
     {
-      for( std::size_t x = 0; x < width; x++ )
+      if( sizeof(T) == sizeof(float) )
+        return H5::PredType::NATIVE_FLOAT;
+      else if( sizeof(T) == sizeof(double) )
+        return H5::PredType::NATIVE_DOUBLE;
+      else
+        return H5::PredType::NATIVE_LDOUBLE;
+    }
+    else if( std::is_signed<T>::value )
+    {
+      switch( sizeof(T) )
       {
-        auto&& i = coordinatesToIndex( x, y );
+      case 1:
+        return H5::PredType::NATIVE_INT8;
+      case 2:
+        return H5::PredType::NATIVE_INT16;
+      case 4:
+        return H5::PredType::NATIVE_INT32;
+      default:
+        return H5::PredType::NATIVE_INT64;
+      }
+    }
+    else
+    {
+      switch( sizeof(T) )
+      {
+      case 1:
+        return H5::PredType::NATIVE_UINT8;
+      case 2:
+        return H5::PredType::NATIVE_UINT16;
+      case 4:
+        return H5::PredType::NATIVE_UINT32;
+      default:
+        return H5::PredType::NATIVE_UINT64;
+      }
+    }
+  }
 
-        std::vector<std::size_t> neighbourCoordinates;
-        std::vector<std::size_t> triangleCoordinates;
+#endif
 
-        if( x > 0 )
-          neighbourCoordinates.push_back( coordinatesToIndex( x-1, y ) );
-        if( x < width - 1 )
-          neighbourCoordinates.push_back( coordinatesToIndex( x+1, y ) );
-        if( y > 0 )
-          neighbourCoordinates.push_back( coordinatesToIndex( x  , y-1 ) );
-        if( y < height - 1 )
-          neighbourCoordinates.push_back( coordinatesToIndex( x  , y+1 ) );
+  std::string _groupName    = "/";
+  std::string _dataSetName  = "YField";
 
-        if( x < width - 1 && y > 0 )
-        {
-          neighbourCoordinates.push_back( coordinatesToIndex( x+1, y-1 ) );
+  std::size_t _slabSize     = std::size_t( 1 ) << 20;
+  std::size_t _maxDimension = std::size_t( -1 );
+};
 
-          triangleCoordinates.push_back( coordinatesToIndex( x,   y   ) );
-          triangleCoordinates.push_back( coordinatesToIndex( x,   y-1 ) );
-          triangleCoordinates.push_back( coordinatesToIndex( x+1, y   ) );
-          triangleCoordinates.push_back( coordinatesToIndex( x+1, y-1 ) );
-        }
+/**
+  @class HDF5SimpleDataSpaceReader
+  @brief Supports reading simple data spaces from HDF5 files
 
-        // 1-skeleton --------------------------------------------------
-        //
-        // The check below ensures that an edge is only added once. This
-        // is faster than using e.g. std::set.
+  This class provides a parser for extracting *simple data spaces* from
+  HDF5 files. In other words, this class can extract scalar fields from
+  HDF5 files. The class can only extract one field at a time. Moreover,
+  it requires knowledge about which group and which data set to parse.
 
-        for( auto&& n : neighbourCoordinates )
-        {
-          auto u = i;
-          auto v = n;
+  Two-dimensional data sets are triangulated as in previous versions: a
+  vertex at (x,y) has index y*width+x, with the width being the extent
+  of the first dimension, and every square is split along its diagonal
+  from (x,y) to (x+1,y-1). Data sets of other dimensions are streamed
+  and triangulated by HDF5GridReader.
+*/
 
-          if( u > v )
-            simplices.push_back( Simplex( {u,v}, f( data[u], data[v] ) ) );
-        }
+class HDF5SimpleDataSpaceReader
+{
+public:
 
-        if( !triangleCoordinates.empty() )
-        {
-          auto&& u = triangleCoordinates.at(0);
-          auto&& v = triangleCoordinates.at(1);
-          auto&& w = triangleCoordinates.at(2);
-          auto&& x = triangleCoordinates.at(3);
+  template <class SimplicialComplex> void operator()( const std::string& filename, SimplicialComplex& K )
+  {
+    using Simplex  = typename SimplicialComplex::ValueType;
+    using DataType = typename Simplex::DataType;
 
-          simplices.push_back( Simplex( {u,x,w}, f( data[u], f( data[x], data[w] ) ) ) );
-          simplices.push_back( Simplex( {u,v,x}, f( data[u], f( data[v], data[x] ) ) ) );
-        }
-      }
-    }
+    this->operator()( filename, K, [] ( DataType a, DataType b ) { return std::max(a,b); } );
+  }
 
-    K = SimplicialComplex( simplices.begin(), simplices.end() );
-#else
-    (void) filename;
-    (void) K;
-    (void) f;
+  template <class SimplicialComplex, class Functor> void operator()( const std::string& filename, SimplicialComplex& K, Functor f )
+  {
+    using Simplex  = typename SimplicialComplex::ValueType;
+    using DataType = typename Simplex::DataType;
 
-    // TODO: throw error?
-#endif
+    HDF5GridReader reader;
+
+    reader.setGroupName( _groupName );
+    reader.setDataSetName( _dataSetName );
+
+    FreudenthalTriangulation<Simplex> triangulation;
+
+    std::vector<Simplex> simplices;
+    std::vector<std::size_t> dimensions;
+    std::vector<DataType> data;
+
+    reader.read<DataType>( filename, [&] ( const GridSlab<DataType>& slab )
+    {
+      dimensions = slab.dimensions;
+
+      if( dimensions.size() == 2 )
+        data.insert( data.end(), slab.values.begin(), slab.values.end() );
+      else
+        triangulation( slab, std::back_inserter( simplices ), f );
+    } );
+
+    if( dimensions.size() == 2 )
+      simplices = triangulate<Simplex>( dimensions[0], dimensions[1], data, f );
+
+    K = SimplicialComplex( simplices.begin(), simplices.end() );
   }
 
   // Getters -----------------------------------------------------------
@@ -179,49 +324,61 @@ public:
 
 private:
 
-  /**
-    Auxiliary function for reading data from an HDF5 file and *directly*
-    into a vector. This function does not perform additional type checks
-    but merely attempts a direct conversion.
-  */
-
-#ifdef ALEPH_WITH_HDF5
-  template <class T> std::vector<T> read( const H5::DataSet& dataSet, std::size_t size )
+  /** Triangulates a two-dimensional data set using the legacy numbering */
+  template <class Simplex, class Functor> static std::vector<Simplex> triangulate( std::size_t width,
+                                                                                  std::size_t height,
+                                                                                  const std::vector<typename Simplex::DataType>& data,
+                                                                                  Functor f )
   {
-    std::vector<T> data;
+    using VertexType = typename Simplex::VertexType;
 
-    auto dataType = dataSet.getDataType();
+    std::vector<Simplex> simplices;
+
+    // 0-skeleton ------------------------------------------------------
 
-    std::vector<H5::PredType> doubleTypes = { H5::PredType::NATIVE_DOUBLE,
-                                              H5::PredType::IEEE_F64LE,
-                                              H5::PredType::IEEE_F64BE };
+    for( std::size_t i = 0; i < data.size(); i++ )
+      simplices.push_back( Simplex( static_cast<VertexType>( i ), data[i] ) );
 
-    std::vector<H5::PredType> floatTypes  = { H5::PredType::NATIVE_FLOAT,
-                                              H5::PredType::IEEE_F32LE,
-                                              H5::PredType::IEEE_F32BE };
+    // 1-skeleton & 2-skeleton -----------------------------------------
 
-    if( std::find( doubleTypes.begin(), doubleTypes.end(), dataType ) != doubleTypes.end() )
+    auto coordinatesToIndex = [&width] ( std::size_t x, std::size_t y )
     {
-      std::vector<double> data_( size );
+      return static_cast<VertexType>( y * width + x );
+    };
 
-      dataSet.read( &data_[0], dataType );
-      data.assign( data_.begin(), data_.end() );
-    }
-    else if( std::find( floatTypes.begin(), floatTypes.end(), dataType ) != floatTypes.end() )
+    auto addEdge = [&] ( VertexType u, VertexType v )
     {
-      std::vector<float> data_( size );
+      simplices.push_back( Simplex( {u,v}, f( data[u], data[v] ) ) );
+    };
 
-      dataSet.read( &data_[0], dataType );
-      data.assign( data_.begin(), data_.end() );
-    }
-    else
+    for( std::size_t y = 0; y < height; y++ )
     {
-      // FIXME: handle unknown data type
+      for( std::size_t x = 0; x < width; x++ )
+      {
+        auto u = coordinatesToIndex( x, y );
+
+        if( x > 0 )
+          addEdge( u, coordinatesToIndex( x-1, y ) );
+
+        if( y > 0 )
+          addEdge( u, coordinatesToIndex( x, y-1 ) );
+
+        if( x + 1 < width && y > 0 )
+        {
+          auto v = coordinatesToIndex( x,   y-1 );
+          auto w = coordinatesToIndex( x+1, y   );
+          auto z = coordinatesToIndex( x+1, y-1 );
+
+          addEdge( u, z );
+
+          simplices.push_back( Simplex( {u,z,w}, f( data[u], f( data[z], data[w] ) ) ) );
+          simplices.push_back( Simplex( {u,v,z}, f( data[u], f( data[v], data[z] ) ) ) );
+        }
+      }
     }
 
-    return data;
+    return simplices;
   }
-#endif
 
   std::string _groupName    = "/";
   std::string _dataSetName  = "YField";
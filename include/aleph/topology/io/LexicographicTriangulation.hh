@@ -150,6 +150,10 @@ private:
     using DifferenceType = std::string::difference_type;
     using SizeType       = std::string::size_type;
 
+    // Vertices of a simplex are separated by commas, possibly surrounded
+    // by whitespace.
+    aleph::utilities::Tokenizer tokenizer( ", \t\n\r" );
+
     // Remove the opening bracket from the block. It makes the number of
     // brackets unbalanced but it also simplifies parsing because we may
     // rely on the fact that every opening bracket starts a new simplex.
@@ -207,11 +211,11 @@ private:
 
         using namespace aleph::utilities;
 
-        auto list   = trim( block.substr( positionBegin + 1, positionEnd - positionBegin - 1 ) );
-        auto tokens = split( list, std::string(",") );
+        auto list     = StringView( block ).substr( positionBegin + 1, positionEnd - positionBegin - 1 );
+        auto&& tokens = tokenizer( list );
 
         for( auto&& token : tokens )
-          vertices.emplace_back( convert<VertexType>( token ) );
+          vertices.emplace_back( parse<VertexType>( token ) );
 
         std::advance( it, positionEnd - offset );
       }
@@ -3,19 +3,29 @@
 
 #include <aleph/utilities/String.hh>
 
+#include <aleph/topology/Mesh.hh>
 #include <aleph/topology/Simplex.hh>
 #include <aleph/topology/SimplicialComplex.hh>
 
 #include <aleph/topology/filtrations/Data.hh>
 
+#include <aleph/topology/io/VertexProperties.hh>
+
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 
+#include <algorithm>
 #include <fstream>
+#include <istream>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -71,53 +81,96 @@ std::map<std::string, bool> TypeSignednessMap = {
   { "uint8"  , false }
 };
 
-/* Describes an arbitrary value of a PLY file */
-union PLYValue
+/* Data types of PLY properties */
+enum class PLYType
 {
-  double         d;
-  float          f;
-  int            i;
-  short          s;
-  char           c;
-  unsigned       u;
-  unsigned short us;
-  unsigned char  uc;
+  Char,
+  UnsignedChar,
+  Short,
+  UnsignedShort,
+  Int,
+  UnsignedInt,
+  Float,
+  Double
+};
+
+/*
+  Maps PLY data types to their corresponding type. This is required for
+  decoding binary files later on.
+*/
+
+std::map<std::string, PLYType> TypeMap = {
+  { "double" , PLYType::Double        },
+  { "float"  , PLYType::Float         },
+  { "int"    , PLYType::Int           },
+  { "int32"  , PLYType::Int           },
+  { "uint"   , PLYType::UnsignedInt   },
+  { "uint32" , PLYType::UnsignedInt   },
+  { "short"  , PLYType::Short         },
+  { "ushort" , PLYType::UnsignedShort },
+  { "char"   , PLYType::Char          },
+  { "uchar"  , PLYType::UnsignedChar  },
+  { "uint8"  , PLYType::UnsignedChar  }
 };
 
 /*
-  Reads a single value from a binary input stream, reversing the storage
-  order if necessary.
+  Reads a single value from a binary input stream. The value is decoded
+  from the byte order of the file, independently of the byte order of
+  the machine.
 */
 
-template <class T> void readValue( std::ifstream& stream,
-                                   std::size_t bytes,
-                                   bool littleEndian,
-                                   T* target )
+template <class T> T readValue( std::istream& stream, bool littleEndian )
 {
-  if( !littleEndian || bytes == 1 )
-    stream.read( reinterpret_cast<char*>( target ), static_cast<std::streamsize>( bytes ) );
-  else
-  {
-    char* buffer         = new char[bytes];
-    char* reversedBuffer = new char[bytes];
+  using Unsigned = typename std::conditional<sizeof(T) == 1, std::uint8_t,
+                   typename std::conditional<sizeof(T) == 2, std::uint16_t,
+                   typename std::conditional<sizeof(T) == 4, std::uint32_t,
+                                                             std::uint64_t>::type>::type>::type;
 
-    stream.read( buffer, static_cast<std::streamsize>( bytes ) );
+  static_assert( sizeof(T) == sizeof(Unsigned), "Unsupported type size" );
 
-    for( std::size_t i = 0; i < bytes; i++ )
-      reversedBuffer[i] = buffer[ bytes - 1 - i ];
+  char bytes[ sizeof(T) ];
 
-    std::copy( reversedBuffer, reversedBuffer + bytes, target );
+  if( !stream.read( bytes, static_cast<std::streamsize>( sizeof(T) ) ) )
+    throw std::runtime_error( "Unexpected end of file" );
 
-    // FIXME: Superfluous?
-#if 0
-    memcpy( reinterpret_cast<void*>( &target ),
-            reinterpret_cast<void*>( reversedBuffer ),
-            bytes );
-#endif
+  Unsigned u = 0;
 
-    delete[] reversedBuffer;
-    delete[] buffer;
+  for( std::size_t i = 0; i < sizeof(T); i++ )
+  {
+    auto byte = static_cast<unsigned char>( bytes[ littleEndian ? sizeof(T) - 1 - i : i ] );
+    u         = static_cast<Unsigned>( ( std::uint64_t( u ) << 8 ) | byte );
   }
+
+  T value;
+  std::memcpy( &value, &u, sizeof(T) );
+
+  return value;
+}
+
+/* Reads a single value of the given type and converts it */
+inline double readValue( std::istream& stream, PLYType type, bool littleEndian )
+{
+  switch( type )
+  {
+  case PLYType::Char:
+    return double( readValue<std::int8_t>( stream, littleEndian ) );
+  case PLYType::UnsignedChar:
+    return double( readValue<std::uint8_t>( stream, littleEndian ) );
+  case PLYType::Short:
+    return double( readValue<std::int16_t>( stream, littleEndian ) );
+  case PLYType::UnsignedShort:
+    return double( readValue<std::uint16_t>( stream, littleEndian ) );
+  case PLYType::Int:
+    return double( readValue<std::int32_t>( stream, littleEndian ) );
+  case PLYType::UnsignedInt:
+    return double( readValue<std::uint32_t>( stream, littleEndian ) );
+  case PLYType::Float:
+    return double( readValue<float>( stream, littleEndian ) );
+  case PLYType::Double:
+    return readValue<double>( stream, littleEndian );
+  }
+
+  return 0.0;
 }
 
 } // namespace detail
@@ -141,19 +194,22 @@ public:
   struct PropertyDescriptor
   {
     std::string name;     // Property name (or list name)
+    std::string element;  // Name of the element the property belongs to
     unsigned index;       // Offset of attribute for ASCII data
     unsigned bytesOffset; // Offset of attribute for binary data
     unsigned bytes;       // Number of bytes
+    detail::PLYType type; // Data type (or data type of list entries)
 
     // Only used for lists: Here, both the length parameter and the
     // entry parameter of a list usually have different lengths.
     unsigned bytesListSize;
     unsigned bytesListEntry;
+    detail::PLYType listSizeType;
   };
 
   template <class SimplicialComplex> void operator()( const std::string& filename, SimplicialComplex& K )
   {
-    std::ifstream in( filename );
+    std::ifstream in( filename, std::ios::binary );
     if( !in )
       throw std::runtime_error( "Unable to read input file" );
 
@@ -161,15 +217,135 @@ public:
   }
 
   template <class SimplicialComplex> void operator()( std::ifstream& in, SimplicialComplex& K )
+  {
+    std::size_t numVertices = 0; // Number of vertices
+    std::size_t numFaces    = 0; // Number of faces
+
+    bool parseBinary  = false;
+    bool littleEndian = false;
+
+    // All properties stored in the PLY file in the order in which they
+    // were discovered. The parse requires the existence of some of the
+    // properties, e.g. "x", "y", and "z" in order to work correctly.
+    std::vector<PropertyDescriptor> properties;
+
+    this->parseHeader( in,
+                       numVertices, numFaces,
+                       parseBinary, littleEndian,
+                       properties );
+
+    using Simplex = typename SimplicialComplex::ValueType;
+
+    // Container for storing all simplices that are created while reading
+    // the mesh data structure.
+    std::vector<Simplex> simplices;
+
+    if( parseBinary )
+    {
+      simplices = this->parseBinary<Simplex>( in,
+                                              numVertices, numFaces,
+                                              littleEndian,
+                                              properties );
+    }
+    else
+    {
+      simplices = this->parseASCII<Simplex>( in,
+                                             numVertices, numFaces,
+                                             properties );
+    }
+
+    in.close();
+
+    K = SimplicialComplex( simplices.begin(), simplices.end() );
+    K.recalculateWeights();
+    K.sort( filtrations::Data<Simplex>() );
+  }
+
+  /* Sets the property to read for every simplex */
+  void setDataProperty( const std::string& property )
+  {
+    _property = property;
+  }
+
+  /**
+    Reads a mesh instead of a simplicial complex. Vertices and faces are
+    added in bulk, and faces are not restricted to triangles. The data of
+    every vertex is taken from the selected property.
+  */
+
+  template <class Position, class Data> void operator()( const std::string& filename, Mesh<Position, Data>& M )
+  {
+    std::ifstream in( filename, std::ios::binary );
+    if( !in )
+      throw std::runtime_error( "Unable to read input file" );
+
+    this->operator()( in, M );
+  }
+
+  template <class Position, class Data> void operator()( std::ifstream& in, Mesh<Position, Data>& M )
+  {
+    std::size_t numVertices = 0;
+    std::size_t numFaces    = 0;
+
+    bool parseBinary  = false;
+    bool littleEndian = false;
+
+    std::vector<PropertyDescriptor> properties;
+
+    this->parseHeader( in,
+                       numVertices, numFaces,
+                       parseBinary, littleEndian,
+                       properties );
+
+    std::vector<Data> weights;
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> vertices;
+
+    if( parseBinary )
+    {
+      this->readVerticesBinary( in, numVertices, littleEndian, properties, weights );
+      this->readFacesBinary( in, numFaces, littleEndian, properties, offsets, vertices );
+    }
+    else
+    {
+      this->readVerticesASCII( in, numVertices, properties, weights );
+      this->readFacesASCII( in, numFaces, offsets, vertices );
+    }
+
+    M = Mesh<Position, Data>();
+    M.reserveVertices( numVertices );
+
+    for( std::size_t i = 0; i < numVertices; i++ )
+    {
+      auto&& p = _coordinates[i];
+
+      M.addVertex( static_cast<Position>( p[0] ),
+                   static_cast<Position>( p[1] ),
+                   static_cast<Position>( p[2] ),
+                   weights[i] );
+    }
+
+    M.addFaces( offsets, vertices );
+  }
+
+private:
+
+  /**
+    Parses the header of a PLY file and reports the number of vertices and
+    faces, the format of the file, and all properties.
+  */
+
+  void parseHeader( std::ifstream& in,
+                    std::size_t& numVertices, std::size_t& numFaces,
+                    bool& parseBinary, bool& littleEndian,
+                    std::vector<PropertyDescriptor>& properties )
   {
     // Header ------------------------------------------------------------
     //
     // The header needs to consist of the word "ply", followed by a "format"
     // description.
 
-    std::size_t numVertices       = 0; // Number of edges
     std::size_t vertexSizeInBytes = 0; // Only relevant for binary files
-    std::size_t numFaces          = 0; // Number of faces
     std::size_t faceSizeInBytes   = 0; // Only relevant for binary files
 
     // Current line in file. This is required because I prefer reading the
@@ -177,8 +353,6 @@ public:
     std::string line;
 
     bool headerParsed = false;
-    bool parseBinary  = false;
-    bool littleEndian = false;
 
     std::getline( in, line );
     line = utilities::trim( line );
@@ -212,17 +386,14 @@ public:
         throw std::runtime_error( "Format error: Expecting \"ascii 1.0\" or \"binary_little_endian 1.0\" or \"binary_big_endian 1.0\" " );
     }
 
-    // All properties stored in the PLY file in the order in which they
-    // were discovered. The parse requires the existence of some of the
-    // properties, e.g. "x", "y", and "z" in order to work correctly.
-    std::vector<PropertyDescriptor> properties;
-
     unsigned propertyIndex  = 0; // Offset for properties in ASCII files
     unsigned propertyOffset = 0; // Offset for properties in binary files
 
     bool readingVertexProperties = false;
     bool readingFaceProperties   = false;
 
+    std::string currentElement; // Element to which subsequent properties belong
+
     // Parse the rest of the header, taking care to skip any comment lines.
     do
     {
@@ -250,7 +421,8 @@ public:
         if( !converter )
           throw std::runtime_error( "Element conversion error: Expecting number of elements" );
 
-        name = utilities::trim( name );
+        name           = utilities::trim( name );
+        currentElement = name;
 
         if( name == "vertex" )
         {
@@ -279,8 +451,9 @@ public:
         dataType = utilities::trim( dataType );
         name     = utilities::trim( name );
 
-        PropertyDescriptor descriptor;
-        descriptor.index = propertyIndex;
+        PropertyDescriptor descriptor = PropertyDescriptor();
+        descriptor.index              = propertyIndex;
+        descriptor.element            = currentElement;
 
         // List of properties require a special handling. The syntax is
         // "property list SIZE_TYPE ENTRY_TYPE NAME", e.g. "property
@@ -299,12 +472,15 @@ public:
 
           descriptor.bytesListSize  = detail::TypeSizeMap.at( sizeType );
           descriptor.bytesListEntry = detail::TypeSizeMap.at( entryType );
+          descriptor.listSizeType   = detail::TypeMap.at( sizeType );
+          descriptor.type           = detail::TypeMap.at( entryType );
           descriptor.name           = listName;
         }
         else
         {
           descriptor.bytes       = detail::TypeSizeMap.at( dataType );
           descriptor.bytesOffset = propertyOffset;
+          descriptor.type        = detail::TypeMap.at( dataType );
           descriptor.name        = name;
         }
 
@@ -332,112 +508,122 @@ public:
 
     assert( numVertices > 0 );
     assert( numFaces    > 0 );
+  }
 
-    using Simplex = typename SimplicialComplex::ValueType;
-
-    // Container for storing all simplices that are created while reading
-    // the mesh data structure.
-    std::vector<Simplex> simplices;
+  template <class Simplex> std::vector<Simplex> parseBinary( std::ifstream& in,
+                                                             std::size_t numVertices,
+                                                             std::size_t numFaces,
+                                                             bool littleEndian,
+                                                             const std::vector<PropertyDescriptor>& properties )
+  {
+    using DataType = typename Simplex::DataType;
 
-    if( parseBinary )
-    {
-      simplices = this->parseBinary<Simplex>( in,
-                                              numVertices, numFaces,
-                                              littleEndian,
-                                              properties );
-    }
-    else
-    {
-      simplices = this->parseASCII<Simplex>( in,
-                                             numVertices, numFaces,
-                                             properties );
-    }
+    std::vector<DataType> weights;
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> vertices;
 
-    in.close();
+    this->readVerticesBinary( in, numVertices, littleEndian, properties, weights );
+    this->readFacesBinary( in, numFaces, littleEndian, properties, offsets, vertices );
 
-    K = SimplicialComplex( simplices.begin(), simplices.end() );
-    K.recalculateWeights();
-    K.sort( filtrations::Data<Simplex>() );
+    return this->makeSimplices<Simplex>( weights, offsets, vertices );
   }
 
-  /* Sets the property to read for every simplex */
-  void setDataProperty( const std::string& property )
+  template <class Simplex> std::vector<Simplex> parseASCII( std::ifstream& in,
+                                                            std::size_t numVertices, std::size_t numFaces,
+                                                            const std::vector<PropertyDescriptor>& properties )
   {
-    _property = property;
+    using DataType = typename Simplex::DataType;
+
+    std::vector<DataType> weights;
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> vertices;
+
+    this->readVerticesASCII( in, numVertices, properties, weights );
+    this->readFacesASCII( in, numFaces, offsets, vertices );
+
+    return this->makeSimplices<Simplex>( weights, offsets, vertices );
   }
 
-private:
+  /**
+    Creates the simplices of a triangulated surface, i.e. all vertices,
+    edges, and triangles, from the vertex data and the faces.
+  */
 
-  template <class Simplex> std::vector<Simplex> parseBinary( std::ifstream& in,
-                                                             std::size_t numVertices,
-                                                             std::size_t numFaces,
-                                                             bool littleEndian,
-                                                             const std::vector<PropertyDescriptor>& properties )
+  template <class Simplex> std::vector<Simplex> makeSimplices( const std::vector<typename Simplex::DataType>& weights,
+                                                               const std::vector<std::size_t>& offsets,
+                                                               const std::vector<std::size_t>& vertices )
   {
-    using DataType   = typename Simplex::DataType;
     using VertexType = typename Simplex::VertexType;
 
-    // FIXME: this is just to placate the compiler
-    {
-      (void) numFaces;
+    auto numVertices = weights.size();
+    auto numFaces    = offsets.size() - 1;
 
-      VertexType v = VertexType();
-      (void) v;
-
-      DataType weight = DataType();
-      (void) weight;
-    }
+    std::vector<Simplex> simplices;
 
     for( std::size_t vertexIndex = 0; vertexIndex < numVertices; vertexIndex++ )
+      simplices.push_back( Simplex( VertexType( vertexIndex ), weights[vertexIndex] ) );
+
+    // Keep track of all edges that are encountered. This ensures that the
+    // simplicial complex is valid upon construction and does not have any
+    // missing simplices.
+    std::set< std::pair<VertexType, VertexType> > edges;
+
+    for( std::size_t faceIndex = 0; faceIndex < numFaces; faceIndex++ )
     {
-      std::vector<double> coordinates;
+      // I can make a simplex out of a triangle, but every other shape would
+      // get complicated.
+      if( offsets[faceIndex+1] - offsets[faceIndex] != 3 )
+        throw std::runtime_error( "Format error: Expecting triangular faces only" );
+
+      auto i1 = VertexType( vertices[ offsets[faceIndex]     ] );
+      auto i2 = VertexType( vertices[ offsets[faceIndex] + 1 ] );
+      auto i3 = VertexType( vertices[ offsets[faceIndex] + 2 ] );
+
+      Simplex triangle( {i1,i2,i3} );
 
-      for( auto&& descriptor : properties )
+      // Create edges ----------------------------------------------------
+
+      for( auto itEdge = triangle.begin_boundary();
+           itEdge != triangle.end_boundary();
+           ++itEdge )
       {
-        // Only faces may have lists for now...
-        if( descriptor.bytesListSize + descriptor.bytesListEntry != 0 )
-          continue;
+        // As the boundary iterator works as a filtered iterator only,
+        // I need this copy.
+        //
+        // Else, different calls to `begin()` and `end()` will result in
+        // two different copies of the simplex. The copies, in turn,
+        // will then not be usable as a source for vertices.
+        Simplex edge = *itEdge;
 
-        detail::PLYValue pv;
+        auto u = *( edge.begin() );
+        auto v = *( edge.begin() + 1 );
 
-        switch( descriptor.bytes )
-        {
-          case 8:
-            detail::readValue( in, descriptor.bytes, littleEndian, &pv.d );
-            break;
-          case 4:
-            detail::readValue( in, descriptor.bytes, littleEndian, &pv.f );
-            break;
-          case 2:
-            detail::readValue( in, descriptor.bytes, littleEndian, &pv.s );
-            break;
-          case 1:
-            detail::readValue( in, descriptor.bytes, littleEndian, &pv.c );
-            break;
-        }
+        if( u < v )
+          std::swap( u, v );
 
-        // FIXME: Not sure whether this is legal...
-        if( descriptor.name == "x" || descriptor.name == "y" || descriptor.name == "z" )
-          coordinates.push_back( pv.d );
+        auto pair = edges.insert( std::make_pair( u,v ) );
+
+        if( pair.second )
+          simplices.push_back( Simplex( edge.begin(), edge.end() ) );
       }
-    }
 
-    for( std::size_t faceIndex = 0; faceIndex < numVertices; faceIndex++ )
-    {
+      simplices.push_back( triangle );
     }
 
-    return {};
+    return simplices;
   }
 
+  /**
+    Reads the vertices of an ASCII file. Coordinates are stored for later
+    use, while the selected property of every vertex is stored in the
+    given vector. If the property does not exist, a default value is used.
+  */
 
-  template <class Simplex> std::vector<Simplex> parseASCII( std::ifstream& in,
-                                                            std::size_t numVertices, std::size_t numFaces,
-                                                            const std::vector<PropertyDescriptor>& properties )
+  template <class DataType> void readVerticesASCII( std::ifstream& in,
+                                                    std::size_t numVertices,
+                                                    const std::vector<PropertyDescriptor>& properties,
+                                                    std::vector<DataType>& weights )
   {
-    using DataType   = typename Simplex::DataType;
-    using VertexType = typename Simplex::VertexType;
-
-    std::vector<Simplex> simplices;
     std::string line;
 
     auto getPropertyIndex = [&properties] ( const std::string& property )
@@ -454,108 +640,228 @@ private:
         return std::numeric_limits<unsigned>::max();
     };
 
-    // Read vertices -----------------------------------------------------
+    auto ix = getPropertyIndex( "x" );
+    auto iy = getPropertyIndex( "y" );
+    auto iz = getPropertyIndex( "z" );
+    auto iw = getPropertyIndex( _property );
+
+    utilities::Tokenizer tokenizer;
+
+    _coordinates.clear();
+    _coordinates.reserve( numVertices );
+
+    weights.clear();
+    weights.reserve( numVertices );
 
     for( std::size_t vertexIndex = 0; vertexIndex < numVertices; vertexIndex++ )
     {
-      std::vector<double> vertexCoordinates( 3 );
-
       std::getline( in, line );
 
-      line        = utilities::trim( line );
-      auto tokens = utilities::split( line );
+      auto&& tokens = tokenizer( line );
 
-      auto ix     = getPropertyIndex( "x" );
-      auto iy     = getPropertyIndex( "y" );
-      auto iz     = getPropertyIndex( "z" );
-      auto iw     = getPropertyIndex( _property );
-
-      auto x      = std::stod( tokens.at( ix ) );
-      auto y      = std::stod( tokens.at( iy ) );
-      auto z      = std::stod( tokens.at( iz ) );
+      auto x = utilities::parse<double>( tokens.at( ix ) );
+      auto y = utilities::parse<double>( tokens.at( iy ) );
+      auto z = utilities::parse<double>( tokens.at( iz ) );
 
       _coordinates.push_back( {x,y,z} );
 
       // No property for reading weights specified, or the specified
-      // property could not be found; just use the default weight of
-      // the simplex class.
+      // property could not be found; just use the default weight.
       if( _property.empty() || iw == std::numeric_limits<unsigned>::max() )
-        simplices.push_back( { VertexType( vertexIndex ) } );
+        weights.push_back( DataType() );
       else
-      {
-        DataType w = aleph::utilities::convert<DataType>( tokens.at(iw) );
-        simplices.push_back( Simplex( VertexType( vertexIndex ), w ) );
-      }
+        weights.push_back( utilities::parse<DataType>( tokens.at(iw) ) );
     }
+  }
 
-    // Read faces --------------------------------------------------------
+  /**
+    Reads the faces of an ASCII file. The vertex indices of all faces are
+    stored contiguously; the indices of face i are stored in the range
+    [offsets[i], offsets[i+1]).
+  */
 
-    // Keep track of all edges that are encountered. This ensures that the
-    // simplicial complex is valid upon construction and does not have any
-    // missing simplices.
-    std::set< std::pair<VertexType, VertexType> > edges;
+  void readFacesASCII( std::ifstream& in,
+                       std::size_t numFaces,
+                       std::vector<std::size_t>& offsets,
+                       std::vector<std::size_t>& vertices )
+  {
+    std::string line;
+    utilities::Tokenizer tokenizer;
+
+    offsets.assign( 1, 0 );
+    offsets.reserve( numFaces + 1 );
+
+    vertices.clear();
+    vertices.reserve( 3 * numFaces );
 
     for( std::size_t faceIndex = 0; faceIndex < numFaces; faceIndex++ )
     {
       std::getline( in, line );
-      std::istringstream converter( line );
 
+      auto&& tokens       = tokenizer( line );
       unsigned numEntries = 0;
 
-      converter >> numEntries;
-      if( !converter )
+      if( tokens.empty() || !utilities::parse( tokens.front(), numEntries ) )
         throw std::runtime_error( "Face conversion error: Expecting number of entries" );
 
-      // I can make a simplex out of a triangle, but every other shape would
-      // get complicated.
-      if( numEntries == 3 )
-      {
-        VertexType i1 = 0;
-        VertexType i2 = 0;
-        VertexType i3 = 0;
+      if( tokens.size() < std::size_t( numEntries ) + 1 )
+        throw std::runtime_error( "Unable to parse vertex indices" );
 
-        converter >> i1
-                  >> i2
-                  >> i3;
+      for( std::size_t i = 1; i <= numEntries; i++ )
+      {
+        std::size_t index = 0;
 
-        if( !converter )
+        if( !utilities::parse( tokens[i], index ) )
           throw std::runtime_error( "Unable to parse vertex indices" );
 
-        Simplex triangle( {i1,i2,i3} );
+        vertices.push_back( index );
+      }
 
-        // Create edges ----------------------------------------------
+      offsets.push_back( vertices.size() );
+    }
+  }
 
-        for( auto itEdge = triangle.begin_boundary();
-             itEdge != triangle.end_boundary();
-             ++itEdge )
-        {
-          // As the boundary iterator works as a filtered iterator only,
-          // I need this copy.
-          //
-          // Else, different calls to `begin()` and `end()` will result in
-          // two different copies of the simplex. The copies, in turn,
-          // will then not be usable as a source for vertices.
-          Simplex edge = *itEdge;
+  /**
+    Reads the vertices of a binary file. This works like the ASCII case
+    but decodes every property of a vertex according to its data type.
+    Lists of vertex properties are read but ignored.
+  */
+
+  template <class DataType> void readVerticesBinary( std::ifstream& in,
+                                                     std::size_t numVertices,
+                                                     bool littleEndian,
+                                                     const std::vector<PropertyDescriptor>& properties,
+                                                     std::vector<DataType>& weights )
+  {
+    std::vector<PropertyDescriptor> vertexProperties;
 
-          auto u = *( edge.begin() );
-          auto v = *( edge.begin() + 1 );
+    std::copy_if( properties.begin(), properties.end(), std::back_inserter( vertexProperties ),
+                  [] ( const PropertyDescriptor& descriptor )
+                  {
+                    return descriptor.element == "vertex";
+                  } );
 
-          if( u < v )
-            std::swap( u, v );
+    auto getPropertyIndex = [&vertexProperties] ( const std::string& property )
+    {
+      auto it = std::find_if( vertexProperties.begin(), vertexProperties.end(),
+                              [&property] ( const PropertyDescriptor& descriptor )
+                              {
+                                return descriptor.name == property;
+                              } );
 
-          auto pair = edges.insert( std::make_pair( u,v ) );
+      return static_cast<std::size_t>( std::distance( vertexProperties.begin(), it ) );
+    };
 
-          if( pair.second )
-            simplices.push_back( Simplex( edge.begin(), edge.end() ) );
-        }
+    auto ix = getPropertyIndex( "x" );
+    auto iy = getPropertyIndex( "y" );
+    auto iz = getPropertyIndex( "z" );
+    auto iw = _property.empty() ? vertexProperties.size() : getPropertyIndex( _property );
+
+    if( std::max( { ix, iy, iz } ) >= vertexProperties.size() )
+      throw std::runtime_error( "Format error: Expecting \"x\", \"y\", and \"z\" properties" );
+
+    std::vector<double> values( vertexProperties.size() );
+
+    _coordinates.clear();
+    _coordinates.reserve( numVertices );
+
+    weights.clear();
+    weights.reserve( numVertices );
+
+    for( std::size_t vertexIndex = 0; vertexIndex < numVertices; vertexIndex++ )
+    {
+      for( std::size_t i = 0; i < vertexProperties.size(); i++ )
+      {
+        auto&& descriptor = vertexProperties[i];
+
+        if( descriptor.bytesListSize + descriptor.bytesListEntry != 0 )
+        {
+          auto n = static_cast<std::size_t>( detail::readValue( in, descriptor.listSizeType, littleEndian ) );
 
-        simplices.push_back( triangle );
+          for( std::size_t j = 0; j < n; j++ )
+            detail::readValue( in, descriptor.type, littleEndian );
+        }
+        else
+          values[i] = detail::readValue( in, descriptor.type, littleEndian );
       }
+
+      _coordinates.push_back( { values[ix], values[iy], values[iz] } );
+
+      // See above; the default weight is used if no property has been
+      // specified or if the property does not exist.
+      if( iw >= vertexProperties.size() )
+        weights.push_back( DataType() );
       else
-        throw std::runtime_error( "Format error: Expecting triangular faces only" );
+        weights.push_back( static_cast<DataType>( values[iw] ) );
     }
+  }
 
-    return simplices;
+  /**
+    Reads the faces of a binary file. The first list of every face is
+    taken to contain its vertex indices; all other properties of a face
+    are read but ignored.
+  */
+
+  void readFacesBinary( std::ifstream& in,
+                        std::size_t numFaces,
+                        bool littleEndian,
+                        const std::vector<PropertyDescriptor>& properties,
+                        std::vector<std::size_t>& offsets,
+                        std::vector<std::size_t>& vertices )
+  {
+    std::vector<PropertyDescriptor> faceProperties;
+
+    std::copy_if( properties.begin(), properties.end(), std::back_inserter( faceProperties ),
+                  [] ( const PropertyDescriptor& descriptor )
+                  {
+                    return descriptor.element == "face";
+                  } );
+
+    auto indices = std::find_if( faceProperties.begin(), faceProperties.end(),
+                                 [] ( const PropertyDescriptor& descriptor )
+                                 {
+                                   return descriptor.bytesListSize + descriptor.bytesListEntry != 0;
+                                 } );
+
+    if( indices == faceProperties.end() )
+      throw std::runtime_error( "Format error: Expecting list of vertex indices" );
+
+    offsets.assign( 1, 0 );
+    offsets.reserve( numFaces + 1 );
+
+    vertices.clear();
+    vertices.reserve( 3 * numFaces );
+
+    for( std::size_t faceIndex = 0; faceIndex < numFaces; faceIndex++ )
+    {
+      for( auto it = faceProperties.begin(); it != faceProperties.end(); ++it )
+      {
+        if( it->bytesListSize + it->bytesListEntry != 0 )
+        {
+          auto n = detail::readValue( in, it->listSizeType, littleEndian );
+
+          if( n < 0 )
+            throw std::runtime_error( "Face conversion error: Expecting number of entries" );
+
+          for( std::size_t j = 0; j < static_cast<std::size_t>( n ); j++ )
+          {
+            auto index = detail::readValue( in, it->type, littleEndian );
+
+            if( it != indices )
+              continue;
+
+            if( index < 0 )
+              throw std::runtime_error( "Unable to parse vertex indices" );
+
+            vertices.push_back( static_cast<std::size_t>( index ) );
+          }
+        }
+        else
+          detail::readValue( in, it->type, littleEndian );
+      }
+
+      offsets.push_back( vertices.size() );
+    }
   }
 
   /** Data property to assign to new simplices */
@@ -565,6 +871,107 @@ private:
   std::vector< std::vector<double> > _coordinates;
 };
 
+/**
+  @class PLYWriter
+  @brief Writes meshes in ASCII PLY format
+
+  Besides the coordinates of every vertex, the writer stores the data of
+  every vertex as well as an arbitrary number of additional per-vertex
+  properties. This makes it possible to store e.g. segmentations of the
+  mesh. Every property needs to be indexed like the vertices of the mesh,
+  i.e. in the order of `Mesh::vertices()`.
+*/
+
+class PLYWriter
+{
+public:
+
+  /** Sets the name of the property that stores the data of every vertex */
+  void setDataProperty( const std::string& property )
+  {
+    _property = property;
+  }
+
+  /**
+    Adds a per-vertex property. Integral values are stored as integers,
+    whereas all other values are stored as floating point numbers.
+  */
+
+  template <class T> void addVertexProperty( const std::string& name, const std::vector<T>& values )
+  {
+    _vertexProperties.add( name, values );
+  }
+
+  template <class Position, class Data> void operator()( const std::string& filename, const Mesh<Position, Data>& M )
+  {
+    std::ofstream out( filename );
+    if( !out )
+      throw std::runtime_error( "Unable to open output file" );
+
+    this->operator()( out, M );
+  }
+
+  template <class Position, class Data> void operator()( std::ostream& out, const Mesh<Position, Data>& M )
+  {
+    auto&& vertices = M.vertices();
+    auto&& faces    = M.faces();
+
+    if( !_vertexProperties.matches( vertices.size() ) )
+      throw std::runtime_error( "Number of property values does not match number of vertices" );
+
+    out << "ply\n"
+        << "format ascii 1.0\n"
+        << "element vertex " << vertices.size() << "\n"
+        << "property double x\n"
+        << "property double y\n"
+        << "property double z\n"
+        << "property double " << _property << "\n";
+
+    for( std::size_t j = 0; j < _vertexProperties.size(); j++ )
+      out << "property " << _vertexProperties.type( j ) << " " << _vertexProperties.name( j ) << "\n";
+
+    out << "element face " << faces.size() << "\n"
+        << "property list uchar int vertex_indices\n"
+        << "end_header\n";
+
+    out.precision( std::numeric_limits<double>::max_digits10 );
+
+    for( std::size_t i = 0; i < vertices.size(); i++ )
+    {
+      Position x, y, z;
+      std::tie( x, y, z ) = M.position( vertices[i] );
+
+      out << x << " " << y << " " << z << " " << M.data( vertices[i] );
+
+      for( std::size_t j = 0; j < _vertexProperties.size(); j++ )
+      {
+        out << " ";
+        _vertexProperties.write( out, j, i );
+      }
+
+      out << "\n";
+    }
+
+    for( auto&& face : faces )
+    {
+      out << face.size();
+
+      for( auto&& id : face )
+        out << " " << M.index( id );
+
+      out << "\n";
+    }
+  }
+
+private:
+
+  /** Name of the property that stores the data of every vertex */
+  std::string _property = "data";
+
+  /** Additional properties to write for every vertex */
+  detail::VertexProperties _vertexProperties;
+};
+
 } // namespace io
 
 } // namespace topology
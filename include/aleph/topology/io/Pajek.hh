@@ -3,11 +3,13 @@
 
 #include <algorithm>
 #include <fstream>
-#include <regex>
+#include <map>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include <cctype>
+
 #include <aleph/utilities/String.hh>
 
 namespace aleph
@@ -52,42 +54,49 @@ public:
 
     Mode mode = Mode::Unspecified;
 
-    std::regex reKeyword  = std::regex( "\\*([[:alpha:]]+).*" );
-    std::regex reKeyValue = std::regex( "\\*([[:alpha:]]+)[[:space:]]+([[:digit:]]+)" );
-    std::regex reVertex   = std::regex( "([[:digit:]]+)[[:space:]]+\"(.*)\"");
-    std::regex reEdge     = std::regex( "([[:digit:]]+)[[:space:]]+([[:digit:]]+)[[:space:]]*([[:digit:]\\.]+)*");
-
-    std::smatch matches;
-
     std::vector<Simplex> simplices;
     std::size_t numVertices = 0;
 
     std::string line;
+    Tokenizer tokenizer;
+
+    auto isNumber = [] ( StringView token )
+    {
+      return !token.empty() && std::all_of( token.begin(), token.end(), [] ( char c ) { return c >= '0' && c <= '9'; } );
+    };
 
     while( std::getline( in, line ) )
     {
       // Although this is not explicitly specified in the rather terse
       // Pajek file format specification, it makes sense to remove all
       // white space characters in order to simplify parsing.
-      line = trim( line );
+      auto view = trim( StringView( line ) );
 
-      // Skip comments
-      if( line.front() == '%' )
+      // Skip empty lines and comments
+      if( view.empty() || view.front() == '%' )
         continue;
 
       // 1st case: Found a keyword. This changes the parser mode and
       // requires us to load additional information.
-      if( std::regex_match( line, matches, reKeyword ) )
+      if( view.size() >= 2 && view[0] == '*' && std::isalpha( static_cast<unsigned char>( view[1] ) ) )
       {
-        std::string name = matches[1];
+        std::size_t n = 1;
+        while( n < view.size() && std::isalpha( static_cast<unsigned char>( view[n] ) ) )
+          ++n;
+
+        std::string name = view.substr( 1, n - 1 ).str();
         std::transform( name.begin(), name.end(), name.begin(), ::tolower );
 
         if( name == "vertices" || name == "verts" )
         {
-          if( !std::regex_match( line, matches, reKeyValue ) )
+          auto value = view.substr( n );
+
+          if(    value.empty()
+              || !std::isspace( static_cast<unsigned char>( value.front() ) )
+              || !isNumber( trim( value ) ) )
             throw std::runtime_error( "Unable to parse vertices specification" );
 
-          numVertices = std::stoul( matches[2] );
+          numVertices = parse<std::size_t>( trim( value ) );
           mode        = Mode::Vertices;
 
           simplices.reserve( numVertices );
@@ -99,11 +108,21 @@ public:
       // 2nd case: Proceed according to parser mode: vertices
       else if( mode == Mode::Vertices )
       {
-        if( !std::regex_match( line, matches, reVertex ) )
+        std::size_t n = 0;
+        while( n < view.size() && !std::isspace( static_cast<unsigned char>( view[n] ) ) )
+          ++n;
+
+        auto idView    = view.substr( 0, n );
+        auto labelView = trim( view.substr( n ) );
+
+        // Labels are enclosed in quotes; everything between the first and
+        // the last quote belongs to the label.
+        if(    !isNumber( idView ) || n == view.size()
+            || labelView.size() < 2 || labelView.front() != '"' || labelView.back() != '"' )
           throw std::runtime_error( "Unable to parse vertex identifier" );
 
-        auto id    = matches[1];
-        auto label = matches[2];
+        auto id    = idView.str();
+        auto label = labelView.substr( 1, labelView.size() - 2 ).str();
 
         if( _labels.find(id) != _labels.end() )
           throw std::runtime_error( "Duplicate vertex identifier" );
@@ -116,7 +135,7 @@ public:
         // TODO: We could potentially support vertex weights here as well but
         // the original file format specification apparently does not account
         // for it.
-        simplices.push_back( Simplex( VertexType( std::stoul(id) ) ) );
+        simplices.push_back( Simplex( parse<VertexType>( idView ) ) );
       }
 
       // 2nd case: Proceed according to parser mode: edges
@@ -137,19 +156,22 @@ public:
         if( simplices.size() < numVertices )
           throw std::runtime_error( "Missing at least one vertex specification" );
 
-        if( !std::regex_match( line, matches, reEdge ) )
+        auto&& tokens = tokenizer( view );
+
+        DataType weight = DataType();
+
+        if(    tokens.size() < 2 || tokens.size() > 3
+            || !isNumber( tokens[0] ) || !isNumber( tokens[1] )
+            || ( tokens.size() == 3 && !parse( tokens[2], weight ) ) )
           throw std::runtime_error( "Unable to parse edge identifier" );
 
-        auto source = VertexType( std::stoul( matches[1] ) );
-        auto target = VertexType( std::stoul( matches[2] ) );
+        auto source = parse<VertexType>( tokens[0] );
+        auto target = parse<VertexType>( tokens[1] );
 
         Simplex edge( {source, target} );
 
-        if( matches[3].matched )
-        {
-          auto weight = convert<DataType>( matches[3] );
+        if( tokens.size() == 3 )
           edge.setData( weight );
-        }
 
         simplices.push_back( edge );
       }
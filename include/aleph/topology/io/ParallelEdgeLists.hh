@@ -0,0 +1,754 @@
+#ifndef ALEPH_TOPOLOGY_IO_PARALLEL_EDGE_LISTS_HH__
+#define ALEPH_TOPOLOGY_IO_PARALLEL_EDGE_LISTS_HH__
+
+#include <aleph/topology/WeightedGraph.hh>
+
+#include <aleph/utilities/MemoryMappedFile.hh>
+#include <aleph/utilities/String.hh>
+#include <aleph/utilities/Timer.hh>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace aleph
+{
+
+namespace topology
+{
+
+namespace io
+{
+
+/**
+  @struct EdgeListStatistics
+  @brief Timings and sizes of the last file read by a ParallelEdgeListReader
+*/
+
+struct EdgeListStatistics
+{
+  std::size_t bytes    = 0; ///< Size of the file
+  std::size_t lines    = 0; ///< Number of lines, including comments
+  std::size_t edges    = 0; ///< Number of edges in the file, including duplicates
+  std::size_t vertices = 0; ///< Number of distinct vertices
+  std::size_t chunks   = 0; ///< Number of chunks that were parsed in parallel
+
+  double parseTime = 0.0; ///< Time for parsing the file and interning labels, in seconds
+  double buildTime = 0.0; ///< Time for sorting and building the output, in seconds
+
+  double totalTime() const noexcept
+  {
+    return parseTime + buildTime;
+  }
+
+  /** @returns Number of megabytes processed per second */
+  double megabytesPerSecond() const noexcept
+  {
+    return totalTime() > 0.0 ? static_cast<double>( bytes ) / ( 1024.0 * 1024.0 ) / totalTime() : 0.0;
+  }
+
+  /** @returns Number of edges processed per second */
+  double edgesPerSecond() const noexcept
+  {
+    return totalTime() > 0.0 ? static_cast<double>( edges ) / totalTime() : 0.0;
+  }
+};
+
+inline std::ostream& operator<<( std::ostream& o, const EdgeListStatistics& s )
+{
+  o << s.bytes << " bytes, "
+    << s.lines << " lines, "
+    << s.edges << " edges, "
+    << s.vertices << " vertices in "
+    << s.chunks << " chunks; "
+    << "parsing: " << s.parseTime << "s, "
+    << "building: " << s.buildTime << "s, "
+    << s.megabytesPerSecond() << " MiB/s, "
+    << s.edgesPerSecond() << " edges/s";
+
+  return o;
+}
+
+namespace detail
+{
+
+/** FNV-1a hash of a label */
+struct LabelHash
+{
+  std::size_t operator()( aleph::utilities::StringView label ) const noexcept
+  {
+    std::uint64_t hash = 14695981039346656037ull;
+
+    for( char c : label )
+    {
+      hash ^= static_cast<unsigned char>( c );
+      hash *= 1099511628211ull;
+    }
+
+    return static_cast<std::size_t>( hash );
+  }
+};
+
+/**
+  @class LabelTable
+  @brief Concurrent table for interning vertex labels
+
+  Labels are distributed over a fixed number of shards, each of which is
+  protected by its own lock, so threads rarely have to wait for each
+  other. Labels are not copied; they refer to the memory-mapped file.
+
+  Every label remembers the position of its first occurrence in the file.
+  Identifiers are assigned in that order once all chunks have been parsed,
+  which makes them independent of the scheduling of threads, and equal to
+  the identifiers assigned by a sequential reader.
+*/
+
+class LabelTable
+{
+public:
+  struct Entry
+  {
+    std::size_t offset;
+    std::size_t id;
+  };
+
+  explicit LabelTable( std::size_t numShards = 256 )
+    : _shards( new Shard[numShards] )
+    , _numShards( numShards )
+  {
+  }
+
+  /**
+    Interns a label and returns its entry. The entry remains valid for the
+    lifetime of the table, even if other threads insert labels.
+  */
+
+  Entry* intern( aleph::utilities::StringView label, std::size_t offset )
+  {
+    auto&& shard = _shards[ ( LabelHash()( label ) >> 8 ) % _numShards ];
+
+    std::lock_guard<std::mutex> lock( shard.mutex );
+
+    auto result = shard.labels.emplace( label, Entry{ offset, 0 } );
+
+    if( !result.second )
+      result.first->second.offset = std::min( result.first->second.offset, offset );
+
+    return &result.first->second;
+  }
+
+  /**
+    Assigns identifiers to all labels in the order of their first
+    occurrence and returns the labels, indexed by their identifiers.
+  */
+
+  std::vector<std::string> assignIdentifiers()
+  {
+    std::vector< std::pair<aleph::utilities::StringView, Entry*> > entries;
+
+    for( std::size_t i = 0; i < _numShards; i++ )
+      for( auto&& pair : _shards[i].labels )
+        entries.push_back( std::make_pair( pair.first, &pair.second ) );
+
+    std::sort( entries.begin(), entries.end(),
+               [] ( const std::pair<aleph::utilities::StringView, Entry*>& a,
+                    const std::pair<aleph::utilities::StringView, Entry*>& b )
+               {
+                 return a.second->offset < b.second->offset;
+               } );
+
+    std::vector<std::string> labels;
+    labels.reserve( entries.size() );
+
+    for( auto&& pair : entries )
+    {
+      pair.second->id = labels.size();
+      labels.push_back( pair.first.str() );
+    }
+
+    return labels;
+  }
+
+private:
+  struct Shard
+  {
+    std::mutex mutex;
+    std::unordered_map<aleph::utilities::StringView, Entry, LabelHash> labels;
+  };
+
+  std::unique_ptr<Shard[]> _shards;
+  std::size_t _numShards;
+};
+
+/** Edges, and their labels, of a single chunk of the file */
+template <class Vertex, class Weight> struct EdgeListChunk
+{
+  std::vector<Vertex> vertices;              // Numeric identifiers; two per edge
+  std::vector<LabelTable::Entry*> labels;    // Interned labels; two per edge
+  std::vector<Weight> weights;               // One per edge
+
+  std::size_t lines = 0;
+  std::exception_ptr error;
+};
+
+/**
+  Sort key of a simplex of an edge list. Vertices are stored in
+  descending order, so sorting the keys results in the lexicographical
+  order of the corresponding simplices.
+*/
+
+template <class Vertex, class Weight> struct EdgeListKey
+{
+  Vertex a;
+  Vertex b;
+  bool   edge;
+  Weight w;
+
+  bool operator<( const EdgeListKey& other ) const noexcept
+  {
+    if( a != other.a )
+      return a < other.a;
+    else if( edge != other.edge )
+      return other.edge;
+    else
+      return b < other.b;
+  }
+
+  bool operator==( const EdgeListKey& other ) const noexcept
+  {
+    return a == other.a && edge == other.edge && b == other.b;
+  }
+};
+
+/**
+  Merges sorted runs in parallel, one pair of runs at a time, and returns
+  the result. Merging is stable: of two equal elements, the one stemming
+  from the earlier run is sorted first.
+*/
+
+template <class T> std::vector<T> mergeRuns( std::vector< std::vector<T> > runs )
+{
+  if( runs.empty() )
+    return {};
+
+  while( runs.size() > 1 )
+  {
+    std::vector< std::vector<T> > merged( ( runs.size() + 1 ) / 2 );
+
+    #pragma omp parallel for schedule(dynamic)
+    for( std::size_t i = 0; i < merged.size(); i++ )
+    {
+      if( 2*i + 1 < runs.size() )
+      {
+        auto&& left  = runs[2*i];
+        auto&& right = runs[2*i+1];
+
+        merged[i].resize( left.size() + right.size() );
+
+        std::merge( left.begin(), left.end(),
+                    right.begin(), right.end(),
+                    merged[i].begin() );
+
+        std::vector<T>().swap( left );
+        std::vector<T>().swap( right );
+      }
+      else
+        merged[i].swap( runs[2*i] );
+    }
+
+    runs.swap( merged );
+  }
+
+  return std::move( runs.front() );
+}
+
+} // namespace detail
+
+/**
+  @class ParallelEdgeListReader
+  @brief Reads large edge lists in parallel
+
+  This reader understands the same format as EdgeListReader, i.e. every
+  line contains two vertices and an optional weight, but it is meant for
+  graphs with billions of edges. The file is mapped into memory and split
+  into chunks of lines, which are parsed in parallel. Vertex labels are
+  interned in a concurrent table without copying them.
+
+  The reader either creates a sorted array of simplices, from which a
+  simplicial complex can be created directly, or a weighted graph in
+  compressed sparse row format, which requires much less memory.
+
+  In contrast to EdgeListReader, the kind of vertex identifiers is fixed
+  by the first edge of the file: if its first vertex is a number, all
+  vertices need to be numbers; else, all vertices are treated as labels,
+  which are numbered in the order of their first occurrence.
+
+  Statistics about the last file, including its throughput, are
+  available via statistics().
+*/
+
+class ParallelEdgeListReader
+{
+public:
+
+  bool readWeights()     const noexcept { return _readWeights; }
+  bool trimLines()       const noexcept { return _trimLines;   }
+  std::size_t chunkSize() const noexcept { return _chunkSize;   }
+
+  void setReadWeights( bool value = true ) noexcept { _readWeights = value; }
+  void setTrimLines( bool value = true )   noexcept { _trimLines = value; }
+
+  /**
+    Sets the approximate size of a chunk in bytes. Chunks are extended to
+    the end of their last line.
+  */
+
+  void setChunkSize( std::size_t value ) noexcept { _chunkSize = std::max( value, std::size_t(1) ); }
+
+  /** @returns Statistics about the last file */
+  const EdgeListStatistics& statistics() const noexcept { return _statistics; }
+
+  /**
+    @returns Labels of the last file, indexed by vertex identifier. This is
+    empty if the file uses numeric identifiers.
+  */
+
+  const std::vector<std::string>& labels() const noexcept { return _labels; }
+
+  /** Reads a simplicial complex, which is equal to the one of EdgeListReader */
+  template <class SimplicialComplex> void operator()( const std::string& filename, SimplicialComplex& K )
+  {
+    using Simplex = typename SimplicialComplex::ValueType;
+
+    auto simplices = this->readSimplices<Simplex>( filename );
+
+    utilities::Timer timer;
+    K = SimplicialComplex( simplices.begin(), simplices.end() );
+
+    _statistics.buildTime += timer.elapsed_s();
+  }
+
+  /**
+    Reads all simplices of an edge list, i.e. its vertices and edges. The
+    simplices are sorted lexicographically and free of duplicates. Of all
+    duplicate edges, the first one determines the weight. Self-loops are
+    ignored.
+  */
+
+  template <class Simplex> std::vector<Simplex> readSimplices( const std::string& filename )
+  {
+    using DataType   = typename Simplex::DataType;
+    using VertexType = typename Simplex::VertexType;
+    using Key        = detail::EdgeListKey<VertexType, DataType>;
+
+    auto chunks = this->parseFile<VertexType, DataType>( filename );
+
+    utilities::Timer timer;
+
+    auto keys = this->sortSimplices<VertexType, DataType>( chunks, true );
+
+    std::vector<Simplex> simplices( keys.size() );
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < keys.size(); i++ )
+    {
+      Key& key = keys[i];
+
+      if( key.edge )
+        simplices[i] = Simplex( { key.a, key.b }, key.w );
+      else
+        simplices[i] = Simplex( key.a );
+    }
+
+    _statistics.vertices = static_cast<std::size_t>(
+      std::count_if( keys.begin(), keys.end(), [] ( const Key& key ) { return !key.edge; } ) );
+
+    _statistics.buildTime = timer.elapsed_s();
+    return simplices;
+  }
+
+  /**
+    Reads a weighted graph. Duplicate edges and self-loops are handled as
+    for readSimplices(). For numeric identifiers, the graph contains all
+    vertices up to the largest identifier, some of which may be isolated.
+  */
+
+  template <class Vertex, class Weight> WeightedGraph<Vertex, Weight> readGraph( const std::string& filename )
+  {
+    auto chunks = this->parseFile<Vertex, Weight>( filename );
+
+    utilities::Timer timer;
+
+    std::size_t n = _labels.size();
+
+    if( _labels.empty() )
+    {
+      for( auto&& chunk : chunks )
+        for( auto&& v : chunk.vertices )
+          n = std::max( n, std::size_t(v) + 1 );
+    }
+
+    auto keys = this->sortSimplices<Vertex, Weight>( chunks, false );
+
+    // Count degrees -------------------------------------------------
+
+    std::vector<std::size_t> offsets( n + 1, 0 );
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < keys.size(); i++ )
+    {
+      #pragma omp atomic
+      offsets[ std::size_t( keys[i].a ) + 1 ]++;
+
+      #pragma omp atomic
+      offsets[ std::size_t( keys[i].b ) + 1 ]++;
+    }
+
+    for( std::size_t u = 0; u < n; u++ )
+      offsets[u+1] += offsets[u];
+
+    // Distribute edges ----------------------------------------------
+
+    std::vector<std::size_t> cursors( offsets.begin(), offsets.end() - 1 );
+    std::vector<Vertex> targets( offsets.back() );
+    std::vector<Weight> weights( offsets.back() );
+
+    #pragma omp parallel for
+    for( std::size_t i = 0; i < keys.size(); i++ )
+    {
+      auto&& key    = keys[i];
+      std::size_t j = 0;
+      std::size_t k = 0;
+
+      #pragma omp atomic capture
+      j = cursors[ std::size_t( key.a ) ]++;
+
+      #pragma omp atomic capture
+      k = cursors[ std::size_t( key.b ) ]++;
+
+      targets[j] = key.b;
+      weights[j] = key.w;
+      targets[k] = key.a;
+      weights[k] = key.w;
+    }
+
+    std::vector<detail::EdgeListKey<Vertex, Weight> >().swap( keys );
+
+    // Sequentially, the edges are already distributed in the proper
+    // order, but parallel threads may interleave them.
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( std::size_t u = 0; u < n; u++ )
+    {
+      auto begin = targets.begin() + static_cast<std::ptrdiff_t>( offsets[u] );
+      auto end   = targets.begin() + static_cast<std::ptrdiff_t>( offsets[u+1] );
+
+      if( std::is_sorted( begin, end ) )
+        continue;
+
+      std::vector< std::pair<Vertex, Weight> > neighbours;
+      neighbours.reserve( offsets[u+1] - offsets[u] );
+
+      for( std::size_t j = offsets[u]; j < offsets[u+1]; j++ )
+        neighbours.push_back( std::make_pair( targets[j], weights[j] ) );
+
+      std::sort( neighbours.begin(), neighbours.end() );
+
+      for( std::size_t j = offsets[u]; j < offsets[u+1]; j++ )
+      {
+        targets[j] = neighbours[ j - offsets[u] ].first;
+        weights[j] = neighbours[ j - offsets[u] ].second;
+      }
+    }
+
+    _statistics.vertices  = n;
+    _statistics.buildTime = timer.elapsed_s();
+
+    return WeightedGraph<Vertex, Weight>( std::move( offsets ),
+                                          std::move( targets ),
+                                          std::move( weights ) );
+  }
+
+private:
+
+  /**
+    Parses the file in chunks and returns all edges per chunk. If labels
+    are used, they are resolved to their identifiers, which are stored as
+    numeric identifiers of the chunk.
+  */
+
+  template <class Vertex, class Weight>
+  std::vector< detail::EdgeListChunk<Vertex, Weight> > parseFile( const std::string& filename )
+  {
+    using namespace utilities;
+
+    utilities::Timer timer;
+
+    _statistics = EdgeListStatistics();
+    _labels.clear();
+
+    MemoryMappedFile file( filename );
+    file.adviseSequential();
+
+    auto data = file.data();
+    auto size = file.size();
+
+    // Chunk boundaries ----------------------------------------------
+
+    std::vector<std::size_t> boundaries( 1, 0 );
+
+    for( std::size_t position = _chunkSize; position < size; position += _chunkSize )
+    {
+      position = std::max( position, boundaries.back() );
+
+      auto newline = static_cast<const char*>( std::memchr( data + position, '\n', size - position ) );
+      if( !newline )
+        break;
+
+      position = static_cast<std::size_t>( newline - data ) + 1;
+
+      if( position < size )
+        boundaries.push_back( position );
+    }
+
+    boundaries.push_back( size );
+
+    std::size_t numChunks = boundaries.size() - 1;
+    bool useLabels        = this->usesLabels( data, size );
+
+    std::vector< detail::EdgeListChunk<Vertex, Weight> > chunks( numChunks );
+    detail::LabelTable table;
+
+    // Parse chunks --------------------------------------------------
+
+    #pragma omp parallel for schedule(dynamic)
+    for( std::size_t i = 0; i < numChunks; i++ )
+    {
+      try
+      {
+        this->parseChunk( data, boundaries[i], boundaries[i+1], useLabels, table, chunks[i] );
+      }
+      catch( ... )
+      {
+        chunks[i].error = std::current_exception();
+      }
+    }
+
+    for( auto&& chunk : chunks )
+      if( chunk.error )
+        std::rethrow_exception( chunk.error );
+
+    // Resolve labels ------------------------------------------------
+
+    if( useLabels )
+    {
+      _labels = table.assignIdentifiers();
+
+      #pragma omp parallel for schedule(dynamic)
+      for( std::size_t i = 0; i < numChunks; i++ )
+      {
+        auto&& chunk = chunks[i];
+
+        chunk.vertices.resize( chunk.labels.size() );
+
+        for( std::size_t j = 0; j < chunk.labels.size(); j++ )
+          chunk.vertices[j] = static_cast<Vertex>( chunk.labels[j]->id );
+
+        std::vector<detail::LabelTable::Entry*>().swap( chunk.labels );
+      }
+    }
+
+    _statistics.bytes  = size;
+    _statistics.chunks = numChunks;
+
+    for( auto&& chunk : chunks )
+    {
+      _statistics.lines += chunk.lines;
+      _statistics.edges += chunk.weights.size();
+    }
+
+    _statistics.parseTime = timer.elapsed_s();
+    return chunks;
+  }
+
+  /** Checks whether a line is empty or a comment; trims it if required */
+  bool skipLine( utilities::StringView& line ) const
+  {
+    if( _trimLines )
+      line = utilities::trim( line );
+
+    return line.empty() || std::find( _commentTokens.begin(), _commentTokens.end(), line.front() ) != _commentTokens.end();
+  }
+
+  /** Checks whether the first edge of a file uses labels or numbers */
+  bool usesLabels( const char* data, std::size_t size ) const
+  {
+    utilities::Tokenizer tokenizer;
+
+    for( std::size_t position = 0; position < size; )
+    {
+      auto newline = static_cast<const char*>( std::memchr( data + position, '\n', size - position ) );
+      auto end     = newline ? static_cast<std::size_t>( newline - data ) : size;
+
+      utilities::StringView line( data + position, end - position );
+      position = end + 1;
+
+      if( this->skipLine( line ) )
+        continue;
+
+      auto&& tokens = tokenizer( line );
+
+      if( tokens.size() >= 2 )
+        return !std::all_of( tokens[0].begin(), tokens[0].end(), [] ( char c ) { return c >= '0' && c <= '9'; } );
+    }
+
+    return false;
+  }
+
+  template <class Vertex, class Weight> void parseChunk( const char* data,
+                                                         std::size_t begin, std::size_t end,
+                                                         bool useLabels,
+                                                         detail::LabelTable& table,
+                                                         detail::EdgeListChunk<Vertex, Weight>& chunk ) const
+  {
+    using namespace utilities;
+
+    Tokenizer tokenizer;
+
+    // Most labels occur more than once per chunk, so a local cache avoids
+    // locking the shared table most of the time.
+    std::unordered_map<StringView, detail::LabelTable::Entry*, detail::LabelHash> cache;
+
+    auto intern = [&] ( StringView label )
+    {
+      auto it = cache.find( label );
+      if( it != cache.end() )
+        return it->second;
+
+      auto entry = table.intern( label, static_cast<std::size_t>( label.data() - data ) );
+      cache.emplace( label, entry );
+
+      return entry;
+    };
+
+    for( std::size_t position = begin; position < end; )
+    {
+      auto newline = static_cast<const char*>( std::memchr( data + position, '\n', end - position ) );
+      auto last    = newline ? static_cast<std::size_t>( newline - data ) : end;
+
+      StringView line( data + position, last - position );
+      position = last + 1;
+
+      ++chunk.lines;
+
+      if( this->skipLine( line ) )
+        continue;
+
+      auto&& tokens = tokenizer( line );
+
+      if( tokens.size() < 2 )
+        continue;
+
+      if( useLabels )
+      {
+        chunk.labels.push_back( intern( tokens[0] ) );
+        chunk.labels.push_back( intern( tokens[1] ) );
+      }
+      else
+      {
+        Vertex u = Vertex();
+        Vertex v = Vertex();
+
+        if( !parse( tokens[0], u ) || !parse( tokens[1], v ) )
+          throw std::runtime_error( "Unable to parse numeric vertex identifier" );
+
+        chunk.vertices.push_back( u );
+        chunk.vertices.push_back( v );
+      }
+
+      Weight w = Weight();
+      if( tokens.size() >= 3 && _readWeights )
+        w = parse<Weight>( tokens[2] );
+
+      chunk.weights.push_back( w );
+    }
+  }
+
+  /**
+    Sorts the simplices of all chunks and removes duplicates. Each chunk is
+    sorted separately before merging all chunks, which keeps the first of
+    all duplicate edges.
+  */
+
+  template <class Vertex, class Weight>
+  std::vector< detail::EdgeListKey<Vertex, Weight> > sortSimplices( std::vector< detail::EdgeListChunk<Vertex, Weight> >& chunks,
+                                                                    bool includeVertices ) const
+  {
+    using Key = detail::EdgeListKey<Vertex, Weight>;
+
+    std::vector< std::vector<Key> > runs( chunks.size() );
+
+    #pragma omp parallel for schedule(dynamic)
+    for( std::size_t i = 0; i < chunks.size(); i++ )
+    {
+      auto&& chunk = chunks[i];
+      auto&& keys  = runs[i];
+
+      keys.reserve( chunk.weights.size() * ( includeVertices ? 3 : 1 ) );
+
+      for( std::size_t j = 0; j < chunk.weights.size(); j++ )
+      {
+        auto u = chunk.vertices[2*j];
+        auto v = chunk.vertices[2*j+1];
+
+        if( includeVertices )
+        {
+          keys.push_back( Key{ u, u, false, Weight() } );
+          keys.push_back( Key{ v, v, false, Weight() } );
+        }
+
+        if( u != v )
+          keys.push_back( Key{ std::max(u,v), std::min(u,v), true, chunk.weights[j] } );
+      }
+
+      std::vector<Vertex>().swap( chunk.vertices );
+      std::vector<Weight>().swap( chunk.weights );
+
+      std::stable_sort( keys.begin(), keys.end() );
+      keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+    }
+
+    auto keys = detail::mergeRuns( std::move( runs ) );
+    keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+
+    return keys;
+  }
+
+  std::vector<char> _commentTokens = { '#', '%', '\"', '*' };
+  std::vector<std::string> _labels;
+
+  EdgeListStatistics _statistics;
+
+  std::size_t _chunkSize = 8 * 1024 * 1024;
+
+  bool _readWeights = true;
+  bool _trimLines   = true;
+};
+
+} // namespace io
+
+} // namespace topology
+
+} // namespace aleph
+
+#endif
@@ -229,17 +229,18 @@ private:
       throw std::runtime_error( "Unable to read input adjacency matrix file" );
 
     std::string line;
+    aleph::utilities::Tokenizer tokenizer( _separator + " \t\r" );
 
     while( std::getline( in, line ) )
     {
       using namespace aleph::utilities;
 
-      auto tokens = split( line, _separator );
+      auto&& tokens = tokenizer( line );
 
       if( tokens.size() == 2 )
       {
-        auto u = convert<VertexType>( tokens.front() );
-        auto v = convert<VertexType>( tokens.back()  );
+        auto u = parse<VertexType>( tokens.front() );
+        auto v = parse<VertexType>( tokens.back()  );
 
         edges.push_back( std::make_pair(u, v) );
 
@@ -274,7 +275,7 @@ private:
       using namespace aleph::utilities;
       line = trim( line );
 
-      auto graphID                    = convert<VertexType>( line );
+      auto graphID                    = parse<VertexType>( line );
       node_id_to_graph_id[ nodeID++ ] = graphID;
 
       graphIDs.insert( graphID );
@@ -324,20 +325,21 @@ private:
     std::vector< std::vector<double> > allAttributes;
 
     std::string line;
+    aleph::utilities::Tokenizer tokenizer( _separator + " \t\r" );
+
     while( std::getline( in, line ) )
     {
       using namespace aleph::utilities;
 
-      if( _trimLines )
-        line = trim( line );
-
-      auto tokens = split( line, _separator );
+      auto&& tokens = tokenizer( line );
 
       std::vector<double> attributes;
+      attributes.reserve( tokens.size() );
+
       std::transform( tokens.begin(), tokens.end(), std::back_inserter( attributes ),
-        [] ( const std::string& token )
+        [] ( StringView token )
         {
-          return convert<double>( token );
+          return parse<double>( token );
         }
       );
 
@@ -1,16 +1,28 @@
 #ifndef ALEPH_TOPOLOGY_IO_VTK_HH__
 #define ALEPH_TOPOLOGY_IO_VTK_HH__
 
+#include <cctype>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 #include <algorithm>
 #include <fstream>
-#include <regex>
+#include <iterator>
+#include <limits>
+#include <ostream>
 #include <stdexcept>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include <aleph/topology/StructuredGrid.hh>
+
+#include <aleph/topology/io/VertexProperties.hh>
+
+#include <aleph/utilities/MemoryMappedFile.hh>
 #include <aleph/utilities/String.hh>
 
 namespace aleph
@@ -22,6 +34,44 @@ namespace topology
 namespace io
 {
 
+namespace detail
+{
+
+/**
+  Decodes a big-endian value, as used by binary VTK files in 'legacy
+  format', independently of the byte order of the machine.
+*/
+
+template <class T> T fromBigEndian( const char* bytes ) noexcept
+{
+  using Unsigned = typename std::conditional<sizeof(T) == 1, std::uint8_t,
+                   typename std::conditional<sizeof(T) == 2, std::uint16_t,
+                   typename std::conditional<sizeof(T) == 4, std::uint32_t,
+                                                             std::uint64_t>::type>::type>::type;
+
+  static_assert( sizeof(T) == sizeof(Unsigned), "Unsupported type size" );
+
+  Unsigned u = 0;
+
+  for( std::size_t i = 0; i < sizeof(T); i++ )
+    u = static_cast<Unsigned>( ( std::uint64_t( u ) << 8 ) | static_cast<unsigned char>( bytes[i] ) );
+
+  T value;
+  std::memcpy( &value, &u, sizeof(T) );
+
+  return value;
+}
+
+/** Decodes a range of big-endian values and converts them */
+template <class S, class T> void decodeBigEndian( const char* bytes, std::size_t n, T* values )
+{
+  #pragma omp parallel for
+  for( std::size_t i = 0; i < n; i++ )
+    values[i] = static_cast<T>( fromBigEndian<S>( bytes + i * sizeof(S) ) );
+}
+
+} // namespace detail
+
 /**
   @class VTKStructuredGridReader
   @brief Simple reader class for VTK structured grids
@@ -30,6 +80,15 @@ namespace io
   capable of parsing a structured grid and converting it to a simplicial
   complex. Data and weights of the simplicial complex will be taken from
   the VTK file.
+
+  Both ASCII and binary files are supported; binary files store their
+  values in big-endian byte order. Files are memory-mapped, so coordinates
+  and other attributes are skipped without being read. Besides structured
+  grids, structured points are supported as well.
+
+  The scalar grid may also be read without converting it to a simplicial
+  complex. In this case, it is passed to a consumer in slabs, which can be
+  fed to one of the grid engines, e.g. FreudenthalTriangulation.
 */
 
 class VTKStructuredGridReader
@@ -45,11 +104,10 @@ public:
 
   template <class SimplicialComplex, class Functor> void operator()( const std::string& filename, SimplicialComplex& K, Functor f )
   {
-    std::ifstream in( filename );
-    if( !in )
-      throw std::runtime_error( "Unable to read input file" );
+    utilities::MemoryMappedFile file( filename );
+    file.adviseSequential();
 
-    this->operator()( in, K, f );
+    this->createComplex( file.begin(), file.end(), K, f );
   }
 
   template <class SimplicialComplex> void operator()( std::ifstream& in, SimplicialComplex& K )
@@ -62,325 +120,666 @@ public:
 
   template <class SimplicialComplex, class Functor> void operator()( std::ifstream& in, SimplicialComplex& K, Functor f )
   {
-    using namespace aleph::utilities;
+    std::string contents( ( std::istreambuf_iterator<char>( in ) ),
+                            std::istreambuf_iterator<char>() );
+
+    this->createComplex( contents.data(), contents.data() + contents.size(), K, f );
+  }
+
+  /**
+    Reads the scalar grid of a file without creating a simplicial complex
+    and passes it to the consumer in slabs. The slabs are stored in the
+    order of the file, so the grid has dimensions (z, y, x).
+  */
 
+  template <class T, class Consumer> void read( const std::string& filename, Consumer consumer )
+  {
+    utilities::MemoryMappedFile file( filename );
+    file.adviseSequential();
+
+    this->parseFile<T>( file.begin(), file.end(), consumer );
+  }
+
+  /** Reads the complete scalar grid of a file */
+  template <class T> GridSlab<T> readGrid( const std::string& filename )
+  {
+    GridSlab<T> grid;
+
+    this->read<T>( filename, [&grid] ( const GridSlab<T>& slab )
+    {
+      if( slab.offset == 0 )
+      {
+        grid.dimensions = slab.dimensions;
+        grid.values.reserve( slab.dimensions.front() * slab.layerSize() );
+      }
+
+      grid.layers += slab.layers;
+      grid.values.insert( grid.values.end(), slab.values.begin(), slab.values.end() );
+    } );
+
+    return grid;
+  }
+
+  /**
+    Sets the name of the scalar field to read. By default, the first scalar
+    field of the point data is used.
+  */
+
+  void setScalarName( const std::string& name ) { _scalarName = name; }
+
+  /** Sets the approximate number of values per slab */
+  void setSlabSize( std::size_t size ) noexcept { _slabSize = size; }
+
+  std::string scalarName() const noexcept { return _scalarName; }
+  std::size_t slabSize() const noexcept   { return _slabSize;   }
+
+private:
+
+  /**
+    Creates the 1-skeleton of the grid, i.e. its vertices and the edges
+    between neighbouring vertices. While it is possible to include squares
+    or triangles, their creation order is not clear and may subtly
+    influence calculations.
+  */
+
+  template <class SimplicialComplex, class Functor> void createComplex( const char* begin, const char* end, SimplicialComplex& K, Functor f )
+  {
     using Simplex    = typename SimplicialComplex::ValueType;
     using DataType   = typename Simplex::DataType;
     using VertexType = typename Simplex::VertexType;
 
-    std::string line;
+    CubicalGridFiltration<DataType> filtration;
+    filtration.setMaxDimension( 1 );
 
-    // Parse header first ----------------------------------------------
+    std::vector<Simplex> simplices;
+    std::vector< GridCube<DataType> > cubes;
 
-    std::size_t nx, ny, nz,
-                n,
-                s;
+    this->parseFile<DataType>( begin, end, [&] ( const GridSlab<DataType>& slab )
+    {
+      if( slab.offset == 0 )
+        simplices.reserve( slab.dimensions.size() * slab.dimensions.front() * slab.layerSize() );
 
-    bool parsedHeader = this->parseHeader( in, nx, ny, nz, n, s );
-    if( !parsedHeader )
-      return;
+      cubes.clear();
+      filtration( slab, std::back_inserter( cubes ), f );
 
-    // TODO: Check data type size against 's' and report if there are
-    // issues such as insufficient storage space
+      // Strides of the dimensions of the grid, ordered like the bits of
+      // the directions of a cube.
+      std::vector<std::size_t> strides( slab.dimensions.size(), 1 );
 
-    // Parse body ------------------------------------------------------
-    //
-    // The body contains coordinates for each of the points, which are
-    // dutifully ignored for now, and attributes. For now, point-based
-    // attributes are supported.
+      for( std::size_t d = slab.dimensions.size() - 1; d > 0; d-- )
+        strides[d-1] = strides[d] * slab.dimensions[d];
+
+      for( auto&& cube : cubes )
+      {
+        auto u = static_cast<VertexType>( cube.anchor );
+
+        if( cube.directions == 0 )
+          simplices.push_back( Simplex( u, cube.value ) );
+        else
+        {
+          std::size_t d = 0;
+          while( ( cube.directions & ( 1u << d ) ) == 0 )
+            ++d;
+
+          auto v = static_cast<VertexType>( cube.anchor + strides[d] );
 
-    std::regex rePointData( "POINT_DATA[[:space:]]+([[:digit:]]+)" );
-    std::regex reScalars( "SCALARS[[:space:]]+([[:alnum:]]+)[[:space:]]+([[:alnum:]]+)[[:space:]]*([[:digit:]]*)" );
-    std::regex reLookupTable( "LOOKUP_TABLE[[:space:]]+([[:alnum:]]+)" );
+          simplices.push_back( Simplex( {u,v}, cube.value ) );
+        }
+      }
+    } );
 
-    std::vector<DataType> coordinates;
-    coordinates.reserve( n*3 );
+    K = SimplicialComplex( simplices.begin(), simplices.end() );
+  }
 
-    while( std::getline( in, line ) )
+  /** Value types of the legacy format */
+  enum class ValueType
+  {
+    Bit, Char, UnsignedChar, Short, UnsignedShort, Int, UnsignedInt,
+    Long, UnsignedLong, Int64, UnsignedInt64, Float, Double
+  };
+
+  static ValueType valueType( aleph::utilities::StringView name )
+  {
+    if( name == "bit" )            return ValueType::Bit;
+    if( name == "char" )           return ValueType::Char;
+    if( name == "unsigned_char" )  return ValueType::UnsignedChar;
+    if( name == "short" )          return ValueType::Short;
+    if( name == "unsigned_short" ) return ValueType::UnsignedShort;
+    if( name == "int" )            return ValueType::Int;
+    if( name == "unsigned_int" )   return ValueType::UnsignedInt;
+    if( name == "long" )           return ValueType::Long;
+    if( name == "unsigned_long" )  return ValueType::UnsignedLong;
+    if( name == "vtktypeint64" )   return ValueType::Int64;
+    if( name == "vtktypeuint64" )  return ValueType::UnsignedInt64;
+    if( name == "float" )          return ValueType::Float;
+    if( name == "double" )         return ValueType::Double;
+
+    throw std::runtime_error( "Unknown data type" );
+  }
+
+  /**
+    @returns Number of bytes of a value in a binary file. The size of
+    values of type 'long' depends on the machine that wrote the file, so
+    they are not supported.
+  */
+
+  static std::size_t valueSize( ValueType type )
+  {
+    switch( type )
     {
-      line         = trim( line );
-      auto strings = split( line );
+    case ValueType::Char:
+    case ValueType::UnsignedChar:
+      return 1;
+    case ValueType::Short:
+    case ValueType::UnsignedShort:
+      return 2;
+    case ValueType::Int:
+    case ValueType::UnsignedInt:
+    case ValueType::Float:
+      return 4;
+    case ValueType::Int64:
+    case ValueType::UnsignedInt64:
+    case ValueType::Double:
+      return 8;
+    case ValueType::Bit:
+    case ValueType::Long:
+    case ValueType::UnsignedLong:
+      break;
+    }
 
-      for( auto&& coordinate : strings )
-        coordinates.push_back( convert<DataType>( coordinate ) );
+    throw std::runtime_error( "Data type is not supported in binary files" );
+  }
 
-      if( coordinates.size() == n*3 )
-        break;
+  /** Sequential access to the contents of a file */
+  struct Cursor
+  {
+    const char* it;
+    const char* end;
+
+    /** @returns Next non-empty line, without its line terminator */
+    aleph::utilities::StringView line()
+    {
+      while( it != end && std::isspace( static_cast<unsigned char>( *it ) ) )
+        ++it;
+
+      auto begin = it;
+
+      while( it != end && *it != '\n' )
+        ++it;
+
+      auto last = it;
+
+      if( it != end )
+        ++it;
+
+      return aleph::utilities::trim( aleph::utilities::StringView( begin, last ) );
+    }
+
+    /** @returns Next line, which may be empty, without its line terminator */
+    aleph::utilities::StringView rawLine()
+    {
+      auto begin = it;
+
+      while( it != end && *it != '\n' )
+        ++it;
+
+      auto last = it;
+
+      if( it != end )
+        ++it;
+
+      return aleph::utilities::trim( aleph::utilities::StringView( begin, last ) );
+    }
+
+    /** @returns Next whitespace-separated token */
+    aleph::utilities::StringView token()
+    {
+      while( it != end && std::isspace( static_cast<unsigned char>( *it ) ) )
+        ++it;
+
+      auto begin = it;
+
+      while( it != end && !std::isspace( static_cast<unsigned char>( *it ) ) )
+        ++it;
+
+      if( begin == it )
+        throw std::runtime_error( "Unexpected end of file" );
+
+      return aleph::utilities::StringView( begin, it );
+    }
+  };
+
+  /**
+    Skips an optional meta data block that follows an array, such as
+    component names or an information key. The block extends up to the
+    next empty line.
+
+    @returns true if a meta data block was skipped
+  */
+
+  static bool skipMetaData( Cursor& cursor )
+  {
+    auto position = cursor.it;
+
+    if( cursor.line() != "METADATA" )
+    {
+      cursor.it = position;
+      return false;
     }
 
-    std::vector<DataType> values;
-    values.reserve( n );
+    while( cursor.it != cursor.end && !cursor.rawLine().empty() )
+      ;
+
+    return true;
+  }
+
+  /** Skips a block of values, e.g. coordinates or unused attributes */
+  static void skipValues( Cursor& cursor, bool binary, ValueType type, std::size_t n )
+  {
+    if( binary )
+    {
+      auto bytes = n * valueSize( type );
+
+      if( static_cast<std::size_t>( cursor.end - cursor.it ) < bytes )
+        throw std::runtime_error( "Unexpected end of file" );
+
+      cursor.it += bytes;
+    }
+    else
+    {
+      for( std::size_t i = 0; i < n; i++ )
+        cursor.token();
+    }
+  }
 
+  /** Reads a block of values, converting them to the requested type */
+  template <class T> static void readValues( Cursor& cursor, bool binary, ValueType type, std::size_t n, T* values )
+  {
+    if( binary )
     {
-      std::smatch matches;
+      auto bytes = n * valueSize( type );
+
+      if( static_cast<std::size_t>( cursor.end - cursor.it ) < bytes )
+        throw std::runtime_error( "Unexpected end of file" );
 
-      while( std::getline( in, line ) )
+      switch( type )
       {
-        if( std::regex_match( line, matches, rePointData ) )
-        {
-          auto sn = matches[1];
-          if( static_cast<std::size_t>( std::stoull( sn ) ) != n )
-            throw std::runtime_error( "Format error: number of point data attributes does not match number of points" );
-        }
-        else if( std::regex_match( line, matches, reScalars ) )
-        {
-          auto name       = matches[1];
-          auto type       = matches[2];
-          auto components = matches[3];
-
-          // TODO:
-          //  - Use name
-          //  - Check type
-          //  - Check number of components (if present)
-
-          (void) name;
-          (void) type;
-          (void) components;
-        }
-        else if( std::regex_match( line, matches, reLookupTable ) )
-        {
-          auto name = matches[1];
-          if( name != "default" )
-            throw std::runtime_error( "Handling non-default lookup tables is not yet implemented" );
-        }
-        else
-        {
-          line         = trim( line );
-          auto strings = split( line );
+      case ValueType::Char:
+        detail::decodeBigEndian<std::int8_t>( cursor.it, n, values );
+        break;
+      case ValueType::UnsignedChar:
+        detail::decodeBigEndian<std::uint8_t>( cursor.it, n, values );
+        break;
+      case ValueType::Short:
+        detail::decodeBigEndian<std::int16_t>( cursor.it, n, values );
+        break;
+      case ValueType::UnsignedShort:
+        detail::decodeBigEndian<std::uint16_t>( cursor.it, n, values );
+        break;
+      case ValueType::Int:
+        detail::decodeBigEndian<std::int32_t>( cursor.it, n, values );
+        break;
+      case ValueType::UnsignedInt:
+        detail::decodeBigEndian<std::uint32_t>( cursor.it, n, values );
+        break;
+      case ValueType::Int64:
+        detail::decodeBigEndian<std::int64_t>( cursor.it, n, values );
+        break;
+      case ValueType::UnsignedInt64:
+        detail::decodeBigEndian<std::uint64_t>( cursor.it, n, values );
+        break;
+      case ValueType::Float:
+        detail::decodeBigEndian<float>( cursor.it, n, values );
+        break;
+      case ValueType::Double:
+        detail::decodeBigEndian<double>( cursor.it, n, values );
+        break;
+      case ValueType::Bit:
+      case ValueType::Long:
+      case ValueType::UnsignedLong:
+        break;
+      }
 
-          for( auto&& value : strings )
-            values.push_back( convert<DataType>( value ) );
-        }
+      cursor.it += bytes;
+    }
+    else
+    {
+      for( std::size_t i = 0; i < n; i++ )
+      {
+        auto token = cursor.token();
+        double value = 0.0;
+
+        if( aleph::utilities::fromChars( token.begin(), token.end(), value ) != token.end() )
+          throw std::runtime_error( "Unable to parse value" );
+
+        values[i] = static_cast<T>( value );
       }
     }
+  }
+
+  /**
+    Parses a file in 'legacy format' and passes the selected scalar field
+    to the consumer in slabs. Coordinates and all other attributes are
+    skipped.
+  */
+
+  template <class T, class Consumer> void parseFile( const char* begin, const char* end, Consumer consumer )
+  {
+    using namespace aleph::utilities;
 
-    // Create topology -------------------------------------------------
+    Cursor cursor = { begin, end };
+    Tokenizer tokenizer;
+
+    // Header ----------------------------------------------------------
     //
-    // Notice that this class only adds 0-simplices and 1-simplices to
-    // the simplicial complex for now. While it is possible to include
-    // triangles (i.e. 2-simplices), their creation order is not clear
-    // and may subtly influence calculations.
+    // The identifier is a little bit more lenient than the original
+    // documentation requires: it will also accept if some fields are
+    // joined by multiple spaces.
 
-    std::vector<Simplex> simplices;
+    {
+      auto&& tokens = tokenizer( cursor.line() );
 
-    // Create 0-simplices ----------------------------------------------
+      if(    tokens.size() != 5
+          || tokens[0] != "#" || tokens[1] != "vtk" || tokens[2] != "DataFile" || tokens[3] != "Version"
+          || !isVersion( tokens[4] ) )
+        throw std::runtime_error( "Format error: invalid identifier" );
+    }
+
+    // The title may be empty, so it must not be read by skipping empty
+    // lines first.
+    while( cursor.it != cursor.end && *cursor.it++ != '\n' )
+      ;
+
+    bool binary = false;
+
+    {
+      auto format = cursor.line();
+
+      if( format == "BINARY" )
+        binary = true;
+      else if( format != "ASCII" )
+        throw std::runtime_error( "Format error: unknown file format" );
+    }
 
     {
-      VertexType v = VertexType();
+      auto&& tokens = tokenizer( cursor.line() );
 
-      for( auto&& value : values )
-        simplices.push_back( Simplex(v++, value) );
+      if(    tokens.size() != 2 || tokens[0] != "DATASET"
+          || ( tokens[1] != "STRUCTURED_GRID" && tokens[1] != "STRUCTURED_POINTS" ) )
+        throw std::runtime_error( "Format error: expected structured grid" );
     }
 
-    // Create 1-simplices ----------------------------------------------
+    // Sections --------------------------------------------------------
+    //
+    // Keywords are processed until the selected scalar field has been
+    // found. Attributes are skipped unless they belong to the points.
+
+    std::vector<std::size_t> dimensions;
 
-    for( std::size_t z = 0; z < nz; z++ )
+    std::size_t n        = 0;
+    std::size_t numCells = 0;
+    bool pointData       = false;
+
+    while( cursor.it != cursor.end )
     {
-      for( std::size_t y = 0; y < ny; y++ )
+      auto&& tokens = tokenizer( cursor.line() );
+
+      if( tokens.empty() )
+        break;
+
+      auto&& keyword = tokens.front();
+
+      if( keyword == "DIMENSIONS" && tokens.size() == 4 )
+      {
+        std::size_t x = 0, y = 0, z = 0;
+
+        if( !parse( tokens[1], x ) || !parse( tokens[2], y ) || !parse( tokens[3], z ) )
+          throw std::runtime_error( "Format error: unable to parse dimensions" );
+
+        // Values are stored with x varying fastest
+        dimensions = { z, y, x };
+
+        n        = x * y * z;
+        numCells = std::max( x, std::size_t(2) ) - 1;
+        numCells = numCells * ( std::max( y, std::size_t(2) ) - 1 ) * ( std::max( z, std::size_t(2) ) - 1 );
+      }
+      else if( keyword == "POINTS" && tokens.size() == 3 )
+      {
+        std::size_t m = 0;
+        if( !parse( tokens[1], m ) || m != n )
+          throw std::runtime_error( "Format error: number of points does not match dimensions" );
+
+        skipValues( cursor, binary, valueType( tokens[2] ), 3*m );
+      }
+      else if( keyword == "ORIGIN" || keyword == "SPACING" || keyword == "ASPECT_RATIO" )
+        continue;
+      else if( keyword == "METADATA" && tokens.size() == 1 )
+      {
+        while( cursor.it != cursor.end && !cursor.rawLine().empty() )
+          ;
+      }
+      else if( keyword == "POINT_DATA" && tokens.size() == 2 )
+      {
+        std::size_t m = 0;
+        if( !parse( tokens[1], m ) || m != n )
+          throw std::runtime_error( "Format error: number of point data attributes does not match number of points" );
+
+        pointData = true;
+      }
+      else if( keyword == "CELL_DATA" && tokens.size() == 2 )
+        pointData = false;
+      else if( keyword == "SCALARS" && ( tokens.size() == 3 || tokens.size() == 4 ) )
       {
-        for( std::size_t x = 0; x < nx; x++ )
+        std::string name( tokens[1].begin(), tokens[1].end() );
+        auto type       = valueType( tokens[2] );
+        std::size_t m   = 1;
+
+        if( tokens.size() == 4 && ( !parse( tokens[3], m ) || m == 0 ) )
+          throw std::runtime_error( "Format error: unable to parse number of components" );
+
+        // The lookup table is optional
         {
-          auto i = coordinatesToIndex(nx,ny,x,y,z);
-          auto N = neighbours(nx,ny,nz,x,y,z);
+          auto position = cursor.it;
+          auto&& lookup = tokenizer( cursor.line() );
 
-          for( auto&& j : N )
-          {
-            if( j > i )
-              continue;
+          if( lookup.empty() || lookup.front() != "LOOKUP_TABLE" )
+            cursor.it = position;
+        }
 
-            auto wi = simplices.at(i).data();
-            auto wj = simplices.at(j).data();
+        if( pointData && ( _scalarName.empty() || name == _scalarName ) )
+        {
+          if( m != 1 )
+            throw std::runtime_error( "Scalar fields with multiple components are not supported" );
 
-            // Use the functor specified by the client in order to
-            // assign a weight for the new simplex.
-            auto w  = f(wi, wj);
+          this->readScalars<T>( cursor, binary, type, dimensions, consumer );
+          return;
+        }
 
-            simplices.push_back( Simplex( {i,j}, w ) );
-          }
+        skipValues( cursor, binary, type, m * ( pointData ? n : numCells ) );
+      }
+      else if( ( keyword == "VECTORS" || keyword == "NORMALS" ) && tokens.size() == 3 )
+        skipValues( cursor, binary, valueType( tokens[2] ), 3 * ( pointData ? n : numCells ) );
+      else if( keyword == "TENSORS" && tokens.size() == 3 )
+        skipValues( cursor, binary, valueType( tokens[2] ), 9 * ( pointData ? n : numCells ) );
+      else if( keyword == "FIELD" && tokens.size() == 3 )
+      {
+        std::size_t numArrays = 0;
+        if( !parse( tokens[2], numArrays ) )
+          throw std::runtime_error( "Format error: unable to parse number of arrays" );
+
+        for( std::size_t i = 0; i < numArrays; i++ )
+        {
+          auto&& array = tokenizer( cursor.line() );
+
+          std::size_t numComponents = 0;
+          std::size_t numTuples     = 0;
+
+          if( array.size() != 4 || !parse( array[1], numComponents ) || !parse( array[2], numTuples ) )
+            throw std::runtime_error( "Format error: unable to parse field array" );
+
+          skipValues( cursor, binary, valueType( array[3] ), numComponents * numTuples );
+          skipMetaData( cursor );
         }
       }
+      else
+        throw std::runtime_error( "Format error: unsupported section" );
     }
 
-    K = SimplicialComplex( simplices.begin(), simplices.end() );
+    throw std::runtime_error( "Format error: scalar field not found" );
   }
 
-private:
+  /** Reads the selected scalar field in slabs and passes them to the consumer */
+  template <class T, class Consumer> void readScalars( Cursor& cursor, bool binary, ValueType type,
+                                                       const std::vector<std::size_t>& dimensions,
+                                                       Consumer& consumer )
+  {
+    if( dimensions.empty() )
+      throw std::runtime_error( "Format error: missing dimensions" );
 
-  /**
-    Converts an index in the array of values to the corresponding set of
-    coordinates.
-  */
+    GridSlab<T> slab;
+    slab.dimensions = dimensions;
 
-  static void indexToCoordinates ( const std::size_t nx, const std::size_t ny,
-                                   const std::size_t i,
-                                   std::size_t& x,      // out: x
-                                   std::size_t& y,      // out: y
-                                   std::size_t& z )     // out: z
-  {
-    x = i % nx;
-    y = static_cast<std::size_t>( i / (nx)    ) % ny;
-    z = static_cast<std::size_t>( i / (nx*ny) );
-  };
+    auto layerSize     = std::max( slab.layerSize(), std::size_t(1) );
+    auto layersPerSlab = std::max( _slabSize / layerSize, std::size_t(1) );
 
-  /**
-    Converts x,y,z coordinates to the corresponding index in the array
-    of values.
-  */
+    for( std::size_t offset = 0; offset < dimensions.front(); offset += layersPerSlab )
+    {
+      slab.offset = offset;
+      slab.layers = std::min( layersPerSlab, dimensions.front() - offset );
 
-  static std::size_t coordinatesToIndex( const std::size_t nx, const std::size_t ny,
-                                         const std::size_t x , const std::size_t  y, const std::size_t z ) noexcept
+      slab.values.resize( slab.layers * layerSize );
+
+      readValues( cursor, binary, type, slab.values.size(), slab.values.data() );
+
+      consumer( static_cast<const GridSlab<T>&>( slab ) );
+    }
+  }
+
+  /** Checks whether a token is a version number of the form 'major.minor' */
+  static bool isVersion( aleph::utilities::StringView token ) noexcept
   {
-   return z * nx*ny + x % nx + y * nx;
+    auto dot = token.find( '.' );
+    if( dot == 0 || dot == std::string::npos || dot + 1 == token.size() )
+      return false;
+
+    for( std::size_t i = 0; i < token.size(); i++ )
+    {
+      if( i != dot && ( token[i] < '0' || token[i] > '9' ) )
+        return false;
+    }
+
+    return true;
   }
 
-  /**
-    Enumerates all valid neighbours of a vertex and returns their
-    indices. A valid neighbour is a neighbour whose index doesn't
-    exceed the bounds of the grid. At present, the diagonal isn't
-    used.
-  */
+  std::string _scalarName;
+  std::size_t _slabSize = std::size_t( 1 ) << 20;
+};
+
+/**
+  @class VTKPolyDataWriter
+  @brief Writes meshes as VTK poly data in 'legacy format'
+
+  The writer stores the vertices and faces of a mesh, followed by the data
+  of every vertex and an arbitrary number of additional per-vertex scalar
+  fields. This makes it possible to visualize e.g. segmentations of the
+  mesh. Every scalar field needs to be indexed like the vertices of the
+  mesh, i.e. in the order of `Mesh::vertices()`.
+*/
+
+class VTKPolyDataWriter
+{
+public:
 
-  static std::vector<std::size_t> neighbours( const std::size_t nx, const std::size_t ny, const std::size_t nz,
-                                              std::size_t x, std::size_t y, std::size_t z )
+  /** Sets the name of the scalar field that stores the data of every vertex */
+  void setDataName( const std::string& name )
   {
-    std::vector<std::size_t> neighbours;
-    neighbours.reserve( 6 );
-
-    // left
-    if( x > 0 )
-      neighbours.push_back( coordinatesToIndex(nx, ny, x-1, y, z) );
-    // right
-    if( x+1 < nx )
-      neighbours.push_back( coordinatesToIndex(nx, ny, x+1, y, z) );
-
-    // bottom
-    if( y > 0 )
-      neighbours.push_back( coordinatesToIndex(nx, ny, x, y-1, z) );
-    // top
-    if( y+1 < ny )
-      neighbours.push_back( coordinatesToIndex(nx, ny, x, y+1, z) );
-
-    // back
-    if( z > 0 )
-      neighbours.push_back( coordinatesToIndex(nx, ny, x, y, z-1) );
-    // front
-    if( z+1 < nz )
-      neighbours.push_back( coordinatesToIndex(nx, ny, x, y, z+1) );
-
-    return neighbours;
+    _name = name;
   }
 
   /**
-    Attempts parsing the header of a structured VTK file. If successful,
-    returns true and sets all output variables:
-
-    - x: x dimension
-    - y: y dimension
-    - z: z dimension
-    - n: number of data points
-
-    This function expects the header to conform to the VTK legacy file
-    format.
+    Adds a per-vertex scalar field. Integral values are stored as integers,
+    whereas all other values are stored as floating point numbers.
   */
 
-  bool parseHeader( std::ifstream& in,
-                    std::size_t& x, std::size_t& y, std::size_t& z,
-                    std::size_t& n,
-                    std::size_t& s )
+  template <class T> void addScalarField( const std::string& name, const std::vector<T>& values )
   {
-    using namespace aleph::utilities;
+    _fields.add( name, values );
+  }
 
-    std::string identifier; // e.g. '# vtk DataFile Version 3.0'
-    std::string header;     // e.g. 'VTK Output'
-    std::string format;     // e.g. 'ASCII'
-    std::string structure;  // e.g. 'DATASET STRUCTURED_GRID'
-    std::string dimensions; // e.g. 'DIMENSIONS 100 10 1'
-    std::string points;     // e.g. 'POINTS 1000 float'
+  template <class Mesh> void operator()( const std::string& filename, const Mesh& M )
+  {
+    std::ofstream out( filename );
+    if( !out )
+      throw std::runtime_error( "Unable to open output file" );
 
-    std::getline( in, identifier );
-    std::getline( in, header );
-    std::getline( in, format );
+    this->operator()( out, M );
+  }
 
-    if( !in )
-      return false;
+  template <class Mesh> void operator()( std::ostream& out, const Mesh& M )
+  {
+    auto&& vertices = M.vertices();
+    auto&& faces    = M.faces();
 
-    identifier = trim( identifier );
-    format     = trim( format );
+    if( !_fields.matches( vertices.size() ) )
+      throw std::runtime_error( "Number of field values does not match number of vertices" );
 
-    // This identifier is a little bit more lenient than the original
-    // documentation requires: it will also accept if some fields are
-    // joined by multiple spaces.
-    std::regex reIdentifier( "#[[:space:]]+vtk[[:space:]]+DataFile[[:space:]]+Version[[:space:]]+([[:digit:]]+)\\.([[:digit:]]+)" );
+    out.precision( std::numeric_limits<double>::max_digits10 );
 
-    if( !std::regex_match( identifier, reIdentifier ) )
-      return false;
+    out << "# vtk DataFile Version 3.0\n"
+        << "Aleph mesh\n"
+        << "ASCII\n"
+        << "DATASET POLYDATA\n"
+        << "POINTS " << vertices.size() << " double\n";
+
+    for( auto&& id : vertices )
+    {
+      auto&& p = M.position( id );
+      out << std::get<0>( p ) << " " << std::get<1>( p ) << " " << std::get<2>( p ) << "\n";
+    }
 
-    if( format != "ASCII" )
-      throw std::runtime_error( "Binary file parsing is not yet supported" );
+    std::size_t numIndices = 0;
+    for( auto&& face : faces )
+      numIndices += face.size() + 1;
 
-    std::getline( in, structure );
-    std::getline( in, dimensions );
-    std::getline( in, points );
+    out << "POLYGONS " << faces.size() << " " << numIndices << "\n";
 
-    if( !in )
-      return false;
+    for( auto&& face : faces )
+    {
+      out << face.size();
 
-    structure  = trim( structure );
-    dimensions = trim( dimensions );
-    points     = trim( points );
+      for( auto&& id : face )
+        out << " " << M.index( id );
 
-    std::regex reStructure( "DATASET[[:space:]]+STRUCTURED_GRID" );
-    if( !std::regex_match( structure, reStructure ) )
-      return false;
+      out << "\n";
+    }
 
-    std::regex reDimensions( "DIMENSIONS[[:space:]]+([[:digit:]]+)[[:space:]]+([[:digit:]]+)[[:space:]]+([[:digit:]]+)" );
-    std::smatch matches;
+    out << "POINT_DATA " << vertices.size() << "\n"
+        << "SCALARS " << _name << " double 1\n"
+        << "LOOKUP_TABLE default\n";
 
-    if( !std::regex_match( dimensions, matches, reDimensions ) )
-      return false;
+    for( auto&& id : vertices )
+      out << M.data( id ) << "\n";
 
-    auto sx = matches[1];
-    auto sy = matches[2];
-    auto sz = matches[3];
+    for( std::size_t j = 0; j < _fields.size(); j++ )
+    {
+      out << "SCALARS " << _fields.name( j ) << " " << _fields.type( j ) << " 1\n"
+          << "LOOKUP_TABLE default\n";
 
-    x = std::size_t( std::stoull( sx ) );
-    y = std::size_t( std::stoull( sy ) );
-    z = std::size_t( std::stoull( sz ) );
+      for( std::size_t i = 0; i < vertices.size(); i++ )
+      {
+        _fields.write( out, j, i );
+        out << "\n";
+      }
+    }
+  }
 
-    std::regex rePoints( "POINTS[[:space:]]+([[:digit:]]+)[[:space:]]+([[:alpha:]]+)" );
-    if( !std::regex_match( points, matches, rePoints ) )
-      return false;
+private:
 
-    auto sn = matches[1];
-    auto st = matches[2];
-
-    n = std::size_t( std::stoull( sn ) );
-
-    if( st == "double" )
-      s = sizeof(double);
-    else if( st == "float" )
-      s = sizeof(float);
-    else if( st == "long" )
-      s = sizeof(long);
-    else if( st == "unsigned_long" )
-      s = sizeof(unsigned long);
-    else if( st == "int" )
-      s = sizeof(int);
-    else if( st == "unsigned_int" )
-      s = sizeof(unsigned int);
-    else if( st == "short" )
-      s = sizeof(short);
-    else if( st == "unsigned_short" )
-      s = sizeof(unsigned short);
-    else if( st == "char" )
-      s = sizeof(char);
-    else if( st == "unsigned char" )
-      s = sizeof(unsigned char);
-    else if( st == "bit" )
-      s = sizeof(bool);
+  /** Name of the scalar field that stores the data of every vertex */
+  std::string _name = "data";
 
-    return true;
-  }
+  /** Additional scalar fields to write for every vertex */
+  detail::VertexProperties _fields;
 };
 
 } // namespace io
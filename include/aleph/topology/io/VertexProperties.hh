@@ -0,0 +1,139 @@
+#ifndef ALEPH_TOPOLOGY_IO_VERTEX_PROPERTIES_HH__
+#define ALEPH_TOPOLOGY_IO_VERTEX_PROPERTIES_HH__
+
+#include <cstddef>
+#include <cstdint>
+
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace aleph
+{
+
+namespace topology
+{
+
+namespace io
+{
+
+namespace detail
+{
+
+/**
+  @class VertexProperties
+  @brief Additional per-vertex properties of the mesh writers
+
+  Stores the values of every property in their original precision and
+  writes them with as many digits as are required for reading them back
+  exactly. Integral values are stored as integers, whereas all other
+  values are stored as floating point numbers.
+*/
+
+class VertexProperties
+{
+public:
+
+  template <class T> void add( const std::string& name, const std::vector<T>& values )
+  {
+    Property property;
+    property.name   = name;
+    property.digits = std::numeric_limits<T>::max_digits10;
+
+    assign( property, values, std::is_integral<T>() );
+
+    _properties.push_back( std::move( property ) );
+  }
+
+  /** @returns Number of properties */
+  std::size_t size() const noexcept
+  {
+    return _properties.size();
+  }
+
+  /** @returns Name of the given property */
+  const std::string& name( std::size_t property ) const
+  {
+    return _properties.at( property ).name;
+  }
+
+  /** @returns Type of the given property, i.e. "int" or "double" */
+  std::string type( std::size_t property ) const
+  {
+    return _properties.at( property ).integral ? "int" : "double";
+  }
+
+  /** Checks whether every property has a value for each vertex */
+  bool matches( std::size_t numVertices ) const noexcept
+  {
+    for( auto&& property : _properties )
+    {
+      auto n = property.integral ? property.integers.size() : property.reals.size();
+      if( n != numVertices )
+        return false;
+    }
+
+    return true;
+  }
+
+  /** Writes the value of a property for the given vertex index */
+  void write( std::ostream& out, std::size_t property, std::size_t vertex ) const
+  {
+    auto&& p = _properties[property];
+
+    if( p.integral )
+      out << p.integers[vertex];
+    else
+    {
+      auto precision = out.precision();
+
+      out << std::setprecision( p.digits ) << p.reals[vertex];
+      out.precision( precision );
+    }
+  }
+
+private:
+
+  struct Property
+  {
+    std::string name;
+    bool integral = false;
+    int digits    = 0;
+
+    std::vector<std::intmax_t> integers;
+    std::vector<double> reals;
+  };
+
+  template <class T> static void assign( Property& property, const std::vector<T>& values, std::true_type )
+  {
+    property.integral = true;
+    property.integers.reserve( values.size() );
+
+    for( auto&& value : values )
+      property.integers.push_back( static_cast<std::intmax_t>( value ) );
+  }
+
+  template <class T> static void assign( Property& property, const std::vector<T>& values, std::false_type )
+  {
+    property.integral = false;
+    property.reals.reserve( values.size() );
+
+    for( auto&& value : values )
+      property.reals.push_back( static_cast<double>( value ) );
+  }
+
+  std::vector<Property> _properties;
+};
+
+} // namespace detail
+
+} // namespace io
+
+} // namespace topology
+
+} // namespace aleph
+
+#endif
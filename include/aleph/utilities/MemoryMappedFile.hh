@@ -0,0 +1,168 @@
+#ifndef ALEPH_UTILITIES_MEMORY_MAPPED_FILE_HH__
+#define ALEPH_UTILITIES_MEMORY_MAPPED_FILE_HH__
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+
+#if defined(__unix__) || defined(__unix) || ( defined(__APPLE__) && defined(__MACH__) )
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace aleph
+{
+
+namespace utilities
+{
+
+/**
+  @class MemoryMappedFile
+  @brief Read-only view of the contents of a file
+
+  Maps a file into memory such that its contents can be accessed like an
+  array. Pages are only loaded by the operating system once they are
+  accessed, so opening even a large file is cheap. The mapping is released
+  when the object is destroyed.
+
+  On platforms without support for memory-mapped files, the contents of
+  the file are read into a buffer instead.
+*/
+
+class MemoryMappedFile
+{
+public:
+  explicit MemoryMappedFile( const std::string& filename )
+  {
+#if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L
+    int fd = ::open( filename.c_str(), O_RDONLY );
+    if( fd < 0 )
+      throw std::runtime_error( "Unable to open file for reading" );
+
+    struct stat status;
+    if( ::fstat( fd, &status ) != 0 )
+    {
+      ::close( fd );
+      throw std::runtime_error( "Unable to determine file size" );
+    }
+
+    _size = static_cast<std::size_t>( status.st_size );
+
+    // Empty files cannot be mapped, but they are valid nonetheless and
+    // only result in an empty view.
+    if( _size > 0 )
+    {
+      void* address = ::mmap( nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+      if( address == MAP_FAILED )
+      {
+        ::close( fd );
+        throw std::runtime_error( "Unable to map file into memory" );
+      }
+
+      _data = static_cast<const char*>( address );
+    }
+
+    // The mapping remains valid after the file descriptor has been closed
+    ::close( fd );
+#else
+    std::ifstream in( filename, std::ios::binary );
+    if( !in )
+      throw std::runtime_error( "Unable to open file for reading" );
+
+    _buffer.assign( std::istreambuf_iterator<char>( in ),
+                    std::istreambuf_iterator<char>() );
+
+    _size = _buffer.size();
+    _data = _buffer.data();
+#endif
+  }
+
+  ~MemoryMappedFile()
+  {
+    this->release();
+  }
+
+  MemoryMappedFile( const MemoryMappedFile& )            = delete;
+  MemoryMappedFile& operator=( const MemoryMappedFile& ) = delete;
+
+  MemoryMappedFile( MemoryMappedFile&& other ) noexcept
+  {
+    this->swap( other );
+  }
+
+  MemoryMappedFile& operator=( MemoryMappedFile&& other ) noexcept
+  {
+    if( this != &other )
+    {
+      this->release();
+      this->swap( other );
+    }
+
+    return *this;
+  }
+
+  /**
+    Indicates that the file is going to be read sequentially. This is only
+    a hint for the operating system, which may read ahead more aggressively.
+  */
+
+  void adviseSequential() const noexcept
+  {
+#if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L
+    if( _data )
+      ::posix_madvise( const_cast<char*>( _data ), _size, POSIX_MADV_SEQUENTIAL );
+#endif
+  }
+
+  const char* data() const noexcept { return _data; }
+  std::size_t size() const noexcept { return _size; }
+  bool empty()       const noexcept { return _size == 0; }
+
+  const char* begin() const noexcept { return _data;         }
+  const char* end()   const noexcept { return _data + _size; }
+
+private:
+  void release() noexcept
+  {
+#if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L
+    if( _data )
+      ::munmap( const_cast<char*>( _data ), _size );
+#else
+    _buffer.clear();
+#endif
+
+    _data = nullptr;
+    _size = 0;
+  }
+
+  void swap( MemoryMappedFile& other ) noexcept
+  {
+    std::swap( _data, other._data );
+    std::swap( _size, other._size );
+
+#if !( defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L )
+    _buffer.swap( other._buffer );
+#endif
+  }
+
+  const char* _data = nullptr;
+  std::size_t _size = 0;
+
+#if !( defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L )
+  std::vector<char> _buffer;
+#endif
+};
+
+} // namespace utilities
+
+} // namespace aleph
+
+#endif
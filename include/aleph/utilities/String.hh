@@ -3,12 +3,17 @@
 
 #include <algorithm>
 #include <limits>
+#include <ostream>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 namespace aleph
 {
@@ -89,6 +94,498 @@ template <class T, class S> T convert( const S& sequence )
   return result;
 }
 
+// Scanning ------------------------------------------------------------
+//
+// The functions in this section are meant for parsing large text files.
+// They do not use regular expressions and they do not allocate memory for
+// individual tokens. Tokens refer to the original string instead, so they
+// are only valid as long as the string exists.
+
+/**
+  @class StringView
+  @brief Non-owning view of a contiguous sequence of characters
+*/
+
+class StringView
+{
+public:
+  StringView() = default;
+
+  StringView( const char* data, std::size_t size )
+    : _data( data )
+    , _size( size )
+  {
+  }
+
+  StringView( const char* begin, const char* end )
+    : _data( begin )
+    , _size( static_cast<std::size_t>( end - begin ) )
+  {
+  }
+
+  StringView( const char* string )
+    : _data( string )
+    , _size( std::strlen( string ) )
+  {
+  }
+
+  StringView( const std::string& string )
+    : _data( string.data() )
+    , _size( string.size() )
+  {
+  }
+
+  const char* data()  const noexcept { return _data;         }
+  const char* begin() const noexcept { return _data;         }
+  const char* end()   const noexcept { return _data + _size; }
+
+  std::size_t size() const noexcept { return _size;      }
+  bool empty()       const noexcept { return _size == 0; }
+
+  char operator[]( std::size_t i ) const noexcept { return _data[i];         }
+  char front()                     const noexcept { return _data[0];         }
+  char back()                      const noexcept { return _data[_size - 1]; }
+
+  /** @returns View of at most n characters, starting at the given position */
+  StringView substr( std::size_t position, std::size_t n = std::string::npos ) const noexcept
+  {
+    position = std::min( position, _size );
+    return StringView( _data + position, std::min( n, _size - position ) );
+  }
+
+  /** @returns Position of the first occurrence of a character, or npos */
+  std::size_t find( char c, std::size_t position = 0 ) const noexcept
+  {
+    for( std::size_t i = position; i < _size; i++ )
+      if( _data[i] == c )
+        return i;
+
+    return std::string::npos;
+  }
+
+  bool startsWith( StringView prefix ) const noexcept
+  {
+    return _size >= prefix._size && std::equal( prefix.begin(), prefix.end(), _data );
+  }
+
+  std::string str() const
+  {
+    return std::string( _data, _size );
+  }
+
+  friend bool operator==( StringView a, StringView b ) noexcept
+  {
+    return a._size == b._size && std::equal( a.begin(), a.end(), b.begin() );
+  }
+
+  friend bool operator!=( StringView a, StringView b ) noexcept
+  {
+    return !( a == b );
+  }
+
+  friend std::ostream& operator<<( std::ostream& o, StringView s )
+  {
+    return o.write( s._data, static_cast<std::streamsize>( s._size ) );
+  }
+
+private:
+  const char* _data = nullptr;
+  std::size_t _size = 0;
+};
+
+/** Removes leading and trailing whitespace from a view without copying */
+inline StringView trim( StringView sequence )
+{
+  auto begin = sequence.begin();
+  auto end   = sequence.end();
+
+  while( begin != end && std::isspace( static_cast<unsigned char>( *begin ) ) )
+    ++begin;
+
+  while( begin != end && std::isspace( static_cast<unsigned char>( *( end - 1 ) ) ) )
+    --end;
+
+  return StringView( begin, end );
+}
+
+/** Compares two views while ignoring the case of ASCII letters */
+inline bool equalsIgnoreCase( StringView a, StringView b ) noexcept
+{
+  if( a.size() != b.size() )
+    return false;
+
+  for( std::size_t i = 0; i < a.size(); i++ )
+    if( std::tolower( static_cast<unsigned char>( a[i] ) ) != std::tolower( static_cast<unsigned char>( b[i] ) ) )
+      return false;
+
+  return true;
+}
+
+/**
+  @class Tokenizer
+  @brief Splits strings at a set of separator characters
+
+  The tokenizer classifies characters by a lookup table, so splitting a
+  string requires only a single pass. Consecutive separators are treated
+  as a single one, and empty tokens are never reported. This corresponds
+  to splitting at a regular expression such as "[[:space:]]+" after the
+  string has been trimmed.
+
+  Tokens are stored in a buffer that is re-used for every call, so they
+  remain valid until the tokenizer is called again, or the input string
+  is modified.
+*/
+
+class Tokenizer
+{
+public:
+
+  /** Creates a tokenizer that splits at whitespace characters */
+  Tokenizer()
+    : Tokenizer( " \t\n\v\f\r" )
+  {
+  }
+
+  /**
+    Creates a tokenizer that splits at any of the given characters. Note
+    that this is not a regular expression but a set of characters.
+  */
+
+  explicit Tokenizer( StringView separators )
+  {
+    std::fill( std::begin( _separator ), std::end( _separator ), false );
+
+    for( auto c : separators )
+      _separator[ static_cast<unsigned char>( c ) ] = true;
+  }
+
+  /** Splits a string and returns all of its tokens */
+  const std::vector<StringView>& operator()( StringView sequence )
+  {
+    _tokens.clear();
+
+    auto it  = sequence.begin();
+    auto end = sequence.end();
+
+    for( ;; )
+    {
+      while( it != end && this->isSeparator( *it ) )
+        ++it;
+
+      if( it == end )
+        break;
+
+      auto begin = it;
+
+      while( it != end && !this->isSeparator( *it ) )
+        ++it;
+
+      _tokens.emplace_back( begin, it );
+    }
+
+    return _tokens;
+  }
+
+  bool isSeparator( char c ) const noexcept
+  {
+    return _separator[ static_cast<unsigned char>( c ) ];
+  }
+
+  const std::vector<StringView>& tokens() const noexcept
+  {
+    return _tokens;
+  }
+
+private:
+  bool _separator[256];
+  std::vector<StringView> _tokens;
+};
+
+namespace detail
+{
+
+inline bool isDigit( char c ) noexcept
+{
+  return c >= '0' && c <= '9';
+}
+
+inline double powerOfTen( int exponent ) noexcept
+{
+  static const double powers[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  return powers[exponent];
+}
+
+inline float       toFloatingPoint( const char* s, float )       { return std::strtof( s, nullptr );  }
+inline double      toFloatingPoint( const char* s, double )      { return std::strtod( s, nullptr );  }
+inline long double toFloatingPoint( const char* s, long double ) { return std::strtold( s, nullptr ); }
+
+// Checks whether the range starts with a word, ignoring the case of all
+// letters, and returns the end of the word in this case.
+inline const char* matchWord( const char* first, const char* last, const char* word ) noexcept
+{
+  auto n = std::strlen( word );
+
+  if( static_cast<std::size_t>( last - first ) < n || !equalsIgnoreCase( StringView( first, n ), word ) )
+    return nullptr;
+
+  return first + n;
+}
+
+} // namespace detail
+
+/**
+  Parses an integer at the beginning of a range of characters, following
+  the conventions of `std::from_chars`: no whitespace is skipped, and the
+  function returns a pointer to the first character that has not been
+  parsed. If no number could be parsed, or the number does not fit into
+  the type, \p first is returned and \p value is left unchanged. A plus
+  sign is permitted.
+*/
+
+template <class T> typename std::enable_if<std::is_integral<T>::value, const char*>::type
+  fromChars( const char* first, const char* last, T& value ) noexcept
+{
+  auto it       = first;
+  bool negative = false;
+
+  if( it != last && ( *it == '+' || *it == '-' ) )
+  {
+    negative = *it == '-';
+    ++it;
+
+    if( negative && !std::is_signed<T>::value )
+      return first;
+  }
+
+  if( it == last || !detail::isDigit( *it ) )
+    return first;
+
+  using U = typename std::make_unsigned<T>::type;
+
+  U limit  = negative ? U( U( std::numeric_limits<T>::max() ) + 1 ) : U( std::numeric_limits<T>::max() );
+  U result = 0;
+
+  for( ; it != last && detail::isDigit( *it ); ++it )
+  {
+    U digit = static_cast<U>( *it - '0' );
+
+    if( result > U( ( limit - digit ) / 10 ) )
+      return first;
+
+    result = U( result * 10 + digit );
+  }
+
+  value = negative ? static_cast<T>( 0 - result ) : static_cast<T>( result );
+  return it;
+}
+
+/**
+  Parses a floating point number at the beginning of a range of
+  characters, following the conventions of `std::from_chars`. Infinite
+  values and NaNs are recognized regardless of their case. Numbers with
+  few significant digits are converted exactly without calling the C
+  library; all other numbers are converted using `strtod` and related
+  functions.
+*/
+
+template <class T> typename std::enable_if<std::is_floating_point<T>::value, const char*>::type
+  fromChars( const char* first, const char* last, T& value ) noexcept
+{
+  auto it       = first;
+  bool negative = false;
+
+  if( it != last && ( *it == '+' || *it == '-' ) )
+  {
+    negative = *it == '-';
+    ++it;
+  }
+
+  // Special values ----------------------------------------------------
+
+  if( it != last && !detail::isDigit( *it ) && *it != '.' )
+  {
+    const char* end = nullptr;
+
+    if( ( end = detail::matchWord( it, last, "infinity" ) ) || ( end = detail::matchWord( it, last, "inf" ) ) )
+    {
+      value = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+      return end;
+    }
+    else if( ( end = detail::matchWord( it, last, "nan" ) ) )
+    {
+      value = std::numeric_limits<T>::quiet_NaN();
+      return end;
+    }
+
+    return first;
+  }
+
+  // Mantissa ----------------------------------------------------------
+
+  std::uint64_t mantissa = 0;
+  int exponent           = 0;
+  int numDigits          = 0;
+  bool exact             = true;
+  bool hasDigits         = false;
+
+  auto addDigit = [&] ( char c )
+  {
+    hasDigits = true;
+
+    if( mantissa == 0 && c == '0' )
+      return false;
+
+    if( numDigits < 19 )
+    {
+      mantissa = mantissa * 10 + std::uint64_t( c - '0' );
+      ++numDigits;
+      return false;
+    }
+
+    if( c != '0' )
+      exact = false;
+
+    return true;
+  };
+
+  for( ; it != last && detail::isDigit( *it ); ++it )
+  {
+    // Digits that do not fit into the mantissa only shift the exponent
+    if( addDigit( *it ) )
+      ++exponent;
+  }
+
+  if( it != last && *it == '.' )
+  {
+    ++it;
+
+    // Every fractional digit shifts the exponent, including leading zeroes
+    // that have not been stored, unless it does not fit into the mantissa.
+    for( ; it != last && detail::isDigit( *it ); ++it )
+    {
+      if( !addDigit( *it ) )
+        --exponent;
+    }
+  }
+
+  if( !hasDigits )
+    return first;
+
+  // Exponent ----------------------------------------------------------
+
+  if( it != last && ( *it == 'e' || *it == 'E' ) )
+  {
+    auto position         = it + 1;
+    bool negativeExponent = false;
+
+    if( position != last && ( *position == '+' || *position == '-' ) )
+    {
+      negativeExponent = *position == '-';
+      ++position;
+    }
+
+    if( position != last && detail::isDigit( *position ) )
+    {
+      int e = 0;
+
+      for( ; position != last && detail::isDigit( *position ); ++position )
+      {
+        if( e < 100000 )
+          e = e * 10 + ( *position - '0' );
+      }
+
+      exponent += negativeExponent ? -e : e;
+      it        = position;
+    }
+  }
+
+  // Conversion --------------------------------------------------------
+  //
+  // If the mantissa and the power of ten are both exactly representable,
+  // a single multiplication or division is correctly rounded.
+
+  std::uint64_t maxMantissa = std::uint64_t(1) << std::numeric_limits<T>::digits;
+  int maxExponent           = std::is_same<T, float>::value ? 10 : 22;
+
+  if( mantissa == 0 )
+  {
+    value = negative ? -T(0) : T(0);
+    return it;
+  }
+  else if( exact && std::numeric_limits<T>::digits <= 53 && mantissa <= maxMantissa && exponent >= -maxExponent && exponent <= maxExponent )
+  {
+    T result = static_cast<T>( mantissa );
+    T power  = static_cast<T>( detail::powerOfTen( exponent < 0 ? -exponent : exponent ) );
+
+    result = exponent < 0 ? result / power : result * power;
+    value  = negative ? -result : result;
+
+    return it;
+  }
+
+  // Slow path: the C library requires a null-terminated string, so the
+  // number is copied to a buffer first.
+  auto length = static_cast<std::size_t>( it - first );
+
+  char buffer[64];
+
+  if( length < sizeof( buffer ) )
+  {
+    std::memcpy( buffer, first, length );
+    buffer[length] = '\0';
+
+    value = detail::toFloatingPoint( buffer, T() );
+  }
+  else
+  {
+    std::string copy( first, length );
+    value = detail::toFloatingPoint( copy.c_str(), T() );
+  }
+
+  return it;
+}
+
+/**
+  Parses a number from a token. Leading whitespace is ignored, as are all
+  characters following the number. This mimics the behaviour of convert()
+  but does not require a string stream.
+
+  @param token Token to parse
+  @param value Result; unchanged if no number could be parsed
+
+  @returns true if the complete token could be parsed
+*/
+
+template <class T> bool parse( StringView token, T& value ) noexcept
+{
+  auto first = token.begin();
+  auto last  = token.end();
+
+  while( first != last && std::isspace( static_cast<unsigned char>( *first ) ) )
+    ++first;
+
+  auto end = fromChars( first, last, value );
+  return end != first && end == last;
+}
+
+/**
+  Parses a number from a token and returns it. If no number could be
+  parsed, a default-constructed value is returned, which is consistent
+  with convert().
+*/
+
+template <class T> T parse( StringView token ) noexcept
+{
+  T value = T();
+  parse( token, value );
+
+  return value;
+}
+
 } // namespace utilities
 
 } // namespace aleph
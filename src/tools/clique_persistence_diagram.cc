@@ -69,12 +69,9 @@ namespace
 class CliqueCommunityInformationFunctor
 {
 public:
-  CliqueCommunityInformationFunctor( SimplicialComplex& K )
+  CliqueCommunityInformationFunctor( const SimplicialComplex& K, const std::vector<VertexType>& vertices )
     : _K( K )
   {
-    std::vector<VertexType> vertices;
-    _K.vertices( std::inserter( vertices, vertices.end() ) );
-
     // Ensure proper initialization for all vertices, regardless of
     // whether they appear in any clique community or not.
     for( auto&& vertex : vertices )
@@ -84,6 +81,21 @@ public:
     }
   }
 
+  /**
+    Merges the vertex information of another functor into the current
+    one. This permits processing clique graphs of different dimensions
+    with their own functors.
+  */
+
+  void merge( const CliqueCommunityInformationFunctor& other )
+  {
+    for( auto&& pair : other._vim )
+    {
+      _vim[pair.first].accumulatedPersistence    += pair.second.accumulatedPersistence;
+      _vim[pair.first].numberOfCliqueCommunities += pair.second.numberOfCliqueCommunities;
+    }
+  }
+
   void initialize( VertexType v )
   {
     _cs[v] = 1;
@@ -177,7 +189,7 @@ private:
 
   // Original simplicial complex for looking up the vertices during
   // merging and centrality calculations.
-  SimplicialComplex& _K;
+  const SimplicialComplex& _K;
 
   // Vertex information storage class. That way, I only require
   // a single map for looking up vertex information. The single
@@ -452,48 +464,74 @@ int main( int argc, char** argv )
 
   K.sort( aleph::topology::filtrations::Data<Simplex>() );
 
-  // Stores the accumulated persistence of vertices. Persistence
-  // accumulates if a vertex participates in a clique community.
-  std::map<VertexType, double> accumulatedPersistenceMap;
+  std::vector<VertexType> vertices;
+  K.vertices( std::back_inserter( vertices ) );
 
-  // Stores the number of clique communities a vertex is a part of.
-  // I am using this only for debugging the algorithm.
-  std::map<VertexType, unsigned> numberOfCliqueCommunities;
+  CliqueCommunityInformationFunctor ccif( K, vertices );
 
-  std::vector<double> totalPersistenceValues;
-  totalPersistenceValues.reserve( maxK );
+  // Batch processing --------------------------------------------------
+  //
+  // All clique graphs are extracted at once from a shared index of the
+  // co-faces. Afterwards, each clique graph is processed independently
+  // with its own functor. Their results are merged and stored in order.
+
+  std::cerr << "* Extracting clique graphs for k=1,...," << maxK << "...";
 
-  CliqueCommunityInformationFunctor ccif( K );
-  ccif.setDestructionThreshold( 2 * maxWeight );
+  auto cliqueGraphs
+    = aleph::topology::getCliqueGraphs( K, 1, maxK );
+
+  std::cerr << "finished\n";
 
   // By traversing the clique graphs in descending order I can be sure
   // that a graph will be available. Otherwise, in case of a minimum k
   // parameter and a reverted expansion, only empty clique graphs will
   // be traversed.
+  unsigned stopK = 0;
+
   for( unsigned k = maxK; k >= 1; k-- )
   {
-    std::cerr << "* Extracting " << k << "-cliques graph...";
+    std::cerr << "* " << k << "-cliques graph has " << cliqueGraphs[k].size() << " simplices\n";
 
-    auto C
-        = aleph::topology::getCliqueGraph( K, k );
+    if( !ignoreEmpty && cliqueGraphs[k].empty() )
+    {
+      std::cerr << "* Stopping here because no further cliques for processing exist\n";
+
+      stopK = k;
+      break;
+    }
+  }
+
+  std::vector<CliqueCommunityInformationFunctor> functors( maxK + 1, CliqueCommunityInformationFunctor( K, {} ) );
+  std::vector<PersistenceDiagram> persistenceDiagrams( maxK + 1 );
+  std::vector<aleph::PersistencePairing<VertexType> > persistencePairings( maxK + 1 );
+
+  auto n = static_cast<long>( maxK ) - static_cast<long>( stopK );
+
+  #pragma omp parallel for schedule(dynamic)
+  for( long i = 0; i < n; i++ )
+  {
+    auto k  = static_cast<unsigned>( maxK - static_cast<unsigned>( i ) );
+    auto&& C = cliqueGraphs[k];
 
     C.sort( aleph::topology::filtrations::Data<Simplex>() );
 
-    std::cerr << "finished\n";
+    functors[k].setDestructionThreshold( 2 * maxWeight );
 
-    std::cerr << "* " << k << "-cliques graph has " << C.size() << " simplices\n";
+    auto&& tuple = aleph::calculateZeroDimensionalPersistenceDiagram<Simplex, aleph::traits::PersistencePairingCalculation<aleph::PersistencePairing<VertexType> > >( C, functors[k] );
 
-    if( !ignoreEmpty && C.empty())
-    {
-      std::cerr << "* Stopping here because no further cliques for processing exist\n";
-      break;
-    }
+    persistenceDiagrams[k] = std::get<0>( tuple );
+    persistencePairings[k] = std::get<1>( tuple );
 
-    auto&& tuple = aleph::calculateZeroDimensionalPersistenceDiagram<Simplex, aleph::traits::PersistencePairingCalculation<aleph::PersistencePairing<VertexType> > >( C, ccif );
-    auto&& pd    = std::get<0>( tuple );
-    auto&& pp    = std::get<1>( tuple );
+    persistenceDiagrams[k].removeDiagonal();
+  }
+
+  for( unsigned k = maxK; k > stopK; k-- )
+  {
+    auto&& C  = cliqueGraphs[k];
+    auto&& pd = persistenceDiagrams[k];
+    auto&& pp = persistencePairings[k];
 
-    pd.removeDiagonal();
+    ccif.merge( functors[k] );
 
     if( !C.empty() )
     {
@@ -522,7 +560,7 @@ int main( int argc, char** argv )
           auto&& simplex = C.at( itPair->first );
           auto&& vertex  = *simplex.begin();
 
-          out << itPoint->x() << "\t" << itPoint->y() << "\t" << ccif.getComponentSize( vertex ) << "\n";
+          out << itPoint->x() << "\t" << itPoint->y() << "\t" << functors[k].getComponentSize( vertex ) << "\n";
         }
       }
     }
@@ -536,9 +574,6 @@ int main( int argc, char** argv )
 
     std::ofstream out( outputFilename );
 
-    std::set<VertexType> vertices;
-    K.vertices( std::inserter( vertices, vertices.end() ) );
-
     for( auto&& vertex : vertices )
     {
       out << vertex
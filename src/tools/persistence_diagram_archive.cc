@@ -0,0 +1,163 @@
+/*
+  This is a tool shipped by 'Aleph - A Library for Exploring Persistent
+  Homology'.
+
+  It converts persistence diagrams in raw or JSON format to a binary
+  archive. Archives can be mapped into memory, so individual diagrams
+  can be accessed without parsing any text. Other tools, for example
+  `topological_distance`, can read them directly.
+
+  Diagrams are named such that they can be grouped again later on. For
+  raw files, the name is the prefix preceding a suffix of the form _d or
+  _k, followed by digits, which also specifies the dimension. For JSON
+  files, all diagrams of a file share the stem of the file as their name.
+*/
+
+#include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+
+#include <aleph/persistenceDiagrams/io/Archive.hh>
+#include <aleph/persistenceDiagrams/io/JSON.hh>
+#include <aleph/persistenceDiagrams/io/Raw.hh>
+
+#include <aleph/utilities/Filesystem.hh>
+
+#include <iostream>
+#include <regex>
+#include <string>
+
+#include <getopt.h>
+
+using DataType           = double;
+using PersistenceDiagram = aleph::PersistenceDiagram<DataType>;
+
+void usage()
+{
+  std::cerr << "Usage: persistence_diagram_archive [--float] [--list] --output FILE FILES\n"
+            << "\n"
+            << "Converts a set of persistence diagrams, stored in FILES in raw or\n"
+            << "JSON format, to a binary archive. Raw files need to follow the\n"
+            << "naming scheme of 'topological_distance' in order to specify their\n"
+            << "dimension; JSON files may contain multiple diagrams. Archives should\n"
+            << "use the extension '.pda' in order to be recognized by other tools.\n"
+            << "\n"
+            << "Flags:\n"
+            << "  -f: store values in single precision\n"
+            << "  -l: list the contents of an existing archive\n"
+            << "  -o: output file\n"
+            << "\n";
+}
+
+template <class T> void convert( const std::string& output, char** begin, char** end )
+{
+  aleph::io::ArchiveWriter<T> writer( output );
+
+  std::regex reDataSetPrefix( "(.*)_[dk]([[:digit:]]+)\\.txt" );
+  std::smatch matches;
+
+  for( auto it = begin; it != end; ++it )
+  {
+    std::string filename = *it;
+
+    std::cerr << "* Processing '" << filename << "'...";
+
+    if( aleph::utilities::extension( filename ) == ".json" )
+    {
+      auto name = aleph::utilities::stem( filename );
+
+      aleph::io::readJSON<DataType>( filename, [&] ( PersistenceDiagram&& D, const std::string& )
+      {
+        writer( D, name );
+      } );
+    }
+    else
+    {
+      auto D    = aleph::io::load<DataType>( filename );
+      auto name = filename;
+
+      if( std::regex_match( filename, matches, reDataSetPrefix ) )
+      {
+        name = matches[1];
+        D.setDimension( std::stoul( matches[2] ) );
+      }
+
+      writer( D, name );
+    }
+
+    std::cerr << "finished\n";
+  }
+
+  writer.close();
+}
+
+void list( const std::string& filename )
+{
+  aleph::io::Archive archive( filename );
+
+  std::cout << "name,dimension,size\n";
+
+  for( std::size_t i = 0; i < archive.size(); i++ )
+  {
+    std::cout << "'" << archive.name(i) << "',"
+              << archive.dimension(i)   << ","
+              << archive.size(i)        << "\n";
+  }
+}
+
+int main( int argc, char** argv )
+{
+  static option commandLineOptions[] =
+  {
+    { "float" , no_argument      , nullptr, 'f' },
+    { "list"  , no_argument      , nullptr, 'l' },
+    { "output", required_argument, nullptr, 'o' },
+    { nullptr , 0                , nullptr,  0  }
+  };
+
+  bool useFloat = false;
+  bool listOnly = false;
+  std::string output;
+
+  {
+    int option = 0;
+    while( ( option = getopt_long( argc, argv, "flo:", commandLineOptions, nullptr ) ) != -1 )
+    {
+      switch( option )
+      {
+      case 'f':
+        useFloat = true;
+        break;
+      case 'l':
+        listOnly = true;
+        break;
+      case 'o':
+        output = optarg;
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  if( listOnly )
+  {
+    if( argc - optind != 1 )
+    {
+      usage();
+      return -1;
+    }
+
+    list( argv[optind] );
+    return 0;
+  }
+
+  if( output.empty() || argc - optind < 1 )
+  {
+    usage();
+    return -1;
+  }
+
+  if( useFloat )
+    convert<float>( output, argv + optind, argv + argc );
+  else
+    convert<double>( output, argv + optind, argv + argc );
+}
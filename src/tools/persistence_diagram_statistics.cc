@@ -13,8 +13,12 @@
 #include <aleph/persistenceDiagrams/Norms.hh>
 #include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
 
+#include <aleph/persistenceDiagrams/io/JSON.hh>
 #include <aleph/persistenceDiagrams/io/Raw.hh>
 
+#include <aleph/utilities/Filesystem.hh>
+
+#include <algorithm>
 #include <iostream>
 #include <limits>
 #include <numeric>
@@ -28,18 +32,14 @@
 using DataType           = double;
 using PersistenceDiagram = aleph::PersistenceDiagram<DataType>;
 
-struct Input
-{
-  std::string filename;
-  PersistenceDiagram persistenceDiagram;
-};
-
 void usage()
 {
   std::cerr << "Usage: persistence_diagram_statistics FILES\n"
             << "\n"
             << "Given a set of persistence diagrams, calculates numerous statistics\n"
-            << "and writes them to STDOUT in CSV format.\n"
+            << "and writes them to STDOUT in CSV format. Files with an extension of\n"
+            << "'.json' may contain multiple diagrams; they are processed one after\n"
+            << "the other, without loading the whole file.\n"
             << "\n"
             << "Currently, the following statistics are calculated:\n"
             << "  - Average persistence\n"
@@ -93,9 +93,6 @@ int main( int argc, char** argv )
     return -1;
   }
 
-  std::vector<Input> inputs;
-  inputs.reserve( argc - optind );
-
   std::vector<std::string> columns = {
     "file" ,
     "power",
@@ -105,22 +102,6 @@ int main( int argc, char** argv )
     "average_persistence"
   };
 
-  for( int i = optind; i < argc; i++ )
-  {
-    std::string filename = argv[i];
-
-    std::cerr << "* Loading '" << filename << "'...";
-
-    Input input = {
-      filename,
-      aleph::io::load<DataType>( filename )
-    };
-
-    inputs.push_back( input );
-
-    std::cerr << "finished\n";
-  }
-
   // Header ------------------------------------------------------------
 
   {
@@ -134,7 +115,9 @@ int main( int argc, char** argv )
     std::cout << "\n";
   }
 
-  for( auto&& input : inputs )
+  // Every diagram is processed as soon as it has been read, so only one
+  // diagram needs to be kept in memory at any time.
+  auto process = [&invalid, &p] ( const std::string& label, PersistenceDiagram& persistenceDiagram )
   {
     if( !std::isnan( invalid ) && invalid != std::numeric_limits<DataType>::max() )
     {
@@ -142,8 +125,8 @@ int main( int argc, char** argv )
 
       using Point = typename PersistenceDiagram::Point;
 
-      std::transform( input.persistenceDiagram.begin(), input.persistenceDiagram.end(),
-                      input.persistenceDiagram.begin(),
+      std::transform( persistenceDiagram.begin(), persistenceDiagram.end(),
+                      persistenceDiagram.begin(),
                       [&invalid] ( const Point& p )
                       {
                         if( p.x() == invalid || p.y() == invalid )
@@ -152,25 +135,51 @@ int main( int argc, char** argv )
                           return Point( p );
                       } );
 
-      input.persistenceDiagram.removeDiagonal();
+      persistenceDiagram.removeDiagonal();
 
       std::cerr << "\n";
     }
 
-    auto totalPersistence           = aleph::totalPersistence( input.persistenceDiagram, p, false );
-    auto totalPersistenceNormalized = totalPersistence / static_cast<decltype(totalPersistence)>( input.persistenceDiagram.size() );
-    auto infinityNorm               = aleph::infinityNorm( input.persistenceDiagram );
+    auto totalPersistence           = aleph::totalPersistence( persistenceDiagram, p, false );
+    auto totalPersistenceNormalized = totalPersistence / static_cast<decltype(totalPersistence)>( persistenceDiagram.size() );
+    auto infinityNorm               = aleph::infinityNorm( persistenceDiagram );
 
     std::vector<DataType> persistence;
-    aleph::persistence( input.persistenceDiagram, std::back_inserter( persistence ) );
+    aleph::persistence( persistenceDiagram, std::back_inserter( persistence ) );
 
-    auto averagePersistence         = std::accumulate( persistence.begin(), persistence.end(), 0.0 ) / static_cast<double>( input.persistenceDiagram.size() );
+    auto averagePersistence         = std::accumulate( persistence.begin(), persistence.end(), 0.0 ) / static_cast<double>( persistenceDiagram.size() );
 
-    std::cout << "'" << input.filename      << "'" << ","
+    std::cout << "'" << label << "'"            << ","
               << p                          << ","
               << totalPersistence           << ","
               << totalPersistenceNormalized << ","
               << infinityNorm               << ","
               << averagePersistence         << "\n";
+  };
+
+  for( int i = optind; i < argc; i++ )
+  {
+    std::string filename = argv[i];
+
+    std::cerr << "* Processing '" << filename << "'...\n";
+
+    if( aleph::utilities::extension( filename ) == ".json" )
+    {
+      unsigned index = 0;
+
+      // Diagrams are identified by their index in the file because their
+      // names are not required to be unique.
+      aleph::io::readJSON<DataType>( filename, [&] ( PersistenceDiagram&& D, const std::string& )
+      {
+        process( filename + ":" + std::to_string( index ), D );
+
+        ++index;
+      } );
+    }
+    else
+    {
+      auto D = aleph::io::load<DataType>( filename );
+      process( filename, D );
+    }
   }
 }
@@ -8,10 +8,14 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <random>
 #include <string>
 #include <vector>
 
 #include <cmath>
+#include <cstdint>
+
+#include <getopt.h>
 
 using DataType                     = double;
 using PersistenceDiagram           = aleph::PersistenceDiagram<DataType>;
@@ -20,30 +24,73 @@ using Image                        = PersistenceIndicatorFunction::Image;
 
 auto meanCalculation = [] ( auto begin, auto end )
 {
-  using T  = typename std::iterator_traits<decltype(begin)>::value_type;
-  auto sum = std::accumulate( begin, end, T() );
+  auto sum = aleph::math::sum( begin, end );
 
   return sum / static_cast<double>( std::distance(begin, end) );
 };
 
-// TODO: shamelessly copied from bootstrap functor class; this should
-// either be made public or the calculation below needs to be changed
-// accordingly...
-unsigned index( unsigned int samples, double alpha )
+void usage()
 {
-  // This accounts for rounding and works regardless of whether
-  // the product samples * alpha is an integer or not. Note the
-  // offset of -1. It is required because, say, the 100th value
-  // is at index 99 of the vector.
-  return static_cast<unsigned>( std::ceil( samples * alpha ) ) - 1;
+  std::cerr << "Usage: persistence_indicator_function_confidence_sets [--samples N] [--alpha ALPHA] [--seed SEED] FILES\n"
+            << "\n"
+            << "Calculates the mean persistence indicator function of a set of\n"
+            << "persistence diagrams, along with a confidence band that is given\n"
+            << "by bootstrap replicates of the mean. Replicates are calculated in\n"
+            << "parallel; specifying a seed makes them reproducible.\n"
+            << "\n"
+            << "Flags:\n"
+            << "  -a: significance level (default: 0.05)\n"
+            << "  -n: number of bootstrap samples (default: 50)\n"
+            << "  -s: seed of the random number generator\n"
+            << "\n"
+            << "The results are written to '/tmp/Mean_plus_confidence.txt'.\n\n";
 }
 
 int main( int argc, char** argv )
 {
+  static option commandLineOptions[] =
+  {
+    { "alpha"  , required_argument, nullptr, 'a' },
+    { "samples", required_argument, nullptr, 'n' },
+    { "seed"   , required_argument, nullptr, 's' },
+    { nullptr  , 0                , nullptr,  0  }
+  };
+
+  double alpha                 = 0.05;
+  unsigned numBootstrapSamples = 50;
+  std::uint64_t seed           = std::random_device()();
+
+  {
+    int option = 0;
+    while( ( option = getopt_long( argc, argv, "a:n:s:", commandLineOptions, nullptr ) ) != -1 )
+    {
+      switch( option )
+      {
+      case 'a':
+        alpha = std::stod( optarg );
+        break;
+      case 'n':
+        numBootstrapSamples = static_cast<unsigned>( std::stoul( optarg ) );
+        break;
+      case 's':
+        seed = static_cast<std::uint64_t>( std::stoull( optarg ) );
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  if( ( argc - optind ) < 1 || numBootstrapSamples == 0 )
+  {
+    usage();
+    return -1;
+  }
+
   std::vector<PersistenceIndicatorFunction> persistenceIndicatorFunctions;
-  persistenceIndicatorFunctions.reserve( argc - 1 );
+  persistenceIndicatorFunctions.reserve( static_cast<std::size_t>( argc - optind ) );
 
-  for( int i = 1; i < argc; i++ )
+  for( int i = optind; i < argc; i++ )
   {
     std::cerr << "* Processing '" << argv[i] << "'...";
 
@@ -57,44 +104,44 @@ int main( int argc, char** argv )
     std::cerr << "finished\n";
   }
 
-  // TODO: make configurable
-  unsigned numBootstrapSamples = 50;
-
   std::vector<PersistenceIndicatorFunction> meanReplicates;
   meanReplicates.reserve( numBootstrapSamples );
 
-  aleph::math::Bootstrap bootstrap;
+  aleph::math::Bootstrap bootstrap( seed );
+
+  std::cerr << "* Calculating " << numBootstrapSamples << " bootstrap replicates (seed: " << seed << ")...";
 
   bootstrap.makeReplicates( numBootstrapSamples,
                             persistenceIndicatorFunctions.begin(), persistenceIndicatorFunctions.end(),
                             meanCalculation,
                             std::back_inserter( meanReplicates ) );
 
+  std::cerr << "finished\n";
+
   auto empiricalMean = meanCalculation( persistenceIndicatorFunctions.begin(), persistenceIndicatorFunctions.end() );
+  auto n             = persistenceIndicatorFunctions.size();
 
-  std::vector<Image> theta;
-  theta.reserve( numBootstrapSamples );
+  std::vector<Image> theta( meanReplicates.size() );
 
-  for( auto&& meanReplicate: meanReplicates )
+  #pragma omp parallel for
+  for( std::size_t i = 0; i < meanReplicates.size(); i++ )
   {
-    auto n = persistenceIndicatorFunctions.size();
-    auto f = std::sqrt( n ) * ( meanReplicate - empiricalMean );
+    auto f = std::sqrt( n ) * ( meanReplicates[i] - empiricalMean );
     f      = f.abs();
 
-    theta.emplace_back( f.sup() );
+    theta[i] = f.sup();
   }
 
-  std::sort( theta.begin(), theta.end() );
-
-  auto alpha    = 0.05;
-  auto quantile = theta.at( index( numBootstrapSamples, alpha / 2 ) );
-  auto fLower   = empiricalMean - quantile / std::sqrt( persistenceIndicatorFunctions.size() );
-  auto fUpper   = empiricalMean + quantile / std::sqrt( persistenceIndicatorFunctions.size() );
+  // The confidence band is given by the (1-alpha) quantile of the supremum
+  // distances between the replicates and the empirical mean.
+  auto k        = aleph::math::Bootstrap::index( numBootstrapSamples, 1 - alpha );
+  auto quantile = aleph::math::Bootstrap::quantiles( theta, k, k ).first;
+  auto fLower   = empiricalMean - quantile / std::sqrt( n );
+  auto fUpper   = empiricalMean + quantile / std::sqrt( n );
 
   std::ofstream out( "/tmp/Mean_plus_confidence.txt" );
 
   out << empiricalMean << "\n\n"
       << fUpper        << "\n\n"
       << fLower        << "\n";
-
 }
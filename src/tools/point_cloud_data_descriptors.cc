@@ -23,6 +23,7 @@
 #include <aleph/config/FLANN.hh>
 
 #include <aleph/containers/DataDescriptors.hh>
+#include <aleph/containers/DescriptorEngine.hh>
 #include <aleph/containers/PointCloud.hh>
 
 #include <aleph/geometry/BruteForce.hh>
@@ -81,29 +82,46 @@ void invertValues( std::vector<DataType>& values )
     value = max - value;
 }
 
-std::vector<DataType> calculateDataDescriptor( const std::string& name, const PointCloud& pointCloud, unsigned k, double h, unsigned p )
+std::vector<DataType> calculateDataDescriptor( const std::string& name, const PointCloud& pointCloud, unsigned k, double h, unsigned p, unsigned a )
 {
+  aleph::containers::DescriptorEngine<Distance, PointCloud> engine( pointCloud );
+
   if( name == "density" )
-  {
-    #ifdef ALEPH_WITH_FLANN
-      return aleph::containers::estimateDensityDistanceToMeasure<Distance, PointCloud, Wrapper>( pointCloud, k );
-    #else
-      // The function will automatically fall back to the default
-      // wrapper.
-      return aleph::containers::estimateDensityDistanceToMeasure<Distance>( pointCloud, k );
-    #endif
-  }
+    engine.setNumNeighbours( k );
   else if( name == "eccentricity" )
-    return aleph::containers::eccentricities<Distance>( pointCloud, p );
+    engine.setEccentricityOrders( { p } );
   else if( name == "gaussian" )
-    return aleph::containers::estimateDensityTruncatedGaussian( pointCloud, h );
+    engine.setBandwidth( h );
+  else
+    return {};
+
+  // The distance to a measure only requires the k nearest neighbours,
+  // so it is always calculated from them.
+  if( name == "density" && a == 0 )
+    a = k;
+
+  aleph::containers::Descriptors descriptors;
+
+  if( a > 0 )
+  {
+    Wrapper wrapper( pointCloud );
+    descriptors = engine( wrapper, a );
+  }
+  else
+    descriptors = engine();
 
-  return {};
+  if( name == "density" )
+    return descriptors.distanceToMeasure;
+  else if( name == "eccentricity" )
+    return descriptors.eccentricities.front();
+  else
+    return descriptors.truncatedGaussian;
 }
 
 void usage()
 {
-  std::cerr << "Usage: point_cloud_data_descriptors [--bandwidth=H] [--dimension=D]\n"
+  std::cerr << "Usage: point_cloud_data_descriptors [--approximate=A]\n"
+            << "                                    [--bandwidth=H] [--dimension=D]\n"
             << "                                    [--descriptor=DESC]\n"
             << "                                    [--epsilon=EPS] [--k=k]\n"
             << "                                    [--invert] [--normalize]\n"
@@ -131,6 +149,11 @@ void usage()
             << "            bandwidth of h. By default, h=0.01.\n"
             << "\n"
             << "Several flags permit some control over the calculations:\n"
+            << "--approximate: restricts the calculation of descriptors to the\n"
+            << "               A nearest neighbours of every point instead of\n"
+            << "               using all pairwise distances. Eccentricities are\n"
+            << "               local in this case.\n"
+            << "\n"
             << "--invert: inverts data descriptor values. This is useful for the\n"
             << "          eccentricity descriptor, for example, because it uses\n"
             << "          small values to indicate very central points.\n"
@@ -143,6 +166,7 @@ void usage()
             << "\n"
             << "Abbreviations of the command-line arguments specified above\n"
             << "are also supported:\n"
+            << "  -a: approximate\n"
             << "  -b: bandwidth\n"
             << "  -D: dimension\n"
             << "  -d: descriptor\n"
@@ -159,6 +183,7 @@ int main( int argc, char** argv )
 {
   static option commandLineOptions[] =
   {
+    { "approximate"    , required_argument, nullptr, 'a' },
     { "bandwidth"      , required_argument, nullptr, 'b' },
     { "dimension"      , required_argument, nullptr, 'D' },
     { "descriptor"     , required_argument, nullptr, 'd' },
@@ -171,6 +196,7 @@ int main( int argc, char** argv )
     { nullptr          , 0                , nullptr,  0  }
   };
 
+  unsigned a             = 0;           // default number of neighbours (approximation)
   unsigned dimension     = 0;           // default dimension (point cloud expansion)
   double h               = 0.01;        // default bandwidth (Gaussian estimator)
   unsigned k             = 10;          // default number of neighbours (density estimator)
@@ -184,10 +210,13 @@ int main( int argc, char** argv )
 
   {
     int option = 0;
-    while( ( option = getopt_long( argc, argv, "b:D:d:e:k:inp:r", commandLineOptions, nullptr ) ) != -1 )
+    while( ( option = getopt_long( argc, argv, "a:b:D:d:e:k:inp:r", commandLineOptions, nullptr ) ) != -1 )
     {
       switch( option )
       {
+      case 'a':
+        a = static_cast<unsigned>( std::stoul( optarg ) );
+        break;
       case 'b':
         h = std::stod( optarg );
         break;
@@ -238,7 +267,8 @@ int main( int argc, char** argv )
                                pointCloud,
                                k,
                                h,
-                               p );
+                               p,
+                               a );
 
   if( invertDataDescriptorValues )
     invertValues( dataDescriptorValues );
@@ -37,11 +37,12 @@
 */
 
 #include <algorithm>
-#include <functional>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <regex>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -51,12 +52,11 @@
 // parser interface.
 #include <getopt.h>
 
+#include <aleph/persistenceDiagrams/PairwiseDistances.hh>
 #include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
 #include <aleph/persistenceDiagrams/PersistenceIndicatorFunction.hh>
 
-#include <aleph/persistenceDiagrams/distances/Hausdorff.hh>
-#include <aleph/persistenceDiagrams/distances/Wasserstein.hh>
-
+#include <aleph/persistenceDiagrams/io/Archive.hh>
 #include <aleph/persistenceDiagrams/io/JSON.hh>
 #include <aleph/persistenceDiagrams/io/Raw.hh>
 
@@ -85,8 +85,8 @@ struct DataSet
 void usage()
 {
   std::cerr << "Usage: topological_distance [--power=POWER] [--kernel] [--exp] [--sigma]\n"
-            << "                            [--hausdorff|indicator|wasserstein]\n"
-            << "                            [--clean] FILES\n"
+            << "                            [--hausdorff|indicator|sliced|wasserstein]\n"
+            << "                            [--checkpoint=FILE] [--clean] FILES\n"
             << "\n"
             << "Calculates distances between a set of persistence diagrams, stored\n"
             << "in FILES. By default, this tool calculates Hausdorff distances for\n"
@@ -100,10 +100,16 @@ void usage()
             << "The distance matrix is written to STDOUT. Rows and columns will be\n"
             << "separated by whitespace.\n"
             << "\n"
+            << "If a checkpoint file is given, all distances are also written to it\n"
+            << "while they are being calculated. Running the tool again with the same\n"
+            << "checkpoint file resumes an interrupted calculation.\n"
+            << "\n"
             << "This tool tries to be smart and is able to detect whether a set of\n"
             << "persistence diagrams belongs to the same group. This works only if\n"
             << "each file contains a suffix with digits that is preceded by either\n"
-            << "a 'd' (for dimension) or a 'k' (for clique dimension).\n"
+            << "a 'd' (for dimension) or a 'k' (for clique dimension). Archives of\n"
+            << "persistence diagrams, with an extension of '.pda', are grouped by the\n"
+            << "names of their diagrams instead.\n"
             << "\n"
             << "Flags:\n"
             << "  -c: clean persistence diagrams (remove unpaired points)\n"
@@ -111,6 +117,7 @@ void usage()
             << "  -h: calculate Hausdorff distances\n"
             << "  -i: calculate persistence indicator function distances\n"
             << "  -k: calculate kernel values instead of distances\n"
+            << "  -l: calculate sliced Wasserstein distances\n"
             << "  -n: normalize the persistence indicator function\n"
             << "  -s: use sigma as a scale parameter for the kernel\n"
             << "  -w: calculate Wasserstein distances\n"
@@ -148,103 +155,184 @@ void storeMatrix( const std::vector< std::vector<double> >& M, std::ostream& out
 }
 
 /*
-  Calculates the topological distance between two data sets using persistence
-  indicator functions. This requires enumerating all dimensions and finding a
-  corresponding persistence indicator function. If no suitable function could
-  be found, the calculation defaults to calculating the norm.
+  Auxiliary function for obtaining the persistence diagram of a data set in
+  a given dimension. If no persistence diagram exists, an empty one will be
+  returned.
+*/
+
+PersistenceDiagram getPersistenceDiagram( const std::vector<DataSet>& dataSet, unsigned dimension )
+{
+  auto it = std::find_if( dataSet.begin(), dataSet.end(),
+                          [&dimension] ( const DataSet& dataSet )
+                          {
+                            return dataSet.dimension == dimension;
+                          } );
+
+  if( it != dataSet.end() )
+    return PersistenceDiagram( it->persistenceDiagram );
+  else
+    return PersistenceDiagram();
+}
+
+/*
+  Metric for calculating the topological distance between two data sets
+  using persistence indicator functions. This requires enumerating all
+  dimensions and finding a corresponding persistence indicator function.
+  If no suitable function could be found, the calculation defaults to
+  calculating the norm.
 */
 
-double distancePIF( const std::vector<DataSet>& dataSet1,
-                    const std::vector<DataSet>& dataSet2,
-                    unsigned minDimension,
-                    unsigned maxDimension,
-                    double power,
-                    bool normalize )
+class IndicatorFunctionMetric
 {
-  auto getPersistenceIndicatorFunction = [] ( const std::vector<DataSet>& dataSet, unsigned dimension )
+public:
+  struct Cache
   {
-    auto it = std::find_if( dataSet.begin(), dataSet.end(),
-                            [&dimension] ( const DataSet& dataSet )
-                            {
-                              return dataSet.dimension == dimension;
-                            } );
-
-    if( it != dataSet.end() )
-      return PersistenceIndicatorFunction( it->persistenceIndicatorFunction );
-    else
-      return PersistenceIndicatorFunction();
+    std::vector<PersistenceIndicatorFunction> functions;
+    std::size_t size = 0;
   };
 
-  double d = 0.0;
+  IndicatorFunctionMetric( unsigned minDimension, unsigned maxDimension, double power, bool normalize )
+    : _minDimension( minDimension )
+    , _maxDimension( maxDimension )
+    , _power( power )
+    , _normalize( normalize )
+  {
+  }
 
-  for( unsigned dimension = minDimension; dimension <= maxDimension; dimension++ )
+  Cache prepare( const std::vector<DataSet>& dataSet ) const
   {
-    auto f = getPersistenceIndicatorFunction( dataSet1, dimension );
-    auto g = getPersistenceIndicatorFunction( dataSet2, dimension );
+    Cache cache;
 
-    if( normalize )
+    for( unsigned dimension = _minDimension; dimension <= _maxDimension; dimension++ )
     {
-      f = aleph::math::normalize( f );
-      g = aleph::math::normalize( g );
+      auto it = std::find_if( dataSet.begin(), dataSet.end(),
+                              [&dimension] ( const DataSet& dataSet )
+                              {
+                                return dataSet.dimension == dimension;
+                              } );
+
+      PersistenceIndicatorFunction f;
+
+      if( it != dataSet.end() )
+        f = it->persistenceIndicatorFunction;
+
+      if( _normalize )
+        f = aleph::math::normalize( f );
+
+      // The domain contains two values for every step, so its size is a
+      // good estimate of the number of operations.
+      std::vector<DataType> domain;
+      f.domain( std::back_inserter( domain ) );
+
+      cache.functions.push_back( f );
+      cache.size += domain.size();
     }
 
-    g = -g;
-    if( power == 1.0 )
-      d = d + (f+g).abs().integral();
-    else
-      d = d + (f+g).abs().pow( power ).integral();
+    return cache;
   }
 
-  return d;
-}
+  double cost( const Cache& F, const Cache& G ) const
+  {
+    return double( F.size + G.size );
+  }
 
-/*
-  Calculates the topological distance between two data sets, using
-  a standard distance between two persistence diagrams, for example
-  the Hausdorff, Wasserstein, or bottleneck distance.
+  double operator()( const Cache& F, const Cache& G ) const
+  {
+    double d = 0.0;
+
+    for( std::size_t i = 0; i < F.functions.size(); i++ )
+    {
+      auto f = F.functions[i];
+      auto g = -G.functions[i];
+
+      if( _power == 1.0 )
+        d = d + (f+g).abs().integral();
+      else
+        d = d + (f+g).abs().pow( _power ).integral();
+    }
+
+    return d;
+  }
 
-  By default, the Wasserstein distance is calculated.
+private:
+  unsigned _minDimension;
+  unsigned _maxDimension;
+  double _power;
+  bool _normalize;
+};
+
+/*
+  Metric for calculating the topological distance between two data sets,
+  using a standard distance between two persistence diagrams, for example
+  the Hausdorff, Wasserstein, or sliced Wasserstein distance. The distances
+  of all dimensions are accumulated. Optionally, each of them is raised to
+  the given power before.
 */
 
-template <class Functor>
-double persistenceDiagramDistance( const std::vector<DataSet>& dataSet1,
-                                   const std::vector<DataSet>& dataSet2,
-                                   unsigned minDimension,
-                                   unsigned maxDimension,
-                                   double power,
-                                   Functor functor = [] ( const PersistenceDiagram& D1, const PersistenceDiagram& D2, double power )
-                                   {
-                                     return aleph::distances::wassersteinDistance( D1, D2, power );
-                                   } )
+template <class Metric> class PersistenceDiagramMetric
 {
-  auto getPersistenceDiagram = [] ( const std::vector<DataSet>& dataSet, unsigned dimension )
+public:
+  using Cache = std::vector<typename Metric::Cache>;
+
+  PersistenceDiagramMetric( Metric metric, unsigned minDimension, unsigned maxDimension, double power, bool raise )
+    : _metric( metric )
+    , _minDimension( minDimension )
+    , _maxDimension( maxDimension )
+    , _power( power )
+    , _raise( raise )
   {
-    auto it = std::find_if( dataSet.begin(), dataSet.end(),
-                            [&dimension] ( const DataSet& dataSet )
-                            {
-                              return dataSet.dimension == dimension;
-                            } );
-
-    if( it != dataSet.end() )
-      return PersistenceDiagram( it->persistenceDiagram );
-    else
-      return PersistenceDiagram();
-  };
+  }
+
+  Cache prepare( const std::vector<DataSet>& dataSet ) const
+  {
+    Cache cache;
 
-  double d = 0.0;
+    for( unsigned dimension = _minDimension; dimension <= _maxDimension; dimension++ )
+      cache.push_back( _metric.prepare( getPersistenceDiagram( dataSet, dimension ) ) );
 
-  for( unsigned dimension = minDimension; dimension <= maxDimension; dimension++ )
+    return cache;
+  }
+
+  double cost( const Cache& C1, const Cache& C2 ) const
   {
-    auto D1 = getPersistenceDiagram( dataSet1, dimension );
-    auto D2 = getPersistenceDiagram( dataSet2, dimension );
+    double cost = 0.0;
+
+    for( std::size_t i = 0; i < C1.size(); i++ )
+      cost += _metric.cost( C1[i], C2[i] );
 
-    d += functor( D1, D2, power );
+    return cost;
   }
 
-  d = std::pow( d, 1.0 / power );
-  return d;
-}
+  double operator()( const Cache& C1, const Cache& C2 ) const
+  {
+    double d = 0.0;
+
+    for( std::size_t i = 0; i < C1.size(); i++ )
+    {
+      auto x = _metric( C1[i], C2[i] );
+      d     += _raise ? std::pow( x, _power ) : x;
+    }
+
+    d = std::pow( d, 1.0 / _power );
+    return d;
+  }
 
+private:
+  Metric _metric;
+
+  unsigned _minDimension;
+  unsigned _maxDimension;
+  double _power;
+  bool _raise;
+};
+
+template <class Metric> PersistenceDiagramMetric<Metric> makePersistenceDiagramMetric( Metric metric,
+                                                                                      unsigned minDimension, unsigned maxDimension,
+                                                                                      double power,
+                                                                                      bool raise )
+{
+  return PersistenceDiagramMetric<Metric>( metric, minDimension, maxDimension, power, raise );
+}
 
 int main( int argc, char** argv )
 {
@@ -259,6 +347,8 @@ int main( int argc, char** argv )
     { "normalize"  , no_argument      , nullptr, 'n' },
     { "kernel"     , no_argument      , nullptr, 'k' },
     { "wasserstein", no_argument      , nullptr, 'w' },
+    { "sliced"     , no_argument      , nullptr, 'l' },
+    { "checkpoint" , required_argument, nullptr, 'C' },
     { nullptr      , 0                , nullptr,  0  }
   };
 
@@ -270,9 +360,11 @@ int main( int argc, char** argv )
   bool normalize                    = false;
   bool calculateKernel              = false;
   bool useWassersteinDistance       = false;
+  bool useSlicedWassersteinDistance = false;
+  std::string checkpoint;
 
   int option = 0;
-  while( ( option = getopt_long( argc, argv, "p:s:cehinkw", commandLineOptions, nullptr ) ) != -1 )
+  while( ( option = getopt_long( argc, argv, "p:s:C:cehiklnw", commandLineOptions, nullptr ) ) != -1 )
   {
     switch( option )
     {
@@ -282,6 +374,9 @@ int main( int argc, char** argv )
     case 's':
       sigma = std::stod( optarg );
       break;
+    case 'C':
+      checkpoint = optarg;
+      break;
     case 'c':
       cleanPersistenceDiagrams = true;
       break;
@@ -291,27 +386,35 @@ int main( int argc, char** argv )
     case 'h':
       useWassersteinDistance       = false;
       useIndicatorFunctionDistance = false;
+      useSlicedWassersteinDistance = false;
       break;
     case 'i':
       useIndicatorFunctionDistance = true;
       useWassersteinDistance       = false;
+      useSlicedWassersteinDistance = false;
       break;
     case 'k':
       calculateKernel = true;
       break;
+    case 'l':
+      useIndicatorFunctionDistance = false;
+      useWassersteinDistance       = false;
+      useSlicedWassersteinDistance = true;
+      break;
     case 'n':
       normalize = true;
       break;
     case 'w':
       useIndicatorFunctionDistance = false;
       useWassersteinDistance       = true;
+      useSlicedWassersteinDistance = false;
       break;
     default:
       break;
     }
   }
 
-  if( ( argc - optind ) <= 1 )
+  if( ( argc - optind ) < 1 )
   {
     usage();
     return -1;
@@ -423,12 +526,11 @@ int main( int argc, char** argv )
 
       for( auto&& filename : filenames )
       {
-        auto persistenceDiagrams = aleph::io::readJSON<DataType>( filename );
-
         std::vector<DataSet> dataSet;
-        dataSet.reserve( persistenceDiagrams.size() );
 
-        for( auto&& diagram : persistenceDiagrams )
+        // Diagrams are streamed from the file, so only the diagrams that
+        // are actually stored in the data sets need to be kept in memory.
+        aleph::io::readJSON<DataType>( filename, [&] ( PersistenceDiagram&& diagram, const std::string& )
         {
           auto dimension = static_cast<unsigned>( diagram.dimension() );
           minDimension   = std::min( minDimension, dimension );
@@ -451,40 +553,79 @@ int main( int argc, char** argv )
             diagram.removeUnpaired();
           }
 
+          auto f = aleph::persistenceIndicatorFunction( pd );
+
           dataSet.push_back( { name,
                                filename,
                                dimension,
-                               diagram,
-                               aleph::persistenceIndicatorFunction( pd ) } );
-        }
+                               std::move( diagram ),
+                               std::move( f ) } );
+        } );
 
         dataSets.push_back( dataSet );
       }
     }
-  }
+    else if( aleph::utilities::extension( filenames.front() ) == ".pda" )
+    {
+      // Archives do not have to be parsed. Diagrams of the same name are
+      // grouped into one data set, in the order in which they appear.
+      std::map<std::string, std::size_t> nameMap;
+
+      for( auto&& filename : filenames )
+      {
+        std::cerr << "* Processing '" << filename << "'...";
 
-  // Setup distance functor --------------------------------------------
-
-  std::function< double( const PersistenceDiagram&, const PersistenceDiagram&, double ) > functor
-    = !useIndicatorFunctionDistance ? useWassersteinDistance ? [] ( const PersistenceDiagram& D1, const PersistenceDiagram& D2, double p )
-                                                               {
-                                                                 return aleph::distances::wassersteinDistance( D1, D2, p );
-                                                               }
-                                                             : [] ( const PersistenceDiagram& D1, const PersistenceDiagram& D2, double p )
-                                                               {
-                                                                 return std::pow( aleph::distances::hausdorffDistance( D1, D2 ), p );
-                                                               }
-                                    : [] ( const PersistenceDiagram&, const PersistenceDiagram&, double )
-                                    {
-                                      return 0.0;
-                                    };
+        aleph::io::Archive archive( filename );
+
+        for( std::size_t i = 0; i < archive.size(); i++ )
+        {
+          auto name      = archive.name(i);
+          auto dimension = static_cast<unsigned>( archive.dimension(i) );
+          minDimension   = std::min( minDimension, dimension );
+          maxDimension   = std::max( maxDimension, dimension );
+
+          if( nameMap.find( name ) == nameMap.end() )
+          {
+            nameMap[ name ] = dataSets.size();
+            dataSets.push_back( {} );
+          }
+
+          auto diagram = archive.diagram<DataType>(i);
+
+          // FIXME: This is only required in order to ensure that the
+          // persistence indicator function has a finite integral; it
+          // can be solved more elegantly by using a special value to
+          // indicate infinite intervals.
+          auto pd = diagram;
+          pd.removeUnpaired();
+
+          if( cleanPersistenceDiagrams )
+          {
+            diagram.removeDiagonal();
+            diagram.removeUnpaired();
+          }
+
+          auto f = aleph::persistenceIndicatorFunction( pd );
+
+          dataSets.at( nameMap[name] ).push_back( { name,
+                                                    filename,
+                                                    dimension,
+                                                    std::move( diagram ),
+                                                    std::move( f ) } );
+        }
+
+        std::cerr << "finished\n";
+      }
+    }
+  }
 
   // Calculate all distances -------------------------------------------
 
   {
     auto name = useIndicatorFunctionDistance ? "persistence indicator function"
                                              : useWassersteinDistance ? "Wasserstein"
-                                                                      : "Hausdorff";
+                                                                      : useSlicedWassersteinDistance ? "sliced Wasserstein"
+                                                                                                     : "Hausdorff";
 
     auto type = calculateKernel ? "kernel values" : "distances";
 
@@ -492,23 +633,59 @@ int main( int argc, char** argv )
     std::cerr << "* Calculating pairwise " << type << " with p=" << power << "...";
   }
 
+  aleph::PairwiseDistancesOptions options;
+  options.checkpoint = checkpoint;
+
+  // The checkpoint file must only be used to resume exactly the same
+  // calculation, so its identifier contains all relevant parameters.
+  {
+    auto name = useIndicatorFunctionDistance ? "indicator"
+                                             : useWassersteinDistance ? "wasserstein"
+                                                                      : useSlicedWassersteinDistance ? "sliced"
+                                                                                                     : "hausdorff";
+
+    std::ostringstream metric;
+    metric << name
+           << " normalize=" << normalize
+           << " clean="     << cleanPersistenceDiagrams
+           << " dimensions=" << minDimension << "-" << maxDimension;
+
+    options.identifier = aleph::checkpointIdentifier( metric.str(),
+                                                      power,
+                                                      std::vector<std::string>( argv + optind, argv + argc ) );
+  }
+
+  aleph::math::SymmetricMatrix<double> D;
+
+  if( useIndicatorFunctionDistance )
+  {
+    IndicatorFunctionMetric metric( minDimension, maxDimension, power, normalize );
+    D = aleph::pairwiseDistances( dataSets, metric, options );
+  }
+  else if( useWassersteinDistance )
+  {
+    auto metric = makePersistenceDiagramMetric( aleph::distances::WassersteinMetric<DataType>( power ), minDimension, maxDimension, power, false );
+    D           = aleph::pairwiseDistances( dataSets, metric, options );
+  }
+  else if( useSlicedWassersteinDistance )
+  {
+    auto metric = makePersistenceDiagramMetric( aleph::distances::SlicedWassersteinMetric(), minDimension, maxDimension, power, true );
+    D           = aleph::pairwiseDistances( dataSets, metric, options );
+  }
+  else
+  {
+    auto metric = makePersistenceDiagramMetric( aleph::distances::HausdorffMetric<DataType>(), minDimension, maxDimension, power, true );
+    D           = aleph::pairwiseDistances( dataSets, metric, options );
+  }
+
   std::vector< std::vector<double> > distances;
   distances.resize( dataSets.size(), std::vector<double>( dataSets.size() ) );
 
-  #pragma omp parallel for collapse(2)
   for( std::size_t row = 0; row < dataSets.size(); row++ )
   {
-    for( std::size_t col = 0; col < dataSets.size(); col++ )
+    for( std::size_t col = 0; col < row; col++ )
     {
-      if( row <= col )
-        continue;
-
-      double d = 0.0;
-
-      if( useIndicatorFunctionDistance )
-        d = distancePIF( dataSets.at(row), dataSets.at(col), minDimension, maxDimension, power, normalize );
-      else
-        d = persistenceDiagramDistance( dataSets.at(row), dataSets.at(col), minDimension, maxDimension, power, functor );
+      double d = D( row, col );
 
       if( calculateKernel )
       {
@@ -5,6 +5,11 @@
 #include <stdexcept>
 #include <string>
 
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
 namespace aleph
 {
 
@@ -59,6 +64,32 @@ namespace aleph
   }                                                                 \
 }
 
+#define ALEPH_ASSERT_THROWS( expression, exception )                \
+{                                                                   \
+  bool alephExceptionThrown = false;                                \
+                                                                    \
+  try                                                               \
+  {                                                                 \
+    ( expression );                                                 \
+  }                                                                 \
+  catch( exception& )                                               \
+  {                                                                 \
+    alephExceptionThrown = true;                                    \
+  }                                                                 \
+                                                                    \
+  if( !alephExceptionThrown )                                       \
+  {                                                                 \
+    throw std::runtime_error(   std::string( __FILE__ )             \
+                              + std::string( ":" )                  \
+                              + std::to_string( __LINE__ )          \
+                              + std::string( " in " )               \
+                              + std::string( __PRETTY_FUNCTION__ )  \
+                              + std::string( ": expected " )        \
+                              + std::string( #exception )           \
+    );                                                              \
+  }                                                                 \
+}
+
 #define ALEPH_TEST_BEGIN( name )\
 {\
   std::cerr << "-- Running test \"" << name << "\"...";\
@@ -70,6 +101,52 @@ namespace aleph
 }
 
 
+namespace tests
+{
+
+/**
+  @class TemporaryFile
+  @brief Unique temporary file that is removed when going out of scope
+
+  Creates an empty file in the temporary directory whose name starts with
+  the given prefix. The file is closed immediately, so that tests can use
+  its name for writing and reading.
+*/
+
+class TemporaryFile
+{
+public:
+  explicit TemporaryFile( const std::string& prefix = "aleph" )
+  {
+    std::string pattern = "/tmp/" + prefix + "_XXXXXX";
+
+    int fd = mkstemp( &pattern[0] );
+    if( fd < 0 )
+      throw std::runtime_error( "Unable to create temporary file" );
+
+    close( fd );
+    _filename = pattern;
+  }
+
+  ~TemporaryFile()
+  {
+    std::remove( _filename.c_str() );
+  }
+
+  TemporaryFile( const TemporaryFile& )            = delete;
+  TemporaryFile& operator=( const TemporaryFile& ) = delete;
+
+  const std::string& filename() const noexcept
+  {
+    return _filename;
+  }
+
+private:
+  std::string _filename;
+};
+
+} // namespace tests
+
 }
 
 #endif
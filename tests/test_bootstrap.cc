@@ -2,10 +2,13 @@
 
 #include <aleph/math/Bootstrap.hh>
 
+#include <algorithm>
 #include <iterator>
 #include <numeric>
 #include <vector>
 
+#include <cmath>
+
 auto meanCalculation = [] ( auto begin, auto end )
 {
   using T  = typename std::iterator_traits<decltype(begin)>::value_type;
@@ -71,7 +74,48 @@ void testSimple()
   ALEPH_ASSERT_THROW( percentileConfidenceInterval.second <= 43.0 );
 }
 
+void testReproducibility()
+{
+  std::vector<double> samples;
+  for( unsigned i = 0; i < 100; i++ )
+    samples.push_back( std::sin( double( i ) ) );
+
+  std::vector<double> means1;
+  std::vector<double> means2;
+  std::vector<double> means3;
+
+  aleph::math::Bootstrap bootstrap1( 42 );
+  aleph::math::Bootstrap bootstrap2( 42 );
+  aleph::math::Bootstrap bootstrap3( 23 );
+
+  bootstrap1.makeReplicates( 200, samples.begin(), samples.end(), meanCalculation, std::back_inserter( means1 ) );
+  bootstrap2.makeReplicates( 200, samples.begin(), samples.end(), meanCalculation, std::back_inserter( means2 ) );
+  bootstrap3.makeReplicates( 200, samples.begin(), samples.end(), meanCalculation, std::back_inserter( means3 ) );
+
+  ALEPH_ASSERT_THROW( means1 == means2 );
+  ALEPH_ASSERT_THROW( means1 != means3 );
+
+  // Replicates must not coincide with each other
+  std::sort( means1.begin(), means1.end() );
+
+  {
+    auto unique = means1;
+    ALEPH_ASSERT_THROW( std::unique( unique.begin(), unique.end() ) - unique.begin() > 190 );
+  }
+
+  // Selecting quantiles yields the same values as sorting
+  auto quantiles = aleph::math::Bootstrap::quantiles( means2, 4, 194 );
+
+  ALEPH_ASSERT_EQUAL( quantiles.first,  means1.at(4)   );
+  ALEPH_ASSERT_EQUAL( quantiles.second, means1.at(194) );
+
+  ALEPH_ASSERT_EQUAL( aleph::math::Bootstrap::index( 200, 0.025 ), 4   );
+  ALEPH_ASSERT_EQUAL( aleph::math::Bootstrap::index( 200, 0.975 ), 194 );
+  ALEPH_ASSERT_EQUAL( aleph::math::Bootstrap::index( 200, 0.0   ), 0   );
+}
+
 int main(int, char**)
 {
   testSimple();
+  testReproducibility();
 }
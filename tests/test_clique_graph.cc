@@ -82,6 +82,50 @@ template <class Data, class Vertex> void triangles()
   ALEPH_TEST_END();
 }
 
+template <class Data, class Vertex> void batch()
+{
+  ALEPH_TEST_BEGIN( "Batch extraction" );
+
+  using Simplex           = Simplex<Data, Vertex>;
+  using SimplicialComplex = SimplicialComplex<Simplex>;
+
+  // Two tetrahedra that share a triangle, plus an additional triangle
+  // that is only connected via a single edge.
+  std::vector<Simplex> simplices
+    = {
+        {0}, {1}, {2}, {3}, {4}, {5},
+        {0,1}, {0,2}, {0,3}, {0,4}, {1,2}, {1,3}, {1,4}, {2,3}, {2,4}, {3,5}, {4,5},
+        {0,1,2}, {0,1,3}, {0,1,4}, {0,2,3}, {0,2,4}, {1,2,3}, {1,2,4},
+        {0,1,2,3}, {0,1,2,4}
+    };
+
+  SimplicialComplex K( simplices.begin(), simplices.end() );
+
+  auto cliqueGraphs = getCliqueGraphs( K, 1, 4 );
+
+  ALEPH_ASSERT_EQUAL( cliqueGraphs.size(), 5 );
+  ALEPH_ASSERT_THROW( cliqueGraphs[0].empty() );
+  ALEPH_ASSERT_THROW( cliqueGraphs[4].empty() );
+
+  for( unsigned k = 1; k <= 3; k++ )
+  {
+    auto C = getCliqueGraph( K, k );
+
+    ALEPH_ASSERT_THROW( C.empty() == false );
+    ALEPH_ASSERT_EQUAL( C.size(), cliqueGraphs[k].size() );
+
+    for( auto&& s : C )
+    {
+      auto it = cliqueGraphs[k].find( s );
+
+      ALEPH_ASSERT_THROW( it != cliqueGraphs[k].end() );
+      ALEPH_ASSERT_THROW( it->data() == s.data() );
+    }
+  }
+
+  ALEPH_TEST_END();
+}
+
 int main()
 {
   triangle<double, unsigned>();
@@ -89,4 +133,7 @@ int main()
 
   triangles<double, unsigned>();
   triangles<float,  unsigned>();
+
+  batch<double, unsigned>();
+  batch<float,  unsigned>();
 }
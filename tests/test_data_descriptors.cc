@@ -2,6 +2,9 @@
 
 #include <aleph/containers/PointCloud.hh>
 #include <aleph/containers/DataDescriptors.hh>
+#include <aleph/containers/DescriptorEngine.hh>
+
+#include <aleph/geometry/BruteForce.hh>
 
 #include <aleph/geometry/distances/Euclidean.hh>
 #include <aleph/geometry/distances/Manhattan.hh>
@@ -159,6 +162,124 @@ template <class D> void distanceToMeasureTest()
   ALEPH_TEST_END();
 }
 
+template <class D> void descriptorEngineTest()
+{
+  ALEPH_TEST_BEGIN( "Descriptor engine test" );
+
+  using PointCloud = aleph::containers::PointCloud<double>;
+  using Wrapper    = aleph::geometry::BruteForce<PointCloud, D>;
+
+  auto pc = load<double>( CMAKE_SOURCE_DIR + std::string( "/tests/input/Iris_comma_separated.txt" ) );
+  auto n  = pc.size();
+
+  // Reference values --------------------------------------------------
+
+  std::vector< std::vector<double> > distances( n, std::vector<double>( n ) );
+
+  {
+    D dist;
+    distances::Traits<D> traits;
+
+    for( std::size_t i = 0; i < n; i++ )
+      for( std::size_t j = 0; j < n; j++ )
+        distances[i][j] = traits.from( dist( pc[i].begin(), pc[j].begin(), pc.dimension() ) );
+  }
+
+  std::vector<double> eccentricities3;
+  std::vector<double> gaussian;
+  std::vector<double> kNNDistances;
+
+  for( std::size_t i = 0; i < n; i++ )
+  {
+    double sum     = 0.0;
+    double density = 0.0;
+
+    for( std::size_t j = 0; j < n; j++ )
+    {
+      if( i != j )
+        sum += std::pow( distances[i][j], 3.0 );
+
+      if( distances[i][j] * distances[i][j] <= 0.25 )
+        density += std::exp( -distances[i][j] * distances[i][j] / 1.0 );
+    }
+
+    eccentricities3.push_back( std::pow( sum / double(n), 1.0 / 3.0 ) );
+    gaussian.push_back( density / double(n) );
+
+    auto row = distances[i];
+    std::sort( row.begin(), row.end() );
+
+    kNNDistances.push_back( row.at(4) );
+  }
+
+  auto e0  = eccentricities<D>( pc, 0 );
+  auto e1  = eccentricities<D>( pc, 1 );
+  auto dtm = estimateDensityDistanceToMeasure<D>( pc, 5 );
+
+  // Exact calculation with different tile sizes -----------------------
+
+  for( auto&& size : { std::make_pair( 1, 1 ), std::make_pair( 7, 13 ), std::make_pair( 32, 512 ) } )
+  {
+    DescriptorEngine<D, PointCloud> engine( pc );
+
+    engine.setEccentricityOrders( { 0, 1, 3 } );
+    engine.setBandwidth( 0.5 );
+    engine.setNumNeighbours( 5 );
+    engine.setTileSize( std::size_t( size.first ), std::size_t( size.second ) );
+
+    auto descriptors = engine();
+
+    ALEPH_ASSERT_EQUAL( descriptors.eccentricities.size(), 3 );
+
+    ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.eccentricities[0].begin(), descriptors.eccentricities[0].end(), e0.begin(), e0.end() ) );
+    ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.eccentricities[1].begin(), descriptors.eccentricities[1].end(), e1.begin(), e1.end() ) );
+    ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.eccentricities[2].begin(), descriptors.eccentricities[2].end(), eccentricities3.begin(), eccentricities3.end() ) );
+
+    ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.truncatedGaussian.begin(), descriptors.truncatedGaussian.end(), gaussian.begin(), gaussian.end() ) );
+    ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.distanceToMeasure.begin(), descriptors.distanceToMeasure.end(), dtm.begin(), dtm.end() ) );
+    ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.kNNDistance.begin(), descriptors.kNNDistance.end(), kNNDistances.begin(), kNNDistances.end() ) );
+  }
+
+  // Approximate calculation -------------------------------------------
+
+  {
+    DescriptorEngine<D, PointCloud> engine( pc );
+
+    engine.setEccentricityOrders( { 0, 1 } );
+    engine.setBandwidth( 0.5 );
+    engine.setNumNeighbours( 5 );
+
+    Wrapper wrapper( pc );
+
+    // Using all neighbours yields the exact values
+    {
+      auto descriptors = engine( wrapper, unsigned( n ) );
+
+      ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.eccentricities[0].begin(), descriptors.eccentricities[0].end(), e0.begin(), e0.end() ) );
+      ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.eccentricities[1].begin(), descriptors.eccentricities[1].end(), e1.begin(), e1.end() ) );
+      ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.truncatedGaussian.begin(), descriptors.truncatedGaussian.end(), gaussian.begin(), gaussian.end() ) );
+    }
+
+    // Using fewer neighbours still yields the exact nearest neighbour
+    // descriptors, while eccentricities become smaller
+    {
+      auto descriptors = engine( wrapper, 10 );
+
+      ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.distanceToMeasure.begin(), descriptors.distanceToMeasure.end(), dtm.begin(), dtm.end() ) );
+      ALEPH_ASSERT_THROW( moreOrLessEqual( descriptors.kNNDistance.begin(), descriptors.kNNDistance.end(), kNNDistances.begin(), kNNDistances.end() ) );
+
+      for( std::size_t i = 0; i < n; i++ )
+      {
+        ALEPH_ASSERT_THROW( descriptors.eccentricities[0][i] <= e0[i] );
+        ALEPH_ASSERT_THROW( descriptors.eccentricities[1][i] <= e1[i] + 1e-12 );
+        ALEPH_ASSERT_THROW( descriptors.truncatedGaussian[i] <= gaussian[i] + 1e-12 );
+      }
+    }
+  }
+
+  ALEPH_TEST_END();
+}
+
 int main()
 {
   using T  = double;
@@ -171,9 +292,11 @@ int main()
 
   eccentricityTest<ED>();
   distanceToMeasureTest<ED>();
+  descriptorEngineTest<ED>();
 
   std::cerr << "-- Manhattan distance\n";
 
   eccentricityTest<MD>();
   distanceToMeasureTest<MD>();
+  descriptorEngineTest<MD>();
 }
@@ -0,0 +1,263 @@
+#include <aleph/config/Base.hh>
+
+#include <tests/Base.hh>
+
+#include <aleph/containers/DataDescriptors.hh>
+#include <aleph/containers/DensityEstimators.hh>
+#include <aleph/containers/PointCloud.hh>
+
+#include <aleph/geometry/BruteForce.hh>
+#include <aleph/geometry/VietorisRipsComplex.hh>
+
+#include <aleph/geometry/distances/Euclidean.hh>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cmath>
+
+/** Creates a point cloud of several Gaussian clusters with different spreads */
+aleph::containers::PointCloud<double> makeClusters( std::size_t n, std::size_t d, unsigned seed )
+{
+  aleph::containers::PointCloud<double> pc( n, d );
+
+  std::mt19937 rng( seed );
+  std::normal_distribution<double> normal;
+
+  std::vector<double> p( d );
+
+  for( std::size_t i = 0; i < n; i++ )
+  {
+    auto cluster = i % 4;
+
+    for( std::size_t c = 0; c < d; c++ )
+      p[c] = 3.0 * double( cluster ) + normal( rng ) * 0.25 * double( cluster + 1 );
+
+    pc.set( i, p.begin(), p.end() );
+  }
+
+  return pc;
+}
+
+/** Evaluates a kernel density estimate by visiting all pairs of points */
+template <class Kernel> std::vector<double> bruteForceDensity( const aleph::containers::PointCloud<double>& pc,
+                                                               const aleph::containers::PointCloud<double>& queries,
+                                                               Kernel kernel )
+{
+  auto n = pc.size();
+  auto d = pc.dimension();
+
+  std::vector<double> result;
+
+  for( std::size_t i = 0; i < queries.size(); i++ )
+  {
+    double sum = 0.0;
+
+    for( std::size_t j = 0; j < n; j++ )
+    {
+      double distance = 0.0;
+
+      for( std::size_t c = 0; c < d; c++ )
+      {
+        auto z    = queries.data()[ i * d + c ] - pc.data()[ j * d + c ];
+        distance += z * z;
+      }
+
+      sum += kernel( distance );
+    }
+
+    result.push_back( sum * kernel.normalization( d ) / double( n ) );
+  }
+
+  return result;
+}
+
+template <class Kernel> void testKernel( Kernel kernel )
+{
+  using namespace aleph::containers;
+
+  auto pc        = makeClusters( 2000, 3, 42 );
+  auto reference = bruteForceDensity( pc, pc, kernel );
+
+  // Exact -------------------------------------------------------------
+
+  {
+    auto densities = estimateDensity( pc, kernel );
+
+    ALEPH_ASSERT_EQUAL( densities.size(), pc.size() );
+
+    for( std::size_t i = 0; i < densities.size(); i++ )
+      ALEPH_ASSERT_THROW( std::abs( densities[i] - reference[i] ) <= 1e-12 * reference[i] );
+  }
+
+  // Absolute error ----------------------------------------------------
+
+  {
+    auto densities = estimateDensity( pc, kernel, 1e-3 );
+
+    for( std::size_t i = 0; i < densities.size(); i++ )
+      ALEPH_ASSERT_THROW( std::abs( densities[i] - reference[i] ) <= 1e-3 + 1e-12 );
+  }
+
+  // Relative error ----------------------------------------------------
+
+  {
+    auto densities = estimateDensity( pc, kernel, 0.0, 0.01 );
+
+    for( std::size_t i = 0; i < densities.size(); i++ )
+      ALEPH_ASSERT_THROW( std::abs( densities[i] - reference[i] ) <= 0.01 * reference[i] + 1e-12 );
+  }
+
+  // Queries from another point cloud ----------------------------------
+
+  {
+    auto queries = makeClusters( 300, 3, 23 );
+    auto values  = bruteForceDensity( pc, queries, kernel );
+
+    TreeDensityEstimator< PointCloud<double>, Kernel > estimator( pc, kernel, 8 );
+    estimator.setRelativeError( 0.05 );
+    estimator.setBatchSize( 7 );
+
+    auto densities = estimator( queries );
+
+    ALEPH_ASSERT_EQUAL( densities.size(), queries.size() );
+
+    for( std::size_t i = 0; i < densities.size(); i++ )
+    {
+      ALEPH_ASSERT_THROW( std::abs( densities[i] - values[i] ) <= 0.05 * values[i] + 1e-12 );
+      ALEPH_ASSERT_THROW( std::abs( estimator( queries.data() + i * 3 ) - densities[i] ) <= 1e-12 );
+    }
+
+    ALEPH_ASSERT_THROWS( estimator( PointCloud<double>( 2, 2 ) ), std::runtime_error );
+    ALEPH_ASSERT_THROWS( estimator.setAbsoluteError( -1.0 ), std::runtime_error );
+  }
+}
+
+void testKernels()
+{
+  ALEPH_TEST_BEGIN( "Tree-based kernel density estimation" );
+
+  using namespace aleph::containers;
+
+  testKernel( kernels::Gaussian( 0.5 ) );
+  testKernel( kernels::Epanechnikov( 0.5 ) );
+  testKernel( kernels::TruncatedGaussian( 0.5 ) );
+
+  // Degenerate point clouds -------------------------------------------
+
+  {
+    PointCloud<double> empty;
+    ALEPH_ASSERT_THROW( estimateDensity( empty, kernels::Gaussian() ).empty() );
+
+    // All points coincide, so the tree consists of a single leaf
+    PointCloud<double> pc( 100, 2 );
+
+    auto densities = estimateDensity( pc, kernels::Epanechnikov( 1.0 ) );
+
+    for( auto&& density : densities )
+      ALEPH_ASSERT_THROW( std::abs( density - 2.0 / M_PI ) < 1e-12 );
+  }
+
+  // The Gaussian kernel integrates to one -----------------------------
+
+  {
+    PointCloud<double> pc( 1, 2 );
+    PointCloud<double> grid( 201 * 201, 2 );
+
+    for( std::size_t i = 0; i < 201; i++ )
+      for( std::size_t j = 0; j < 201; j++ )
+        grid.set( i * 201 + j, { -5.0 + 0.05 * double(i), -5.0 + 0.05 * double(j) } );
+
+    TreeDensityEstimator< PointCloud<double>, kernels::Gaussian > estimator( pc, kernels::Gaussian( 0.7 ) );
+
+    double integral = 0.0;
+
+    for( auto&& value : estimator( grid ) )
+      integral += value * 0.05 * 0.05;
+
+    ALEPH_ASSERT_THROW( std::abs( integral - 1.0 ) < 1e-3 );
+  }
+
+  ALEPH_TEST_END();
+}
+
+void testTruncatedGaussian()
+{
+  ALEPH_TEST_BEGIN( "Truncated Gaussian estimator versus pairwise evaluation" );
+
+  auto pc = aleph::containers::load<double>( CMAKE_SOURCE_DIR + std::string( "/tests/input/Iris_comma_separated.txt" ) );
+  auto n  = pc.size();
+  auto d  = pc.dimension();
+
+  for( auto&& h : { 0.1, 0.2, 1.0 } )
+  {
+    auto densities = aleph::containers::estimateDensityTruncatedGaussian( pc, h );
+
+    ALEPH_ASSERT_EQUAL( densities.size(), n );
+
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      double density = 0.0;
+
+      for( std::size_t j = 0; j < n; j++ )
+      {
+        double distance = 0.0;
+
+        for( std::size_t c = 0; c < d; c++ )
+        {
+          auto z    = pc.data()[ i * d + c ] - pc.data()[ j * d + c ];
+          distance += z * z;
+        }
+
+        if( distance <= h * h )
+          density += std::exp( -distance / ( 2.0 * h ) );
+      }
+
+      density /= double( n );
+
+      ALEPH_ASSERT_THROW( std::abs( densities[i] - density ) < 1e-12 );
+    }
+  }
+
+  ALEPH_TEST_END();
+}
+
+void testVietorisRipsComplex()
+{
+  ALEPH_TEST_BEGIN( "Density filtration of a Vietoris--Rips complex" );
+
+  using PointCloud        = aleph::containers::PointCloud<double>;
+  using Distance          = aleph::distances::Euclidean<double>;
+  using NearestNeighbours = aleph::geometry::BruteForce<PointCloud, Distance>;
+
+  auto pc        = makeClusters( 200, 2, 7 );
+  auto densities = aleph::containers::estimateDensity( pc, aleph::containers::kernels::Gaussian( 0.3 ), 0.0, 1e-6 );
+
+  auto K = aleph::geometry::buildVietorisRipsComplex( NearestNeighbours( pc ),
+                                                      0.2,
+                                                      2,
+                                                      densities.begin(), densities.end() );
+
+  ALEPH_ASSERT_THROW( K.empty() == false );
+
+  for( auto&& s : K )
+  {
+    double value = 0.0;
+
+    for( auto&& v : s )
+      value = std::max( value, densities.at( v ) );
+
+    ALEPH_ASSERT_EQUAL( s.data(), value );
+  }
+
+  ALEPH_TEST_END();
+}
+
+int main( int, char** )
+{
+  testKernels();
+  testTruncatedGaussian();
+  testVietorisRipsComplex();
+}
@@ -0,0 +1,343 @@
+#include <aleph/config/Base.hh>
+#include <aleph/config/Eigen.hh>
+
+#include <tests/Base.hh>
+
+#include <aleph/containers/DimensionalityEstimators.hh>
+#include <aleph/containers/PointCloud.hh>
+
+#include <aleph/geometry/BruteForce.hh>
+
+#include <aleph/geometry/distances/Euclidean.hh>
+
+#include <aleph/math/PrincipalComponentAnalysis.hh>
+#include <aleph/math/SymmetricEigenvalues.hh>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cmath>
+
+using PointCloud        = aleph::containers::PointCloud<double>;
+using Distance          = aleph::distances::Euclidean<double>;
+using NearestNeighbours = aleph::geometry::BruteForce<PointCloud, Distance>;
+
+/**
+  Samples points from a linear subspace of the given dimension and adds
+  a small amount of noise in all ambient directions.
+*/
+
+PointCloud makeSubspace( std::size_t n, std::size_t d, std::size_t D, unsigned seed )
+{
+  std::mt19937 rng( seed );
+  std::uniform_real_distribution<double> uniform( -1.0, 1.0 );
+  std::normal_distribution<double> normal( 0.0, 1e-4 );
+
+  // Random orthonormal basis of the subspace, obtained by Gram--Schmidt
+  // orthogonalization. This ensures that local neighbourhoods are not
+  // stretched along one direction of the subspace.
+  std::vector<double> basis( d * D );
+
+  for( std::size_t j = 0; j < d; j++ )
+  {
+    auto b = basis.begin() + std::ptrdiff_t( j * D );
+
+    for( std::size_t c = 0; c < D; c++ )
+      b[ std::ptrdiff_t(c) ] = uniform( rng );
+
+    for( std::size_t l = 0; l < j; l++ )
+    {
+      auto a   = basis.begin() + std::ptrdiff_t( l * D );
+      auto dot = std::inner_product( a, a + std::ptrdiff_t( D ), b, 0.0 );
+
+      for( std::size_t c = 0; c < D; c++ )
+        b[ std::ptrdiff_t(c) ] -= dot * a[ std::ptrdiff_t(c) ];
+    }
+
+    auto norm = std::sqrt( std::inner_product( b, b + std::ptrdiff_t( D ), b, 0.0 ) );
+
+    for( std::size_t c = 0; c < D; c++ )
+      b[ std::ptrdiff_t(c) ] /= norm;
+  }
+
+  PointCloud pc( n, D );
+  std::vector<double> p( D );
+
+  for( std::size_t i = 0; i < n; i++ )
+  {
+    std::fill( p.begin(), p.end(), 0.0 );
+
+    for( std::size_t j = 0; j < d; j++ )
+    {
+      auto t = uniform( rng );
+
+      for( std::size_t c = 0; c < D; c++ )
+        p[c] += t * basis[ j * D + c ];
+    }
+
+    for( auto&& x : p )
+      x += normal( rng );
+
+    pc.set( i, p.begin(), p.end() );
+  }
+
+  return pc;
+}
+
+void testSymmetricEigenvalues()
+{
+  ALEPH_TEST_BEGIN( "Eigenvalues of small symmetric matrices" );
+
+  std::mt19937 rng( 42 );
+  std::uniform_real_distribution<double> uniform( -1.0, 1.0 );
+
+  aleph::math::SymmetricEigenvalues eigenvalues;
+
+  for( std::size_t n : { 1, 2, 3, 4, 5, 8, 9, 12 } )
+  {
+    for( unsigned trial = 0; trial < 10; trial++ )
+    {
+      std::vector<double> lambda( n );
+      std::vector<double> v( n );
+
+      for( auto&& l : lambda )
+        l = 10.0 * uniform( rng );
+
+      // Repeated eigenvalues must not pose a problem
+      if( trial == 0 && n > 2 )
+        lambda[1] = lambda[0];
+
+      double norm = 0.0;
+
+      for( auto&& x : v )
+      {
+        x     = uniform( rng );
+        norm += x * x;
+      }
+
+      // A = H diag(lambda) H, where H = I - 2 v v^T / |v|^2 is a
+      // Householder reflection, has the prescribed eigenvalues.
+      std::vector<double> H( n * n );
+      std::vector<double> A( n * n );
+
+      for( std::size_t i = 0; i < n; i++ )
+        for( std::size_t j = 0; j < n; j++ )
+          H[ i * n + j ] = ( i == j ? 1.0 : 0.0 ) - 2.0 * v[i] * v[j] / norm;
+
+      for( std::size_t i = 0; i < n; i++ )
+        for( std::size_t j = 0; j < n; j++ )
+          for( std::size_t k = 0; k < n; k++ )
+            A[ i * n + j ] += H[ i * n + k ] * lambda[k] * H[ k * n + j ];
+
+      auto result = eigenvalues( A, n );
+
+      std::sort( lambda.begin(), lambda.end(), std::greater<double>() );
+
+      ALEPH_ASSERT_EQUAL( result.size(), n );
+
+      for( std::size_t i = 0; i < n; i++ )
+        ALEPH_ASSERT_THROW( std::abs( result[i] - lambda[i] ) < 1e-10 );
+    }
+  }
+
+  ALEPH_TEST_END();
+}
+
+void testPCA()
+{
+  ALEPH_TEST_BEGIN( "Local PCA over a range of neighbourhoods" );
+
+  for( std::size_t D : { 2, 3, 4, 8 } )
+  {
+    for( std::size_t d = 1; d < std::min( D, std::size_t( 3 ) ); d++ )
+    {
+      auto pc        = makeSubspace( 300, d, D, unsigned( 7 * D + d ) );
+      auto estimates = aleph::containers::estimateLocalDimensionalityPCA<Distance, PointCloud, NearestNeighbours>( pc, 15, 25 );
+
+      ALEPH_ASSERT_EQUAL( estimates.size(), pc.size() );
+
+      std::size_t numCorrect = 0;
+
+      for( auto&& localEstimates : estimates )
+      {
+        ALEPH_ASSERT_EQUAL( localEstimates.size(), 11 );
+
+        for( auto&& estimate : localEstimates )
+          numCorrect += estimate == d;
+      }
+
+      // Neighbourhoods at the boundary of the sample are only partially
+      // filled, which may result in an underestimate.
+      ALEPH_ASSERT_THROW( double( numCorrect ) >= 0.9 * double( 11 * pc.size() ) );
+    }
+  }
+
+  // Neighbourhoods that are larger than the data set ------------------
+
+  {
+    auto pc        = makeSubspace( 5, 1, 3, 23 );
+    auto estimates = aleph::containers::estimateLocalDimensionalityPCA<Distance, PointCloud, NearestNeighbours>( pc, 3, 10 );
+
+    for( auto&& localEstimates : estimates )
+      for( auto&& estimate : localEstimates )
+        ALEPH_ASSERT_EQUAL( estimate, 1 );
+  }
+
+  ALEPH_TEST_END();
+}
+
+void testPCAReference()
+{
+  ALEPH_TEST_BEGIN( "Local PCA versus explicit principal component analysis" );
+
+#ifdef ALEPH_WITH_EIGEN
+  auto pc = aleph::containers::load<double>( CMAKE_SOURCE_DIR + std::string( "/tests/input/Iris_comma_separated.txt" ) );
+
+  std::vector< std::vector<std::size_t> > indices;
+  std::vector< std::vector<double> > distances;
+
+  NearestNeighbours nn( pc );
+  nn.neighbourSearch( 16, indices, distances );
+
+  auto estimates = aleph::containers::estimateLocalDimensionalityPCA<Distance, PointCloud, NearestNeighbours>( pc, 3, 15 );
+
+  for( std::size_t i = 0; i < pc.size(); i++ )
+  {
+    for( std::size_t k = 3; k <= 15; k++ )
+    {
+      std::vector< std::vector<double> > data;
+
+      for( std::size_t j = 0; j <= k; j++ )
+        data.push_back( pc[ indices[i][j] ] );
+
+      aleph::math::PrincipalComponentAnalysis pca;
+      auto singularValues = pca( data ).singularValues;
+
+      ALEPH_ASSERT_EQUAL( estimates[i][k-3],
+                          aleph::containers::detail::largestGapIndex( singularValues.data(), singularValues.size() ) );
+    }
+  }
+
+  auto single = aleph::containers::estimateLocalDimensionalityPCA<Distance, PointCloud, NearestNeighbours>( pc, 8 );
+
+  ALEPH_ASSERT_EQUAL( single.size(), pc.size() );
+
+  for( std::size_t i = 0; i < pc.size(); i++ )
+    ALEPH_ASSERT_EQUAL( single[i], estimates[i][8-3] );
+#endif
+
+  ALEPH_TEST_END();
+}
+
+void testNearestNeighbours()
+{
+  ALEPH_TEST_BEGIN( "Nearest neighbour estimators versus explicit sums" );
+
+  auto pc = makeSubspace( 500, 2, 4, 11 );
+
+  std::vector< std::vector<std::size_t> > indices;
+  std::vector< std::vector<double> > distances;
+
+  NearestNeighbours nn( pc );
+  nn.neighbourSearch( 21, indices, distances );
+
+  auto relativeError = [] ( double x, double y )
+  {
+    return std::abs( x - y ) / std::max( 1.0, std::abs( y ) );
+  };
+
+  // Single neighbourhood size -----------------------------------------
+
+  {
+    unsigned k     = 10;
+    auto estimates = aleph::containers::estimateLocalDimensionalityNearestNeighbours<Distance, PointCloud, NearestNeighbours>( pc, k );
+
+    for( std::size_t i = 0; i < pc.size(); i++ )
+    {
+      double r1 = 0.0;
+      double r2 = 0.0;
+
+      for( unsigned j = 0; j < k; j++ )
+        r1 += distances[i][j];
+
+      r2  = ( r1 + distances[i][k] ) / ( k + 1 );
+      r1 /= k;
+
+      ALEPH_ASSERT_THROW( relativeError( estimates[i], r1 / ( (r2-r1)*k ) ) < 1e-9 );
+    }
+  }
+
+  // Regression over a range of neighbourhood sizes --------------------
+
+  {
+    unsigned kMin  = 5;
+    unsigned kMax  = 20;
+    auto estimates = aleph::containers::estimateLocalDimensionalityNearestNeighbours<Distance, PointCloud, NearestNeighbours>( pc, kMin, kMax );
+
+    for( std::size_t i = 0; i < pc.size(); i++ )
+    {
+      double s = 0.0;
+      double t = 0.0;
+
+      for( unsigned k = kMin; k + 1 < kMax; k++ )
+      {
+        double r1 = 0.0;
+        double r2 = 0.0;
+
+        for( unsigned j = 0; j < k; j++ )
+          r1 += distances[i][j];
+
+        r2  = ( r1 + distances[i][k] ) / ( k + 1 );
+        r1 /= k;
+
+        s += ( (r2-r1) * r1 ) / k;
+        t += ( (r2-r1) * (r2-r1) );
+      }
+
+      ALEPH_ASSERT_THROW( relativeError( estimates[i], s / t ) < 1e-9 );
+    }
+  }
+
+  // Maximum likelihood estimates --------------------------------------
+
+  {
+    unsigned kMin  = 5;
+    unsigned kMax  = 20;
+    auto estimates = aleph::containers::estimateLocalDimensionalityNearestNeighboursMLE<Distance, PointCloud, NearestNeighbours>( pc, kMin, kMax );
+
+    for( std::size_t i = 0; i < pc.size(); i++ )
+    {
+      double sum = 0.0;
+
+      for( unsigned k = kMin - 1; k < kMax; k++ )
+      {
+        double mk = 0.0;
+
+        for( unsigned j = 0; j < k; j++ )
+        {
+          if( distances[i][j] > 0.0 && distances[i][k] > 0.0 )
+            mk += std::log( distances[i][k] / distances[i][j] );
+        }
+
+        mk = k > 1 ? mk / ( k - 1 ) : 0.0;
+        sum += mk > 0.0 ? 1.0 / mk : 0.0;
+      }
+
+      ALEPH_ASSERT_THROW( relativeError( estimates[i], sum / ( kMax - kMin + 1 ) ) < 1e-9 );
+    }
+  }
+
+  ALEPH_TEST_END();
+}
+
+int main( int, char** )
+{
+  testSymmetricEigenvalues();
+  testPCA();
+  testPCAReference();
+  testNearestNeighbours();
+}
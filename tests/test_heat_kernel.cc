@@ -3,10 +3,16 @@
 #include <aleph/config/Eigen.hh>
 
 #include <aleph/geometry/HeatKernel.hh>
+#include <aleph/geometry/SparseHeatKernel.hh>
 
 #include <aleph/topology/Simplex.hh>
 #include <aleph/topology/SimplicialComplex.hh>
 
+#include <algorithm>
+#include <vector>
+
+#include <cmath>
+
 template <class T> aleph::topology::SimplicialComplex< aleph::topology::Simplex<T, unsigned> > createTestSimplicialComplex()
 {
   using Simplex           = typename aleph::topology::Simplex<T, unsigned>;
@@ -26,6 +32,204 @@ template <class T> aleph::topology::SimplicialComplex< aleph::topology::Simplex<
   return SimplicialComplex( simplices.begin(), simplices.end() );
 }
 
+/** Creates a grid graph with m x n vertices and unit edge weights */
+aleph::topology::SimplicialComplex< aleph::topology::Simplex<double, unsigned> > createGridSimplicialComplex( unsigned m, unsigned n )
+{
+  using Simplex           = aleph::topology::Simplex<double, unsigned>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+  std::vector<Simplex> simplices;
+
+  for( unsigned i = 0; i < m; i++ )
+  {
+    for( unsigned j = 0; j < n; j++ )
+    {
+      auto u = i * n + j;
+
+      simplices.push_back( Simplex( {u}, 1.0 ) );
+
+      if( j + 1 < n )
+        simplices.push_back( Simplex( {u, u + 1}, 1.0 ) );
+
+      if( i + 1 < m )
+        simplices.push_back( Simplex( {u, u + n}, 1.0 ) );
+    }
+  }
+
+  return SimplicialComplex( simplices.begin(), simplices.end() );
+}
+
+/**
+  @returns Laplacian eigenvalues of a grid graph in ascending order; they
+  are the sums of the eigenvalues of two paths.
+*/
+
+std::vector<double> gridEigenvalues( unsigned m, unsigned n )
+{
+  auto pi = std::acos( -1.0 );
+
+  std::vector<double> result;
+
+  for( unsigned k = 0; k < m; k++ )
+    for( unsigned l = 0; l < n; l++ )
+      result.push_back( 4 - 2 * std::cos( pi * k / m ) - 2 * std::cos( pi * l / n ) );
+
+  std::sort( result.begin(), result.end() );
+  return result;
+}
+
+void testSparseLaplacian()
+{
+  ALEPH_TEST_BEGIN( "Sparse Laplacian" );
+
+  auto K = createTestSimplicialComplex<double>();
+  auto L = aleph::geometry::sparseLaplacianMatrix( K );
+
+  ALEPH_ASSERT_EQUAL( L.size(), 4 );
+
+  std::vector<double> expectedValues = {
+      2,-1,-1, 0,
+     -1, 3,-1,-1,
+     -1,-1, 2, 0,
+      0,-1, 0, 1,
+  };
+
+  // Multiplying with the identity matrix, stored as a block of four
+  // vectors, yields the full Laplacian.
+  std::vector<double> I( 16 );
+  std::vector<double> actualValues( 16 );
+
+  for( std::size_t i = 0; i < 4; i++ )
+    I[ i * 4 + i ] = 1.0;
+
+  L.multiply( I.data(), actualValues.data(), 4 );
+
+  ALEPH_ASSERT_THROW( actualValues == expectedValues );
+  ALEPH_ASSERT_EQUAL( L.degree(1), 3.0 );
+  ALEPH_ASSERT_THROW( L.spectralBound() >= 6.0 );
+
+  ALEPH_TEST_END();
+}
+
+void testTridiagonalEigenDecomposition()
+{
+  ALEPH_TEST_BEGIN( "Tridiagonal eigendecomposition" );
+
+  // The matrix with 2 on its diagonal and -1 on its subdiagonal has the
+  // eigenvalues 2 - 2 cos( k pi / (n+1) )
+
+  std::size_t n = 12;
+  auto pi       = std::acos( -1.0 );
+
+  std::vector<double> diagonal( n, 2.0 );
+  std::vector<double> subdiagonal( n - 1, -1.0 );
+  std::vector<double> Z;
+
+  aleph::geometry::detail::tridiagonalEigenDecomposition( diagonal, subdiagonal, Z );
+
+  for( std::size_t k = 0; k < n; k++ )
+    ALEPH_ASSERT_THROW( std::abs( diagonal[k] - ( 2 - 2 * std::cos( pi * double( k + 1 ) / double( n + 1 ) ) ) ) < 1e-12 );
+
+  // Every column is an eigenvector of unit length
+  for( std::size_t k = 0; k < n; k++ )
+  {
+    double norm = 0.0;
+
+    for( std::size_t i = 0; i < n; i++ )
+    {
+      auto z  = Z[ i * n + k ];
+      auto Az = 2 * z;
+
+      if( i > 0 )
+        Az -= Z[ ( i - 1 ) * n + k ];
+
+      if( i + 1 < n )
+        Az -= Z[ ( i + 1 ) * n + k ];
+
+      ALEPH_ASSERT_THROW( std::abs( Az - diagonal[k] * z ) < 1e-12 );
+
+      norm += z * z;
+    }
+
+    ALEPH_ASSERT_THROW( std::abs( norm - 1.0 ) < 1e-12 );
+  }
+
+  ALEPH_TEST_END();
+}
+
+void testSparseHeatKernel()
+{
+  ALEPH_TEST_BEGIN( "Sparse heat kernel" );
+
+  unsigned m = 7;
+  unsigned n = 9;
+
+  auto K = createGridSimplicialComplex( m, n );
+  auto L = aleph::geometry::sparseLaplacianMatrix( K );
+
+  std::vector<double> times = { 0.01, 0.1, 1.0, 10.0 };
+
+  // The full spectrum yields the exact heat kernel signatures -----------
+
+  aleph::geometry::LanczosHeatKernel exact( L, m * n, m * n );
+
+  auto eigenvalues = gridEigenvalues( m, n );
+
+  ALEPH_ASSERT_EQUAL( exact.eigenvalues().size(), eigenvalues.size() );
+
+  for( std::size_t k = 0; k < eigenvalues.size(); k++ )
+    ALEPH_ASSERT_THROW( std::abs( exact.eigenvalues()[k] - eigenvalues[k] ) < 1e-8 );
+
+  auto reference = exact.signatures( times );
+
+  // The heat operator at t = 0 is the identity matrix
+  for( auto&& h : exact.signatures( { 0.0 } ) )
+    ALEPH_ASSERT_THROW( std::abs( h - 1.0 ) < 1e-8 );
+
+  // Truncated spectrum ------------------------------------------------
+
+  {
+    aleph::geometry::LanczosHeatKernel truncated( L, 10 );
+
+    ALEPH_ASSERT_EQUAL( truncated.eigenvalues().size(), 10 );
+
+    for( std::size_t k = 0; k < 10; k++ )
+      ALEPH_ASSERT_THROW( std::abs( truncated.eigenvalues()[k] - eigenvalues[k] ) < 1e-6 );
+
+    // Large time scales are dominated by the smallest eigenvalues
+    auto signatures = truncated.signatures( { 10.0 } );
+
+    for( std::size_t i = 0; i < signatures.size(); i++ )
+      ALEPH_ASSERT_THROW( std::abs( signatures[i] - reference[ i * times.size() + 3 ] ) < 1e-6 );
+  }
+
+  // Chebyshev expansion -----------------------------------------------
+
+  {
+    aleph::geometry::ChebyshevHeatKernel chebyshev( L );
+    chebyshev.setNumProbes( 0 );
+
+    auto signatures = chebyshev.signatures( times );
+
+    ALEPH_ASSERT_EQUAL( signatures.size(), reference.size() );
+
+    for( std::size_t i = 0; i < signatures.size(); i++ )
+      ALEPH_ASSERT_THROW( std::abs( signatures[i] - reference[i] ) < 1e-8 );
+
+    // The stochastic estimate of the trace is unbiased; its error
+    // decreases with the number of probes.
+    chebyshev.setNumProbes( 256 );
+
+    auto trace1 = chebyshev.trace( times );
+    auto trace2 = exact.trace( times );
+
+    for( std::size_t s = 0; s < times.size(); s++ )
+      ALEPH_ASSERT_THROW( std::abs( trace1[s] - trace2[s] ) < 0.05 * trace2[s] );
+  }
+
+  ALEPH_TEST_END();
+}
+
 #ifdef ALEPH_WITH_EIGEN
 
 template <class T> void testWeightedLaplacianMatrix()
@@ -86,15 +290,49 @@ template <class T> void testHeatKernelSimple()
   ALEPH_TEST_END();
 }
 
+void testSparseHeatKernelDense()
+{
+  ALEPH_TEST_BEGIN( "Sparse heat kernel versus dense heat kernel" );
+
+  auto K = createGridSimplicialComplex( 4, 5 );
+
+  aleph::geometry::HeatKernel hk( K );
+  aleph::geometry::LanczosHeatKernel lhk( aleph::geometry::sparseLaplacianMatrix( K ), 20 );
+
+  // The dense heat kernel skips the constant eigenvector, which adds
+  // 1/n to the signature of every vertex of a connected graph.
+  for( auto&& t : { 0.1, 1.0, 5.0 } )
+  {
+    auto signatures = lhk.signatures( { t } );
+    auto diagonal   = hk( t );
+
+    ALEPH_ASSERT_EQUAL( diagonal.size(), signatures.size() );
+
+    for( unsigned i = 0; i < 20; i++ )
+    {
+      ALEPH_ASSERT_THROW( std::abs( hk( i, t ) + 1.0 / 20 - signatures[i] ) < 1e-8 );
+      ALEPH_ASSERT_THROW( std::abs( diagonal[i] + 1.0 / 20 - signatures[i] ) < 1e-8 );
+    }
+  }
+
+  ALEPH_TEST_END();
+}
+
 #endif
 
 int main( int, char** )
 {
+  testSparseLaplacian();
+  testTridiagonalEigenDecomposition();
+  testSparseHeatKernel();
+
 #ifdef ALEPH_WITH_EIGEN
   testWeightedLaplacianMatrix<float> ();
   testWeightedLaplacianMatrix<double>();
 
   testHeatKernelSimple<float> ();
   testHeatKernelSimple<double>();
+
+  testSparseHeatKernelDense();
 #endif
 }
@@ -0,0 +1,119 @@
+#include <tests/Base.hh>
+
+#include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+#include <aleph/persistenceDiagrams/io/Archive.hh>
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+template <class T, class S> void testRoundTrip()
+{
+  using PersistenceDiagram = aleph::PersistenceDiagram<T>;
+
+  std::vector<PersistenceDiagram> diagrams( 3 );
+
+  diagrams[0].setDimension( 0 );
+  diagrams[0].add( T(0), T(1) );
+  diagrams[0].add( T(0.5), std::numeric_limits<T>::infinity() );
+
+  diagrams[1].setDimension( 2 );
+
+  diagrams[2].setDimension( 1 );
+  for( unsigned i = 0; i < 100; i++ )
+    diagrams[2].add( T(i), T(2*i+1) );
+
+  aleph::tests::TemporaryFile file( "aleph_archive" );
+  auto&& filename = file.filename();
+
+  {
+    aleph::io::ArchiveWriter<S> writer( filename );
+
+    writer( diagrams[0], "first" );
+    writer( diagrams[1] );
+    writer( diagrams[2], "third" );
+  }
+
+  {
+    aleph::io::Archive archive( filename );
+
+    ALEPH_ASSERT_EQUAL( archive.size(),      3         );
+    ALEPH_ASSERT_EQUAL( archive.valueSize(), sizeof(S) );
+
+    ALEPH_ASSERT_THROW( archive.name(0) == "first" );
+    ALEPH_ASSERT_THROW( archive.name(1).empty()    );
+    ALEPH_ASSERT_THROW( archive.name(2) == "third" );
+
+    for( std::size_t i = 0; i < diagrams.size(); i++ )
+    {
+      auto D = archive.template diagram<T>( i );
+
+      ALEPH_ASSERT_THROW( D == diagrams[i] );
+      ALEPH_ASSERT_EQUAL( D.dimension(),       diagrams[i].dimension() );
+      ALEPH_ASSERT_EQUAL( archive.size(i),     diagrams[i].size()      );
+      ALEPH_ASSERT_EQUAL( archive.dimension(i), diagrams[i].dimension() );
+    }
+
+    // Columns can be accessed in place
+    auto x = archive.template births<S>( 2 );
+    auto y = archive.template deaths<S>( 2 );
+
+    ALEPH_ASSERT_EQUAL( x[10], S(10) );
+    ALEPH_ASSERT_EQUAL( y[10], S(21) );
+
+    // Mismatched types and invalid indices must be detected
+    using U = typename std::conditional<std::is_same<S, float>::value, double, float>::type;
+
+    ALEPH_ASSERT_THROWS( archive.template births<U>( 0 ), std::runtime_error );
+    ALEPH_ASSERT_THROWS( archive.dimension( 3 ),          std::out_of_range   );
+  }
+}
+
+void testInvalid()
+{
+  aleph::tests::TemporaryFile file( "aleph_archive" );
+  auto&& filename = file.filename();
+
+  {
+    std::ofstream out( filename );
+    out << "0 1\n"
+        << "1 2\n";
+  }
+
+  ALEPH_ASSERT_THROWS( aleph::io::Archive( filename ), std::runtime_error );
+
+  // Truncating a valid archive must be detected as well
+  {
+    aleph::io::ArchiveWriter<double> writer( filename );
+    aleph::PersistenceDiagram<double> D;
+
+    D.add( 0.0, 1.0 );
+    writer( D );
+  }
+
+  {
+    std::ifstream in( filename, std::ios::binary );
+    std::string contents( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+
+    in.close();
+
+    std::ofstream out( filename, std::ios::binary | std::ios::trunc );
+    out.write( contents.data(), static_cast<std::streamsize>( contents.size() - 8 ) );
+  }
+
+  ALEPH_ASSERT_THROWS( aleph::io::Archive( filename ), std::runtime_error );
+}
+
+int main(int, char**)
+{
+  testRoundTrip<double, double>();
+  testRoundTrip<double, float >();
+  testRoundTrip<float,  float >();
+  testRoundTrip<float,  double>();
+
+  testInvalid();
+}
@@ -0,0 +1,180 @@
+#include <tests/Base.hh>
+
+#include <aleph/topology/BoundaryMatrix.hh>
+#include <aleph/topology/Conversions.hh>
+#include <aleph/topology/Simplex.hh>
+#include <aleph/topology/SimplicialComplex.hh>
+
+#include <aleph/topology/filtrations/Data.hh>
+
+#include <aleph/topology/io/Binary.hh>
+
+#include <aleph/topology/representations/Set.hh>
+#include <aleph/topology/representations/Vector.hh>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Creates the full simplicial complex on n vertices, up to dimension 2,
+// with weights that depend on the vertices.
+template <class SimplicialComplex> SimplicialComplex makeComplex( unsigned n )
+{
+  using Simplex    = typename SimplicialComplex::ValueType;
+  using DataType   = typename Simplex::DataType;
+  using VertexType = typename Simplex::VertexType;
+
+  std::vector<Simplex> simplices;
+
+  for( VertexType i = 0; i < n; i++ )
+    simplices.push_back( Simplex( i, DataType( 0 ) ) );
+
+  for( VertexType i = 0; i < n; i++ )
+    for( VertexType j = VertexType( i+1 ); j < n; j++ )
+      simplices.push_back( Simplex( {i,j}, DataType( i+j ) ) );
+
+  for( VertexType i = 0; i < n; i++ )
+    for( VertexType j = VertexType( i+1 ); j < n; j++ )
+      for( VertexType k = VertexType( j+1 ); k < n; k++ )
+        simplices.push_back( Simplex( {i,j,k}, DataType( i+j+k ) ) );
+
+  SimplicialComplex K( simplices.begin(), simplices.end() );
+  K.sort( aleph::topology::filtrations::Data<Simplex>() );
+
+  return K;
+}
+
+template <class D, class V> void testSimplicialComplex()
+{
+  ALEPH_TEST_BEGIN( "Binary simplicial complex" );
+
+  using Simplex           = aleph::topology::Simplex<D, V>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+  auto K = makeComplex<SimplicialComplex>( 10 );
+
+  aleph::tests::TemporaryFile file( "aleph_binary" );
+  auto&& filename = file.filename();
+
+  aleph::topology::io::BinaryWriter writer;
+  writer( filename, K );
+
+  {
+    SimplicialComplex L;
+
+    aleph::topology::io::BinaryReader reader;
+    reader( filename, L );
+
+    ALEPH_ASSERT_THROW( K == L );
+
+    for( std::size_t i = 0; i < K.size(); i++ )
+      ALEPH_ASSERT_EQUAL( K[i].data(), L[i].data() );
+  }
+
+  {
+    aleph::topology::io::SimplicialComplexView<Simplex> view( filename );
+
+    ALEPH_ASSERT_EQUAL( view.size(), K.size() );
+
+    auto range = view.vertices( K.size() - 1 );
+
+    ALEPH_ASSERT_EQUAL( std::distance( range.first, range.second ), 3 );
+    ALEPH_ASSERT_THROW( view[ K.size() - 1 ] == K[ K.size() - 1 ] );
+  }
+
+  // Requesting different types must fail
+  {
+    using OtherSimplex           = aleph::topology::Simplex<D, unsigned long long>;
+    using OtherSimplicialComplex = aleph::topology::SimplicialComplex<OtherSimplex>;
+
+    OtherSimplicialComplex M;
+    aleph::topology::io::BinaryReader reader;
+
+    ALEPH_ASSERT_THROWS( reader( filename, M ), std::runtime_error );
+  }
+
+  // Corrupting a single byte must be detected by the checksum, unless
+  // the checksum is not verified.
+  {
+    {
+      std::fstream stream( filename, std::ios::in | std::ios::out | std::ios::binary );
+      stream.seekp( -1, std::ios::end );
+      stream.put( 0x7f );
+    }
+
+    SimplicialComplex M;
+    aleph::topology::io::BinaryReader reader;
+
+    ALEPH_ASSERT_THROWS( reader( filename, M ), std::runtime_error );
+
+    M.clear();
+
+    reader.setVerifyChecksum( false );
+    reader( filename, M );
+
+    ALEPH_ASSERT_EQUAL( M.size(), K.size() );
+  }
+
+  ALEPH_TEST_END();
+}
+
+template <class Representation> void testBoundaryMatrix()
+{
+  ALEPH_TEST_BEGIN( "Binary boundary matrix" );
+
+  using Simplex           = aleph::topology::Simplex<double, unsigned>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+  using BoundaryMatrix    = aleph::topology::BoundaryMatrix<Representation>;
+
+  auto K = makeComplex<SimplicialComplex>( 8 );
+  auto M = aleph::topology::makeBoundaryMatrix<Representation>( K );
+  auto N = M.dualize();
+
+  aleph::tests::TemporaryFile file( "aleph_binary" );
+  auto&& filename = file.filename();
+
+  aleph::topology::io::BinaryWriter writer;
+  aleph::topology::io::BinaryReader reader;
+
+  {
+    BoundaryMatrix L;
+
+    writer( filename, M );
+    reader( filename, L );
+
+    ALEPH_ASSERT_THROW( L == M );
+  }
+
+  {
+    BoundaryMatrix L;
+
+    writer( filename, N );
+    reader( filename, L );
+
+    ALEPH_ASSERT_THROW( L == N );
+    ALEPH_ASSERT_THROW( L.isDualized() );
+
+    for( unsigned j = 0; j < N.getNumColumns(); j++ )
+      ALEPH_ASSERT_EQUAL( L.getDimension(j), N.getDimension(j) );
+  }
+
+  // A boundary matrix is not a simplicial complex
+  {
+    SimplicialComplex L;
+    ALEPH_ASSERT_THROWS( reader( filename, L ), std::runtime_error );
+  }
+
+  ALEPH_TEST_END();
+}
+
+int main(int, char**)
+{
+  testSimplicialComplex<double, unsigned>();
+  testSimplicialComplex<float,  unsigned short>();
+  testSimplicialComplex<int,    unsigned>();
+
+  testBoundaryMatrix< aleph::topology::representations::Vector<unsigned> >();
+  testBoundaryMatrix< aleph::topology::representations::Set<unsigned> >();
+}
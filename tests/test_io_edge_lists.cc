@@ -0,0 +1,203 @@
+#include <tests/Base.hh>
+
+#include <aleph/topology/Simplex.hh>
+#include <aleph/topology/SimplicialComplex.hh>
+#include <aleph/topology/WeightedGraph.hh>
+
+#include <aleph/topology/io/EdgeLists.hh>
+#include <aleph/topology/io/ParallelEdgeLists.hh>
+
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+void writeFile( const std::string& filename, const std::string& contents )
+{
+  std::ofstream out( filename );
+  out << contents;
+}
+
+template <class SimplicialComplex> bool equal( const SimplicialComplex& K, const SimplicialComplex& L )
+{
+  if( K.size() != L.size() )
+    return false;
+
+  auto it = L.begin();
+  for( auto&& s : K )
+  {
+    if( s != *it || s.data() != it->data() )
+      return false;
+
+    ++it;
+  }
+
+  return true;
+}
+
+template <class T> void testNumeric()
+{
+  ALEPH_TEST_BEGIN( "Parallel edge list reader: numeric identifiers" );
+
+  using DataType          = T;
+  using VertexType        = unsigned;
+  using Simplex           = aleph::topology::Simplex<DataType, VertexType>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+  std::mt19937 rng( 42 );
+  std::uniform_int_distribution<VertexType> vertices( 0, 199 );
+  std::uniform_int_distribution<int> weights( 0, 100 );
+
+  std::ostringstream stream;
+  stream << "# Comment\n"
+         << "% Another comment\n"
+         << "\n";
+
+  for( unsigned i = 0; i < 2000; i++ )
+  {
+    stream << vertices( rng ) << " " << vertices( rng ) << "\t" << weights( rng ) << "\n";
+
+    if( i % 100 == 0 )
+      stream << "  \n";
+  }
+
+  // Missing newline at the end
+  stream << "3 3 1";
+
+  aleph::tests::TemporaryFile file( "aleph_edge_list" );
+  auto&& filename = file.filename();
+
+  writeFile( filename, stream.str() );
+
+  SimplicialComplex K;
+  SimplicialComplex L;
+
+  aleph::topology::io::EdgeListReader reader;
+  reader( filename, K );
+
+  aleph::topology::io::ParallelEdgeListReader parallelReader;
+  parallelReader.setChunkSize( 512 );
+  parallelReader( filename, L );
+
+  ALEPH_ASSERT_THROW( equal( K, L ) );
+  ALEPH_ASSERT_THROW( parallelReader.statistics().chunks > 1 );
+  ALEPH_ASSERT_EQUAL( parallelReader.statistics().edges, 2001 );
+  ALEPH_ASSERT_THROW( parallelReader.labels().empty() );
+
+  // Graph -------------------------------------------------------------
+
+  auto G = parallelReader.readGraph<VertexType, DataType>( filename );
+
+  std::size_t numEdges = 0;
+
+  for( auto&& s : K )
+  {
+    if( s.dimension() != 1 )
+      continue;
+
+    ++numEdges;
+
+    auto u     = s[0];
+    auto v     = s[1];
+    bool found = false;
+
+    for( std::size_t k = 0; k < G.degree(u); k++ )
+    {
+      if( G.neighbour(u,k) == v )
+      {
+        found = true;
+        ALEPH_ASSERT_THROW( G.weight(u,k) == s.data() );
+      }
+
+      if( k > 0 )
+        ALEPH_ASSERT_THROW( G.neighbour(u,k-1) < G.neighbour(u,k) );
+    }
+
+    ALEPH_ASSERT_THROW( found );
+  }
+
+  ALEPH_ASSERT_EQUAL( G.edges(), numEdges );
+  ALEPH_ASSERT_THROW( G.size() <= 200 );
+
+  ALEPH_TEST_END();
+}
+
+void testLabels()
+{
+  ALEPH_TEST_BEGIN( "Parallel edge list reader: labels" );
+
+  using DataType          = float;
+  using VertexType        = unsigned;
+  using Simplex           = aleph::topology::Simplex<DataType, VertexType>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+  std::vector<std::string> names = { "alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta" };
+
+  std::mt19937 rng( 23 );
+  std::uniform_int_distribution<std::size_t> indices( 0, names.size() - 1 );
+
+  std::ostringstream stream;
+
+  for( unsigned i = 0; i < 500; i++ )
+    stream << names[ indices( rng ) ] << " " << names[ indices( rng ) ] << " " << i << "\n";
+
+  aleph::tests::TemporaryFile file( "aleph_edge_list" );
+  auto&& filename = file.filename();
+
+  writeFile( filename, stream.str() );
+
+  SimplicialComplex K;
+  SimplicialComplex L;
+
+  aleph::topology::io::EdgeListReader reader;
+  reader( filename, K );
+
+  aleph::topology::io::ParallelEdgeListReader parallelReader;
+  parallelReader.setChunkSize( 64 );
+  parallelReader( filename, L );
+
+  ALEPH_ASSERT_THROW( equal( K, L ) );
+  ALEPH_ASSERT_EQUAL( parallelReader.labels().size(), names.size() );
+
+  auto G = parallelReader.readGraph<VertexType, DataType>( filename );
+
+  ALEPH_ASSERT_EQUAL( G.size(), names.size() );
+
+  ALEPH_TEST_END();
+}
+
+void testErrors()
+{
+  ALEPH_TEST_BEGIN( "Parallel edge list reader: errors" );
+
+  using Simplex = aleph::topology::Simplex<double, unsigned>;
+
+  aleph::topology::io::ParallelEdgeListReader reader;
+
+  {
+    aleph::tests::TemporaryFile file( "aleph_edge_list" );
+    writeFile( file.filename(), "1 2\n3 foo\n" );
+
+    ALEPH_ASSERT_THROWS( reader.readSimplices<Simplex>( file.filename() ),      std::runtime_error );
+    ALEPH_ASSERT_THROWS( reader.readSimplices<Simplex>( "/nonexistent/file" ), std::runtime_error );
+  }
+
+  {
+    aleph::tests::TemporaryFile file( "aleph_edge_list" );
+
+    ALEPH_ASSERT_THROW( reader.readSimplices<Simplex>( file.filename() ).empty() );
+    auto G = reader.readGraph<unsigned, double>( file.filename() );
+    ALEPH_ASSERT_EQUAL( G.size(), 0 );
+  }
+
+  ALEPH_TEST_END();
+}
+
+int main( int, char** )
+{
+  testNumeric<float>();
+  testNumeric<double>();
+  testLabels();
+  testErrors();
+}
@@ -7,6 +7,10 @@
 
 #include <aleph/topology/io/HDF5.hh>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 template <class D, class V> void test()
 {
   ALEPH_TEST_BEGIN( "HDF5 file simple data set parsing" );
@@ -45,6 +49,136 @@ template <class D, class V> void test()
   checkSimplexCount( K );
   checkSimplexCount( L );
 
+  // Contiguous data sets are read in slabs of the requested size, which
+  // must not change the resulting simplicial complex
+  {
+    SimplicialComplex M;
+
+    aleph::topology::io::HDF5GridReader gridReader;
+    gridReader.setDataSetName( "Simple" );
+    gridReader.setSlabSize( 3 );
+
+    std::size_t numSlabs = 0;
+
+    gridReader.read<D>( CMAKE_SOURCE_DIR + std::string( "/tests/input/Simple.h5" ),
+                        [&numSlabs] ( const aleph::topology::GridSlab<D>& ) { ++numSlabs; } );
+
+    gridReader( CMAKE_SOURCE_DIR + std::string( "/tests/input/Simple.h5" ), M );
+
+    ALEPH_ASSERT_EQUAL( numSlabs, 3 );
+    checkSimplexCount( M );
+  }
+
+  ALEPH_TEST_END();
+}
+
+template <class D, class V> void testChunked()
+{
+  ALEPH_TEST_BEGIN( "HDF5 file chunked data set streaming" );
+
+  using Simplex           = aleph::topology::Simplex<D, V>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+  aleph::tests::TemporaryFile temporary( "aleph_hdf5" );
+  auto&& filename = temporary.filename();
+
+  // A 3D grid of integers, stored in chunks of two layers; the number of
+  // layers is not divisible by the chunk size.
+  std::vector<hsize_t> dimensions = { 5, 4, 3 };
+  std::vector<int> values( 5*4*3 );
+
+  for( std::size_t i = 0; i < values.size(); i++ )
+    values[i] = static_cast<int>( ( i * 13 ) % 17 );
+
+  {
+    H5::H5File file( filename, H5F_ACC_TRUNC );
+    H5::DataSpace dataSpace( 3, dimensions.data() );
+    H5::DSetCreatPropList properties;
+
+    std::vector<hsize_t> chunk = { 2, 4, 3 };
+    properties.setChunk( 3, chunk.data() );
+
+    auto dataSet = file.createDataSet( "Grid", H5::PredType::STD_I32LE, dataSpace, properties );
+    dataSet.write( values.data(), H5::PredType::NATIVE_INT );
+  }
+
+  aleph::topology::io::HDF5GridReader reader;
+  reader.setDataSetName( "Grid" );
+
+  std::vector<std::size_t> offsets;
+  std::vector<D> data;
+
+  reader.read<D>( filename, [&] ( const aleph::topology::GridSlab<D>& slab )
+  {
+    ALEPH_ASSERT_EQUAL( slab.dimensions.size(), 3 );
+    ALEPH_ASSERT_THROW( slab.layers <= 2 );
+
+    offsets.push_back( slab.offset );
+    data.insert( data.end(), slab.values.begin(), slab.values.end() );
+  } );
+
+  ALEPH_ASSERT_THROW( offsets == std::vector<std::size_t>( { 0, 2, 4 } ) );
+  ALEPH_ASSERT_EQUAL( data.size(), values.size() );
+  ALEPH_ASSERT_THROW( std::equal( data.begin(), data.end(), values.begin(),
+                                  [] ( D a, int b ) { return a == D( b ); } ) );
+
+  SimplicialComplex K;
+  reader( filename, K );
+
+  auto n0 = std::count_if( K.begin(), K.end(), [] ( const Simplex& s ) { return s.dimension() == 0; } );
+  auto n3 = std::count_if( K.begin(), K.end(), [] ( const Simplex& s ) { return s.dimension() == 3; } );
+
+  ALEPH_ASSERT_EQUAL( n0, 5*4*3 );
+  ALEPH_ASSERT_EQUAL( n3, 6 * 4*3*2 );
+
+  ALEPH_TEST_END();
+}
+
+template <class D, class V> void testLegacyTriangulation()
+{
+  ALEPH_TEST_BEGIN( "HDF5 file simple data set triangulation" );
+
+  using Simplex           = aleph::topology::Simplex<D, V>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+  aleph::tests::TemporaryFile temporary( "aleph_hdf5" );
+  auto&& filename = temporary.filename();
+
+  // The first dimension is the width of the grid, i.e. vertices (x,y)
+  // have index y*2+x, and squares are split along the anti-diagonal.
+  std::vector<hsize_t> dimensions = { 2, 3 };
+  std::vector<double> values      = { 0, 1, 2, 3, 4, 5 };
+
+  {
+    H5::H5File file( filename, H5F_ACC_TRUNC );
+    H5::DataSpace dataSpace( 2, dimensions.data() );
+
+    auto dataSet = file.createDataSet( "Grid", H5::PredType::IEEE_F64LE, dataSpace );
+    dataSet.write( values.data(), H5::PredType::NATIVE_DOUBLE );
+  }
+
+  aleph::topology::io::HDF5SimpleDataSpaceReader reader;
+  reader.setDataSetName( "Grid" );
+
+  SimplicialComplex K;
+  reader( filename, K );
+
+  std::vector<Simplex> expected = {
+    {0}, {1}, {2}, {3}, {4}, {5},
+    {0,1}, {2,3}, {4,5},
+    {0,2}, {1,3}, {2,4}, {3,5},
+    {1,2}, {3,4},
+    {1,2,3}, {0,1,2},
+    {3,4,5}, {2,3,4}
+  };
+
+  ALEPH_ASSERT_EQUAL( K.size(), expected.size() );
+
+  for( auto&& s : expected )
+    ALEPH_ASSERT_THROW( K.contains( s ) );
+
+  ALEPH_ASSERT_EQUAL( K.find( Simplex( {4,2,3} ) )->data(), D(4) );
+
   ALEPH_TEST_END();
 }
 
@@ -54,4 +188,10 @@ int main(int, char**)
   test<double,unsigned short>();
   test<float, unsigned>      ();
   test<float, unsigned short>();
+
+  testChunked<double,unsigned>();
+  testChunked<float, unsigned>();
+
+  testLegacyTriangulation<double,unsigned>();
+  testLegacyTriangulation<float, unsigned short>();
 }
@@ -6,6 +6,10 @@
 #include <aleph/persistenceDiagrams/io/JSON.hh>
 
 #include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 template <class T> void testReading()
@@ -18,10 +22,116 @@ template <class T> void testReading()
   ALEPH_ASSERT_EQUAL( diagrams[0].betti(), 12 );
   ALEPH_ASSERT_EQUAL( diagrams[3].size(),   0 );
   ALEPH_ASSERT_EQUAL( diagrams[4].size(),   0 );
+
+  // Streaming the diagrams must yield the same results, and the names
+  // must be reported as well
+  std::vector<std::string> names;
+  unsigned index = 0;
+
+  aleph::io::readJSON<T>( filename, [&] ( aleph::PersistenceDiagram<T>&& D, const std::string& name )
+                                    {
+                                      ALEPH_ASSERT_THROW( D == diagrams.at( index++ ) );
+                                      names.push_back( name );
+                                    } );
+
+  ALEPH_ASSERT_EQUAL( index,        5 );
+  ALEPH_ASSERT_EQUAL( names.size(), 5 );
+  ALEPH_ASSERT_THROW( names.front().find( "Iris" ) != std::string::npos );
+}
+
+template <class T> void testStreaming()
+{
+  using PersistenceDiagram = aleph::PersistenceDiagram<T>;
+
+  PersistenceDiagram D;
+  PersistenceDiagram E;
+
+  D.setDimension( 1 );
+  D.add( T(0.5), T(1.0) );
+  D.add( T(0.25), std::numeric_limits<T>::infinity() );
+
+  E.setDimension( 2 );
+
+  std::stringstream stream;
+
+  {
+    aleph::io::JSONWriter writer( stream );
+
+    writer( D, "first \"diagram\"" );
+    writer( E );
+  }
+
+  {
+    aleph::io::JSONReader<T> reader( stream );
+    PersistenceDiagram F;
+
+    ALEPH_ASSERT_THROW( reader( F ) );
+    ALEPH_ASSERT_THROW( F == D );
+    ALEPH_ASSERT_EQUAL( F.dimension(), 1 );
+    ALEPH_ASSERT_THROW( reader.name() == "first \"diagram\"" );
+
+    ALEPH_ASSERT_THROW( reader( F ) );
+    ALEPH_ASSERT_THROW( F == E );
+    ALEPH_ASSERT_EQUAL( F.dimension(), 2 );
+    ALEPH_ASSERT_THROW( reader.name().empty() );
+
+    ALEPH_ASSERT_THROW( !reader( F ) );
+    ALEPH_ASSERT_THROW( !reader( F ) );
+  }
+
+  // A single diagram, as written by the non-streaming function, can
+  // be read as well
+  {
+    std::stringstream single;
+    aleph::io::writeJSON( single, D, "single" );
+
+    auto diagrams = aleph::io::readJSON<T>( single );
+
+    ALEPH_ASSERT_EQUAL( diagrams.size(), 1 );
+    ALEPH_ASSERT_THROW( diagrams.front() == D );
+  }
+
+  // Inconsistent data must be detected
+  {
+    std::stringstream invalid( "{ \"diagrams\": [ { \"size\": 2, \"diagram\": [ [1, 2] ] } ] }" );
+
+    bool thrown = false;
+
+    try
+    {
+      aleph::io::readJSON<T>( invalid );
+    }
+    catch( std::runtime_error& )
+    {
+      thrown = true;
+    }
+
+    ALEPH_ASSERT_THROW( thrown );
+  }
+
+  {
+    std::stringstream truncated( "{ \"diagrams\": [ { \"diagram\": [ [1, 2" );
+
+    bool thrown = false;
+
+    try
+    {
+      aleph::io::readJSON<T>( truncated );
+    }
+    catch( std::runtime_error& )
+    {
+      thrown = true;
+    }
+
+    ALEPH_ASSERT_THROW( thrown );
+  }
 }
 
 int main(int, char**)
 {
   testReading<double>();
   testReading<float >();
+
+  testStreaming<double>();
+  testStreaming<float >();
 }
@@ -12,7 +12,91 @@
 #include <aleph/topology/io/SimplicialComplexReader.hh>
 #include <aleph/topology/io/VTK.hh>
 
+#include <aleph/topology/StructuredGrid.hh>
+
 #include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cstdint>
+#include <cstring>
+
+/** Writes a value in big-endian byte order, as required by binary VTK files */
+template <class T> void writeBigEndian( std::ostream& out, T value )
+{
+  unsigned char bytes[sizeof(T)];
+  std::memcpy( bytes, &value, sizeof(T) );
+
+  std::uint16_t one = 1;
+  bool littleEndian = *reinterpret_cast<unsigned char*>( &one ) == 1;
+
+  if( littleEndian )
+    std::reverse( bytes, bytes + sizeof(T) );
+
+  out.write( reinterpret_cast<const char*>( bytes ), sizeof(T) );
+}
+
+/**
+  Writes a structured grid of size 4 x 3 x 2 with two scalar fields, the
+  second one being the negated first one, as well as a vector field.
+*/
+
+template <class S> void writeGrid( const std::string& filename, bool binary, const std::vector<double>& values )
+{
+  std::ofstream out( filename, std::ios::binary );
+
+  std::size_t nx = 4, ny = 3, nz = 2;
+
+  out << "# vtk DataFile Version 3.0\n"
+      << "\n"
+      << ( binary ? "BINARY" : "ASCII" ) << "\n"
+      << "DATASET STRUCTURED_GRID\n"
+      << "DIMENSIONS " << nx << " " << ny << " " << nz << "\n"
+      << "POINTS " << nx*ny*nz << " float\n";
+
+  auto writeValue = [&] ( double value, bool isFloat )
+  {
+    if( binary )
+    {
+      if( isFloat )
+        writeBigEndian( out, static_cast<float>( value ) );
+      else
+        writeBigEndian( out, static_cast<S>( value ) );
+    }
+    else
+      out << value << "\n";
+  };
+
+  for( std::size_t z = 0; z < nz; z++ )
+    for( std::size_t y = 0; y < ny; y++ )
+      for( std::size_t x = 0; x < nx; x++ )
+        for( auto&& c : { x, y, z } )
+          writeValue( double(c), true );
+
+  out << "\nPOINT_DATA " << nx*ny*nz << "\n"
+      << "VECTORS velocity float\n";
+
+  for( std::size_t i = 0; i < 3*nx*ny*nz; i++ )
+    writeValue( 1.0, true );
+
+  std::string type = sizeof(S) == sizeof(float) ? "float" : "double";
+
+  out << "\nSCALARS first " << type << " 1\n"
+      << "LOOKUP_TABLE default\n";
+
+  for( auto&& value : values )
+    writeValue( value, false );
+
+  out << "\nSCALARS second " << type << "\n";
+
+  for( auto&& value : values )
+    writeValue( -value, false );
+
+  out << "\n";
+}
 
 template <class D, class V> void test()
 {
@@ -69,10 +153,160 @@ template <class D, class V> void test()
   ALEPH_TEST_END();
 }
 
+template <class S> void testBinary()
+{
+  ALEPH_TEST_BEGIN( "VTK binary structured grid parsing" );
+
+  using Simplex           = aleph::topology::Simplex<double, unsigned>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+  std::vector<double> values( 4*3*2 );
+
+  for( std::size_t i = 0; i < values.size(); i++ )
+    values[i] = double( ( i * 5 ) % 7 ) + 0.5;
+
+  aleph::tests::TemporaryFile asciiFile( "aleph_vtk" );
+  aleph::tests::TemporaryFile binaryFile( "aleph_vtk" );
+
+  auto&& ascii  = asciiFile.filename();
+  auto&& binary = binaryFile.filename();
+
+  writeGrid<S>( ascii,  false, values );
+  writeGrid<S>( binary, true,  values );
+
+  aleph::topology::io::VTKStructuredGridReader reader;
+
+  // Scalar grid -------------------------------------------------------
+
+  {
+    auto grid = reader.readGrid<double>( binary );
+
+    ALEPH_ASSERT_THROW( grid.dimensions == std::vector<std::size_t>( { 2, 3, 4 } ) );
+    ALEPH_ASSERT_EQUAL( grid.layers, 2 );
+    ALEPH_ASSERT_THROW( grid.values == values );
+
+    reader.setScalarName( "second" );
+    grid = reader.readGrid<double>( ascii );
+
+    ALEPH_ASSERT_EQUAL( grid.values.front(), -values.front() );
+    ALEPH_ASSERT_EQUAL( grid.values.back(),  -values.back() );
+
+    reader.setScalarName( "third" );
+    ALEPH_ASSERT_THROWS( reader.readGrid<double>( binary ), std::runtime_error );
+
+    reader.setScalarName( std::string() );
+  }
+
+  // Simplicial complexes from both formats ----------------------------
+
+  {
+    SimplicialComplex K;
+    SimplicialComplex L;
+
+    reader( ascii,  K );
+    reader( binary, L );
+
+    auto n0 = std::count_if( L.begin(), L.end(), [] ( const Simplex& s ) { return s.dimension() == 0; } );
+    auto n1 = std::count_if( L.begin(), L.end(), [] ( const Simplex& s ) { return s.dimension() == 1; } );
+
+    ALEPH_ASSERT_EQUAL( n0, 24 );
+    ALEPH_ASSERT_EQUAL( n1, 3*3*2 + 4*2*2 + 4*3*1 );
+    ALEPH_ASSERT_THROW( K == L );
+  }
+
+  // Streaming the grid to a triangulation -----------------------------
+
+  {
+    reader.setSlabSize( 12 );
+
+    aleph::topology::FreudenthalTriangulation<Simplex> triangulation;
+    std::vector<Simplex> simplices;
+    std::size_t numSlabs = 0;
+
+    reader.read<double>( binary, [&] ( const aleph::topology::GridSlab<double>& slab )
+    {
+      ++numSlabs;
+      triangulation( slab, std::back_inserter( simplices ) );
+    } );
+
+    auto n3 = std::count_if( simplices.begin(), simplices.end(), [] ( const Simplex& s ) { return s.dimension() == 3; } );
+
+    ALEPH_ASSERT_EQUAL( numSlabs, 2 );
+    ALEPH_ASSERT_EQUAL( n3, 6 * 3*2*1 );
+  }
+
+  // Truncated files are detected --------------------------------------
+
+  {
+    std::ifstream in( binary, std::ios::binary );
+    std::string contents( ( std::istreambuf_iterator<char>( in ) ),
+                            std::istreambuf_iterator<char>() );
+
+    std::ofstream out( binary, std::ios::binary );
+    out << contents.substr( 0, contents.size() / 2 );
+    out.close();
+
+    ALEPH_ASSERT_THROWS( reader.readGrid<double>( binary ), std::runtime_error );
+  }
+
+  ALEPH_TEST_END();
+}
+
+void testStructuredPoints()
+{
+  ALEPH_TEST_BEGIN( "VTK structured points parsing" );
+
+  aleph::tests::TemporaryFile file( "aleph_vtk" );
+  auto&& filename = file.filename();
+
+  {
+    std::ofstream out( filename );
+
+    out << "# vtk DataFile Version 2.0\n"
+        << "Structured points\n"
+        << "ASCII\n"
+        << "DATASET STRUCTURED_POINTS\n"
+        << "DIMENSIONS 3 2 1\n"
+        << "ORIGIN 0 0 0\n"
+        << "SPACING 1 1 1\n"
+        << "POINT_DATA 6\n"
+        << "SCALARS data int\n"
+        << "1 2 3\n"
+        << "4 5 6\n";
+  }
+
+  aleph::topology::io::VTKStructuredGridReader reader;
+  auto grid = reader.readGrid<int>( filename );
+
+  ALEPH_ASSERT_THROW( grid.dimensions == std::vector<std::size_t>( { 1, 2, 3 } ) );
+  ALEPH_ASSERT_THROW( grid.values == std::vector<int>( { 1, 2, 3, 4, 5, 6 } ) );
+
+  ALEPH_TEST_END();
+}
+
+void testMetaData()
+{
+  ALEPH_TEST_BEGIN( "VTK meta data blocks" );
+
+  aleph::topology::io::VTKStructuredGridReader reader;
+  auto grid = reader.readGrid<double>( CMAKE_SOURCE_DIR + std::string( "/tests/input/Metadata.vtk" ) );
+
+  ALEPH_ASSERT_THROW( grid.dimensions == std::vector<std::size_t>( { 1, 2, 3 } ) );
+  ALEPH_ASSERT_THROW( grid.values == std::vector<double>( { 0.25, 1.5, 2.75, 4, 5.25, 6.5 } ) );
+
+  ALEPH_TEST_END();
+}
+
 int main()
 {
   test<double,unsigned>      ();
   test<double,unsigned short>();
   test<float, unsigned>      ();
   test<float, unsigned short>();
+
+  testBinary<float> ();
+  testBinary<double>();
+
+  testStructuredPoints();
+  testMetaData();
 }
@@ -3,8 +3,49 @@
 #include <aleph/topology/Mesh.hh>
 #include <aleph/topology/MorseSmaleComplex.hh>
 
+#include <aleph/topology/io/PLY.hh>
+#include <aleph/topology/io/VTK.hh>
+
+#include <aleph/topology/Simplex.hh>
+#include <aleph/topology/SimplicialComplex.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+template <class Mesh> void addGrid( Mesh& M, unsigned n, bool incremental )
+{
+  for( unsigned y = 0; y < n; y++ )
+    for( unsigned x = 0; x < n; x++ )
+      M.addVertex( double(x), double(y), 0.0, static_cast<float>( (x*7 + y*3) % 5 ) );
+
+  std::vector< std::vector<unsigned> > faces;
+
+  for( unsigned y = 0; y + 1 < n; y++ )
+  {
+    for( unsigned x = 0; x + 1 < n; x++ )
+    {
+      unsigned i = y*n + x;
+
+      faces.push_back( { i, i+1, i+n+1 } );
+      faces.push_back( { i, i+n+1, i+n } );
+    }
+  }
+
+  if( incremental )
+  {
+    for( auto&& face : faces )
+      M.addFace( face.begin(), face.end() );
+  }
+  else
+    M.addFaces( faces.begin(), faces.end() );
+}
+
 void test1()
 {
   ALEPH_TEST_BEGIN( "Simple mesh");
@@ -148,7 +189,477 @@ void test3()
   }
 
   aleph::topology::MorseSmaleComplex<decltype(M)> msc;
-  msc( M );
+  auto S = msc( M );
+
+  ALEPH_ASSERT_THROW( S.maxima == std::vector<std::size_t>( { 4 } ) );
+  ALEPH_ASSERT_THROW( S.minima == std::vector<std::size_t>( { 0, 2, 6, 8 } ) );
+
+  ALEPH_TEST_END();
+}
+
+void test4()
+{
+  ALEPH_TEST_BEGIN( "Bulk construction" );
+
+  aleph::topology::Mesh<double> M;
+  aleph::topology::Mesh<double> N;
+
+  addGrid( M, 6, false );
+  addGrid( N, 6, true  );
+
+  ALEPH_ASSERT_EQUAL( M.numVertices(),  N.numVertices() );
+  ALEPH_ASSERT_EQUAL( M.numFaces(),     50 );
+  ALEPH_ASSERT_EQUAL( N.numFaces(),     50 );
+  ALEPH_ASSERT_EQUAL( M.numHalfEdges(), N.numHalfEdges() );
+  ALEPH_ASSERT_THROW( M.faces() == N.faces() );
+
+  ALEPH_ASSERT_EQUAL( M.numConnectedComponents(), 1 );
+  ALEPH_ASSERT_EQUAL( N.numConnectedComponents(), 1 );
+
+  for( auto&& v : M.vertices() )
+  {
+    auto l1 = M.link(v);
+    auto l2 = N.link(v);
+
+    std::sort( l1.begin(), l1.end() );
+    std::sort( l2.begin(), l2.end() );
+
+    ALEPH_ASSERT_THROW( l1 == l2 );
+
+    auto lower1 = M.getLowerNeighbours(v);
+    auto lower2 = N.getLowerNeighbours(v);
+
+    std::sort( lower1.begin(), lower1.end() );
+    std::sort( lower2.begin(), lower2.end() );
+
+    ALEPH_ASSERT_THROW( lower1 == lower2 );
+
+    for( auto&& w : l1 )
+    {
+      ALEPH_ASSERT_THROW( M.hasEdge(v,w) );
+      ALEPH_ASSERT_THROW( M.hasEdge(w,v) );
+    }
+
+    ALEPH_ASSERT_EQUAL( M.star(v).numFaces(), N.star(v).numFaces() );
+  }
+
+  // Corners, boundary vertices, and interior vertices
+  ALEPH_ASSERT_EQUAL( M.link(0).size(),  3 );
+  ALEPH_ASSERT_EQUAL( M.link(5).size(),  2 );
+  ALEPH_ASSERT_EQUAL( M.link(2).size(),  4 );
+  ALEPH_ASSERT_EQUAL( M.link(7).size(),  6 );
+  ALEPH_ASSERT_EQUAL( M.star(7).numFaces(), 6 );
+
+  ALEPH_ASSERT_THROW(  M.hasEdge(0,7) );
+  ALEPH_ASSERT_THROW( !M.hasEdge(0,8) );
+
+  // Adding faces in two batches results in the same mesh
+  {
+    aleph::topology::Mesh<double> O;
+
+    for( unsigned i = 0; i < 4; i++ )
+      O.addVertex( 0.0, 0.0, 0.0 );
+
+    std::vector< std::vector<unsigned> > f1 = { { 0, 1, 2 } };
+    std::vector< std::vector<unsigned> > f2 = { { 2, 1, 3 } };
+
+    O.addFaces( f1.begin(), f1.end() );
+    O.addFaces( f2.begin(), f2.end() );
+
+    ALEPH_ASSERT_EQUAL( O.numFaces(),     2 );
+    ALEPH_ASSERT_EQUAL( O.numHalfEdges(), 10 );
+    ALEPH_ASSERT_EQUAL( O.link(1).size(), 3 );
+  }
+
+  ALEPH_TEST_END();
+}
+
+void test5()
+{
+  ALEPH_TEST_BEGIN( "Vertex IDs and errors" );
+
+  aleph::topology::Mesh<double> M;
+
+  M.addVertex( 0.0, 0.0, 0.0, 1.0, 10 );
+  M.addVertex( 1.0, 0.0, 0.0, 2.0, 20 );
+  M.addVertex( 0.0, 1.0, 0.0, 3.0, 30 );
+  M.addVertex( 1.0, 1.0, 0.0, 4.0 );
+
+  ALEPH_ASSERT_EQUAL( M.vertices().back(), 31 );
+  ALEPH_ASSERT_EQUAL( M.data(20), 2.0 );
+
+  ALEPH_ASSERT_THROWS( M.addVertex( 0.0, 0.0, 0.0, 0.0, 10 ), std::runtime_error );
+
+  std::vector< std::vector<unsigned> > faces = { { 10, 20, 30 }, { 30, 20, 31 } };
+  M.addFaces( faces.begin(), faces.end() );
+
+  ALEPH_ASSERT_EQUAL( M.numFaces(), 2 );
+  ALEPH_ASSERT_THROW( M.hasEdge(20,30) );
+  ALEPH_ASSERT_THROW( M.faces().back() == std::vector<std::size_t>( { 30, 20, 31 } ) );
+
+  {
+    aleph::topology::Mesh<double> N;
+
+    for( unsigned i = 0; i < 4; i++ )
+      N.addVertex( 0.0, 0.0, 0.0 );
+
+    // The second face traverses the shared edge in the same direction
+    std::vector< std::vector<unsigned> > inconsistent = { { 0, 1, 2 }, { 1, 2, 3 } };
+
+    ALEPH_ASSERT_THROWS( N.addFaces( inconsistent.begin(), inconsistent.end() ), std::runtime_error );
+  }
+
+  {
+    aleph::topology::Mesh<double> N;
+
+    for( unsigned i = 0; i < 5; i++ )
+      N.addVertex( 0.0, 0.0, 0.0 );
+
+    std::vector< std::vector<unsigned> > nonManifold = { { 0, 1, 2 }, { 1, 0, 3 }, { 0, 1, 4 } };
+
+    ALEPH_ASSERT_THROWS( N.addFaces( nonManifold.begin(), nonManifold.end() ), std::runtime_error );
+  }
+
+  {
+    aleph::topology::Mesh<double> N;
+    N.addVertex( 0.0, 0.0, 0.0 );
+
+    ALEPH_ASSERT_THROWS( N.data( 1 ), std::out_of_range );
+  }
+
+  ALEPH_TEST_END();
+}
+
+/** Writes a value to a binary PLY file in the given byte order */
+template <class T> void writeValue( std::ostream& out, T value, bool littleEndian )
+{
+  using Unsigned = typename std::conditional<sizeof(T) == 1, std::uint8_t,
+                   typename std::conditional<sizeof(T) == 2, std::uint16_t,
+                   typename std::conditional<sizeof(T) == 4, std::uint32_t,
+                                                             std::uint64_t>::type>::type>::type;
+
+  Unsigned u;
+  std::memcpy( &u, &value, sizeof(T) );
+
+  for( std::size_t i = 0; i < sizeof(T); i++ )
+  {
+    auto shift = 8 * ( littleEndian ? i : sizeof(T) - 1 - i );
+    out.put( static_cast<char>( ( std::uint64_t( u ) >> shift ) & 0xFF ) );
+  }
+}
+
+/**
+  Writes the square pyramid of the ASCII test in binary format. Besides
+  the properties of the ASCII file, every vertex has a list of labels,
+  and every face has a colour, which the reader has to skip.
+*/
+
+void writePyramid( const std::string& filename,
+                   bool littleEndian,
+                   const std::vector< std::vector<int> >& faces )
+{
+  std::ofstream out( filename, std::ios::binary );
+
+  out << "ply\n"
+      << "format " << ( littleEndian ? "binary_little_endian" : "binary_big_endian" ) << " 1.0\n"
+      << "element vertex 5\n"
+      << "property float x\n"
+      << "property float y\n"
+      << "property list uchar short labels\n"
+      << "property float z\n"
+      << "property double quality\n"
+      << "element face " << faces.size() << "\n"
+      << "property uchar red\n"
+      << "property list uchar int vertex_indices\n"
+      << "end_header\n";
+
+  std::vector< std::vector<float> > positions = {
+    { 0.0f, 0.0f, 0.0f },
+    { 1.0f, 0.0f, 0.0f },
+    { 1.0f, 1.0f, 0.0f },
+    { 0.0f, 1.0f, 0.0f },
+    { 0.5f, 0.5f, 1.0f }
+  };
+
+  for( std::size_t i = 0; i < positions.size(); i++ )
+  {
+    writeValue( out, positions[i][0], littleEndian );
+    writeValue( out, positions[i][1], littleEndian );
+    writeValue( out, std::uint8_t( i % 3 ), littleEndian );
+
+    for( std::size_t j = 0; j < i % 3; j++ )
+      writeValue( out, std::int16_t( -1 ), littleEndian );
+
+    writeValue( out, positions[i][2], littleEndian );
+    writeValue( out, double( i + 1 ), littleEndian );
+  }
+
+  for( auto&& face : faces )
+  {
+    writeValue( out, std::uint8_t( 255 ), littleEndian );
+    writeValue( out, std::uint8_t( face.size() ), littleEndian );
+
+    for( auto&& index : face )
+      writeValue( out, std::int32_t( index ), littleEndian );
+  }
+}
+
+void test6()
+{
+  ALEPH_TEST_BEGIN( "Reading meshes from PLY files" );
+
+  aleph::tests::TemporaryFile file( "aleph_mesh" );
+  auto&& filename = file.filename();
+
+  {
+    std::ofstream out( filename );
+
+    out << "ply\n"
+        << "format ascii 1.0\n"
+        << "comment A square pyramid\n"
+        << "element vertex 5\n"
+        << "property float x\n"
+        << "property float y\n"
+        << "property float z\n"
+        << "property float quality\n"
+        << "element face 5\n"
+        << "property list uchar int vertex_indices\n"
+        << "end_header\n"
+        << "0 0 0 1\n"
+        << "1 0 0 2\n"
+        << "1 1 0 3\n"
+        << "0 1 0 4\n"
+        << "0.5 0.5 1 5\n"
+        << "4 3 2 1 0\n"
+        << "3 0 1 4\n"
+        << "3 1 2 4\n"
+        << "3 2 3 4\n"
+        << "3 3 0 4\n";
+  }
+
+  aleph::topology::Mesh<float, double> M;
+  aleph::topology::io::PLYReader reader;
+
+  reader.setDataProperty( "quality" );
+  reader( filename, M );
+
+  ALEPH_ASSERT_EQUAL( M.numVertices(), 5 );
+  ALEPH_ASSERT_EQUAL( M.numFaces(),    5 );
+
+  // Closed surface: there are no boundary edges
+  ALEPH_ASSERT_EQUAL( M.numHalfEdges(), 16 );
+  ALEPH_ASSERT_EQUAL( M.link(4).size(), 4 );
+  ALEPH_ASSERT_EQUAL( M.link(0).size(), 3 );
+  ALEPH_ASSERT_EQUAL( M.data(4), 5.0 );
+  ALEPH_ASSERT_EQUAL( M.getHigherNeighbours(3).size(), 1 );
+  ALEPH_ASSERT_EQUAL( M.faces().front().size(), 4 );
+
+  // Binary files ------------------------------------------------------
+
+  std::vector< std::vector<int> > faces = {
+    { 3, 2, 1, 0 },
+    { 0, 1, 4 },
+    { 1, 2, 4 },
+    { 2, 3, 4 },
+    { 3, 0, 4 }
+  };
+
+  for( bool littleEndian : { true, false } )
+  {
+    writePyramid( filename, littleEndian, faces );
+
+    aleph::topology::Mesh<float, double> N;
+    reader( filename, N );
+
+    ALEPH_ASSERT_EQUAL( N.numVertices(), M.numVertices() );
+    ALEPH_ASSERT_EQUAL( N.numHalfEdges(), M.numHalfEdges() );
+    ALEPH_ASSERT_THROW( N.faces() == M.faces() );
+
+    for( auto&& v : N.vertices() )
+    {
+      ALEPH_ASSERT_THROW( N.position(v) == M.position(v) );
+      ALEPH_ASSERT_EQUAL( N.data(v), M.data(v) );
+    }
+  }
+
+  // Simplicial complexes from binary files ----------------------------
+
+  {
+    using Simplex           = aleph::topology::Simplex<double, unsigned>;
+    using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+    writePyramid( filename, true, { faces.begin() + 1, faces.end() } );
+
+    SimplicialComplex K;
+    reader( filename, K );
+
+    ALEPH_ASSERT_EQUAL( K.size(), 5 + 8 + 4 );
+    ALEPH_ASSERT_EQUAL( K[0].data(), 1.0 );
+  }
+
+  ALEPH_TEST_END();
+}
+
+void test7()
+{
+  ALEPH_TEST_BEGIN( "Morse--Smale segmentation" );
+
+  using Mesh = aleph::topology::Mesh<double, double>;
+  using MSC  = aleph::topology::MorseSmaleComplex<Mesh>;
+  using Type = aleph::topology::CriticalPointType;
+
+  unsigned n = 5;
+
+  // A paraboloid with a single maximum in the centre of the grid; the
+  // corners of the grid are its minima.
+  Mesh M;
+
+  for( unsigned y = 0; y < n; y++ )
+  {
+    for( unsigned x = 0; x < n; x++ )
+    {
+      double dx = double(x) - 2.0;
+      double dy = double(y) - 2.0;
+
+      M.addVertex( double(x), double(y), 0.0, -dx*dx - dy*dy );
+    }
+  }
+
+  std::vector< std::vector<unsigned> > faces;
+
+  for( unsigned y = 0; y + 1 < n; y++ )
+  {
+    for( unsigned x = 0; x + 1 < n; x++ )
+    {
+      unsigned i = y*n + x;
+
+      faces.push_back( { i, i+1, i+n+1 } );
+      faces.push_back( { i, i+n+1, i+n } );
+    }
+  }
+
+  M.addFaces( faces.begin(), faces.end() );
+
+  MSC msc;
+  auto S = msc( M );
+
+  ALEPH_ASSERT_EQUAL( S.maxima.size(), 1 );
+  ALEPH_ASSERT_EQUAL( S.maxima.front(), 12 );
+  ALEPH_ASSERT_THROW( S.minima == std::vector<std::size_t>( { 0, 4, 20, 24 } ) );
+  ALEPH_ASSERT_THROW( S.types[12] == Type::Maximum );
+  ALEPH_ASSERT_THROW( S.types[6]  == Type::Regular );
+
+  for( std::size_t i = 0; i < M.numVertices(); i++ )
+  {
+    ALEPH_ASSERT_EQUAL( S.descendingManifolds[i], 12 );
+    ALEPH_ASSERT_THROW( std::find( S.minima.begin(), S.minima.end(), S.ascendingManifolds[i] ) != S.minima.end() );
+  }
+
+  // Every vertex is in the ascending manifold of its nearest corner
+  ALEPH_ASSERT_EQUAL( S.ascendingManifolds[1],  0 );
+  ALEPH_ASSERT_EQUAL( S.ascendingManifolds[9],  4 );
+  ALEPH_ASSERT_EQUAL( S.ascendingManifolds[21], 20 );
+  ALEPH_ASSERT_EQUAL( S.ascendingManifolds[23], 24 );
+
+  auto numCells = *std::max_element( S.cells.begin(), S.cells.end() ) + 1;
+  ALEPH_ASSERT_EQUAL( numCells, 4 );
+
+  // Constant functions are treated like their vertex indices due to the
+  // simulation of simplicity, so there are no saddles.
+  {
+    Mesh C;
+
+    for( unsigned i = 0; i < n*n; i++ )
+      C.addVertex( double(i % n), double(i / n), 0.0, 1.0 );
+
+    C.addFaces( faces.begin(), faces.end() );
+
+    auto T = msc( C );
+
+    ALEPH_ASSERT_THROW( T.minima  == std::vector<std::size_t>( { 0 } ) );
+    ALEPH_ASSERT_THROW( T.maxima  == std::vector<std::size_t>( { 24 } ) );
+    ALEPH_ASSERT_THROW( T.saddles.empty() );
+  }
+
+  // Writing the segmentation ------------------------------------------
+
+  aleph::tests::TemporaryFile file( "aleph_mesh" );
+  auto&& filename = file.filename();
+
+  // Properties are stored with their full precision
+  std::vector<double> heights;
+  std::vector<float> weights;
+
+  for( std::size_t i = 0; i < M.numVertices(); i++ )
+  {
+    heights.push_back( 1.0 / double( i + 3 ) + 1e-9 );
+    weights.push_back( float( i ) / 7.0f );
+  }
+
+  {
+    aleph::topology::io::PLYWriter writer;
+    writer.addVertexProperty( "cell", S.cells );
+    writer.addVertexProperty( "type", S.typesAsIntegers() );
+    writer.addVertexProperty( "height", heights );
+    writer.addVertexProperty( "weight", weights );
+    writer( filename, M );
+
+    Mesh N;
+    aleph::topology::io::PLYReader reader;
+
+    reader.setDataProperty( "cell" );
+    reader( filename, N );
+
+    ALEPH_ASSERT_EQUAL( N.numVertices(), M.numVertices() );
+    ALEPH_ASSERT_THROW( N.faces() == M.faces() );
+
+    for( auto&& v : N.vertices() )
+      ALEPH_ASSERT_EQUAL( N.data(v), double( S.cells[ N.index(v) ] ) );
+
+    reader.setDataProperty( "data" );
+    reader( filename, N );
+
+    for( auto&& v : N.vertices() )
+      ALEPH_ASSERT_EQUAL( N.data(v), M.data(v) );
+
+    reader.setDataProperty( "height" );
+    reader( filename, N );
+
+    for( auto&& v : N.vertices() )
+      ALEPH_ASSERT_EQUAL( N.data(v), heights[ N.index(v) ] );
+
+    reader.setDataProperty( "weight" );
+    reader( filename, N );
+
+    for( auto&& v : N.vertices() )
+      ALEPH_ASSERT_EQUAL( float( N.data(v) ), weights[ N.index(v) ] );
+  }
+
+  {
+    aleph::topology::io::VTKPolyDataWriter writer;
+    writer.addScalarField( "cell", S.cells );
+    writer.addScalarField( "height", heights );
+    writer( filename, M );
+
+    std::ifstream in( filename );
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+
+    auto contents = buffer.str();
+
+    ALEPH_ASSERT_THROW( contents.find( "DATASET POLYDATA"     ) != std::string::npos );
+    ALEPH_ASSERT_THROW( contents.find( "POINTS 25 double"     ) != std::string::npos );
+    ALEPH_ASSERT_THROW( contents.find( "POLYGONS 32 128"      ) != std::string::npos );
+    ALEPH_ASSERT_THROW( contents.find( "SCALARS cell int 1"   ) != std::string::npos );
+    ALEPH_ASSERT_THROW( contents.find( "SCALARS height double 1" ) != std::string::npos );
+
+    // The last value of the scalar field has to be read back exactly
+    std::istringstream last( contents.substr( contents.find_last_of( '\n', contents.size() - 2 ) + 1 ) );
+    double height = 0.0;
+    last >> height;
+
+    ALEPH_ASSERT_EQUAL( height, heights.back() );
+  }
 
   ALEPH_TEST_END();
 }
@@ -158,4 +669,8 @@ int main(int, char**)
   test1();
   test2();
   test3();
+  test4();
+  test5();
+  test6();
+  test7();
 }
@@ -3,8 +3,12 @@
 #include <aleph/persistenceDiagrams/Mean.hh>
 #include <aleph/persistenceDiagrams/Norms.hh>
 #include <aleph/persistenceDiagrams/MultiScaleKernel.hh>
+#include <aleph/persistenceDiagrams/PairwiseDistances.hh>
 #include <aleph/persistenceDiagrams/PersistenceDiagram.hh>
+#include <aleph/persistenceDiagrams/PersistenceImage.hh>
+#include <aleph/persistenceDiagrams/PersistenceLandscape.hh>
 #include <aleph/persistenceDiagrams/PersistenceIndicatorFunction.hh>
+#include <aleph/persistenceDiagrams/SlicedWasserstein.hh>
 
 #include <aleph/persistenceDiagrams/distances/Bottleneck.hh>
 #include <aleph/persistenceDiagrams/distances/Hausdorff.hh>
@@ -12,11 +16,18 @@
 #include <aleph/persistenceDiagrams/distances/Wasserstein.hh>
 
 #include <algorithm>
+#include <fstream>
+#include <functional>
 #include <limits>
+#include <numeric>
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include <cassert>
 #include <cmath>
+#include <cstdio>
 
 template <class T> aleph::PersistenceDiagram<T> createRandomPersistenceDiagram( unsigned n )
 {
@@ -78,7 +89,23 @@ template <class T> void testBottleneckDistance()
     ALEPH_ASSERT_THROW( d21 > T() );
 
     ALEPH_ASSERT_EQUAL( d12, d21 );
-    ALEPH_ASSERT_EQUAL( d21, T(9.9)-T(4.0) );
+
+    // The cheapest option is to match the differing points with the
+    // diagonal, whose distance is half of their persistence.
+    ALEPH_ASSERT_THROW( std::abs( d12 - T(3.0) ) < 1e-6 );
+  }
+
+  {
+    auto D3 = createRandomPersistenceDiagram<T>( 100 );
+    auto D4 = createRandomPersistenceDiagram<T>( 100 );
+
+    auto d34 = bottleneckDistance( D3, D4 );
+    auto d43 = bottleneckDistance( D4, D3 );
+    auto a34 = bottleneckDistance( D3, D4, T(0.1) );
+
+    ALEPH_ASSERT_EQUAL( d34, d43 );
+    ALEPH_ASSERT_THROW( a34 >= d34 );
+    ALEPH_ASSERT_THROW( a34 <= T(1.1) * d34 );
   }
 
   ALEPH_TEST_END();
@@ -106,6 +133,38 @@ template <class T> void testFrechetMean()
   ALEPH_ASSERT_THROW( D.size() > 0 );
   ALEPH_ASSERT_THROW( std::abs( P - p ) < 2.0 );
 
+  // Restarts, approximate pairings, and convergence thresholds
+  {
+    aleph::MeanOptions options;
+    options.restarts      = 3;
+    options.maxIterations = 20;
+    options.tolerance     = 1e-6;
+    options.seed          = 42;
+
+    auto E = aleph::mean( diagrams.begin(), diagrams.end(), options );
+    auto F = aleph::mean( diagrams.begin(), diagrams.end(), options );
+
+    ALEPH_ASSERT_THROW( E.size() > 0 );
+    ALEPH_ASSERT_THROW( E == F );
+    ALEPH_ASSERT_THROW( std::abs( aleph::totalPersistence( E ) - p ) < 2.0 );
+
+    options.relativeError = 0.01;
+
+    auto G = aleph::mean( diagrams.begin(), diagrams.end(), options );
+
+    ALEPH_ASSERT_THROW( G.size() > 0 );
+    ALEPH_ASSERT_THROW( std::abs( aleph::totalPersistence( G ) - p ) < 2.0 );
+  }
+
+  // Warm starts must not change the optimal cost
+  {
+    auto pairing = aleph::detail::optimalPairing( diagrams[0], diagrams[1] );
+    auto warm    = aleph::detail::optimalPairing( diagrams[0], diagrams[2], T(2), pairing );
+    auto cold    = aleph::detail::optimalPairing( diagrams[0], diagrams[2] );
+
+    ALEPH_ASSERT_THROW( std::abs( warm.cost - cold.cost ) < 1e-4 * std::max( 1.0, cold.cost ) );
+  }
+
   ALEPH_TEST_END();
 }
 
@@ -129,6 +188,376 @@ template <class T> void testHausdorffDistance()
   ALEPH_TEST_END();
 }
 
+template <class T> void testPairwiseDistances()
+{
+  ALEPH_TEST_BEGIN( "Pairwise distances" );
+
+  using Diagram = aleph::PersistenceDiagram<T>;
+
+  std::vector<Diagram> diagrams;
+
+  for( unsigned i = 0; i < 6; i++ )
+  {
+    auto D = createRandomPersistenceDiagram<T>( 10 + 5 * i );
+    D.add( T( i ) );
+
+    diagrams.push_back( D );
+  }
+
+  diagrams.push_back( Diagram() );
+
+  auto H = aleph::pairwiseDistances( diagrams, aleph::distances::HausdorffMetric<T>() );
+  auto W = aleph::pairwiseDistances( diagrams, aleph::distances::WassersteinMetric<T>( T(2) ) );
+
+  ALEPH_ASSERT_EQUAL( H.numRows(), diagrams.size() );
+  ALEPH_ASSERT_EQUAL( W.numRows(), diagrams.size() );
+
+  for( std::size_t i = 0; i < diagrams.size(); i++ )
+  {
+    ALEPH_ASSERT_EQUAL( H(i,i), 0.0 );
+    ALEPH_ASSERT_EQUAL( W(i,i), 0.0 );
+
+    for( std::size_t j = i + 1; j < diagrams.size(); j++ )
+    {
+      ALEPH_ASSERT_EQUAL( H(i,j), double( aleph::distances::hausdorffDistance( diagrams[i], diagrams[j] ) ) );
+      ALEPH_ASSERT_EQUAL( W(i,j), double( aleph::distances::wassersteinDistance( diagrams[i], diagrams[j], T(2) ) ) );
+      ALEPH_ASSERT_EQUAL( H(i,j), H(j,i) );
+    }
+  }
+
+  // Resume from a checkpoint that only contains some of the distances;
+  // the remaining distances have to be calculated again.
+  {
+    aleph::PairwiseDistancesOptions options;
+    options.checkpoint = "test_pairwise_distances_checkpoint.txt";
+
+    std::remove( options.checkpoint.c_str() );
+
+    auto S = aleph::pairwiseDistances( diagrams, aleph::distances::SlicedWassersteinMetric( 10 ), options );
+
+    {
+      std::ofstream out( options.checkpoint );
+      out.precision( std::numeric_limits<double>::max_digits10 );
+      out << "pairwise_distances " << diagrams.size() << "\n"
+          << "0 1 " << S(0,1) << "\n"
+          << "2 3 " << S(2,3) << "\n"
+          << "4 5 0.1";
+    }
+
+    auto R = aleph::pairwiseDistances( diagrams, aleph::distances::SlicedWassersteinMetric( 10 ), options );
+
+    for( std::size_t i = 0; i < diagrams.size(); i++ )
+      for( std::size_t j = 0; j < diagrams.size(); j++ )
+        ALEPH_ASSERT_EQUAL( S(i,j), R(i,j) );
+
+    std::remove( options.checkpoint.c_str() );
+  }
+
+  // Infinite distances, which occur for diagrams with different numbers
+  // of unpaired points, are read back instead of being calculated again.
+  {
+    aleph::tests::TemporaryFile file( "aleph_checkpoint" );
+
+    aleph::PairwiseDistancesOptions options;
+    options.checkpoint = file.filename();
+
+    auto n = diagrams.size();
+    auto S = aleph::pairwiseDistances( diagrams, aleph::distances::WassersteinMetric<T>( T(2) ), options );
+    auto R = aleph::pairwiseDistances( diagrams, aleph::distances::WassersteinMetric<T>( T(2) ), options );
+
+    ALEPH_ASSERT_THROW( std::isinf( S(0,n-1) ) );
+
+    for( std::size_t i = 0; i < n; i++ )
+      for( std::size_t j = 0; j < n; j++ )
+        ALEPH_ASSERT_EQUAL( S(i,j), R(i,j) );
+
+    // The distance between the first two diagrams is finite, so it is
+    // only infinite if it has been taken from the checkpoint.
+    {
+      std::ofstream out( options.checkpoint );
+      out << "pairwise_distances " << n << "\n"
+          << "0 1 " << std::numeric_limits<double>::infinity() << "\n";
+    }
+
+    R = aleph::pairwiseDistances( diagrams, aleph::distances::WassersteinMetric<T>( T(2) ), options );
+
+    ALEPH_ASSERT_THROW( std::isfinite( S(0,1) ) );
+    ALEPH_ASSERT_THROW( std::isinf( R(0,1) ) );
+    ALEPH_ASSERT_EQUAL( R(2,3), S(2,3) );
+
+    {
+      std::ofstream out( options.checkpoint );
+      out << "pairwise_distances " << n << "\n"
+          << "0 1 distance\n";
+    }
+
+    ALEPH_ASSERT_THROWS( aleph::pairwiseDistances( diagrams, aleph::distances::HausdorffMetric<T>(), options ),
+                         std::runtime_error );
+  }
+
+  // Checkpoints of a different calculation must not be resumed, even if
+  // they refer to the same number of items.
+  {
+    std::vector<std::string> inputs = { "a.txt", "b.txt", "c.txt", "d.txt", "e.txt", "f.txt", "g.txt" };
+
+    aleph::PairwiseDistancesOptions options;
+    options.checkpoint = "test_pairwise_distances_checkpoint.txt";
+    options.identifier = aleph::checkpointIdentifier( "sliced", 2.0, inputs );
+
+    std::remove( options.checkpoint.c_str() );
+
+    auto S = aleph::pairwiseDistances( diagrams, aleph::distances::SlicedWassersteinMetric( 10 ), options );
+    auto R = aleph::pairwiseDistances( diagrams, aleph::distances::SlicedWassersteinMetric( 10 ), options );
+
+    for( std::size_t i = 0; i < diagrams.size(); i++ )
+      for( std::size_t j = 0; j < diagrams.size(); j++ )
+        ALEPH_ASSERT_EQUAL( S(i,j), R(i,j) );
+
+    auto rejects = [&] ( const std::string& identifier )
+    {
+      auto other       = options;
+      other.identifier = identifier;
+
+      try
+      {
+        aleph::pairwiseDistances( diagrams, aleph::distances::SlicedWassersteinMetric( 10 ), other );
+      }
+      catch( const std::runtime_error& )
+      {
+        return true;
+      }
+
+      return false;
+    };
+
+    auto permuted = inputs;
+    std::swap( permuted[0], permuted[1] );
+
+    ALEPH_ASSERT_THROW( rejects( aleph::checkpointIdentifier( "hausdorff", 2.0, inputs ) ) );
+    ALEPH_ASSERT_THROW( rejects( aleph::checkpointIdentifier( "sliced",    1.0, inputs ) ) );
+    ALEPH_ASSERT_THROW( rejects( aleph::checkpointIdentifier( "sliced",    2.0, permuted ) ) );
+    ALEPH_ASSERT_THROW( rejects( std::string() ) );
+    ALEPH_ASSERT_THROW( rejects( options.identifier ) == false );
+
+    std::remove( options.checkpoint.c_str() );
+  }
+
+  ALEPH_TEST_END();
+}
+
+template <class T> void testPersistenceImage()
+{
+  ALEPH_TEST_BEGIN( "Persistence image" );
+
+  using PersistenceDiagram = aleph::PersistenceDiagram<T>;
+
+  aleph::PersistenceImageOptions options;
+  options.width  = 50;
+  options.height = 40;
+  options.sigma  = 0.05;
+
+  // A single point in the interior of the grid retains all of its mass,
+  // and its peak is located in the corresponding pixel.
+  {
+    PersistenceDiagram D;
+    D.add( T(0.51), T(1.02) );
+
+    auto image = aleph::persistenceImage( D, options );
+
+    ALEPH_ASSERT_EQUAL( image.size(), 2000 );
+
+    auto sum = std::accumulate( image.begin(), image.end(), 0.0 );
+    auto max = std::max_element( image.begin(), image.end() ) - image.begin();
+
+    ALEPH_ASSERT_THROW( std::abs( sum - 1.0 ) < 1e-4 );
+    ALEPH_ASSERT_EQUAL( max % 50, 25 );
+    ALEPH_ASSERT_EQUAL( max / 50, 20 );
+
+    auto weighted            = options;
+    weighted.weightThreshold = 1.0;
+
+    image = aleph::persistenceImage( D, weighted );
+    sum   = std::accumulate( image.begin(), image.end(), 0.0 );
+
+    ALEPH_ASSERT_THROW( std::abs( sum - 0.51 ) < 1e-4 );
+  }
+
+  // Truncating the Gaussian does not change the result noticeably, and the
+  // batched calculation coincides with the individual one.
+  {
+    std::vector<PersistenceDiagram> diagrams;
+    for( unsigned i = 0; i < 10; i++ )
+      diagrams.push_back( createRandomPersistenceDiagram<T>( 30 ) );
+
+    auto untruncated       = options;
+    untruncated.truncation = 0.0;
+
+    auto images = aleph::persistenceImages( diagrams.begin(), diagrams.end(), options );
+
+    ALEPH_ASSERT_EQUAL( images.size(), diagrams.size() * 2000 );
+
+    for( std::size_t i = 0; i < diagrams.size(); i++ )
+    {
+      auto truncated = aleph::persistenceImage( diagrams[i], options );
+      auto reference = aleph::persistenceImage( diagrams[i], untruncated );
+
+      ALEPH_ASSERT_THROW( std::equal( truncated.begin(), truncated.end(), images.begin() + std::ptrdiff_t( i * 2000 ) ) );
+
+      for( std::size_t j = 0; j < reference.size(); j++ )
+        ALEPH_ASSERT_THROW( std::abs( truncated[j] - reference[j] ) < 1e-5 );
+    }
+
+    aleph::fitPersistenceImage( diagrams.begin(), diagrams.end(), options );
+
+    ALEPH_ASSERT_THROW( options.xMin < 0.0 );
+    ALEPH_ASSERT_THROW( options.yMin >= 0.0 );
+    ALEPH_ASSERT_THROW( options.xMax > 0.0 );
+  }
+
+  ALEPH_TEST_END();
+}
+
+template <class T> void testPersistenceLandscape()
+{
+  ALEPH_TEST_BEGIN( "Persistence landscape" );
+
+  using PersistenceDiagram = aleph::PersistenceDiagram<T>;
+
+  // Two overlapping intervals
+  {
+    PersistenceDiagram D;
+    D.add( T(0), T(2) );
+    D.add( T(1), T(3) );
+
+    aleph::PersistenceLandscape L( D );
+
+    ALEPH_ASSERT_EQUAL( L.levels(), 2 );
+    ALEPH_ASSERT_EQUAL( L.level(0).size(), 5 );
+    ALEPH_ASSERT_EQUAL( L.level(1).size(), 3 );
+
+    ALEPH_ASSERT_THROW( std::abs( L( 0, 1.0 ) - 1.0  ) < 1e-12 );
+    ALEPH_ASSERT_THROW( std::abs( L( 0, 1.5 ) - 0.5  ) < 1e-12 );
+    ALEPH_ASSERT_THROW( std::abs( L( 1, 1.5 ) - 0.5  ) < 1e-12 );
+    ALEPH_ASSERT_THROW( std::abs( L( 1, 1.25 ) - 0.25 ) < 1e-12 );
+    ALEPH_ASSERT_THROW( L( 2, 1.5 ) == 0.0 );
+
+    // The first level consists of two triangles of area 1 minus a small
+    // triangle of area 1/4, while the second level has area 1/4.
+    ALEPH_ASSERT_THROW( std::abs( L.norm( 1 ) - 2.0 ) < 1e-12 );
+    ALEPH_ASSERT_THROW( std::abs( L.norm( std::numeric_limits<double>::infinity() ) - 1.0 ) < 1e-12 );
+    ALEPH_ASSERT_THROW( std::abs( innerProduct( L, L ) - std::pow( L.norm( 2 ), 2 ) ) < 1e-12 );
+  }
+
+  // Random diagrams: compare exact landscapes to a brute-force evaluation
+  // and to their discretised counterparts
+  {
+    std::vector<PersistenceDiagram> diagrams;
+    for( unsigned i = 0; i < 5; i++ )
+      diagrams.push_back( createRandomPersistenceDiagram<T>( 40 ) );
+
+    aleph::PersistenceLandscapeGrid grid;
+    grid.samples = 1001;
+    grid.levels  = 100;
+
+    auto landscapes = aleph::persistenceLandscapes( diagrams.begin(), diagrams.end() );
+    auto discrete   = aleph::persistenceLandscapes( diagrams.begin(), diagrams.end(), grid );
+
+    ALEPH_ASSERT_EQUAL( landscapes.size(), diagrams.size() );
+    ALEPH_ASSERT_EQUAL( discrete.size(),   diagrams.size() );
+
+    for( std::size_t i = 0; i < diagrams.size(); i++ )
+    {
+      for( unsigned s = 0; s < grid.samples; s += 10 )
+      {
+        auto t = grid.xMin + s * discrete[i].delta();
+
+        std::vector<double> values;
+        for( auto&& p : diagrams[i] )
+          values.push_back( std::max( 0.0, std::min( t - double( p.x() ), double( p.y() ) - t ) ) );
+
+        std::sort( values.begin(), values.end(), std::greater<double>() );
+
+        for( std::size_t k = 0; k < 5; k++ )
+        {
+          ALEPH_ASSERT_THROW( std::abs( landscapes[i]( k, t ) - values[k] ) < 1e-9 );
+          ALEPH_ASSERT_THROW( std::abs( discrete[i]( k, s )   - values[k] ) < 1e-9 );
+        }
+      }
+
+      for( double p : { 1.0, 2.0 } )
+        ALEPH_ASSERT_THROW( std::abs( landscapes[i].norm( p ) - discrete[i].norm( p ) ) < 1e-3 * landscapes[i].norm( p ) );
+    }
+
+    auto A = aleph::averageLandscape( landscapes.begin(), landscapes.end() );
+    auto B = aleph::averageLandscape( discrete.begin(), discrete.end() );
+
+    for( unsigned s = 0; s < grid.samples; s += 50 )
+    {
+      auto t = grid.xMin + s * B.delta();
+
+      double mean = 0.0;
+      for( auto&& L : landscapes )
+        mean += L( 0, t );
+
+      mean /= double( landscapes.size() );
+
+      ALEPH_ASSERT_THROW( std::abs( A( 0, t ) - mean ) < 1e-9 );
+      ALEPH_ASSERT_THROW( std::abs( B( 0, s ) - mean ) < 1e-9 );
+    }
+
+    auto d1 = aleph::landscapeDistance( landscapes[0], landscapes[1] );
+    auto d2 = aleph::landscapeDistance( discrete[0], discrete[1] );
+
+    ALEPH_ASSERT_THROW( d1 > 0.0 );
+    ALEPH_ASSERT_THROW( std::abs( d1 - d2 ) < 1e-2 * d1 );
+    ALEPH_ASSERT_THROW( aleph::landscapeDistance( landscapes[0], landscapes[0] ) == 0.0 );
+
+    // Polarisation identity
+    auto n0 = landscapes[0].norm( 2 );
+    auto n1 = landscapes[1].norm( 2 );
+    auto ip = innerProduct( landscapes[0], landscapes[1] );
+
+    ALEPH_ASSERT_THROW( std::abs( d1 * d1 - ( n0 * n0 + n1 * n1 - 2 * ip ) ) < 1e-9 );
+  }
+
+  // Sums of many landscapes, including nested and duplicate intervals,
+  // agree with adding them one after the other
+  {
+    std::vector<aleph::PersistenceLandscape> landscapes;
+
+    for( unsigned i = 0; i < 30; i++ )
+    {
+      auto D = createRandomPersistenceDiagram<T>( 20 + i );
+      D.add( T(1), T(4) );
+      D.add( T(1), T(4) );
+      D.add( T(2), T(3) );
+
+      landscapes.push_back( aleph::PersistenceLandscape( D ) );
+    }
+
+    auto S = aleph::PersistenceLandscape::sum( landscapes.begin(), landscapes.end() );
+    auto R = landscapes.front();
+
+    for( std::size_t i = 1; i < landscapes.size(); i++ )
+      R += landscapes[i];
+
+    ALEPH_ASSERT_EQUAL( S.levels(), R.levels() );
+
+    for( std::size_t k = 0; k < R.levels(); k++ )
+    {
+      for( auto&& p : R.level(k) )
+        ALEPH_ASSERT_THROW( std::abs( S( k, p.first ) - p.second ) < 1e-9 );
+
+      for( auto&& p : S.level(k) )
+        ALEPH_ASSERT_THROW( std::abs( R( k, p.first ) - p.second ) < 1e-9 );
+    }
+
+    ALEPH_ASSERT_THROW( std::abs( S.norm( 2 ) - R.norm( 2 ) ) < 1e-9 * R.norm( 2 ) );
+  }
+
+  ALEPH_TEST_END();
+}
+
 template <class T> void testPersistenceIndicatorFunction()
 {
   ALEPH_TEST_BEGIN( "Persistence indicator function" );
@@ -198,8 +627,12 @@ template <class T> void testPersistenceIndicatorFunction()
     auto d1 = (f-g).abs().integral();
     auto d2 = (g-f).abs().integral();
 
-    ALEPH_ASSERT_THROW( d1 >= p1+p2 );
-    ALEPH_ASSERT_THROW( d2 >= p1+p2 );
+    // The supports of both functions are disjoint, so the bound is
+    // attained up to rounding errors.
+    auto tolerance = 1e-5 * ( p1+p2 );
+
+    ALEPH_ASSERT_THROW( d1 >= p1+p2 - tolerance );
+    ALEPH_ASSERT_THROW( d2 >= p1+p2 - tolerance );
   }
 
   ALEPH_TEST_END();
@@ -229,6 +662,33 @@ template <class T> void testMultiScaleKernel()
   ALEPH_ASSERT_THROW( d1 < 1.0 / ( 1.0 / ( 1.0 * std::sqrt( 8.0 * M_PI ) ) * d3 ) );
   ALEPH_ASSERT_THROW( d2 < 1.0 / ( 1.0 / ( 2.0 * std::sqrt( 8.0 * M_PI ) ) * d3 ) );
 
+  // Gram matrix
+  {
+    std::vector< aleph::PersistenceDiagram<T> > diagrams = { D1, D2, createRandomPersistenceDiagram<T>( 20 ) };
+
+    auto K1 = aleph::multiScaleKernelGramMatrix( diagrams.begin(), diagrams.end(), 1.0 );
+    auto K2 = aleph::multiScaleKernelGramMatrix( diagrams.begin(), diagrams.end(), 1.0, 0.0 );
+    auto D  = aleph::multiScalePseudoMetricMatrix( diagrams.begin(), diagrams.end(), 2.0 );
+
+    for( std::size_t i = 0; i < diagrams.size(); i++ )
+    {
+      for( std::size_t j = 0; j < diagrams.size(); j++ )
+      {
+        // The reference implementation calculates distances in the data
+        // type of the diagram, which is less precise for `float`.
+        auto k = aleph::multiScaleKernel( diagrams[i], diagrams[j], 1.0 );
+        auto e = 1e-5 * std::max( 1.0, std::abs( k ) );
+
+        ALEPH_ASSERT_THROW( std::abs( K1[i][j] - k ) < e );
+        ALEPH_ASSERT_THROW( std::abs( K2[i][j] - k ) < e );
+        ALEPH_ASSERT_EQUAL( K1[i][j], K1[j][i] );
+      }
+    }
+
+    ALEPH_ASSERT_EQUAL( D[0][0], 0.0 );
+    ALEPH_ASSERT_THROW( std::abs( D[0][1] - d2 ) < 1e-4 );
+  }
+
   ALEPH_TEST_END();
 }
 
@@ -247,6 +707,49 @@ template <class T> void testNearestNeighbourDistance()
   ALEPH_TEST_END();
 }
 
+template <class T> void testSlicedWasserstein()
+{
+  ALEPH_TEST_BEGIN( "Sliced Wasserstein distance" );
+
+  auto D1 = createRandomPersistenceDiagram<T>( 50 );
+  auto D2 = createRandomPersistenceDiagram<T>( 40 );
+
+  auto d11 = aleph::slicedWassersteinDistance( D1, D1 );
+  auto d12 = aleph::slicedWassersteinDistance( D1, D2 );
+  auto d21 = aleph::slicedWassersteinDistance( D2, D1 );
+  auto w12 = aleph::distances::wassersteinDistance( D1, D2, T(1) );
+
+  ALEPH_ASSERT_THROW( std::abs( d11 ) < 1e-8 );
+  ALEPH_ASSERT_THROW( d12 > 0.0 );
+  ALEPH_ASSERT_THROW( std::abs( d12 - d21 ) < 1e-8 );
+
+  // The sliced Wasserstein distance is bounded by the Wasserstein
+  // distance, up to a constant.
+  ALEPH_ASSERT_THROW( d12 <= 2 * std::sqrt( 2.0 ) * w12 );
+
+  std::vector< aleph::PersistenceDiagram<T> > diagrams = { D1, D2, createRandomPersistenceDiagram<T>( 10 ) };
+
+  auto K = aleph::slicedWassersteinGramMatrix( diagrams.begin(), diagrams.end(), 1.0 );
+
+  ALEPH_ASSERT_EQUAL( K.size(), diagrams.size() );
+
+  for( std::size_t i = 0; i < K.size(); i++ )
+  {
+    ALEPH_ASSERT_EQUAL( K[i][i], 1.0 );
+
+    for( std::size_t j = 0; j < K.size(); j++ )
+    {
+      ALEPH_ASSERT_EQUAL( K[i][j], K[j][i] );
+      ALEPH_ASSERT_THROW( K[i][j] > 0.0 );
+      ALEPH_ASSERT_THROW( K[i][j] <= 1.0 );
+    }
+  }
+
+  ALEPH_ASSERT_THROW( std::abs( K[0][1] - aleph::slicedWassersteinKernel( D1, D2, 1.0 ) ) < 1e-12 );
+
+  ALEPH_TEST_END();
+}
+
 template <class T> void testWassersteinDistance()
 {
   ALEPH_TEST_BEGIN( "Wasserstein distance" );
@@ -287,6 +790,27 @@ template <class T> void testWassersteinDistance()
     ALEPH_ASSERT_THROW( std::abs( d12 -  T( 3.05 ) ) < 1e-8 );
   }
 
+  {
+    auto D3 = createRandomPersistenceDiagram<T>( 50 );
+    auto D4 = createRandomPersistenceDiagram<T>( 50 );
+
+    for( auto&& power : { T(1), T(2) } )
+    {
+      auto d34 = wassersteinDistance( D3, D4, power );
+      auto a34 = wassersteinDistance( D3, D4, power, T(0.01) );
+
+      // The exact distance is calculated in the data type of the diagram,
+      // so there may be slight rounding differences.
+      ALEPH_ASSERT_THROW( a34 >= T(0.999) * d34 );
+      ALEPH_ASSERT_THROW( a34 <= T(1.011) * d34 );
+
+      auto pairing = aleph::detail::optimalPairing( D3, D4, power );
+
+      ALEPH_ASSERT_EQUAL( pairing.pairs.size(), D3.size() + D4.size() );
+      ALEPH_ASSERT_THROW( std::abs( std::pow( pairing.cost, 1 / double( power ) ) - double( d34 ) ) < 1e-4 );
+    }
+  }
+
   ALEPH_TEST_END();
 }
 
@@ -307,9 +831,21 @@ int main(int, char**)
   testNearestNeighbourDistance<float> ();
   testNearestNeighbourDistance<double>();
 
+  testPairwiseDistances<float> ();
+  testPairwiseDistances<double>();
+
+  testPersistenceImage<float> ();
+  testPersistenceImage<double>();
+
+  testPersistenceLandscape<float> ();
+  testPersistenceLandscape<double>();
+
   testPersistenceIndicatorFunction<float> ();
   testPersistenceIndicatorFunction<double>();
 
+  testSlicedWasserstein<float> ();
+  testSlicedWasserstein<double>();
+
   testWassersteinDistance<float> ();
   testWassersteinDistance<double>();
 }
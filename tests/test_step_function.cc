@@ -6,7 +6,9 @@
 #include <tests/Base.hh>
 
 #include <iterator>
+#include <random>
 #include <set>
+#include <vector>
 
 #include <cmath>
 
@@ -267,6 +269,67 @@ template <class T> void testPersistenceIndicatorFunction()
   ALEPH_TEST_END();
 }
 
+template <class T> void testStepFunctionSum()
+{
+  ALEPH_TEST_BEGIN( "Step function: Sum" );
+
+  std::random_device rd;
+  std::default_random_engine rng( rd() );
+  std::uniform_int_distribution<int> distribution( 0, 20 );
+
+  std::vector< StepFunction<T> > functions;
+
+  for( unsigned i = 0; i < 50; i++ )
+  {
+    StepFunction<T> f;
+
+    T a = T( distribution( rng ) ) / 4;
+    for( unsigned j = 0; j < 5; j++ )
+    {
+      auto b = a + T( 1 + distribution( rng ) ) / 4;
+      f.add( a, b, T( distribution( rng ) - 10 ) );
+
+      a = b + T( distribution( rng ) % 2 ) / 4;
+    }
+
+    functions.push_back( f );
+  }
+
+  auto f = sum( functions.begin(), functions.end() );
+
+  StepFunction<T> g;
+  StepFunction<T> h;
+
+  for( auto&& function : functions )
+  {
+    g += function;
+    h  = function + h;
+  }
+
+  // All values are multiples of 1/8, so the comparison is exact.
+  for( unsigned i = 0; i < 400; i++ )
+  {
+    auto x = T( i ) / 8;
+
+    T y = T();
+    for( auto&& function : functions )
+      y += function( x );
+
+    ALEPH_ASSERT_EQUAL( f(x), y );
+    ALEPH_ASSERT_EQUAL( g(x), y );
+    ALEPH_ASSERT_EQUAL( h(x), y );
+  }
+
+  ALEPH_ASSERT_EQUAL( f.integral(), g.integral() );
+  ALEPH_ASSERT_EQUAL( f.integral(), h.integral() );
+
+  auto d = f - g;
+  ALEPH_ASSERT_EQUAL( d.integral(), T(0) );
+  ALEPH_ASSERT_EQUAL( d.sup(),      T(0) );
+
+  ALEPH_TEST_END();
+}
+
 int main()
 {
   testStepFunction<double>();
@@ -278,6 +341,9 @@ int main()
   testStepFunctionNegation<double>();
   testStepFunctionNegation<float> ();
 
+  testStepFunctionSum<double>();
+  testStepFunctionSum<float> ();
+
   testStepFunctionNormalization<double>();
   testStepFunctionNormalization<float> ();
 
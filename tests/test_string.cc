@@ -0,0 +1,178 @@
+#include <tests/Base.hh>
+
+#include <aleph/utilities/String.hh>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+void testTokenizer()
+{
+  ALEPH_TEST_BEGIN( "Tokenizer" );
+
+  using namespace aleph::utilities;
+
+  {
+    Tokenizer tokenizer;
+
+    auto&& tokens = tokenizer( "  1.0\t2  \r\n3 " );
+
+    ALEPH_ASSERT_EQUAL( tokens.size(), 3 );
+    ALEPH_ASSERT_THROW( tokens[0] == "1.0" );
+    ALEPH_ASSERT_THROW( tokens[1] == "2" );
+    ALEPH_ASSERT_THROW( tokens[2] == "3" );
+
+    ALEPH_ASSERT_THROW( tokenizer( "" ).empty() );
+    ALEPH_ASSERT_THROW( tokenizer( " \t " ).empty() );
+  }
+
+  {
+    Tokenizer tokenizer( ",; " );
+
+    auto&& tokens = tokenizer( ",a,,b ;c;" );
+
+    ALEPH_ASSERT_EQUAL( tokens.size(), 3 );
+    ALEPH_ASSERT_THROW( tokens[0] == "a" );
+    ALEPH_ASSERT_THROW( tokens[1] == "b" );
+    ALEPH_ASSERT_THROW( tokens[2] == "c" );
+  }
+
+  {
+    ALEPH_ASSERT_THROW( trim( StringView( "  foo bar \t" ) ) == "foo bar" );
+    ALEPH_ASSERT_THROW( trim( StringView( "   " ) ).empty() );
+    ALEPH_ASSERT_THROW( equalsIgnoreCase( "Vertices", "vERTICES" ) );
+    ALEPH_ASSERT_THROW( !equalsIgnoreCase( "Vertices", "Vertex" ) );
+  }
+
+  ALEPH_TEST_END();
+}
+
+void testIntegers()
+{
+  ALEPH_TEST_BEGIN( "Parsing integers" );
+
+  using namespace aleph::utilities;
+
+  {
+    int value = 0;
+
+    ALEPH_ASSERT_THROW( parse( "42", value ) );
+    ALEPH_ASSERT_EQUAL( value, 42 );
+
+    ALEPH_ASSERT_THROW( parse( "-17", value ) );
+    ALEPH_ASSERT_EQUAL( value, -17 );
+
+    ALEPH_ASSERT_THROW( parse( "+5", value ) );
+    ALEPH_ASSERT_EQUAL( value, 5 );
+
+    ALEPH_ASSERT_THROW( parse( "-2147483648", value ) );
+    ALEPH_ASSERT_EQUAL( value, std::numeric_limits<int>::min() );
+
+    ALEPH_ASSERT_THROW( !parse( "2147483648", value ) );
+    ALEPH_ASSERT_THROW( !parse( "12a", value ) );
+    ALEPH_ASSERT_THROW( !parse( "", value ) );
+    ALEPH_ASSERT_THROW( !parse( "-", value ) );
+  }
+
+  {
+    unsigned value = 3;
+
+    ALEPH_ASSERT_THROW( !parse( "-1", value ) );
+    ALEPH_ASSERT_EQUAL( value, 3 );
+
+    ALEPH_ASSERT_THROW( parse( "4294967295", value ) );
+    ALEPH_ASSERT_EQUAL( value, std::numeric_limits<unsigned>::max() );
+
+    std::uint8_t small = 0;
+    ALEPH_ASSERT_THROW( !parse( "256", small ) );
+  }
+
+  {
+    const char* s = "123abc";
+    long value    = 0;
+
+    auto end = fromChars( s, s + 6, value );
+
+    ALEPH_ASSERT_EQUAL( value, 123 );
+    ALEPH_ASSERT_THROW( end == s + 3 );
+  }
+
+  ALEPH_ASSERT_EQUAL( parse<int>( "foo" ), 0 );
+
+  ALEPH_TEST_END();
+}
+
+void testFloatingPoint()
+{
+  ALEPH_TEST_BEGIN( "Parsing floating point numbers" );
+
+  using namespace aleph::utilities;
+
+  {
+    double value = 0.0;
+
+    ALEPH_ASSERT_THROW( parse( "0.1", value ) );
+    ALEPH_ASSERT_THROW( value == 0.1 );
+
+    ALEPH_ASSERT_THROW( parse( "-1.5e3", value ) );
+    ALEPH_ASSERT_THROW( value == -1500.0 );
+
+    ALEPH_ASSERT_THROW( parse( ".5", value ) );
+    ALEPH_ASSERT_THROW( value == 0.5 );
+
+    ALEPH_ASSERT_THROW( parse( "3.", value ) );
+    ALEPH_ASSERT_THROW( value == 3.0 );
+
+    // Many significant digits require the slow path
+    ALEPH_ASSERT_THROW( parse( "3.14159265358979323846", value ) );
+    ALEPH_ASSERT_THROW( value == 3.14159265358979323846 );
+
+    ALEPH_ASSERT_THROW( parse( "1e-300", value ) );
+    ALEPH_ASSERT_THROW( value == 1e-300 );
+
+    ALEPH_ASSERT_THROW( parse( "  2.5", value ) );
+    ALEPH_ASSERT_THROW( value == 2.5 );
+  }
+
+  {
+    double value = 0.0;
+
+    ALEPH_ASSERT_THROW( parse( "inf", value ) );
+    ALEPH_ASSERT_THROW( std::isinf( value ) && value > 0 );
+
+    ALEPH_ASSERT_THROW( parse( "-Infinity", value ) );
+    ALEPH_ASSERT_THROW( std::isinf( value ) && value < 0 );
+
+    ALEPH_ASSERT_THROW( parse( "NaN", value ) );
+    ALEPH_ASSERT_THROW( std::isnan( value ) );
+  }
+
+  {
+    double value = 7.0;
+
+    ALEPH_ASSERT_THROW( !parse( "1.0x", value ) );
+    ALEPH_ASSERT_THROW( !parse( "e5", value ) );
+    ALEPH_ASSERT_THROW( !parse( "", value ) );
+    ALEPH_ASSERT_THROW( !parse( "infinit", value ) );
+  }
+
+  {
+    float value = 0.0f;
+
+    ALEPH_ASSERT_THROW( parse( "0.1", value ) );
+    ALEPH_ASSERT_THROW( value == 0.1f );
+
+    ALEPH_ASSERT_THROW( parse( "16777217", value ) );
+    ALEPH_ASSERT_THROW( value == 16777217.0f );
+  }
+
+  ALEPH_TEST_END();
+}
+
+int main( int, char** )
+{
+  testTokenizer();
+  testIntegers();
+  testFloatingPoint();
+}
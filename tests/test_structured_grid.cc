@@ -0,0 +1,254 @@
+#include <tests/Base.hh>
+
+#include <aleph/topology/Simplex.hh>
+#include <aleph/topology/SimplicialComplex.hh>
+#include <aleph/topology/StructuredGrid.hh>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+template <class T> std::vector< aleph::topology::GridSlab<T> > makeSlabs( const std::vector<std::size_t>& dimensions,
+                                                                           const std::vector<T>& values,
+                                                                           std::size_t layersPerSlab )
+{
+  std::vector< aleph::topology::GridSlab<T> > slabs;
+
+  std::size_t layerSize = values.size() / dimensions.front();
+
+  for( std::size_t offset = 0; offset < dimensions.front(); offset += layersPerSlab )
+  {
+    aleph::topology::GridSlab<T> slab;
+
+    slab.dimensions = dimensions;
+    slab.offset     = offset;
+    slab.layers     = std::min( layersPerSlab, dimensions.front() - offset );
+
+    slab.values.assign( values.begin() + static_cast<std::ptrdiff_t>( offset * layerSize ),
+                        values.begin() + static_cast<std::ptrdiff_t>( ( offset + slab.layers ) * layerSize ) );
+
+    slabs.push_back( slab );
+  }
+
+  return slabs;
+}
+
+template <class Simplex> long eulerCharacteristic( const std::vector<Simplex>& simplices )
+{
+  long chi = 0;
+
+  for( auto&& s : simplices )
+    chi += s.dimension() % 2 == 0 ? 1 : -1;
+
+  return chi;
+}
+
+template <class T> void testFreudenthal()
+{
+  ALEPH_TEST_BEGIN( "Freudenthal triangulation" );
+
+  using Simplex           = aleph::topology::Simplex<T, unsigned>;
+  using SimplicialComplex = aleph::topology::SimplicialComplex<Simplex>;
+
+  // 2D ----------------------------------------------------------------
+
+  {
+    std::vector<T> values = { 0, 1, 2,
+                              3, 4, 5,
+                              6, 7, 8 };
+
+    aleph::topology::FreudenthalTriangulation<Simplex> triangulation;
+    std::vector<Simplex> simplices;
+
+    for( auto&& slab : makeSlabs<T>( { 3, 3 }, values, 3 ) )
+      triangulation( slab, std::back_inserter( simplices ) );
+
+    auto n0 = std::count_if( simplices.begin(), simplices.end(), [] ( const Simplex& s ) { return s.dimension() == 0; } );
+    auto n1 = std::count_if( simplices.begin(), simplices.end(), [] ( const Simplex& s ) { return s.dimension() == 1; } );
+    auto n2 = std::count_if( simplices.begin(), simplices.end(), [] ( const Simplex& s ) { return s.dimension() == 2; } );
+
+    ALEPH_ASSERT_EQUAL( n0,  9 );
+    ALEPH_ASSERT_EQUAL( n1, 16 );
+    ALEPH_ASSERT_EQUAL( n2,  8 );
+
+    // Every simplex is assigned the maximum of its vertices
+    for( auto&& s : simplices )
+      ALEPH_ASSERT_EQUAL( s.data(), values.at( *s.begin() ) );
+  }
+
+  // 3D, streamed in slabs of different sizes --------------------------
+
+  {
+    std::vector<std::size_t> dimensions = { 5, 3, 4 };
+    std::vector<T> values( 5*3*4 );
+
+    std::mt19937 rng( 42 );
+    std::uniform_int_distribution<int> distribution( 0, 10 );
+
+    for( auto&& value : values )
+      value = static_cast<T>( distribution( rng ) );
+
+    std::vector<Simplex> reference;
+
+    {
+      aleph::topology::FreudenthalTriangulation<Simplex> triangulation;
+
+      for( auto&& slab : makeSlabs( dimensions, values, 5 ) )
+        triangulation( slab, std::back_inserter( reference ) );
+    }
+
+    // Each cube is split into 6 tetrahedra
+    auto n3 = std::count_if( reference.begin(), reference.end(), [] ( const Simplex& s ) { return s.dimension() == 3; } );
+
+    ALEPH_ASSERT_EQUAL( n3, 6 * 4*2*3 );
+    ALEPH_ASSERT_EQUAL( eulerCharacteristic( reference ), 1 );
+
+    SimplicialComplex K( reference.begin(), reference.end() );
+
+    for( auto&& s : K )
+    {
+      for( auto it = s.begin_boundary(); it != s.end_boundary(); ++it )
+        ALEPH_ASSERT_THROW( K.contains( *it ) );
+    }
+
+    std::sort( reference.begin(), reference.end() );
+
+    for( std::size_t layers = 1; layers <= 4; layers++ )
+    {
+      aleph::topology::FreudenthalTriangulation<Simplex> triangulation;
+      std::vector<Simplex> simplices;
+
+      for( auto&& slab : makeSlabs( dimensions, values, layers ) )
+        triangulation( slab, std::back_inserter( simplices ) );
+
+      std::sort( simplices.begin(), simplices.end() );
+
+      ALEPH_ASSERT_EQUAL( simplices.size(), reference.size() );
+      ALEPH_ASSERT_THROW( std::equal( simplices.begin(), simplices.end(), reference.begin(),
+                                      [] ( const Simplex& s, const Simplex& t ) { return s == t && s.data() == t.data(); } ) );
+    }
+
+    // Restricting the dimension yields the 1-skeleton of the
+    // triangulation
+    {
+      aleph::topology::FreudenthalTriangulation<Simplex> triangulation;
+      triangulation.setMaxDimension( 1 );
+
+      std::vector<Simplex> simplices;
+
+      for( auto&& slab : makeSlabs( dimensions, values, 2 ) )
+        triangulation( slab, std::back_inserter( simplices ) );
+
+      auto n1 = std::count_if( reference.begin(), reference.end(), [] ( const Simplex& s ) { return s.dimension() <= 1; } );
+      auto n2 = static_cast<long>( simplices.size() );
+
+      ALEPH_ASSERT_EQUAL( n1, n2 );
+    }
+  }
+
+  // 4D ----------------------------------------------------------------
+
+  {
+    std::vector<std::size_t> dimensions = { 3, 2, 2, 3 };
+    std::vector<T> values( 3*2*2*3, T(1) );
+
+    aleph::topology::FreudenthalTriangulation<Simplex> triangulation;
+    std::vector<Simplex> simplices;
+
+    for( auto&& slab : makeSlabs( dimensions, values, 2 ) )
+      triangulation( slab, std::back_inserter( simplices ) );
+
+    // Each hypercube is split into 24 simplices
+    auto n4 = std::count_if( simplices.begin(), simplices.end(), [] ( const Simplex& s ) { return s.dimension() == 4; } );
+
+    ALEPH_ASSERT_EQUAL( n4, 24 * 2*1*1*2 );
+    ALEPH_ASSERT_EQUAL( eulerCharacteristic( simplices ), 1 );
+  }
+
+  ALEPH_TEST_END();
+}
+
+void testCubical()
+{
+  ALEPH_TEST_BEGIN( "Cubical grid filtration" );
+
+  using Cube = aleph::topology::GridCube<double>;
+
+  std::vector<std::size_t> dimensions = { 4, 3, 5 };
+  std::vector<int> values( 4*3*5 );
+
+  for( std::size_t i = 0; i < values.size(); i++ )
+    values[i] = static_cast<int>( ( i * 7 ) % 11 );
+
+  std::vector<Cube> reference;
+
+  {
+    aleph::topology::CubicalGridFiltration<double> filtration;
+
+    for( auto&& slab : makeSlabs( dimensions, values, 4 ) )
+      filtration( slab, std::back_inserter( reference ) );
+  }
+
+  std::vector<long> counts( 4 );
+
+  for( auto&& cube : reference )
+    counts.at( cube.dimension() ) += 1;
+
+  ALEPH_ASSERT_EQUAL( counts[0], 4*3*5 );
+  ALEPH_ASSERT_EQUAL( counts[1], 3*3*5 + 4*2*5 + 4*3*4 );
+  ALEPH_ASSERT_EQUAL( counts[3], 3*2*4 );
+  ALEPH_ASSERT_EQUAL( counts[0] - counts[1] + counts[2] - counts[3], 1 );
+
+  // The value of every cube is the maximum of its corners; the corner
+  // opposite to the anchor is part of all cubes.
+  for( auto&& cube : reference )
+  {
+    std::size_t opposite = cube.anchor;
+
+    if( cube.directions & 1 ) opposite += 15;
+    if( cube.directions & 2 ) opposite += 5;
+    if( cube.directions & 4 ) opposite += 1;
+
+    ALEPH_ASSERT_THROW( cube.value >= values.at( cube.anchor ) );
+    ALEPH_ASSERT_THROW( cube.value >= values.at( opposite ) );
+  }
+
+  {
+    aleph::topology::CubicalGridFiltration<double> filtration;
+    std::vector<Cube> cubes;
+
+    for( auto&& slab : makeSlabs( dimensions, values, 1 ) )
+      filtration( slab, std::back_inserter( cubes ) );
+
+    ALEPH_ASSERT_EQUAL( cubes.size(), reference.size() );
+    ALEPH_ASSERT_THROW( std::equal( cubes.begin(), cubes.end(), reference.begin(),
+                                    [] ( const Cube& c, const Cube& d )
+                                    {
+                                      return c.anchor == d.anchor && c.directions == d.directions && c.value == d.value;
+                                    } ) );
+  }
+
+  // Slabs need to be contiguous
+  {
+    aleph::topology::CubicalGridFiltration<double> filtration;
+    std::vector<Cube> cubes;
+
+    auto slabs = makeSlabs( dimensions, values, 1 );
+
+    filtration( slabs.at(0), std::back_inserter( cubes ) );
+
+    ALEPH_ASSERT_THROWS( filtration( slabs.at(2), std::back_inserter( cubes ) ), std::runtime_error );
+  }
+
+  ALEPH_TEST_END();
+}
+
+int main(int, char**)
+{
+  testFreudenthal<double>();
+  testFreudenthal<float> ();
+
+  testCubical();
+}